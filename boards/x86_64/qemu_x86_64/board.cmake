@@ -1,2 +1,6 @@
 set(EMU_PLATFORM qemu)
 set(QEMU_FLAGS_${ARCH} -nographic)
+
+if(CONFIG_SMP)
+  list(APPEND QEMU_FLAGS_${ARCH} -smp ${CONFIG_MP_NUM_CPUS})
+endif()
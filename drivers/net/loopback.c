@@ -23,6 +23,52 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #include <net/net_if.h>
 
 #include <net/dummy.h>
+#include <net/loopback.h>
+
+#if defined(CONFIG_NET_LOOPBACK_SIMULATE_PACKET_DROP)
+static u8_t drop_rate;
+static u32_t drop_state = 1U;
+static u32_t dropped;
+
+int loopback_set_packet_drop_rate(u8_t percent)
+{
+	if (percent > 100) {
+		return -EINVAL;
+	}
+
+	drop_rate = percent;
+
+	return 0;
+}
+
+u32_t loopback_get_num_dropped_packets(void)
+{
+	return dropped;
+}
+
+static bool drop_packet(void)
+{
+	if (drop_rate == 0U) {
+		return false;
+	}
+
+	/* Deterministic sequence so that test runs are reproducible */
+	drop_state = drop_state * 1103515245U + 12345U;
+
+	if ((drop_state >> 16) % 100 >= drop_rate) {
+		return false;
+	}
+
+	dropped++;
+
+	return true;
+}
+#else
+static inline bool drop_packet(void)
+{
+	return false;
+}
+#endif
 
 int loopback_dev_init(struct device *dev)
 {
@@ -70,6 +116,12 @@ static int loopback_send(struct device *dev, struct net_pkt *pkt)
 		net_ipaddr_copy(&NET_IPV4_HDR(pkt)->dst, &addr);
 	}
 
+	/* Lost on the "wire", the caller releases the packet as usual */
+	if (drop_packet()) {
+		LOG_DBG("Dropping pkt %p", pkt);
+		return 0;
+	}
+
 	/* We should simulate normal driver meaning that if the packet is
 	 * properly sent (which is always in this driver), then the packet
 	 * must be dropped. This is very much needed for TCP packets where
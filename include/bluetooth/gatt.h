@@ -739,6 +739,60 @@ static inline int bt_gatt_notify(struct bt_conn *conn,
 	return bt_gatt_notify_cb(conn, attr, data, len, NULL);
 }
 
+struct bt_gatt_notify_all_params;
+
+/** @typedef bt_gatt_notify_all_func_t
+ *  @brief Notification to all peers complete callback.
+ *
+ *  @param params Notification parameters.
+ *  @param count Number of peers the notification was queued for.
+ */
+typedef void (*bt_gatt_notify_all_func_t)(
+				struct bt_gatt_notify_all_params *params,
+				u8_t count);
+
+/** @brief GATT Notify All Value parameters */
+struct bt_gatt_notify_all_params {
+	/** Characteristic or Characteristic Value attribute */
+	const struct bt_gatt_attr *attr;
+	/** Notification Value data */
+	const void *data;
+	/** Notification Value length */
+	u16_t len;
+	/** Notification Value callback, called once for all the peers */
+	bt_gatt_notify_all_func_t func;
+	/** Number of peers the notification was queued for */
+	u8_t count;
+};
+
+/** @brief Notify attribute value change to all peers at once.
+ *
+ *  Send notification of attribute value change to all the peers that have
+ *  notification enabled via CCC, like @ref bt_gatt_notify with a NULL
+ *  connection. The value is copied once in a buffer shared by all the
+ *  peers instead of once per peer, so the ACL buffers are only used when
+ *  the controller can accept the data.
+ *
+ *  The callback is called from the Bluetooth TX thread, or before this
+ *  function returns, once the notification has been passed to the
+ *  controller, or dropped, for all the peers. The parameters must remain
+ *  valid until then.
+ *
+ *  A peer the notification cannot be queued for, e.g. because its ATT MTU
+ *  is too small for the value, is skipped and does not keep the
+ *  notification from the other peers.
+ *
+ *  @note This API requires CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0.
+ *
+ *  @param params Notify All parameters.
+ *
+ *  @return 0 if the notification was queued for at least one peer,
+ *  -ENOTCONN if no peer has notification enabled, or negative value in
+ *  case of error for all the peers. The callback is only called when 0
+ *  is returned.
+ */
+int bt_gatt_notify_all(struct bt_gatt_notify_all_params *params);
+
 /** @typedef bt_gatt_indicate_func_t
  *  @brief Indication complete result callback.
  *
@@ -41,6 +41,9 @@ enum json_tokens {
 	JSON_TOK_COLON = ':',
 	JSON_TOK_COMMA = ',',
 	JSON_TOK_NUMBER = '0',
+	JSON_TOK_FLOAT = '1',
+	JSON_TOK_INT64 = '5',
+	JSON_TOK_UINT64 = '6',
 	JSON_TOK_TRUE = 't',
 	JSON_TOK_FALSE = 'f',
 	JSON_TOK_NULL = 'n',
@@ -51,20 +54,20 @@ enum json_tokens {
 struct json_obj_descr {
 	const char *field_name;
 
-	/* Alignment can never be 0 or more than 4.  The macros to create a
-	 * struct json_obj_descr will subtract 1 from the result of
-	 * __alignof__() calls in order to keep this value in the 0-3 range
-	 * and thus use only 2 bits.  1 is added back when rounding it up to
-	 * calculate the struct size while parsing an array or object.
+	/* Alignment can only be 1, 2, 4 or 8.  The macros to create a
+	 * struct json_obj_descr store its base 2 logarithm so that it fits
+	 * in 2 bits.  The alignment is used when rounding up to calculate
+	 * the struct size while parsing an array or object.
 	 */
-	u32_t alignment : 2;
+	u32_t align_shift : 2;
 
 	/* 127 characters is more than enough for a field name. */
 	u32_t field_name_len : 7;
 
 	/* Valid values here (enum json_tokens): JSON_TOK_STRING,
-	 * JSON_TOK_NUMBER, JSON_TOK_TRUE, JSON_TOK_FALSE,
-	 * JSON_TOK_OBJECT_START, JSON_TOK_LIST_START.  (All others
+	 * JSON_TOK_NUMBER, JSON_TOK_FLOAT, JSON_TOK_INT64, JSON_TOK_UINT64,
+	 * JSON_TOK_TRUE, JSON_TOK_FALSE, JSON_TOK_OBJECT_START,
+	 * JSON_TOK_LIST_START.  (All others
 	 * ignored.) Maximum value is '}' (125), so this has to be 7 bits
 	 * long.
 	 */
@@ -85,6 +88,36 @@ struct json_obj_descr {
 	};
 };
 
+#define Z_JSON_ALIGN_SHIFT(type) \
+	(__alignof__(type) == 1 ? 0 : \
+	 __alignof__(type) == 2 ? 1 : \
+	 __alignof__(type) == 4 ? 2 : 3)
+
+/**
+ * @brief Fixed point number, the C type of JSON_TOK_FLOAT fields
+ *
+ * The value is val1 + val2 / JSON_FLOAT_DEC_MAX, and both parts have
+ * the sign of the value: -1.25 is stored as { -1, -250000 }. This is
+ * the layout of the LwM2M float32_value_t.
+ */
+struct json_float {
+	s32_t val1;
+	s32_t val2;
+};
+
+#define JSON_FLOAT_DEC_MAX 1000000
+
+/**
+ * @brief Maximum number of fields in an object descriptor
+ *
+ * The decoded fields are reported as a bitmap in a s64_t, so objects,
+ * including nested ones, can have at most this many fields. Split
+ * larger objects over several descriptors.
+ */
+#define JSON_OBJ_MAX_FIELDS 62
+
+struct net_buf;
+
 /**
  * @brief Function pointer type to append bytes to a buffer while
  * encoding JSON data.
@@ -100,6 +133,20 @@ struct json_obj_descr {
 typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 				   void *data);
 
+/**
+ * @brief Function pointer type to read the next bytes of the JSON data
+ * while decoding it with json_obj_parse_stream().
+ *
+ * @param bytes Where to store the data
+ * @param len Maximum number of bytes to store in @param bytes
+ * @param data User-provided pointer
+ *
+ * @return The number of bytes stored, 0 at the end of the data, or a
+ * negative number on error (which will be propagated to the return
+ * value of json_obj_parse_stream()).
+ */
+typedef ssize_t (*json_read_bytes_t)(char *bytes, size_t len, void *data);
+
 
 /**
  * @brief Helper macro to declare a descriptor for supported primitive
@@ -111,7 +158,9 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  *
  * @param type_ Token type for JSON value corresponding to a primitive
  * type. Must be one of: JSON_TOK_STRING for strings, JSON_TOK_NUMBER
- * for numbers, JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
+ * for s32_t numbers, JSON_TOK_INT64 for s64_t numbers, JSON_TOK_UINT64
+ * for u64_t numbers, JSON_TOK_FLOAT for struct json_float numbers,
+ * JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
  *
  * Here's an example of use:
  *
@@ -128,7 +177,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (#field_name_), \
 		.field_name_len = sizeof(#field_name_) - 1, \
 		.offset = offsetof(struct_, field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = type_, \
 	}
 
@@ -162,7 +211,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (#field_name_), \
 		.field_name_len = (sizeof(#field_name_) - 1), \
 		.offset = offsetof(struct_, field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = JSON_TOK_OBJECT_START, \
 		.object = { \
 			.sub_descr = sub_descr_, \
@@ -201,13 +250,13 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (#field_name_), \
 		.field_name_len = sizeof(#field_name_) - 1, \
 		.offset = offsetof(struct_, field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = JSON_TOK_LIST_START, \
 		.array = { \
 			.element_descr = &(struct json_obj_descr) { \
 				.type = elem_type_, \
 				.offset = offsetof(struct_, len_field_), \
-				.alignment = __alignof__(struct_) - 1, \
+				.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 			}, \
 			.n_elements = (max_len_), \
 		}, \
@@ -258,7 +307,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (#field_name_), \
 		.field_name_len = sizeof(#field_name_) - 1, \
 		.offset = offsetof(struct_, field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = JSON_TOK_LIST_START, \
 		.array = { \
 			.element_descr = &(struct json_obj_descr) { \
@@ -268,7 +317,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 					.sub_descr_len = elem_descr_len_, \
 				}, \
 				.offset = offsetof(struct_, len_field_), \
-				.alignment = __alignof__(struct_) - 1, \
+				.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 			}, \
 			.n_elements = (max_len_), \
 		}, \
@@ -328,7 +377,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (#field_name_), \
 			.field_name_len = sizeof(#field_name_) - 1, \
 			.offset = offsetof(struct_, field_name_), \
-			.alignment = __alignof__(struct_) - 1, \
+			.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 			.type = JSON_TOK_LIST_START, \
 			.array = { \
 			.element_descr = &(struct json_obj_descr) { \
@@ -338,7 +387,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 					.sub_descr_len = elem_descr_len_, \
 				}, \
 				.offset = offsetof(struct_, len_field_), \
-				.alignment = __alignof__(struct_) - 1, \
+				.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 			}, \
 			.n_elements = (max_len_), \
 		}, \
@@ -367,7 +416,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (json_field_name_), \
 		.field_name_len = sizeof(json_field_name_) - 1, \
 		.offset = offsetof(struct_, struct_field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = type_, \
 	}
 
@@ -393,7 +442,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (json_field_name_), \
 		.field_name_len = (sizeof(json_field_name_) - 1), \
 		.offset = offsetof(struct_, struct_field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = JSON_TOK_OBJECT_START, \
 		.object = { \
 			.sub_descr = sub_descr_, \
@@ -429,13 +478,13 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = (json_field_name_), \
 		.field_name_len = sizeof(json_field_name_) - 1, \
 		.offset = offsetof(struct_, struct_field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = JSON_TOK_LIST_START, \
 		.array = { \
 			.element_descr = &(struct json_obj_descr) { \
 				.type = elem_type_, \
 				.offset = offsetof(struct_, len_field_), \
-				.alignment = __alignof__(struct_) - 1, \
+				.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 			}, \
 			.n_elements = (max_len_), \
 		}, \
@@ -495,7 +544,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.field_name = json_field_name_, \
 		.field_name_len = sizeof(json_field_name_) - 1, \
 		.offset = offsetof(struct_, struct_field_name_), \
-		.alignment = __alignof__(struct_) - 1, \
+		.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		.type = JSON_TOK_LIST_START, \
 		.element_descr = &(struct json_obj_descr) { \
 			.type = JSON_TOK_OBJECT_START, \
@@ -504,7 +553,7 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 				.sub_descr_len = elem_descr_len_, \
 			}, \
 			.offset = offsetof(struct_, len_field_), \
-			.alignment = __alignof__(struct_) - 1, \
+			.align_shift = Z_JSON_ALIGN_SHIFT(struct_), \
 		}, \
 		.n_elements = (max_len_), \
 	}
@@ -525,8 +574,12 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  * liberties were taken to simplify the design:
  * (1) strings are not unescaped (but only valid escape sequences are
  * accepted);
- * (2) no UTF-8 validation is performed; and
- * (3) only integer numbers are supported (no strtod() in the minimal libc).
+ * (2) no UTF-8 validation is performed;
+ * (3) numbers with an exponent are not supported, and JSON_TOK_FLOAT
+ * fields are decoded in fixed point, with the digits past the sixth
+ * decimal ignored; and
+ * (4) a null value is accepted for any field, the field is then left
+ * untouched and its bit is not set in the returned bitmap.
  *
  * @param json Pointer to JSON-encoded value to be parsed
  *
@@ -534,18 +587,131 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  *
  * @param descr Pointer to the descriptor array
  *
- * @param descr_len Number of elements in the descriptor array. Must be less
- * than 31 due to implementation detail reasons (if more fields are
- * necessary, use two descriptors)
+ * @param descr_len Number of elements in the descriptor array. Must be at
+ * most JSON_OBJ_MAX_FIELDS, as must be the number of fields of the
+ * nested objects
  *
  * @param val Pointer to the struct to hold the decoded values
  *
  * @return < 0 if error, bitmap of decoded fields on success (bit 0
  * is set if first field in the descriptor has been properly decoded, etc).
  */
-int json_obj_parse(char *json, size_t len,
-	const struct json_obj_descr *descr, size_t descr_len,
-	void *val);
+s64_t json_obj_parse(char *json, size_t len,
+		     const struct json_obj_descr *descr, size_t descr_len,
+		     void *val);
+
+/**
+ * @brief Builds an index over the field names of a descriptor
+ *
+ * By default the decoder looks up every key by comparing it with the
+ * field names of the descriptor in turn. For objects with many fields,
+ * build an index once with this function and pass it to
+ * json_obj_parse_indexed() or json_obj_parse_stream_indexed(), which
+ * then find the fields of the top level object with a binary search.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array. Must be at
+ * most JSON_OBJ_MAX_FIELDS.
+ *
+ * @param index Array of @a descr_len elements to store the index in
+ *
+ * @return 0 on success, -EINVAL if there are too many fields or two
+ * fields have the same name.
+ */
+int json_obj_descr_index_build(const struct json_obj_descr *descr,
+			       size_t descr_len, u8_t *index);
+
+/**
+ * @brief Parses a JSON-encoded object using a field index
+ *
+ * This works like json_obj_parse(), but the keys are looked up in
+ * @a index, built beforehand with json_obj_descr_index_build().
+ *
+ * @param json Pointer to JSON-encoded value to be parsed
+ *
+ * @param len Length of JSON-encoded value
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param index Index built for @a descr
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @return < 0 if error, bitmap of decoded fields on success.
+ */
+s64_t json_obj_parse_indexed(char *json, size_t len,
+			     const struct json_obj_descr *descr,
+			     size_t descr_len, const u8_t *index, void *val);
+
+/**
+ * @brief Parses a JSON-encoded object read piece by piece through
+ * @a read_bytes, according to the descriptor pointed to by @a descr.
+ *
+ * This works like json_obj_parse(), but the JSON data does not need to
+ * be in a single buffer, for example it can be read straight from the
+ * fragments of a network buffer. The data is read into @a buf as the
+ * parsing goes, and the decoded strings are copied to the end of @a buf,
+ * so the string fields of @a val point into @a buf.
+ *
+ * @param read_bytes Function to read the next bytes of the JSON data
+ *
+ * @param data Data pointer to be passed to the read_bytes callback
+ * function.
+ *
+ * @param buf Working buffer, it must be large enough for the longest
+ * key and value pair plus all the decoded strings
+ *
+ * @param buf_size Size of buf, in bytes
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array. Must be at
+ * most JSON_OBJ_MAX_FIELDS.
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @return < 0 if error, bitmap of decoded fields on success. -ENOMEM is
+ * returned when @a buf is too small.
+ */
+s64_t json_obj_parse_stream(json_read_bytes_t read_bytes, void *data,
+			    char *buf, size_t buf_size,
+			    const struct json_obj_descr *descr,
+			    size_t descr_len, void *val);
+
+/**
+ * @brief Parses a JSON-encoded object read piece by piece, using a field
+ * index
+ *
+ * This works like json_obj_parse_stream(), but the keys are looked up in
+ * @a index, built beforehand with json_obj_descr_index_build().
+ *
+ * @param read_bytes Function to read the next bytes of the JSON data
+ *
+ * @param data Data pointer to be passed to the read_bytes callback
+ * function.
+ *
+ * @param buf Working buffer
+ *
+ * @param buf_size Size of buf, in bytes
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param index Index built for @a descr
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @return < 0 if error, bitmap of decoded fields on success.
+ */
+s64_t json_obj_parse_stream_indexed(json_read_bytes_t read_bytes,
+				    void *data, char *buf, size_t buf_size,
+				    const struct json_obj_descr *descr,
+				    size_t descr_len, const u8_t *index,
+				    void *val);
 
 /**
  * @brief Escapes the string so it can be used to encode JSON objects
@@ -609,9 +775,34 @@ ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
 			const void *val, char *buffer, size_t buf_size);
 
+/**
+ * @brief Encodes an object into a chain of network buffer fragments
+ *
+ * The encoded length is calculated first, and nothing is written if it
+ * does not fit in the tailroom of @a buf and of the fragments that
+ * follow it. The data is then appended to @a buf, and to the next
+ * fragments when it is full, without intermediate copies.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Struct holding the values
+ *
+ * @param buf First fragment to append the JSON data to
+ *
+ * @return Number of bytes appended on success, -ENOMEM if they do not
+ * fit in the fragments, or another negative value on error.
+ */
+int json_obj_encode_net_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_buf *buf);
+
 /**
  * @brief Encodes an object using an arbitrary writer function
  *
+ * String fields set to NULL are encoded as null.
+ *
  * @param descr Pointer to the descriptor array
  *
  * @param descr_len Number of elements in the descriptor array
@@ -85,6 +85,15 @@ extern bool _priq_rb_lessthan(struct rbnode *a, struct rbnode *b);
 
 #define _WAIT_Q_INIT(wait_q) { { { .lessthan_fn = _priq_rb_lessthan } } }
 
+#elif defined(CONFIG_WAITQ_BITMAP)
+
+typedef struct {
+	struct _priq_bm waitq;
+} _wait_q_t;
+
+/* All-zero is an empty bitmap queue, see sched_priq.h */
+#define _WAIT_Q_INIT(wait_q) { { 0 } }
+
 #else
 
 typedef struct {
@@ -453,6 +462,11 @@ struct _thread_base {
 	/* Recursive count of irq_lock() calls */
 	u8_t global_lock_count;
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* CPU index whose ready queue holds the thread when queued */
+	u8_t runq_cpu;
+#endif
+
 #endif
 
 #ifdef CONFIG_SCHED_CPU_MASK
@@ -3812,6 +3826,19 @@ extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+/* Per-CPU magazine of free blocks.  used counts the blocks handed
+ * out from (minus those returned to) this magazine, it is added to
+ * the slab's num_used to get the real number of allocated blocks.
+ */
+struct k_mem_slab_cache {
+	struct k_spinlock lock;
+	s32_t used;
+	u32_t count;
+	void *blocks[CONFIG_MEM_SLAB_CPU_CACHE_SIZE];
+};
+#endif
+
 struct k_mem_slab {
 	_wait_q_t wait_q;
 	u32_t num_blocks;
@@ -3820,6 +3847,12 @@ struct k_mem_slab {
 	char *free_list;
 	u32_t num_used;
 
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	struct k_mem_slab_cache cache[CONFIG_MP_NUM_CPUS];
+	/* Set while a thread is about to wait for a block */
+	bool waiting;
+#endif
+
 	_OBJECT_TRACING_NEXT_PTR(k_mem_slab)
 };
 
@@ -3945,7 +3978,17 @@ extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
  */
 static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
 {
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	s32_t used = slab->num_used;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		used += slab->cache[i].used;
+	}
+
+	return used;
+#else
 	return slab->num_used;
+#endif
 }
 
 /**
@@ -3961,7 +4004,7 @@ static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
  */
 static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 {
-	return slab->num_blocks - slab->num_used;
+	return slab->num_blocks - k_mem_slab_num_used_get(slab);
 }
 
 /** @} */
@@ -4019,6 +4062,39 @@ struct k_mem_pool {
 		} \
 	}
 
+#ifdef CONFIG_MEM_POOL_TLSF
+/**
+ * @brief Statically define and initialize a TLSF memory pool.
+ *
+ * Same as K_MEM_POOL_DEFINE(), but the pool is managed by the two-level
+ * segregated fit allocator instead of the buddy allocator.  Requests
+ * of up to @a maxsz bytes are only rounded up to pointer alignment
+ * plus a 4 byte block header, and both allocation and release take
+ * constant time.  The buffer is sized so that @a nmax blocks of
+ * @a maxsz bytes can be allocated at once.
+ *
+ * @param name Name of the memory pool.
+ * @param minsz Unused, kept for compatibility with K_MEM_POOL_DEFINE().
+ * @param maxsz Size of the largest blocks in the pool (in bytes).
+ * @param nmax Number of maximum sized blocks in the pool.
+ * @param align Alignment of the pool's buffer (power of 2, at least 4).
+ */
+#define K_MEM_POOL_DEFINE_TLSF(name, minsz, maxsz, nmax, align)		\
+	char __aligned(align)						\
+		_mpool_buf_##name[_MPOOL_TLSF_DATA_SIZE(maxsz, nmax)	\
+				  + _MPOOL_TLSF_CTRL_SIZE(maxsz, nmax)]; \
+	struct k_mem_pool name __in_section(_k_mem_pool, static, name) = { \
+		.base = {						\
+			.buf = _mpool_buf_##name,			\
+			.max_sz = maxsz,				\
+			.n_max = nmax,					\
+			.n_levels = _MPOOL_TLSF_FLS(			\
+				_MPOOL_TLSF_DATA_SIZE(maxsz, nmax)),	\
+			.flags = SYS_MEM_POOL_KERNEL | SYS_MEM_POOL_TLSF \
+		} \
+	}
+#endif
+
 /**
  * @brief Allocate memory from a memory pool.
  *
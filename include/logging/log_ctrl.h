@@ -77,9 +77,11 @@ int log_set_timestamp_func(timestamp_get_t timestamp_getter, u32_t freq);
 void log_panic(void);
 
 /**
- * @brief Process one pending log message.
+ * @brief Process pending log messages.
  *
- * @param bypass If true message is released without being processed.
+ * Up to CONFIG_LOG_PROCESS_BATCH messages are processed per call.
+ *
+ * @param bypass If true one message is released without being processed.
  *
  * @retval true There is more messages pending to be processed.
  * @retval false No messages pending.
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_
+
+#include <logging/log_output.h>
+#include <logging/log_msg.h>
+#include <toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dictionary based log output
+ * @defgroup log_output_dict Dictionary based log output
+ * @ingroup log_output
+ * @{
+ *
+ * Instead of formatting messages on target, the dictionary output emits
+ * the address of the format string together with the raw message
+ * arguments. The host resolves the addresses using the ELF image of the
+ * application and formats the messages, see scripts/log_dict_decoder.py.
+ *
+ * Every packet starts with a type byte. All multi-byte fields use the
+ * byte order of the target. String arguments (%s) are not resolvable on
+ * the host, so they follow the arguments as NUL terminated strings, in
+ * the order they appear in the format string.
+ */
+
+/** @brief Standard log message packet. */
+#define LOG_DICT_PKT_STD	1
+
+/** @brief Hexdump (or raw string) log message packet. */
+#define LOG_DICT_PKT_HEXDUMP	2
+
+/** @brief Dropped messages packet. */
+#define LOG_DICT_PKT_DROPPED	3
+
+/** @brief Header of a standard or hexdump message packet.
+ *
+ * A standard message header is followed by nargs 32 bit arguments and
+ * then by the strings. A hexdump message header is followed by a 16 bit
+ * data length and the data.
+ */
+struct log_dict_msg_hdr {
+	u8_t type;
+	u8_t nargs;
+	u16_t ids;		/*!< Level (3 bits), domain (3), source (10) */
+	u32_t timestamp;
+	u32_t fmt;		/*!< Format string or hexdump metadata */
+} __packed;
+
+/** @brief Dropped messages packet. */
+struct log_dict_dropped_pkt {
+	u8_t type;
+	u32_t cnt;
+} __packed;
+
+/** @brief Process log message to a dictionary based packet.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param msg Log message.
+ * @param flags Optional flags, currently unused.
+ */
+void log_output_dict_msg_process(const struct log_output *log_output,
+				 struct log_msg *msg, u32_t flags);
+
+/** @brief Process dropped messages indication.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param cnt        Number of dropped messages.
+ */
+void log_output_dict_dropped_process(const struct log_output *log_output,
+				     u32_t cnt);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_ */
@@ -64,6 +64,40 @@ struct sys_mem_pool_block {
 		.mutex = kmutex,					\
 	}
 
+#ifdef CONFIG_MEM_POOL_TLSF
+/**
+ * @brief Statically define system memory pool using the TLSF allocator
+ *
+ * Same as SYS_MEM_POOL_DEFINE(), but the pool is managed by the two-level
+ * segregated fit allocator, see K_MEM_POOL_DEFINE_TLSF().
+ *
+ * @param name Name of the memory pool.
+ * @param kmutex Pointer to an initialized k_mutex object, used for
+ *		 synchronization, declared with K_MUTEX_DEFINE().
+ * @param minsz Unused, kept for compatibility with SYS_MEM_POOL_DEFINE().
+ * @param maxsz Size of the largest blocks in the pool (in bytes).
+ * @param nmax Number of maximum sized blocks in the pool.
+ * @param align Alignment of the pool's buffer (power of 2, at least 4).
+ * @param section Destination binary section for pool data
+ */
+#define SYS_MEM_POOL_DEFINE_TLSF(name, kmutex, minsz, maxsz, nmax, align, \
+				 section)				\
+	char __aligned(align) _GENERIC_SECTION(section)			\
+		_mpool_buf_##name[_MPOOL_TLSF_DATA_SIZE(maxsz, nmax)	\
+				  + _MPOOL_TLSF_CTRL_SIZE(maxsz, nmax)]; \
+	_GENERIC_SECTION(section) struct sys_mem_pool name = {		\
+		.base = {						\
+			.buf = _mpool_buf_##name,			\
+			.max_sz = maxsz,				\
+			.n_max = nmax,					\
+			.n_levels = _MPOOL_TLSF_FLS(			\
+				_MPOOL_TLSF_DATA_SIZE(maxsz, nmax)),	\
+			.flags = SYS_MEM_POOL_USER | SYS_MEM_POOL_TLSF	\
+		},							\
+		.mutex = kmutex,					\
+	}
+#endif
+
 /**
  * @brief Initialize a memory pool
  *
@@ -25,6 +25,7 @@ struct sys_mem_pool_lvl {
 
 #define SYS_MEM_POOL_KERNEL	BIT(0)
 #define SYS_MEM_POOL_USER	BIT(1)
+#define SYS_MEM_POOL_TLSF	BIT(2)
 
 struct sys_mem_pool_base {
 	void *buf;
@@ -100,6 +101,65 @@ struct sys_mem_pool_base {
 	_MPOOL_LBIT_BYTES(maxsz, minsz, 14, n_max) +	\
 	_MPOOL_LBIT_BYTES(maxsz, minsz, 15, n_max))
 
+/*
+ * Layout of pools using the TLSF backend (SYS_MEM_POOL_TLSF).  Every
+ * block is preceded by a one word header, padded so that the data
+ * after it is pointer aligned, and the buffer ends in a sentinel
+ * header, so n_max blocks of max_sz bytes always fit.  The allocator
+ * control words (one first level bitmap, then one second level bitmap
+ * and _MPOOL_TLSF_SL free list heads per first level size class)
+ * follow the buffer.  n_levels holds the number of first level
+ * classes.
+ */
+#define _MPOOL_TLSF_SL_LOG2 3
+#define _MPOOL_TLSF_SL (1 << _MPOOL_TLSF_SL_LOG2)
+
+#define _MPOOL_TLSF_ALIGN sizeof(void *)
+#define _MPOOL_TLSF_MINBLK 16
+
+#define _MPOOL_TLSF_BLK(maxsz)						\
+	((((maxsz) + 4 + _MPOOL_TLSF_ALIGN - 1) / _MPOOL_TLSF_ALIGN)	\
+	 * _MPOOL_TLSF_ALIGN)
+
+#define _MPOOL_TLSF_DATA_SIZE(maxsz, n_max)				\
+	(_MPOOL_TLSF_ALIGN + (n_max) *					\
+	 (_MPOOL_TLSF_BLK(maxsz) < _MPOOL_TLSF_MINBLK ?			\
+	  _MPOOL_TLSF_MINBLK : _MPOOL_TLSF_BLK(maxsz)))
+
+#define _MPOOL_TLSF_HAVE_FL(sz, l) ((sz) >= (32UL << (l)) ? 1 : 0)
+
+#define _MPOOL_TLSF_FLS(sz)		\
+	(1 +				\
+	_MPOOL_TLSF_HAVE_FL((sz), 0) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 1) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 2) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 3) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 4) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 5) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 6) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 7) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 8) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 9) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 10) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 11) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 12) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 13) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 14) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 15) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 16) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 17) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 18) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 19) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 20) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 21) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 22) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 23) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 24) +	\
+	_MPOOL_TLSF_HAVE_FL((sz), 25))
+
+#define _MPOOL_TLSF_CTRL_SIZE(maxsz, n_max)			\
+	(4 * (1 + (1 + _MPOOL_TLSF_SL) *			\
+	      _MPOOL_TLSF_FLS(_MPOOL_TLSF_DATA_SIZE(maxsz, n_max))))
 
 void _sys_mem_pool_base_init(struct sys_mem_pool_base *p);
 
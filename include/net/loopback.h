@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Network loopback interface
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_LOOPBACK_H_
+#define ZEPHYR_INCLUDE_NET_LOOPBACK_H_
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Loopback interface support functions
+ * @defgroup loopback Loopback Interface Support Functions
+ * @ingroup networking
+ * @{
+ */
+
+#if defined(CONFIG_NET_LOOPBACK_SIMULATE_PACKET_DROP)
+/**
+ * @brief Set the share of packets dropped by the loopback interface.
+ *
+ * Packets are dropped in a deterministic pseudo random pattern.
+ *
+ * @param percent Share of dropped packets, 0 (the default) to 100.
+ *
+ * @return 0 on success, -EINVAL if percent is out of range.
+ */
+int loopback_set_packet_drop_rate(u8_t percent);
+
+/**
+ * @brief Get the number of packets dropped by the loopback interface.
+ *
+ * @return Number of packets dropped since boot.
+ */
+u32_t loopback_get_num_dropped_packets(void);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_NET_LOOPBACK_H_ */
@@ -270,6 +270,11 @@ struct net_context {
 	/** TLS context information */
 	struct tls_context *tls;
 #endif /* CONFIG_NET_SOCKETS_SOCKOPT_TLS */
+
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	/** Registrations of this socket in epoll instances */
+	sys_slist_t epoll_items;
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
 #endif /* CONFIG_NET_SOCKETS */
 
 #if defined(CONFIG_NET_OFFLOAD)
@@ -277,6 +282,11 @@ struct net_context {
 	void *offload_context;
 #endif /* CONFIG_NET_OFFLOAD */
 
+#if defined(CONFIG_NET_STATISTICS_LAYER_CYCLES)
+	/** Cycle counter value when the socket layer started sending */
+	u32_t cycle_stamp;
+#endif
+
 	/** Option values */
 	struct {
 #if defined(CONFIG_NET_CONTEXT_PRIORITY)
@@ -871,6 +881,62 @@ int net_context_sendto_new(struct net_context *context,
 			   void *token,
 			   void *user_data);
 
+/**
+ * @brief Send data gathered from several buffers to a peer.
+ *
+ * @details Same as net_context_sendto_new() except that the data is
+ * gathered from the msg_iov array of the message header. The message is
+ * sent to msg_name, or to the address set by net_context_connect() if
+ * msg_name is NULL. This is similar as BSD sendmsg() function.
+ *
+ * @param context The network context to use.
+ * @param msghdr The message header.
+ * @param cb Caller-supplied callback function.
+ * @param timeout Timeout for the connection. Possible values
+ * are K_FOREVER, K_NO_WAIT, >0.
+ * @param token Caller specified value that is passed as is to callback.
+ * @param user_data Caller-supplied user data.
+ *
+ * @return numbers of bytes sent on success, a negative errno otherwise
+ */
+int net_context_sendmsg(struct net_context *context,
+			const struct msghdr *msghdr,
+			net_context_send_cb_t cb,
+			s32_t timeout,
+			void *token,
+			void *user_data);
+
+/**
+ * @brief Send a chain of network buffers without copying it.
+ *
+ * @details The buffers are linked to the packet after the protocol
+ * headers, as they are. They can come from any net_buf pool, for example
+ * net_pkt_get_reserve_tx_data(). Only datagram contexts of type
+ * SOCK_DGRAM over UDP are supported.
+ *
+ * @param context The network context to use.
+ * @param frags The buffer chain holding the payload. It is owned by the
+ * stack once the function is called, whether it succeeds or not.
+ * @param dst_addr Destination address, NULL to send to the address set
+ * by net_context_connect().
+ * @param addrlen Length of the address.
+ * @param cb Caller-supplied callback function.
+ * @param timeout Timeout for the connection. Possible values
+ * are K_FOREVER, K_NO_WAIT, >0.
+ * @param token Caller specified value that is passed as is to callback.
+ * @param user_data Caller-supplied user data.
+ *
+ * @return numbers of bytes sent on success, a negative errno otherwise
+ */
+int net_context_sendto_buf(struct net_context *context,
+			   struct net_buf *frags,
+			   const struct sockaddr *dst_addr,
+			   socklen_t addrlen,
+			   net_context_send_cb_t cb,
+			   s32_t timeout,
+			   void *token,
+			   void *user_data);
+
 /**
  * @brief Receive network data from a peer specified by context.
  *
@@ -937,6 +1003,8 @@ int net_context_update_recv_wnd(struct net_context *context,
 
 enum net_context_option {
 	NET_OPT_PRIORITY = 1,
+	NET_OPT_RCVBUF = 2,
+	NET_OPT_SNDBUF = 3,
 };
 
 /**
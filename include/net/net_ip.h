@@ -260,6 +260,29 @@ struct sockaddr {
 	char data[NET_SOCKADDR_MAX_SIZE - sizeof(sa_family_t)];
 };
 
+/** Buffer of a scatter/gather array */
+struct iovec {
+	void  *iov_base;
+	size_t iov_len;
+};
+
+/** Message header of sendmsg() and recvmsg() */
+struct msghdr {
+	void         *msg_name;       /* Optional socket address */
+	socklen_t     msg_namelen;    /* Size of socket address */
+	struct iovec *msg_iov;        /* Scatter/gather array */
+	size_t        msg_iovlen;     /* Number of elements in msg_iov */
+	void         *msg_control;    /* Ancillary data, not supported */
+	size_t        msg_controllen; /* Ancillary data buffer length */
+	int           msg_flags;      /* Flags on received message */
+};
+
+/** Message of sendmmsg() and recvmmsg() */
+struct mmsghdr {
+	struct msghdr msg_hdr;        /* Message header */
+	unsigned int  msg_len;        /* Number of bytes transmitted */
+};
+
 /** @cond INTERNAL_HIDDEN */
 
 struct sockaddr_ptr {
@@ -484,6 +507,15 @@ union net_proto_header {
 #define NET_IPV4TCPH_LEN   (NET_TCPH_LEN + NET_IPV4H_LEN) /* IPv4 + TCP */
 #define NET_IPV4ICMPH_LEN  (NET_IPV4H_LEN + NET_ICMPH_LEN) /* ICMPv4 + IPv4 */
 
+/* Flags and fragment offset field of the IPv4 header */
+#define NET_IPV4_DO_NOT_FRAG_MASK  0x4000
+#define NET_IPV4_MORE_FRAG_MASK    0x2000
+#define NET_IPV4_FRAGH_OFFSET_MASK 0x1fff
+
+/* Fragment offset and flags field of the IPv6 fragment header */
+#define NET_IPV6_MORE_FRAG_MASK    0x0001
+#define NET_IPV6_FRAGH_OFFSET_MASK 0xfff8
+
 /** @endcond */
 
 /**
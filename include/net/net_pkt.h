@@ -114,6 +114,11 @@ struct net_pkt {
 	u16_t data_len;         /* amount of payload data that can be added */
 
 	u16_t appdatalen;
+#if defined(CONFIG_NET_TCP) || defined(CONFIG_NET_UDP)
+	u16_t payload_chksum;	/* ones' complement sum of the last
+				 * appdatalen bytes, if has_payload_chksum
+				 */
+#endif
 	u8_t ip_hdr_len;	/* pre-filled in order to avoid func call */
 
 	u8_t overwrite  : 1;	/* Is packet content being overwritten? */
@@ -139,6 +144,10 @@ struct net_pkt {
 				 * Used only if defined(CONFIG_NET_ROUTE)
 				 */
 	u8_t family     : 3;	/* IPv4 vs IPv6 */
+	u8_t has_payload_chksum : 1; /* payload_chksum is valid.
+				      * Used only if defined(CONFIG_NET_TCP)
+				      * or defined(CONFIG_NET_UDP)
+				      */
 
 	union {
 		u8_t ipv4_auto_arp_msg : 1; /* Is this pkt IPv4 autoconf ARP
@@ -183,6 +192,20 @@ struct net_pkt {
 	u16_t vlan_tci;
 #endif /* CONFIG_NET_VLAN */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	/* Flags and fragment offset field of the IPv4 header, in host
+	 * byte order.
+	 */
+	u16_t ipv4_fragment_flags;
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_STATISTICS_LAYER_CYCLES)
+	/* Cycle counter value when the packet last crossed a network
+	 * stack layer, zero if the packet is not being accounted.
+	 */
+	u32_t cycle_stamp;
+#endif
+
 #if defined(CONFIG_NET_IPV6)
 	u16_t ipv6_ext_len;	/* length of extension headers */
 
@@ -194,7 +217,7 @@ struct net_pkt {
 	u16_t ipv6_prev_hdr_start;
 
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
-	u16_t ipv6_fragment_offset;	/* Fragment offset of this packet */
+	u16_t ipv6_fragment_flags;	/* Fragment offset and M flag */
 	u32_t ipv6_fragment_id;	/* Fragment id */
 	u16_t ipv6_frag_hdr_start;	/* Where starts the fragment header */
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
@@ -384,6 +407,70 @@ static inline void net_pkt_set_ipv4_ttl(struct net_pkt *pkt,
 }
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static inline u16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	return (pkt->ipv4_fragment_flags & NET_IPV4_FRAGH_OFFSET_MASK) * 8;
+}
+
+static inline bool net_pkt_ipv4_fragment_more(struct net_pkt *pkt)
+{
+	return (pkt->ipv4_fragment_flags & NET_IPV4_MORE_FRAG_MASK) != 0;
+}
+
+static inline void net_pkt_set_ipv4_fragment_flags(struct net_pkt *pkt,
+						   u16_t flags)
+{
+	pkt->ipv4_fragment_flags = flags;
+}
+#else /* CONFIG_NET_IPV4_FRAGMENT */
+static inline u16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline bool net_pkt_ipv4_fragment_more(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+
+static inline void net_pkt_set_ipv4_fragment_flags(struct net_pkt *pkt,
+						   u16_t flags)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(flags);
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_STATISTICS_LAYER_CYCLES)
+static inline u32_t net_pkt_cycle_stamp(struct net_pkt *pkt)
+{
+	return pkt->cycle_stamp;
+}
+
+static inline void net_pkt_set_cycle_stamp(struct net_pkt *pkt, u32_t stamp)
+{
+	pkt->cycle_stamp = stamp;
+}
+#else
+static inline u32_t net_pkt_cycle_stamp(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_cycle_stamp(struct net_pkt *pkt, u32_t stamp)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(stamp);
+}
+#endif /* CONFIG_NET_STATISTICS_LAYER_CYCLES */
+
 #if defined(CONFIG_NET_IPV6)
 static inline u8_t net_pkt_ipv6_ext_opt_len(struct net_pkt *pkt)
 {
@@ -521,13 +608,18 @@ static inline void net_pkt_set_ipv6_fragment_start(struct net_pkt *pkt,
 
 static inline u16_t net_pkt_ipv6_fragment_offset(struct net_pkt *pkt)
 {
-	return pkt->ipv6_fragment_offset;
+	return pkt->ipv6_fragment_flags & NET_IPV6_FRAGH_OFFSET_MASK;
+}
+
+static inline bool net_pkt_ipv6_fragment_more(struct net_pkt *pkt)
+{
+	return (pkt->ipv6_fragment_flags & NET_IPV6_MORE_FRAG_MASK) != 0;
 }
 
-static inline void net_pkt_set_ipv6_fragment_offset(struct net_pkt *pkt,
-						    u16_t offset)
+static inline void net_pkt_set_ipv6_fragment_flags(struct net_pkt *pkt,
+						   u16_t flags)
 {
-	pkt->ipv6_fragment_offset = offset;
+	pkt->ipv6_fragment_flags = flags;
 }
 
 static inline u32_t net_pkt_ipv6_fragment_id(struct net_pkt *pkt)
@@ -562,11 +654,18 @@ static inline u16_t net_pkt_ipv6_fragment_offset(struct net_pkt *pkt)
 	return 0;
 }
 
-static inline void net_pkt_set_ipv6_fragment_offset(struct net_pkt *pkt,
-						    u16_t offset)
+static inline bool net_pkt_ipv6_fragment_more(struct net_pkt *pkt)
 {
 	ARG_UNUSED(pkt);
-	ARG_UNUSED(offset);
+
+	return false;
+}
+
+static inline void net_pkt_set_ipv6_fragment_flags(struct net_pkt *pkt,
+						   u16_t flags)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(flags);
 }
 
 static inline u32_t net_pkt_ipv6_fragment_id(struct net_pkt *pkt)
@@ -750,6 +849,45 @@ static inline void net_pkt_set_appdatalen(struct net_pkt *pkt, u16_t len)
 	pkt->appdatalen = len;
 }
 
+#if defined(CONFIG_NET_TCP) || defined(CONFIG_NET_UDP)
+static inline bool net_pkt_has_payload_chksum(struct net_pkt *pkt)
+{
+	return pkt->has_payload_chksum;
+}
+
+static inline u16_t net_pkt_payload_chksum(struct net_pkt *pkt)
+{
+	return pkt->payload_chksum;
+}
+
+/* The sum covers the last appdatalen bytes of the packet, so that the
+ * transport checksum does not need to read the payload again.
+ */
+static inline void net_pkt_set_payload_chksum(struct net_pkt *pkt,
+					      u16_t sum)
+{
+	pkt->payload_chksum = sum;
+	pkt->has_payload_chksum = 1U;
+}
+#else
+static inline bool net_pkt_has_payload_chksum(struct net_pkt *pkt)
+{
+	return false;
+}
+
+static inline u16_t net_pkt_payload_chksum(struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static inline void net_pkt_set_payload_chksum(struct net_pkt *pkt,
+					      u16_t sum)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(sum);
+}
+#endif
+
 static inline struct net_linkaddr *net_pkt_lladdr_src(struct net_pkt *pkt)
 {
 	return &pkt->lladdr_src;
@@ -2172,6 +2310,20 @@ struct net_pkt *net_pkt_rx_alloc_with_buffer(struct net_if *iface,
  */
 void net_pkt_append_buffer(struct net_pkt *pkt, struct net_buf *buffer);
 
+/**
+ * @brief Detach the buffer from the cursor position on
+ *
+ * The buffers before the cursor are released and the data before the
+ * cursor is pulled from the buffer holding it. The packet is left without
+ * buffer, the caller owns the returned buffer chain.
+ *
+ * @param pkt Network packet, usually with the cursor on the payload
+ *
+ * @return Buffer chain holding the data after the cursor, NULL if there is
+ *         none
+ */
+struct net_buf *net_pkt_detach_buffer(struct net_pkt *pkt);
+
 /**
  * @brief Get available buffer space from a pkt
  *
@@ -2376,6 +2528,23 @@ int net_pkt_read_be32_new(struct net_pkt *pkt, u32_t *data);
  */
 int net_pkt_write_new(struct net_pkt *pkt, const void *data, size_t length);
 
+/**
+ * @brief Write data into a net_pkt and compute its checksum on the way
+ *
+ * Works like net_pkt_write_new(), and adds the Internet checksum (ones'
+ * complement sum of 16-bit words) of the written data to chksum, so the
+ * data is read only once.
+ *
+ * @param pkt    The network packet where to write
+ * @param data   Data to be written
+ * @param length Length of the data to be written
+ * @param chksum Sum to add to, must be initialized by the caller
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data,
+			 size_t length, u16_t *chksum);
+
 /* Write u8_t data into a net_pkt. */
 static inline int net_pkt_write_u8_new(struct net_pkt *pkt, u8_t data)
 {
@@ -218,6 +218,35 @@ struct net_stats_tc {
 	} recv[NET_TC_RX_COUNT];
 };
 
+/**
+ * @brief Network stack layers that per packet cycles are accounted to
+ */
+enum net_stats_layer {
+	/** BSD socket API, including the time spent in the receive queue */
+	NET_STATS_LAYER_SOCKET,
+	/** Network context and the UDP or TCP protocol */
+	NET_STATS_LAYER_CONTEXT,
+	/** Connection handler lookup, only when receiving */
+	NET_STATS_LAYER_CONN,
+	/** IP layer and the interface TX and RX queues */
+	NET_STATS_LAYER_IP,
+	/** L2 and the network device driver */
+	NET_STATS_LAYER_L2,
+
+	NET_STATS_LAYER_COUNT
+};
+
+/**
+ * @brief Packet processing cycles spent in each network stack layer
+ */
+struct net_stats_layer_cycles {
+	/** Cycles spent while sending packets */
+	u64_t tx[NET_STATS_LAYER_COUNT];
+
+	/** Cycles spent while receiving packets */
+	u64_t rx[NET_STATS_LAYER_COUNT];
+};
+
 /**
  * @brief All network statistics in one struct.
  */
@@ -273,6 +302,11 @@ struct net_stats {
 	/** Traffic class statistics */
 	struct net_stats_tc tc;
 #endif
+
+#if defined(CONFIG_NET_STATISTICS_LAYER_CYCLES)
+	/** Per layer packet processing cycles */
+	struct net_stats_layer_cycles layer_cycles;
+#endif
 };
 
 /**
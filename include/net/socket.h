@@ -55,8 +55,36 @@ typedef struct zsock_fd_set {
 #define ZSOCK_POLLHUP 0x10
 #define ZSOCK_POLLNVAL 0x20
 
+/** epoll() event data, the value is opaque to the stack */
+typedef union zsock_epoll_data {
+	void *ptr;
+	int fd;
+	u32_t u32;
+	u64_t u64;
+} zsock_epoll_data_t;
+
+struct zsock_epoll_event {
+	u32_t events;
+	zsock_epoll_data_t data;
+};
+
+/* Values are compatible with Linux */
+#define ZSOCK_EPOLLIN 0x001
+#define ZSOCK_EPOLLOUT 0x004
+#define ZSOCK_EPOLLERR 0x008
+#define ZSOCK_EPOLLHUP 0x010
+#define ZSOCK_EPOLLRDHUP 0x2000
+#define ZSOCK_EPOLLONESHOT (1U << 30)
+#define ZSOCK_EPOLLET (1U << 31)
+
+#define ZSOCK_EPOLL_CTL_ADD 1
+#define ZSOCK_EPOLL_CTL_DEL 2
+#define ZSOCK_EPOLL_CTL_MOD 3
+
 #define ZSOCK_MSG_PEEK 0x02
+#define ZSOCK_MSG_TRUNC 0x20
 #define ZSOCK_MSG_DONTWAIT 0x40
+#define ZSOCK_MSG_WAITFORONE 0x10000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -66,6 +94,27 @@ typedef struct zsock_fd_set {
 #define ZSOCK_SHUT_WR 1
 #define ZSOCK_SHUT_RDWR 2
 
+/** Protocol level for socket options, same value as in Linux. */
+#define SOL_SOCKET 1
+
+/**
+ *  @defgroup socket_options Socket level options
+ *  @{
+ */
+
+/** Socket option for the send buffer size, in bytes. It accepts and returns
+ *  an integer. 0 means no limit. Only supported by TCP sockets.
+ */
+#define SO_SNDBUF 7
+/** Socket option for the receive buffer size, in bytes. It accepts and
+ *  returns an integer. The buffer size bounds the TCP receive window, it can
+ *  only grow once the connection is being established. Only supported by
+ *  TCP sockets.
+ */
+#define SO_RCVBUF 8
+
+/** @} */
+
 /** Protocol level for TLS.
  *  Here, the same socket protocol level for TLS as in Linux was used.
  */
@@ -170,10 +219,182 @@ static inline ssize_t zsock_recv(int sock, void *buf, size_t max_len,
 	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
 }
 
+/**
+ * @brief Send data gathered from several buffers
+ *
+ * The iovecs of a datagram socket form a single datagram. msg_control is
+ * not supported and ignored. Sockets which do not support scatter-gather
+ * I/O, e.g. TLS sockets, accept a single iovec only.
+ *
+ * @param sock Socket.
+ * @param msg Message header, msg_name is NULL for a connected socket.
+ * @param flags ZSOCK_MSG_DONTWAIT or 0.
+ *
+ * @return Number of bytes sent, or -1 with errno set.
+ */
+__syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg,
+				int flags);
+
+/**
+ * @brief Receive data scattered to several buffers
+ *
+ * A datagram is scattered over the iovecs, ZSOCK_MSG_TRUNC is set in
+ * msg_flags if it did not fit. On a stream socket only the first iovec
+ * may wait for data. No control messages are returned, msg_controllen is
+ * set to 0.
+ *
+ * @param sock Socket.
+ * @param msg Message header, msg_name may be NULL.
+ * @param flags ZSOCK_MSG_DONTWAIT, ZSOCK_MSG_PEEK or 0.
+ *
+ * @return Number of bytes received, or -1 with errno set.
+ */
+__syscall ssize_t zsock_recvmsg(int sock, struct msghdr *msg, int flags);
+
+/**
+ * @brief Send several messages with one call
+ *
+ * Same as zsock_sendmsg() on each message, msg_len is set to the number
+ * of bytes sent. Sending stops at the first error.
+ *
+ * @param sock Socket.
+ * @param msgvec Messages to send.
+ * @param vlen Number of messages.
+ * @param flags ZSOCK_MSG_DONTWAIT or 0.
+ *
+ * @return Number of messages sent, or -1 with errno set if none was sent.
+ */
+__syscall int zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Receive several messages with one call
+ *
+ * Same as zsock_recvmsg() on each message, msg_len is set to the number
+ * of bytes received. With ZSOCK_MSG_WAITFORONE only the first message may
+ * wait, the call then takes the messages which are already queued. The
+ * timeout argument of the Linux variant is not supported.
+ *
+ * @param sock Socket.
+ * @param msgvec Messages to receive.
+ * @param vlen Number of messages.
+ * @param flags ZSOCK_MSG_DONTWAIT, ZSOCK_MSG_WAITFORONE or 0.
+ *
+ * @return Number of messages received, or -1 with errno set if none was
+ * received.
+ */
+__syscall int zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+struct net_buf;
+
+/**
+ * @brief Receive data without copying it
+ *
+ * Takes the next datagram, or the next received segment of a stream, out
+ * of the socket. The returned buffer chain holds the payload only and
+ * must be released with net_buf_unref(). Held buffers count against the
+ * network RX buffer pool, release them quickly. ZSOCK_MSG_PEEK is not
+ * supported.
+ *
+ * These functions are not system calls, network buffers are not
+ * accessible from user mode.
+ *
+ * @param sock Plain UDP or TCP socket.
+ * @param buf Returns the buffer chain, NULL at end of stream.
+ * @param flags ZSOCK_MSG_DONTWAIT or 0.
+ * @param src_addr Returns the source address of a datagram, may be NULL.
+ * @param addrlen Size of src_addr, set to the actual address size.
+ *
+ * @return Length of the data, 0 at end of stream, or -1 with errno set.
+ */
+ssize_t zsock_recvfrom_buf(int sock, struct net_buf **buf, int flags,
+			   struct sockaddr *src_addr, socklen_t *addrlen);
+
+static inline ssize_t zsock_recv_buf(int sock, struct net_buf **buf,
+				     int flags)
+{
+	return zsock_recvfrom_buf(sock, buf, flags, NULL, NULL);
+}
+
+/**
+ * @brief Send a buffer chain without copying it
+ *
+ * The buffers are sent as they are after the protocol headers, they can
+ * come from net_pkt_get_reserve_tx_data() for example. Only datagram
+ * sockets are supported. The stack owns the buffer chain once the function
+ * is called, whether it succeeds or not.
+ *
+ * @param sock Plain UDP socket.
+ * @param buf Buffer chain holding the payload.
+ * @param flags ZSOCK_MSG_DONTWAIT or 0.
+ * @param dest_addr Destination address, NULL for a connected socket.
+ * @param addrlen Size of dest_addr.
+ *
+ * @return Number of bytes sent, or -1 with errno set.
+ */
+ssize_t zsock_sendto_buf(int sock, struct net_buf *buf, int flags,
+			 const struct sockaddr *dest_addr, socklen_t addrlen);
+
+static inline ssize_t zsock_send_buf(int sock, struct net_buf *buf, int flags)
+{
+	return zsock_sendto_buf(sock, buf, flags, NULL, 0);
+}
+
 __syscall int zsock_fcntl(int sock, int cmd, int flags);
 
 __syscall int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout);
 
+/**
+ * @brief Create an epoll instance
+ *
+ * An epoll instance keeps a set of sockets the caller is interested in.
+ * Unlike poll(), the set is registered once with zsock_epoll_ctl() and the
+ * sockets signal readiness to the instance, so zsock_epoll_wait() costs
+ * O(ready sockets) instead of O(registered sockets). Only available with
+ * CONFIG_NET_SOCKETS_EPOLL, and for plain TCP and UDP sockets.
+ *
+ * @param flags Must be 0.
+ *
+ * @return File descriptor of the instance, or -1 with errno set.
+ */
+__syscall int zsock_epoll_create1(int flags);
+
+/** Same as zsock_epoll_create1(0), size must be positive but is unused */
+int zsock_epoll_create(int size);
+
+/**
+ * @brief Add, modify or remove a socket of an epoll instance
+ *
+ * Readiness is level triggered unless ZSOCK_EPOLLET is given. With
+ * ZSOCK_EPOLLONESHOT the socket is disabled after one event until it is
+ * rearmed with ZSOCK_EPOLL_CTL_MOD. Closing a socket removes it from all
+ * instances.
+ *
+ * @param epfd Epoll instance.
+ * @param op ZSOCK_EPOLL_CTL_ADD, ZSOCK_EPOLL_CTL_MOD or ZSOCK_EPOLL_CTL_DEL.
+ * @param fd Socket.
+ * @param event Requested events and user data, ignored for
+ *        ZSOCK_EPOLL_CTL_DEL.
+ *
+ * @return 0 on success, or -1 with errno set.
+ */
+__syscall int zsock_epoll_ctl(int epfd, int op, int fd,
+			      struct zsock_epoll_event *event);
+
+/**
+ * @brief Wait for events on an epoll instance
+ *
+ * @param epfd Epoll instance.
+ * @param events Returned events.
+ * @param maxevents Size of the events array.
+ * @param timeout Timeout in milliseconds, -1 to wait forever.
+ *
+ * @return Number of returned events, 0 on timeout, or -1 with errno set.
+ */
+__syscall int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			       int maxevents, int timeout);
+
 /* select() API is inefficient, and implemented as inefficient wrapper on
  * top of poll(). Avoid select(), use poll directly().
  */
@@ -230,6 +451,8 @@ int zsock_getnameinfo(const struct sockaddr *addr, socklen_t addrlen,
 #if defined(CONFIG_NET_SOCKETS_POSIX_NAMES)
 
 #define pollfd zsock_pollfd
+#define epoll_event zsock_epoll_event
+#define epoll_data_t zsock_epoll_data_t
 #define fd_set zsock_fd_set
 #define timeval zsock_timeval
 #define FD_SETSIZE ZSOCK_FD_SETSIZE
@@ -297,11 +520,55 @@ static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
 }
 
+static inline ssize_t sendmsg(int sock, const struct msghdr *msg, int flags)
+{
+	return zsock_sendmsg(sock, msg, flags);
+}
+
+static inline ssize_t recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg(sock, msg, flags);
+}
+
+static inline int sendmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
+static inline int recvmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	return zsock_poll(fds, nfds, timeout);
 }
 
+static inline int epoll_create(int size)
+{
+	return zsock_epoll_create(size);
+}
+
+static inline int epoll_create1(int flags)
+{
+	return zsock_epoll_create1(flags);
+}
+
+static inline int epoll_ctl(int epfd, int op, int fd,
+			    struct zsock_epoll_event *event)
+{
+	return zsock_epoll_ctl(epfd, op, fd, event);
+}
+
+static inline int epoll_wait(int epfd, struct zsock_epoll_event *events,
+			     int maxevents, int timeout)
+{
+	return zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+
 static inline int select(int nfds, zsock_fd_set *readfds,
 			 zsock_fd_set *writefds, zsock_fd_set *exceptfds,
 			 struct timeval *timeout)
@@ -410,8 +677,22 @@ static inline int inet_pton(sa_family_t family, const char *src, void *dst)
 #define POLLHUP ZSOCK_POLLHUP
 #define POLLNVAL ZSOCK_POLLNVAL
 
+#define EPOLLIN ZSOCK_EPOLLIN
+#define EPOLLOUT ZSOCK_EPOLLOUT
+#define EPOLLERR ZSOCK_EPOLLERR
+#define EPOLLHUP ZSOCK_EPOLLHUP
+#define EPOLLRDHUP ZSOCK_EPOLLRDHUP
+#define EPOLLONESHOT ZSOCK_EPOLLONESHOT
+#define EPOLLET ZSOCK_EPOLLET
+
+#define EPOLL_CTL_ADD ZSOCK_EPOLL_CTL_ADD
+#define EPOLL_CTL_DEL ZSOCK_EPOLL_CTL_DEL
+#define EPOLL_CTL_MOD ZSOCK_EPOLL_CTL_MOD
+
 #define MSG_PEEK ZSOCK_MSG_PEEK
+#define MSG_TRUNC ZSOCK_MSG_TRUNC
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+#define MSG_WAITFORONE ZSOCK_MSG_WAITFORONE
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
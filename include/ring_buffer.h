@@ -23,6 +23,14 @@ extern "C" {
 
 /**
  * @brief A structure to represent a ring buffer
+ *
+ * A ring buffer with a single producer and a single consumer needs no
+ * locking, even when one of them runs in an ISR or on another CPU: the
+ * producer only updates the tail and the consumer only updates the head.
+ * Each side loads the index of the other side with acquire semantics
+ * and stores its own index with release semantics, once the data has
+ * been copied. Several producers or several consumers still have to be
+ * serialized, see the warnings of each routine.
  */
 struct ring_buf {
 	u32_t head;	 /**< Index in buf for the head element */
@@ -48,6 +56,17 @@ struct ring_buf {
 	u32_t mask;   /**< Modulo mask if size is a power of 2 */
 };
 
+/**
+ * @brief A contiguous area of a ring buffer
+ *
+ * The claimed area of a ring buffer is returned as two segments, the
+ * second one is empty unless the area wraps around the end of the buffer.
+ */
+struct ring_buf_segment {
+	u8_t *data;	 /**< Start of the segment */
+	u32_t size;	 /**< Size of the segment (in bytes) */
+};
+
 /**
  * @defgroup ring_buffer_apis Ring Buffer APIs
  * @ingroup kernel_apis
@@ -163,6 +182,33 @@ __deprecated static inline void sys_ring_buf_init(struct ring_buf *buf,
 	ring_buf_init(buf, size, data);
 }
 
+/** @brief Load the index updated by the other side of a ring buffer.
+ *
+ * @note Function for internal use.
+ *
+ * @param index Address of the head or the tail.
+ *
+ * @return Index value, the data accesses that follow are not reordered
+ *	   before the load.
+ */
+static inline u32_t z_ring_buf_index_load(const u32_t *index)
+{
+	return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Store the index owned by one side of a ring buffer.
+ *
+ * @note Function for internal use.
+ *
+ * @param index Address of the head or the tail.
+ * @param val New index value, the data accesses that precede are not
+ *	      reordered after the store.
+ */
+static inline void z_ring_buf_index_store(u32_t *index, u32_t val)
+{
+	__atomic_store_n(index, val, __ATOMIC_RELEASE);
+}
+
 /** @brief Determine free space based on ring buffer parameters.
  *
  * @note Function for internal use.
@@ -193,7 +239,8 @@ static inline int z_ring_buf_custom_space_get(u32_t size, u32_t head,
  */
 static inline int ring_buf_is_empty(struct ring_buf *buf)
 {
-	return (buf->head == buf->tail);
+	return (z_ring_buf_index_load(&buf->head) ==
+		z_ring_buf_index_load(&buf->tail));
 }
 /** @deprecated Renamed to ring_buf_is_empty. */
 __deprecated static inline int sys_ring_buf_is_empty(struct ring_buf *buf)
@@ -210,7 +257,9 @@ __deprecated static inline int sys_ring_buf_is_empty(struct ring_buf *buf)
  */
 static inline int ring_buf_space_get(struct ring_buf *buf)
 {
-	return z_ring_buf_custom_space_get(buf->size, buf->head, buf->tail);
+	return z_ring_buf_custom_space_get(buf->size,
+					   z_ring_buf_index_load(&buf->head),
+					   z_ring_buf_index_load(&buf->tail));
 }
 
 /** @deprecated Renamed to ring_buf_space_get. */
@@ -313,6 +362,35 @@ __deprecated static inline int sys_ring_buf_get(struct ring_buf *buf,
  */
 u32_t ring_buf_put_claim(struct ring_buf *buf, u8_t **data, u32_t size);
 
+/**
+ * @brief Allocate both segments for writing data to a ring buffer.
+ *
+ * This routine works like @ref ring_buf_put_claim, but when the allocated
+ * area wraps around the end of the ring buffer it returns the part at the
+ * start of the ring buffer as a second segment, for scatter-gather copies
+ * or DMA. The bytes written are confirmed with @ref ring_buf_put_finish.
+ *
+ * @warning
+ * Use cases involving multiple writers to the ring buffer must prevent
+ * concurrent write operations, either by preventing all writers from
+ * being preempted or by using a mutex to govern writes to the ring buffer.
+ *
+ * @warning
+ * Ring buffer instance should not mix byte access and item access
+ * (calls prefixed with ring_buf_item_).
+ *
+ * @param[in]  buf  Address of ring buffer.
+ * @param[out] segs Segments set to locations within ring buffer, the
+ *		    second one is empty unless the allocated area wraps.
+ * @param[in]  size Requested allocation size (in bytes).
+ *
+ * @return Total size of the segments which can be smaller than requested
+ *	   if there is not enough free space.
+ */
+u32_t ring_buf_put_claim_segments(struct ring_buf *buf,
+				  struct ring_buf_segment segs[2],
+				  u32_t size);
+
 /**
  * @brief Indicate number of bytes written to allocated buffers.
  *
@@ -381,6 +459,35 @@ u32_t ring_buf_put(struct ring_buf *buf, const u8_t *data, u32_t size);
  */
 u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size);
 
+/**
+ * @brief Get both segments of valid data in a ring buffer.
+ *
+ * This routine works like @ref ring_buf_get_claim, but when the valid
+ * data wraps around the end of the ring buffer it returns the part at the
+ * start of the ring buffer as a second segment, for scatter-gather copies
+ * or DMA. The bytes processed are freed with @ref ring_buf_get_finish.
+ *
+ * @warning
+ * Use cases involving multiple reads of the ring buffer must prevent
+ * concurrent read operations, either by preventing all readers from
+ * being preempted or by using a mutex to govern reads to the ring buffer.
+ *
+ * @warning
+ * Ring buffer instance should not mix byte access and item access
+ * (calls prefixed with ring_buf_item_).
+ *
+ * @param[in]  buf  Address of ring buffer.
+ * @param[out] segs Segments set to locations within ring buffer, the
+ *		    second one is empty unless the valid data wraps.
+ * @param[in]  size Requested size (in bytes).
+ *
+ * @return Total size of the segments which can be smaller than requested
+ *	   if there is not enough valid data.
+ */
+u32_t ring_buf_get_claim_segments(struct ring_buf *buf,
+				  struct ring_buf_segment segs[2],
+				  u32_t size);
+
 /**
  * @brief Indicate number of bytes read from claimed buffer.
  *
@@ -26,7 +26,7 @@
  * threads.
  *
  * Each can be used for either the wait_q or system ready queue,
- * configurable at build time.
+ * configurable at build time, as can the bitmap multi-queue below.
  */
 
 struct k_thread;
@@ -60,4 +60,27 @@ void _priq_mq_add(struct _priq_mq *pq, struct k_thread *thread);
 void _priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread);
 struct k_thread *_priq_mq_best(struct _priq_mq *pq);
 
+/* Two-level bitmap multi-queue.  Like _priq_mq but with one list
+ * per priority across the whole configured priority range, and a
+ * second level bitmap of non-empty words so that add, remove and best
+ * are all O(1).  A clear bit means the list is empty or was never
+ * initialized, so an all-zero struct is a valid empty queue and can
+ * be used for statically initialized wait_q's.  RAM cost is one
+ * dlist head per priority per queue.
+ */
+#define _PRIQ_BM_PRIOS (CONFIG_NUM_COOP_PRIORITIES + \
+			CONFIG_NUM_PREEMPT_PRIORITIES + 1)
+#define _PRIQ_BM_WORDS ((_PRIQ_BM_PRIOS + 31) / 32)
+
+struct _priq_bm {
+	u32_t top; /* bit 1<<i set if bitmask[i] is non-zero */
+	u32_t bitmask[_PRIQ_BM_WORDS]; /* one bit per entry in queues[] */
+	sys_dlist_t queues[_PRIQ_BM_PRIOS];
+};
+
+void _priq_bm_add(struct _priq_bm *pq, struct k_thread *thread);
+void _priq_bm_remove(struct _priq_bm *pq, struct k_thread *thread);
+struct k_thread *_priq_bm_best(struct _priq_bm *pq);
+struct k_thread *_priq_bm_next(struct _priq_bm *pq, struct k_thread *thread);
+
 #endif /* ZEPHYR_INCLUDE_SCHED_PRIQ_H_ */
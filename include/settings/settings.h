@@ -139,6 +139,27 @@ int settings_save(void);
  */
 int settings_save_one(const char *name, void *value, size_t val_len);
 
+/**
+ * Start a batch of saves. Values passed to settings_save_one() (and so
+ * settings_save() and settings_delete()) until settings_save_end() are
+ * kept in RAM instead of being written to persisted storage.
+ *
+ * Requires CONFIG_SETTINGS_SAVE_BATCH.
+ *
+ * @return 0 on success, -EBUSY if a batch is already started, -ENOTSUP if
+ * the storage back-end has no batch support, other non-zero on failure.
+ */
+int settings_save_begin(void);
+
+/**
+ * Write all values saved since settings_save_begin() to persisted storage
+ * in one pass. After a reset either all or none of them are loaded back.
+ *
+ * @return 0 on success, non-zero on failure. On failure none of the
+ * batched values were written.
+ */
+int settings_save_end(void);
+
 /**
  * Delete a single serialized in persisted storage.
  *
@@ -78,6 +78,8 @@ struct _ready_q {
 	struct _priq_rb runq;
 #elif defined(CONFIG_SCHED_MULTIQ)
 	struct _priq_mq runq;
+#elif defined(CONFIG_SCHED_BITMAP)
+	struct _priq_bm runq;
 #endif
 };
 
@@ -107,6 +109,11 @@ struct _cpu {
 	/* True when _current is allowed to context switch */
 	u8_t swap_ok;
 #endif
+
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* threads made ready on this CPU, may be stolen by others */
+	struct _ready_q ready_q;
+#endif
 };
 
 typedef struct _cpu _cpu_t;
@@ -39,7 +39,24 @@ static inline struct k_thread *_waitq_head(_wait_q_t *w)
 	return (void *)rb_get_min(&w->waitq.tree);
 }
 
-#else /* !CONFIG_WAITQ_SCALABLE: */
+#elif defined(CONFIG_WAITQ_BITMAP)
+
+#define _WAIT_Q_FOR_EACH(wq, thread_ptr)				\
+	for (thread_ptr = _priq_bm_best(&(wq)->waitq);			\
+	     thread_ptr != NULL;					\
+	     thread_ptr = _priq_bm_next(&(wq)->waitq, thread_ptr))
+
+static inline void _waitq_init(_wait_q_t *w)
+{
+	(void)memset(&w->waitq, 0, sizeof(w->waitq));
+}
+
+static inline struct k_thread *_waitq_head(_wait_q_t *w)
+{
+	return _priq_bm_best(&w->waitq);
+}
+
+#else /* !CONFIG_WAITQ_SCALABLE && !CONFIG_WAITQ_BITMAP: */
 
 #define _WAIT_Q_FOR_EACH(wq, thread_ptr) \
 	SYS_DLIST_FOR_EACH_CONTAINER(&((wq)->waitq), thread_ptr, \
@@ -55,7 +72,7 @@ static inline struct k_thread *_waitq_head(_wait_q_t *w)
 	return (void *)sys_dlist_peek_head(&w->waitq);
 }
 
-#endif /* !CONFIG_WAITQ_SCALABLE */
+#endif /* !CONFIG_WAITQ_SCALABLE && !CONFIG_WAITQ_BITMAP */
 
 #ifdef __cplusplus
 }
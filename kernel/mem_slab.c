@@ -13,6 +13,7 @@
 #include <misc/dlist.h>
 #include <ksched.h>
 #include <init.h>
+#include <string.h>
 
 extern struct k_mem_slab _k_mem_slab_list_start[];
 extern struct k_mem_slab _k_mem_slab_list_end[];
@@ -23,6 +24,116 @@ static struct k_spinlock lock;
 struct k_mem_slab *_trace_list_k_mem_slab;
 #endif	/* CONFIG_OBJECT_TRACING */
 
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+/* Per-CPU magazines.  The fast paths only take the magazine lock of
+ * the current CPU; the shared free list, the wait queue and any
+ * cross-CPU magazine access need the global lock, which is always
+ * taken before a magazine lock.
+ *
+ * A thread that is about to wait sets slab->waiting before taking the
+ * blocks left in all magazines, and the free fast path checks it
+ * under the magazine lock.  So once a thread found every magazine
+ * empty, all later frees take the slow path and wake it.
+ */
+#define CACHE_SIZE CONFIG_MEM_SLAB_CPU_CACHE_SIZE
+#define CACHE_BATCH (CACHE_SIZE / 2)
+
+static struct k_mem_slab_cache *local_cache(struct k_mem_slab *slab)
+{
+	/* Reading the CPU unlocked is fine: a thread that migrated in
+	 * between just uses (and locks) another CPU's magazine
+	 */
+	return &slab->cache[_current_cpu->id];
+}
+
+static bool cache_alloc(struct k_mem_slab *slab, void **mem)
+{
+	struct k_mem_slab_cache *c = local_cache(slab);
+	k_spinlock_key_t key = k_spin_lock(&c->lock);
+	bool ret = c->count > 0U;
+
+	if (ret) {
+		*mem = c->blocks[--c->count];
+		c->used++;
+	}
+
+	k_spin_unlock(&c->lock, key);
+
+	return ret;
+}
+
+static bool cache_free(struct k_mem_slab *slab, void *mem)
+{
+	struct k_mem_slab_cache *c = local_cache(slab);
+	k_spinlock_key_t key = k_spin_lock(&c->lock);
+	bool ret = !slab->waiting && c->count < CACHE_SIZE;
+
+	if (ret) {
+		c->blocks[c->count++] = mem;
+		c->used--;
+	}
+
+	k_spin_unlock(&c->lock, key);
+
+	return ret;
+}
+
+/* Called with the global lock held */
+static void cache_refill(struct k_mem_slab *slab)
+{
+	struct k_mem_slab_cache *c = local_cache(slab);
+	k_spinlock_key_t key = k_spin_lock(&c->lock);
+
+	while (c->count < CACHE_BATCH && slab->free_list != NULL) {
+		c->blocks[c->count++] = slab->free_list;
+		slab->free_list = *(char **)(slab->free_list);
+	}
+
+	k_spin_unlock(&c->lock, key);
+}
+
+/* Called with the global lock held */
+static void cache_drain(struct k_mem_slab *slab)
+{
+	struct k_mem_slab_cache *c = local_cache(slab);
+	k_spinlock_key_t key = k_spin_lock(&c->lock);
+
+	if (c->count == CACHE_SIZE) {
+		while (c->count > CACHE_SIZE - CACHE_BATCH) {
+			char *block = c->blocks[--c->count];
+
+			*(char **)block = slab->free_list;
+			slab->free_list = block;
+		}
+	}
+
+	k_spin_unlock(&c->lock, key);
+}
+
+/* Called with the global lock held, takes a block from any magazine */
+static bool cache_steal(struct k_mem_slab *slab, void **mem)
+{
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct k_mem_slab_cache *c = &slab->cache[i];
+		k_spinlock_key_t key = k_spin_lock(&c->lock);
+		bool found = c->count > 0U;
+
+		if (found) {
+			*mem = c->blocks[--c->count];
+			c->used++;
+		}
+
+		k_spin_unlock(&c->lock, key);
+
+		if (found) {
+			return true;
+		}
+	}
+
+	return false;
+}
+#endif /* CONFIG_MEM_SLAB_CPU_CACHE */
+
 /**
  * @brief Initialize kernel memory slab subsystem.
  *
@@ -83,6 +194,10 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	slab->block_size = block_size;
 	slab->buffer = buffer;
 	slab->num_used = 0;
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	(void)memset(slab->cache, 0, sizeof(slab->cache));
+	slab->waiting = false;
+#endif
 	create_free_list(slab);
 	_waitq_init(&slab->wait_q);
 	SYS_TRACING_OBJ_INIT(k_mem_slab, slab);
@@ -92,19 +207,49 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 
 int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
+	k_spinlock_key_t key;
 	int result;
 
 	/* block size must be word aligned */
 	__ASSERT((slab->block_size & (sizeof(void *) - 1)) == 0,
 		 "block size not word aligned");
 
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	if (cache_alloc(slab, mem)) {
+		return 0;
+	}
+#endif
+
+	key = k_spin_lock(&lock);
+
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	if (slab->free_list == NULL) {
+		/* Announce that we may wait before looking at the
+		 * magazines, see above
+		 */
+		if (timeout != K_NO_WAIT) {
+			slab->waiting = true;
+		}
+
+		if (cache_steal(slab, mem)) {
+			if (_waitq_head(&slab->wait_q) == NULL) {
+				slab->waiting = false;
+			}
+			k_spin_unlock(&lock, key);
+			return 0;
+		}
+	}
+#endif
+
 	if (slab->free_list != NULL) {
 		/* take a free block */
 		*mem = slab->free_list;
 		slab->free_list = *(char **)(slab->free_list);
 		slab->num_used++;
 		result = 0;
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+		cache_refill(slab);
+#endif
 	} else if (timeout == K_NO_WAIT) {
 		/* don't wait for a free block to become available */
 		*mem = NULL;
@@ -125,14 +270,27 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 
 void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
-	struct k_thread *pending_thread = _unpend_first_thread(&slab->wait_q);
+	k_spinlock_key_t key;
+	struct k_thread *pending_thread;
+
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	if (cache_free(slab, *mem)) {
+		return;
+	}
+#endif
+
+	key = k_spin_lock(&lock);
+	pending_thread = _unpend_first_thread(&slab->wait_q);
 
 	if (pending_thread != NULL) {
 		_set_thread_return_value_with_data(pending_thread, 0, *mem);
 		_ready_thread(pending_thread);
 		_reschedule(&lock, key);
 	} else {
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+		slab->waiting = false;
+		cache_drain(slab);
+#endif
 		**(char ***)mem = slab->free_list;
 		slab->free_list = *(char **)mem;
 		slab->num_used--;
@@ -30,6 +30,10 @@
 #define _priq_run_add		_priq_mq_add
 #define _priq_run_remove	_priq_mq_remove
 #define _priq_run_best		_priq_mq_best
+#elif defined(CONFIG_SCHED_BITMAP)
+#define _priq_run_add		_priq_bm_add
+#define _priq_run_remove	_priq_bm_remove
+#define _priq_run_best		_priq_bm_best
 #endif
 
 #if defined(CONFIG_WAITQ_SCALABLE)
@@ -40,6 +44,10 @@
 #define _priq_wait_add		_priq_dumb_add
 #define _priq_wait_remove	_priq_dumb_remove
 #define _priq_wait_best		_priq_dumb_best
+#elif defined(CONFIG_WAITQ_BITMAP)
+#define _priq_wait_add		_priq_bm_add
+#define _priq_wait_remove	_priq_bm_remove
+#define _priq_wait_best		_priq_bm_best
 #endif
 
 /* the only struct z_kernel instance */
@@ -176,6 +184,143 @@ static ALWAYS_INLINE struct k_thread *_priq_dumb_mask_best(sys_dlist_t *pq)
 }
 #endif
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+/* Per-CPU ready queues.  Each CPU's _cpu.ready_q is protected by its
+ * own lock in runq_locks[], and a queued thread records the CPU whose
+ * queue holds it in base.runq_cpu.  sched_lock still protects wait
+ * queues and priority changes, and may be held while taking a runq
+ * lock, never the other way around.  Only work stealing holds two
+ * runq locks at a time, and takes them in CPU order.
+ */
+static struct k_spinlock runq_locks[CONFIG_MP_NUM_CPUS];
+
+#define RUNQ(cpu) (&_kernel.cpus[(cpu)].ready_q.runq)
+
+static inline bool can_run_on(struct k_thread *thread, int cpu)
+{
+#ifdef CONFIG_SCHED_CPU_MASK
+	return (thread->base.cpu_mask & BIT(cpu)) != 0;
+#else
+	ARG_UNUSED(thread);
+	ARG_UNUSED(cpu);
+	return true;
+#endif
+}
+
+/* Locks the queue a thread is (or was last) queued on.  The thread
+ * can be stolen between reading runq_cpu and getting the lock, so
+ * retry until the two agree.
+ */
+static int lock_thread_runq(struct k_thread *thread, k_spinlock_key_t *key)
+{
+	while (true) {
+		int cpu = thread->base.runq_cpu;
+
+		*key = k_spin_lock(&runq_locks[cpu]);
+		if (thread->base.runq_cpu == cpu) {
+			return cpu;
+		}
+		k_spin_unlock(&runq_locks[cpu], *key);
+	}
+}
+
+/* Chooses the queue for a newly ready thread: an idle CPU it may run
+ * on, else this CPU if it would preempt _current here, else the CPU
+ * it last ran on (its cache is likely still warm).
+ */
+static int pick_runq(struct k_thread *thread)
+{
+	int id = _current_cpu->id;
+	int i;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct k_thread *curr = _kernel.cpus[i].current;
+
+		if (curr != NULL && _is_idle(curr) && can_run_on(thread, i)) {
+			return i;
+		}
+	}
+
+	if (can_run_on(thread, id) &&
+	    _is_t1_higher_prio_than_t2(thread, _current)) {
+		return id;
+	}
+
+	if (can_run_on(thread, thread->base.cpu)) {
+		return thread->base.cpu;
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (can_run_on(thread, i)) {
+			return i;
+		}
+	}
+
+	/* Runs nowhere (empty mask), park it here */
+	return id;
+}
+
+static void runq_add(int cpu, struct k_thread *thread)
+{
+	_priq_run_add(RUNQ(cpu), thread);
+	thread->base.runq_cpu = cpu;
+	_mark_thread_as_queued(thread);
+}
+
+/* Moves a thread to the back of its priority in the queue holding
+ * it.  An unqueued thread (i.e. _current) is queued on this CPU.
+ */
+static void runq_requeue(struct k_thread *thread)
+{
+	k_spinlock_key_t key;
+	int cpu = lock_thread_runq(thread, &key);
+
+	if (_is_thread_queued(thread)) {
+		_priq_run_remove(RUNQ(cpu), thread);
+	} else if (cpu != _current_cpu->id) {
+		k_spin_unlock(&runq_locks[cpu], key);
+		cpu = _current_cpu->id;
+		key = k_spin_lock(&runq_locks[cpu]);
+	}
+	runq_add(cpu, thread);
+	k_spin_unlock(&runq_locks[cpu], key);
+}
+
+/* Moves the best thread this CPU may run out of another CPU's queue
+ * into this CPU's queue.  Both queue locks are held for the move,
+ * taken in CPU order, so the thread is queued at all times and a
+ * suspend or abort racing with the steal always finds it.  A victim's
+ * _current is never stolen: it may sit in the victim's queue (e.g.
+ * after k_yield()) while it is still running there.
+ */
+static void steal(int id)
+{
+	for (int i = 1; i < CONFIG_MP_NUM_CPUS; i++) {
+		int victim = (id + i) % CONFIG_MP_NUM_CPUS;
+		int first = MIN(id, victim), second = MAX(id, victim);
+		k_spinlock_key_t key1 = k_spin_lock(&runq_locks[first]);
+		k_spinlock_key_t key2 = k_spin_lock(&runq_locks[second]);
+		struct k_thread *th = _priq_run_best(RUNQ(victim));
+
+		if (th == _kernel.cpus[victim].current) {
+			th = NULL;
+		}
+
+		if (th != NULL) {
+			_priq_run_remove(RUNQ(victim), th);
+			runq_add(id, th);
+		}
+
+		k_spin_unlock(&runq_locks[second], key2);
+		k_spin_unlock(&runq_locks[first], key1);
+
+		if (th != NULL) {
+			return;
+		}
+	}
+}
+#endif /* CONFIG_SCHED_PERCPU_RUNQ */
+
 static ALWAYS_INLINE struct k_thread *next_up(void)
 {
 #ifndef CONFIG_SMP
@@ -188,6 +333,55 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	struct k_thread *th = _priq_run_best(&_kernel.ready_q.runq);
 
 	return th ? th : _current_cpu->idle_thread;
+#elif defined(CONFIG_SCHED_PERCPU_RUNQ)
+	/* Same decision as with the global queue below, made on this
+	 * CPU's own queue.  When that is empty, try to steal work from
+	 * the other CPUs into it; our lock is dropped meanwhile as
+	 * steal() takes it in CPU order with the victim's.  The stolen
+	 * thread may be gone again once we hold the lock, so the queue
+	 * is looked at anew.
+	 */
+	int id = _current_cpu->id;
+	k_spinlock_key_t key = k_spin_lock(&runq_locks[id]);
+	struct k_thread *th = _priq_run_best(RUNQ(id));
+
+	if (th == NULL) {
+		k_spin_unlock(&runq_locks[id], key);
+		steal(id);
+		key = k_spin_lock(&runq_locks[id]);
+		th = _priq_run_best(RUNQ(id));
+		if (th == NULL) {
+			th = _current_cpu->idle_thread;
+		}
+	}
+
+	int queued = _is_thread_queued(_current);
+	int active = !_is_thread_prevented_from_running(_current);
+
+	if (active) {
+		if (!queued &&
+		    !_is_t1_higher_prio_than_t2(th, _current)) {
+			th = _current;
+		}
+
+		if (!should_preempt(th, _current_cpu->swap_ok)) {
+			th = _current;
+		}
+	}
+
+	if (th != _current && active && !_is_idle(_current) && !queued) {
+		runq_add(id, _current);
+	}
+
+	if (_is_thread_queued(th)) {
+		__ASSERT_NO_MSG(th->base.runq_cpu == id);
+		_priq_run_remove(RUNQ(id), th);
+	}
+	_mark_thread_as_not_queued(th);
+
+	k_spin_unlock(&runq_locks[id], key);
+
+	return th;
 #else
 
 	/* Under SMP, the "cache" mechanism for selecting the next
@@ -328,6 +522,36 @@ static void update_cache(int preempt_ok)
 #endif
 }
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+void _add_thread_to_ready_q(struct k_thread *thread)
+{
+	int cpu = pick_runq(thread);
+
+	LOCKED(&runq_locks[cpu]) {
+		runq_add(cpu, thread);
+		update_cache(0);
+	}
+}
+
+void _move_thread_to_end_of_prio_q(struct k_thread *thread)
+{
+	runq_requeue(thread);
+	update_cache(thread == _current);
+}
+
+void _remove_thread_from_ready_q(struct k_thread *thread)
+{
+	k_spinlock_key_t key;
+	int cpu = lock_thread_runq(thread, &key);
+
+	if (_is_thread_queued(thread)) {
+		_priq_run_remove(RUNQ(cpu), thread);
+		_mark_thread_as_not_queued(thread);
+		update_cache(thread == _current);
+	}
+	k_spin_unlock(&runq_locks[cpu], key);
+}
+#else
 void _add_thread_to_ready_q(struct k_thread *thread)
 {
 	LOCKED(&sched_lock) {
@@ -357,6 +581,7 @@ void _remove_thread_from_ready_q(struct k_thread *thread)
 		}
 	}
 }
+#endif /* CONFIG_SCHED_PERCPU_RUNQ */
 
 static void pend(struct k_thread *thread, _wait_q_t *wait_q, s32_t timeout)
 {
@@ -479,9 +704,23 @@ void _thread_priority_set(struct k_thread *thread, int prio)
 		need_sched = _is_thread_ready(thread);
 
 		if (need_sched) {
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+			k_spinlock_key_t key;
+			int cpu = lock_thread_runq(thread, &key);
+
+			if (_is_thread_queued(thread)) {
+				_priq_run_remove(RUNQ(cpu), thread);
+				thread->base.prio = prio;
+				_priq_run_add(RUNQ(cpu), thread);
+			} else {
+				thread->base.prio = prio;
+			}
+			k_spin_unlock(&runq_locks[cpu], key);
+#else
 			_priq_run_remove(&_kernel.ready_q.runq, thread);
 			thread->base.prio = prio;
 			_priq_run_add(&_kernel.ready_q.runq, thread);
+#endif
 			update_cache(1);
 		} else {
 			thread->base.prio = prio;
@@ -554,35 +793,48 @@ struct k_thread *_get_next_ready_thread(void)
 {
 	struct k_thread *ret = 0;
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	ret = next_up();
+#else
 	LOCKED(&sched_lock) {
 		ret = next_up();
 	}
+#endif
 
 	return ret;
 }
 #endif
 
 #ifdef CONFIG_USE_SWITCH
+#ifdef CONFIG_SMP
+static void switch_current(struct k_thread *th)
+{
+	if (_current != th) {
+		reset_time_slice();
+		_current_cpu->swap_ok = 0;
+#ifdef CONFIG_TRACING
+		sys_trace_thread_switched_out();
+#endif
+		_current = th;
+#ifdef CONFIG_TRACING
+		sys_trace_thread_switched_in();
+#endif
+	}
+}
+#endif
+
 void *_get_next_switch_handle(void *interrupted)
 {
 	_current->switch_handle = interrupted;
 
 #ifdef CONFIG_SMP
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	switch_current(next_up());
+#else
 	LOCKED(&sched_lock) {
-		struct k_thread *th = next_up();
-
-		if (_current != th) {
-			reset_time_slice();
-			_current_cpu->swap_ok = 0;
-#ifdef CONFIG_TRACING
-			sys_trace_thread_switched_out();
-#endif
-			_current = th;
-#ifdef CONFIG_TRACING
-			sys_trace_thread_switched_in();
-#endif
-		}
+		switch_current(next_up());
 	}
+#endif
 
 #else
 #ifdef CONFIG_TRACING
@@ -736,6 +988,95 @@ struct k_thread *_priq_mq_best(struct _priq_mq *pq)
 	return t;
 }
 
+#if _PRIQ_BM_WORDS > 32
+# error Too many priorities for bitmap priority queue (max 1024)
+#endif
+
+static ALWAYS_INLINE struct k_thread *priq_bm_head(struct _priq_bm *pq,
+						   int word)
+{
+	int idx = word * 32 + __builtin_ctz(pq->bitmask[word]);
+	sys_dnode_t *n = sys_dlist_peek_head_not_empty(&pq->queues[idx]);
+
+	return CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
+}
+
+/* The queue index is cached in order_key (otherwise only used by the
+ * rbtree queues, and a thread sits in one queue at a time) so that a
+ * priority change while queued cannot corrupt the bitmaps on removal.
+ */
+void _priq_bm_add(struct _priq_bm *pq, struct k_thread *thread)
+{
+	int idx = thread->base.prio - K_HIGHEST_THREAD_PRIO;
+	int word = idx / 32;
+	u32_t bit = BIT(idx % 32);
+
+	/* See sched_priq.h: lists behind a clear bit may be garbage */
+	if ((pq->bitmask[word] & bit) == 0U) {
+		sys_dlist_init(&pq->queues[idx]);
+		pq->bitmask[word] |= bit;
+		pq->top |= BIT(word);
+	}
+
+	thread->base.order_key = idx;
+	sys_dlist_append(&pq->queues[idx], &thread->base.qnode_dlist);
+}
+
+void _priq_bm_remove(struct _priq_bm *pq, struct k_thread *thread)
+{
+	int idx = thread->base.order_key;
+	int word = idx / 32;
+
+	sys_dlist_remove(&thread->base.qnode_dlist);
+	if (sys_dlist_is_empty(&pq->queues[idx])) {
+		pq->bitmask[word] &= ~BIT(idx % 32);
+		if (pq->bitmask[word] == 0U) {
+			pq->top &= ~BIT(word);
+		}
+	}
+}
+
+struct k_thread *_priq_bm_best(struct _priq_bm *pq)
+{
+	if (pq->top == 0U) {
+		return NULL;
+	}
+
+	return priq_bm_head(pq, __builtin_ctz(pq->top));
+}
+
+/* Next thread after @thread in priority then FIFO order, for
+ * iterating a wait_q without a nested loop
+ */
+struct k_thread *_priq_bm_next(struct _priq_bm *pq, struct k_thread *thread)
+{
+	int idx = thread->base.order_key;
+	int word = idx / 32;
+	sys_dnode_t *n;
+	u32_t above;
+
+	n = sys_dlist_peek_next_no_check(&pq->queues[idx],
+					 &thread->base.qnode_dlist);
+	if (n != NULL) {
+		return CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
+	}
+
+	/* 2U << 31 wraps to zero, which correctly masks out every bit */
+	above = pq->bitmask[word] & ~((2U << (idx % 32)) - 1U);
+	if (above != 0U) {
+		idx = word * 32 + __builtin_ctz(above);
+		n = sys_dlist_peek_head_not_empty(&pq->queues[idx]);
+		return CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
+	}
+
+	above = pq->top & ~((2U << word) - 1U);
+	if (above == 0U) {
+		return NULL;
+	}
+
+	return priq_bm_head(pq, __builtin_ctz(above));
+}
+
 int _unpend_all(_wait_q_t *wait_q)
 {
 	int need_sched = 0;
@@ -750,14 +1091,14 @@ int _unpend_all(_wait_q_t *wait_q)
 	return need_sched;
 }
 
-void _sched_init(void)
+static void init_ready_q(struct _ready_q *rq)
 {
 #ifdef CONFIG_SCHED_DUMB
-	sys_dlist_init(&_kernel.ready_q.runq);
+	sys_dlist_init(&rq->runq);
 #endif
 
 #ifdef CONFIG_SCHED_SCALABLE
-	_kernel.ready_q.runq = (struct _priq_rb) {
+	rq->runq = (struct _priq_rb) {
 		.tree = {
 			.lessthan_fn = _priq_rb_lessthan,
 		}
@@ -765,8 +1106,23 @@ void _sched_init(void)
 #endif
 
 #ifdef CONFIG_SCHED_MULTIQ
-	for (int i = 0; i < ARRAY_SIZE(_kernel.ready_q.runq.queues); i++) {
-		sys_dlist_init(&_kernel.ready_q.runq.queues[i]);
+	for (int i = 0; i < ARRAY_SIZE(rq->runq.queues); i++) {
+		sys_dlist_init(&rq->runq.queues[i]);
+	}
+#endif
+
+#ifdef CONFIG_SCHED_BITMAP
+	(void)memset(&rq->runq, 0, sizeof(rq->runq));
+#endif
+}
+
+void _sched_init(void)
+{
+	init_ready_q(&_kernel.ready_q);
+
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		init_ready_q(&_kernel.cpus[i].ready_q);
 	}
 #endif
 
@@ -824,10 +1180,21 @@ void _impl_k_thread_deadline_set(k_tid_t tid, int deadline)
 
 	LOCKED(&sched_lock) {
 		th->base.prio_deadline = k_cycle_get_32() + deadline;
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+		k_spinlock_key_t key;
+		int cpu = lock_thread_runq(th, &key);
+
+		if (_is_thread_queued(th)) {
+			_priq_run_remove(RUNQ(cpu), th);
+			_priq_run_add(RUNQ(cpu), th);
+		}
+		k_spin_unlock(&runq_locks[cpu], key);
+#else
 		if (_is_thread_queued(th)) {
 			_priq_run_remove(&_kernel.ready_q.runq, th);
 			_priq_run_add(&_kernel.ready_q.runq, th);
 		}
+#endif
 	}
 }
 
@@ -852,11 +1219,16 @@ void _impl_k_yield(void)
 	__ASSERT(!_is_in_isr(), "");
 
 	if (!_is_idle(_current)) {
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+		runq_requeue(_current);
+		update_cache(1);
+#else
 		LOCKED(&sched_lock) {
 			_priq_run_remove(&_kernel.ready_q.runq, _current);
 			_priq_run_add(&_kernel.ready_q.runq, _current);
 			update_cache(1);
 		}
+#endif
 	}
 
 	_Swap_unlocked();
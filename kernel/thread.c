@@ -679,6 +679,12 @@ void _init_thread_base(struct _thread_base *thread_base, int priority,
 
 	thread_base->sched_locked = 0;
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* Both are used as _kernel.cpus[] indexes before first run */
+	thread_base->cpu = 0;
+	thread_base->runq_cpu = 0;
+#endif
+
 	/* swap_data does not need to be initialized */
 
 	_init_thread_timeout(thread_base);
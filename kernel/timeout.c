@@ -17,8 +17,6 @@
 
 static u64_t curr_tick;
 
-static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
-
 static struct k_spinlock timeout_lock;
 
 static bool can_wait_forever;
@@ -30,6 +28,213 @@ static int announce_remaining;
 int z_clock_hw_cycles_per_sec = CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
 #endif
 
+static s32_t elapsed(void)
+{
+	return announce_remaining == 0 ? z_clock_elapsed() : 0;
+}
+
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+
+/* Hierarchical timer wheel.  Level N has WHEEL_SLOTS buckets, each
+ * spanning WHEEL_SLOTS^N ticks.  A timeout is hashed by its absolute
+ * expiry into the lowest level whose range covers its distance from
+ * the wheel position (curr_tick), and gets re-hashed ("cascaded")
+ * into a lower level when the wheel reaches the start of its bucket.
+ * Add and abort are O(1), finding the next event is O(levels).
+ *
+ * In this mode _timeout.dticks holds the low 32 bits of the absolute
+ * expiry tick instead of a delta.  Bucket bitmaps are allowed to be
+ * stale after an abort and are cleaned up lazily by next_event().
+ */
+#define WHEEL_BITS 5
+#define WHEEL_SLOTS BIT(WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS CONFIG_TIMEOUT_WHEEL_LEVELS
+#define WHEEL_SHIFT(lvl) (WHEEL_BITS * (lvl))
+#define WHEEL_MAX_DELTA ((s32_t)(BIT(WHEEL_SHIFT(WHEEL_LEVELS)) - 1))
+
+#define NO_EVENT UINT64_MAX
+
+struct wheel_level {
+	u32_t bitmask; /* bit 1<<i set if slots[i] may be non-empty */
+	sys_dlist_t slots[WHEEL_SLOTS];
+};
+
+static struct wheel_level wheel[WHEEL_LEVELS];
+
+static s32_t ticks_until(struct _timeout *t)
+{
+	return (s32_t)((u32_t)t->dticks - (u32_t)curr_tick);
+}
+
+static void wheel_insert(struct _timeout *to)
+{
+	s32_t delta = MIN(MAX(0, ticks_until(to)), WHEEL_MAX_DELTA);
+	struct wheel_level *lvl;
+	int idx, l = 0;
+
+	while (l < (WHEEL_LEVELS - 1) &&
+	       delta >= (s32_t)BIT(WHEEL_SHIFT(l + 1))) {
+		l++;
+	}
+
+	lvl = &wheel[l];
+	idx = ((curr_tick + delta) >> WHEEL_SHIFT(l)) & WHEEL_MASK;
+
+	/* A clear bit means the slot list is empty or was never
+	 * initialized (the wheel lives in BSS)
+	 */
+	if ((lvl->bitmask & BIT(idx)) == 0U) {
+		sys_dlist_init(&lvl->slots[idx]);
+		lvl->bitmask |= BIT(idx);
+	}
+	sys_dlist_append(&lvl->slots[idx], &to->node);
+}
+
+/* Returns the absolute tick of the next bucket that needs service:
+ * either a level 0 bucket whose timeouts expire, or the start of a
+ * higher level bucket that must be cascaded.
+ */
+static u64_t next_event(void)
+{
+	u64_t ret = NO_EVENT;
+
+	for (int l = 0; l < WHEEL_LEVELS; l++) {
+		struct wheel_level *lvl = &wheel[l];
+		u64_t pos = curr_tick >> WHEEL_SHIFT(l);
+		/* The current bucket of a higher level was already
+		 * cascaded, so anything in it belongs to the next lap
+		 */
+		u32_t start = (pos + (l > 0 ? 1 : 0)) & WHEEL_MASK;
+
+		while (lvl->bitmask != 0U) {
+			u32_t rot = start == 0U ? lvl->bitmask :
+				(lvl->bitmask >> start) |
+				(lvl->bitmask << (WHEEL_SLOTS - start));
+			u32_t dist = __builtin_ctz(rot);
+			u32_t idx = (start + dist) & WHEEL_MASK;
+
+			if (sys_dlist_is_empty(&lvl->slots[idx])) {
+				lvl->bitmask &= ~BIT(idx);
+				continue;
+			}
+
+			dist += (l > 0 ? 1 : 0);
+			ret = MIN(ret, (pos + dist) << WHEEL_SHIFT(l));
+			break;
+		}
+	}
+
+	return ret;
+}
+
+/* Re-hash the buckets of every level that starts at this tick,
+ * highest first so that timeouts can fall through several levels.
+ */
+static void cascade(u64_t tick)
+{
+	for (int l = WHEEL_LEVELS - 1; l > 0; l--) {
+		struct wheel_level *lvl = &wheel[l];
+		u32_t idx = (tick >> WHEEL_SHIFT(l)) & WHEEL_MASK;
+		sys_dnode_t *n;
+
+		if ((tick & (BIT(WHEEL_SHIFT(l)) - 1)) != 0U ||
+		    (lvl->bitmask & BIT(idx)) == 0U) {
+			continue;
+		}
+
+		lvl->bitmask &= ~BIT(idx);
+		while ((n = sys_dlist_get(&lvl->slots[idx])) != NULL) {
+			wheel_insert(CONTAINER_OF(n, struct _timeout, node));
+		}
+	}
+}
+
+static struct _timeout *pop_expired(u64_t tick)
+{
+	struct wheel_level *lvl = &wheel[0];
+	u32_t idx = tick & WHEEL_MASK;
+	sys_dnode_t *n;
+
+	if ((lvl->bitmask & BIT(idx)) == 0U) {
+		return NULL;
+	}
+
+	n = sys_dlist_get(&lvl->slots[idx]);
+	if (sys_dlist_is_empty(&lvl->slots[idx])) {
+		lvl->bitmask &= ~BIT(idx);
+	}
+
+	return n == NULL ? NULL : CONTAINER_OF(n, struct _timeout, node);
+}
+
+static s32_t next_timeout(void)
+{
+	int maxw = can_wait_forever ? K_FOREVER : INT_MAX;
+	u64_t ev = next_event();
+	s32_t ret = ev == NO_EVENT ? maxw :
+		MAX(0, (s32_t)MIN(ev - curr_tick, INT_MAX) - elapsed());
+
+#ifdef CONFIG_TIMESLICING
+	if (_current_cpu->slice_ticks && _current_cpu->slice_ticks < ret) {
+		ret = _current_cpu->slice_ticks;
+	}
+#endif
+	return ret;
+}
+
+void _add_timeout(struct _timeout *to, _timeout_func_t fn, s32_t ticks)
+{
+	__ASSERT(!sys_dnode_is_linked(&to->node), "");
+	to->fn = fn;
+	ticks = MAX(1, ticks);
+
+	LOCKED(&timeout_lock) {
+		u64_t prev = next_event();
+		u64_t expiry = curr_tick + elapsed() + ticks;
+
+		to->dticks = (s32_t)(u32_t)expiry;
+		wheel_insert(to);
+
+		if (expiry < prev) {
+			z_clock_set_timeout(next_timeout(), false);
+		}
+	}
+}
+
+int _abort_timeout(struct _timeout *to)
+{
+	int ret = -EINVAL;
+
+	LOCKED(&timeout_lock) {
+		if (sys_dnode_is_linked(&to->node)) {
+			sys_dlist_remove(&to->node);
+			ret = 0;
+		}
+	}
+
+	return ret;
+}
+
+s32_t z_timeout_remaining(struct _timeout *timeout)
+{
+	s32_t ticks = 0;
+
+	if (_is_inactive_timeout(timeout)) {
+		return 0;
+	}
+
+	LOCKED(&timeout_lock) {
+		ticks = MAX(0, ticks_until(timeout));
+	}
+
+	return ticks;
+}
+
+#else /* !CONFIG_TIMEOUT_QUEUE_WHEEL */
+
+static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
+
 static struct _timeout *first(void)
 {
 	sys_dnode_t *t = sys_dlist_peek_head(&timeout_list);
@@ -53,11 +258,6 @@ static void remove_timeout(struct _timeout *t)
 	sys_dlist_remove(&t->node);
 }
 
-static s32_t elapsed(void)
-{
-	return announce_remaining == 0 ? z_clock_elapsed() : 0;
-}
-
 static s32_t next_timeout(void)
 {
 	int maxw = can_wait_forever ? K_FOREVER : INT_MAX;
@@ -137,6 +337,8 @@ s32_t z_timeout_remaining(struct _timeout *timeout)
 	return ticks;
 }
 
+#endif /* CONFIG_TIMEOUT_QUEUE_WHEEL */
+
 s32_t _get_next_timeout_expiry(void)
 {
 	s32_t ret = K_FOREVER;
@@ -166,6 +368,53 @@ void z_set_timeout_expiry(s32_t ticks, bool idle)
 	}
 }
 
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+
+void z_clock_announce(s32_t ticks)
+{
+#ifdef CONFIG_TIMESLICING
+	z_time_slice(ticks);
+#endif
+
+	k_spinlock_key_t key = k_spin_lock(&timeout_lock);
+
+	announce_remaining = ticks;
+
+	while (true) {
+		u64_t ev = next_event();
+		struct _timeout *t;
+
+		if (ev > curr_tick + announce_remaining) {
+			break;
+		}
+
+		if (ev != curr_tick) {
+			announce_remaining -= (s32_t)(ev - curr_tick);
+			curr_tick = ev;
+			cascade(ev);
+		}
+
+		t = pop_expired(ev);
+		if (t == NULL) {
+			continue;
+		}
+
+		__ASSERT(ticks_until(t) == 0, "");
+		k_spin_unlock(&timeout_lock, key);
+		t->fn(t);
+		key = k_spin_lock(&timeout_lock);
+	}
+
+	curr_tick += announce_remaining;
+	announce_remaining = 0;
+
+	z_clock_set_timeout(next_timeout(), false);
+
+	k_spin_unlock(&timeout_lock, key);
+}
+
+#else /* !CONFIG_TIMEOUT_QUEUE_WHEEL */
+
 void z_clock_announce(s32_t ticks)
 {
 #ifdef CONFIG_TIMESLICING
@@ -202,6 +451,8 @@ void z_clock_announce(s32_t ticks)
 	k_spin_unlock(&timeout_lock, key);
 }
 
+#endif /* CONFIG_TIMEOUT_QUEUE_WHEEL */
+
 int k_enable_sys_clock_always_on(void)
 {
 	int ret = !can_wait_forever;
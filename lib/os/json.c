@@ -8,13 +8,16 @@
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>
-#include <misc/printk.h>
 #include <misc/util.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <zephyr/types.h>
 
+#if defined(CONFIG_NET_BUF)
+#include <net/buf.h>
+#endif
+
 #include "json.h"
 
 struct token {
@@ -29,6 +32,16 @@ struct lexer {
 	char *pos;
 	char *end;
 	struct token token;
+
+	/* Streaming input, see json_obj_parse_stream(). The data is read
+	 * into the buffer from its start, and decoded strings are stored
+	 * downwards from buf_end.
+	 */
+	json_read_bytes_t read_bytes;
+	void *read_data;
+	char *buf;
+	char *buf_end;
+	int error;
 };
 
 struct json_obj {
@@ -77,9 +90,40 @@ static void emit(struct lexer *lexer, enum json_tokens token)
 	lexer->start = lexer->pos;
 }
 
+static bool refill(struct lexer *lexer)
+{
+	/* Keep one byte for the terminator written by decode_num() */
+	size_t space = lexer->buf_end - lexer->end - 1;
+	ssize_t ret;
+
+	if (!lexer->read_bytes) {
+		return false;
+	}
+
+	if (!space) {
+		lexer->error = -ENOMEM;
+		ret = 0;
+	} else {
+		ret = lexer->read_bytes(lexer->end, space, lexer->read_data);
+	}
+
+	if (ret <= 0) {
+		if (ret < 0) {
+			lexer->error = ret;
+		}
+
+		lexer->read_bytes = NULL;
+		return false;
+	}
+
+	lexer->end += ret;
+
+	return true;
+}
+
 static int next(struct lexer *lexer)
 {
-	if (lexer->pos >= lexer->end) {
+	if (lexer->pos >= lexer->end && !refill(lexer)) {
 		lexer->pos = lexer->end + 1;
 
 		return '\0';
@@ -283,13 +327,33 @@ static void lexer_init(struct lexer *lexer, char *data, size_t len)
 	lexer->pos = data;
 	lexer->end = data + len;
 	lexer->token.type = JSON_TOK_NONE;
+	lexer->read_bytes = NULL;
+	lexer->buf = NULL;
+	lexer->error = 0;
 }
 
-static int obj_init(struct json_obj *json, char *data, size_t len)
+/* Moves the data not lexed yet to the start of the streaming buffer.
+ * Only called between two values, when no token refers to the buffer.
+ */
+static void lexer_compact(struct lexer *lexer)
 {
-	struct token token;
+	size_t shift;
+
+	if (!lexer->buf || lexer->start == lexer->buf) {
+		return;
+	}
+
+	shift = lexer->start - lexer->buf;
 
-	lexer_init(&json->lexer, data, len);
+	memmove(lexer->buf, lexer->start, lexer->end - lexer->start);
+	lexer->start -= shift;
+	lexer->pos -= shift;
+	lexer->end -= shift;
+}
+
+static int obj_init(struct json_obj *json)
+{
+	struct token token;
 
 	if (!lexer_next(&json->lexer, &token)) {
 		return -EINVAL;
@@ -311,6 +375,7 @@ static int element_token(enum json_tokens token)
 	case JSON_TOK_NUMBER:
 	case JSON_TOK_TRUE:
 	case JSON_TOK_FALSE:
+	case JSON_TOK_NULL:
 		return 0;
 	default:
 		return -EINVAL;
@@ -322,6 +387,8 @@ static int obj_next(struct json_obj *json,
 {
 	struct token token;
 
+	lexer_compact(&json->lexer);
+
 	if (!lexer_next(&json->lexer, &token)) {
 		return -EINVAL;
 	}
@@ -371,6 +438,8 @@ static int obj_next(struct json_obj *json,
 
 static int arr_next(struct json_obj *json, struct token *value)
 {
+	lexer_compact(&json->lexer);
+
 	if (!lexer_next(&json->lexer, value)) {
 		return -EINVAL;
 	}
@@ -415,22 +484,165 @@ static int decode_num(const struct token *token, s32_t *num)
 	return 0;
 }
 
+/* Decodes the digits starting at *pos, and moves *pos past them. The
+ * token does not need to be terminated, so this works on the streaming
+ * buffer as well.
+ */
+static int decode_digits(const char **pos, const char *end, u64_t max,
+			 u64_t *num)
+{
+	const char *cur = *pos;
+	u64_t value = 0U;
+
+	if (cur == end || !isdigit((unsigned char)*cur)) {
+		return -EINVAL;
+	}
+
+	for (; cur != end && isdigit((unsigned char)*cur); cur++) {
+		unsigned int digit = *cur - '0';
+
+		if (value > (max - digit) / 10U) {
+			return -ERANGE;
+		}
+
+		value = value * 10U + digit;
+	}
+
+	*pos = cur;
+	*num = value;
+
+	return 0;
+}
+
+static int decode_int64(const struct token *token, s64_t *num)
+{
+	const char *pos = token->start;
+	bool negative = *pos == '-';
+	u64_t value;
+	int ret;
+
+	if (negative) {
+		pos++;
+	}
+
+	ret = decode_digits(&pos, token->end,
+			    negative ? (u64_t)INT64_MAX + 1 : INT64_MAX,
+			    &value);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (pos != token->end) {
+		return -EINVAL;
+	}
+
+	*num = negative ? -(s64_t)(value - 1) - 1 : (s64_t)value;
+
+	return 0;
+}
+
+static int decode_uint64(const struct token *token, u64_t *num)
+{
+	const char *pos = token->start;
+	int ret;
+
+	ret = decode_digits(&pos, token->end, UINT64_MAX, num);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (pos != token->end) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int decode_float(const struct token *token, struct json_float *num)
+{
+	const char *pos = token->start;
+	bool negative = *pos == '-';
+	u64_t val1, val2 = 0U;
+	int ret;
+
+	if (negative) {
+		pos++;
+	}
+
+	ret = decode_digits(&pos, token->end, INT32_MAX, &val1);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (pos != token->end && *pos == '.') {
+		u32_t scale = JSON_FLOAT_DEC_MAX;
+		const char *frac = ++pos;
+
+		/* Only the first six decimals fit in val2 */
+		for (; pos != token->end && isdigit((unsigned char)*pos);
+		     pos++) {
+			scale /= 10U;
+			val2 += (*pos - '0') * scale;
+		}
+
+		if (pos == frac) {
+			return -EINVAL;
+		}
+	}
+
+	if (pos != token->end) {
+		return -EINVAL;
+	}
+
+	num->val1 = negative ? -(s32_t)val1 : (s32_t)val1;
+	num->val2 = negative ? -(s32_t)val2 : (s32_t)val2;
+
+	return 0;
+}
+
 static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
 {
 	if (type1 == JSON_TOK_TRUE || type1 == JSON_TOK_FALSE) {
 		return type2 == JSON_TOK_TRUE || type2 == JSON_TOK_FALSE;
 	}
 
+	/* Number values are decoded according to the descriptor type */
+	if (type1 == JSON_TOK_NUMBER) {
+		return type2 == JSON_TOK_NUMBER || type2 == JSON_TOK_FLOAT ||
+		       type2 == JSON_TOK_INT64 || type2 == JSON_TOK_UINT64;
+	}
+
 	return type1 == type2;
 }
 
-static int obj_parse(struct json_obj *obj,
-		     const struct json_obj_descr *descr, size_t descr_len,
-		     void *val);
+static s64_t obj_parse(struct json_obj *obj,
+		       const struct json_obj_descr *descr, size_t descr_len,
+		       const u8_t *index, void *val);
 static int arr_parse(struct json_obj *obj,
 		     const struct json_obj_descr *elem_descr,
 		     size_t max_elements, void *field, void *val);
 
+/* The streaming buffer is reused for the data that follows, so strings
+ * are moved to its end, out of the way of the lexer.
+ */
+static int store_string(struct lexer *lexer, const struct token *value,
+			char **str)
+{
+	size_t len = value->end - value->start;
+
+	if ((size_t)(lexer->buf_end - lexer->end) < len + 2) {
+		lexer->error = -ENOMEM;
+		return -ENOMEM;
+	}
+
+	lexer->buf_end -= len + 1;
+	memcpy(lexer->buf_end, value->start, len);
+	lexer->buf_end[len] = '\0';
+	*str = lexer->buf_end;
+
+	return 0;
+}
+
 static int decode_value(struct json_obj *obj,
 			const struct json_obj_descr *descr,
 			struct token *value, void *field, void *val)
@@ -441,10 +653,13 @@ static int decode_value(struct json_obj *obj,
 	}
 
 	switch (descr->type) {
-	case JSON_TOK_OBJECT_START:
-		return obj_parse(obj, descr->object.sub_descr,
-				 descr->object.sub_descr_len,
-				 field);
+	case JSON_TOK_OBJECT_START: {
+		s64_t ret = obj_parse(obj, descr->object.sub_descr,
+				      descr->object.sub_descr_len, NULL,
+				      field);
+
+		return ret < 0 ? (int)ret : 0;
+	}
 	case JSON_TOK_LIST_START:
 		return arr_parse(obj, descr->array.element_descr,
 				 descr->array.n_elements, field, val);
@@ -461,9 +676,19 @@ static int decode_value(struct json_obj *obj,
 
 		return decode_num(value, num);
 	}
+	case JSON_TOK_INT64:
+		return decode_int64(value, field);
+	case JSON_TOK_UINT64:
+		return decode_uint64(value, field);
+	case JSON_TOK_FLOAT:
+		return decode_float(value, field);
 	case JSON_TOK_STRING: {
 		char **str = field;
 
+		if (obj->lexer.buf) {
+			return store_string(&obj->lexer, value, str);
+		}
+
 		*value->end = '\0';
 		*str = value->start;
 
@@ -479,6 +704,12 @@ static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
 	switch (descr->type) {
 	case JSON_TOK_NUMBER:
 		return sizeof(s32_t);
+	case JSON_TOK_INT64:
+		return sizeof(s64_t);
+	case JSON_TOK_UINT64:
+		return sizeof(u64_t);
+	case JSON_TOK_FLOAT:
+		return sizeof(struct json_float);
 	case JSON_TOK_STRING:
 		return sizeof(char *);
 	case JSON_TOK_TRUE:
@@ -493,7 +724,7 @@ static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
 		for (i = 0; i < descr->object.sub_descr_len; i++) {
 			ptrdiff_t s = get_elem_size(&descr->object.sub_descr[i]);
 
-			total += ROUND_UP(s, descr->alignment + 1);
+			total += ROUND_UP(s, (1 << descr->align_shift));
 		}
 
 		return total;
@@ -536,67 +767,211 @@ static int arr_parse(struct json_obj *obj,
 	return -EINVAL;
 }
 
-static int obj_parse(struct json_obj *obj, const struct json_obj_descr *descr,
-		     size_t descr_len, void *val)
+static int field_cmp(const char *key, size_t key_len,
+		     const struct json_obj_descr *descr)
+{
+	if (key_len != descr->field_name_len) {
+		return key_len < descr->field_name_len ? -1 : 1;
+	}
+
+	return memcmp(key, descr->field_name, key_len);
+}
+
+/* Returns descr_len if the key is not a field still to be decoded */
+static size_t find_field(const struct json_obj_descr *descr,
+			 size_t descr_len, const u8_t *index,
+			 size_t next_field, s64_t decoded_fields,
+			 const struct json_obj_key_value *kv)
+{
+	size_t i, n;
+
+	if (index) {
+		size_t lo = 0, hi = descr_len;
+
+		while (lo < hi) {
+			size_t mid = (lo + hi) / 2;
+			int cmp = field_cmp(kv->key, kv->key_len,
+					    &descr[index[mid]]);
+
+			if (cmp == 0) {
+				i = index[mid];
+
+				if (decoded_fields & ((s64_t)1 << i)) {
+					return descr_len;
+				}
+
+				return i;
+			}
+
+			if (cmp < 0) {
+				hi = mid;
+			} else {
+				lo = mid + 1;
+			}
+		}
+
+		return descr_len;
+	}
+
+	/* Keys usually come in the order of the descriptor, so start
+	 * looking right after the previous match.
+	 */
+	for (n = 0, i = next_field; n < descr_len; n++, i++) {
+		if (i == descr_len) {
+			i = 0;
+		}
+
+		/* Field has been decoded already, skip */
+		if (decoded_fields & ((s64_t)1 << i)) {
+			continue;
+		}
+
+		if (!field_cmp(kv->key, kv->key_len, &descr[i])) {
+			return i;
+		}
+	}
+
+	return descr_len;
+}
+
+static s64_t obj_parse(struct json_obj *obj, const struct json_obj_descr *descr,
+		       size_t descr_len, const u8_t *index, void *val)
 {
 	struct json_obj_key_value kv;
-	s32_t decoded_fields = 0;
+	s64_t decoded_fields = 0;
+	size_t next_field = 0;
 	size_t i;
 	int ret;
 
+	assert(descr_len <= JSON_OBJ_MAX_FIELDS);
+
 	while (!obj_next(obj, &kv)) {
 		if (kv.value.type == JSON_TOK_OBJECT_END) {
 			return decoded_fields;
 		}
 
-		for (i = 0; i < descr_len; i++) {
-			void *decode_field = (char *)val + descr[i].offset;
+		/* A null value leaves the field as if it was absent */
+		if (kv.value.type == JSON_TOK_NULL) {
+			continue;
+		}
 
-			/* Field has been decoded already, skip */
-			if (decoded_fields & (1 << i)) {
-				continue;
-			}
+		i = find_field(descr, descr_len, index, next_field,
+			       decoded_fields, &kv);
+		if (i == descr_len) {
+			continue;
+		}
 
-			/* Check if it's the i-th field */
-			if (kv.key_len != descr[i].field_name_len) {
-				continue;
-			}
+		/* Store the decoded value */
+		ret = decode_value(obj, &descr[i], &kv.value,
+				   (char *)val + descr[i].offset, val);
+		if (ret < 0) {
+			return ret;
+		}
 
-			if (memcmp(kv.key, descr[i].field_name,
-				   descr[i].field_name_len)) {
-				continue;
+		decoded_fields |= (s64_t)1 << i;
+		next_field = i + 1;
+	}
+
+	return -EINVAL;
+}
+
+int json_obj_descr_index_build(const struct json_obj_descr *descr,
+			       size_t descr_len, u8_t *index)
+{
+	size_t i, j;
+	int cmp;
+
+	if (descr_len > JSON_OBJ_MAX_FIELDS) {
+		return -EINVAL;
+	}
+
+	/* Insertion sort, descriptors are short and this is done once */
+	for (i = 0; i < descr_len; i++) {
+		for (j = i; j > 0; j--) {
+			cmp = field_cmp(descr[i].field_name,
+					descr[i].field_name_len,
+					&descr[index[j - 1]]);
+			if (cmp == 0) {
+				return -EINVAL;
 			}
 
-			/* Store the decoded value */
-			ret = decode_value(obj, &descr[i], &kv.value,
-					   decode_field, val);
-			if (ret < 0) {
-				return ret;
+			if (cmp > 0) {
+				break;
 			}
 
-			decoded_fields |= 1<<i;
-			break;
+			index[j] = index[j - 1];
 		}
+
+		index[j] = i;
 	}
 
-	return -EINVAL;
+	return 0;
+}
+
+s64_t json_obj_parse(char *payload, size_t len,
+		     const struct json_obj_descr *descr, size_t descr_len,
+		     void *val)
+{
+	return json_obj_parse_indexed(payload, len, descr, descr_len, NULL,
+				      val);
 }
 
-int json_obj_parse(char *payload, size_t len,
-		   const struct json_obj_descr *descr, size_t descr_len,
-		   void *val)
+s64_t json_obj_parse_indexed(char *payload, size_t len,
+			     const struct json_obj_descr *descr,
+			     size_t descr_len, const u8_t *index, void *val)
 {
 	struct json_obj obj;
 	int ret;
 
-	assert(descr_len < (sizeof(ret) * CHAR_BIT - 1));
+	lexer_init(&obj.lexer, payload, len);
 
-	ret = obj_init(&obj, payload, len);
+	ret = obj_init(&obj);
 	if (ret < 0) {
 		return ret;
 	}
 
-	return obj_parse(&obj, descr, descr_len, val);
+	return obj_parse(&obj, descr, descr_len, index, val);
+}
+
+s64_t json_obj_parse_stream(json_read_bytes_t read_bytes, void *data,
+			    char *buf, size_t buf_size,
+			    const struct json_obj_descr *descr,
+			    size_t descr_len, void *val)
+{
+	return json_obj_parse_stream_indexed(read_bytes, data, buf, buf_size,
+					     descr, descr_len, NULL, val);
+}
+
+s64_t json_obj_parse_stream_indexed(json_read_bytes_t read_bytes,
+				    void *data, char *buf, size_t buf_size,
+				    const struct json_obj_descr *descr,
+				    size_t descr_len, const u8_t *index,
+				    void *val)
+{
+	struct json_obj obj;
+	s64_t ret;
+
+	if (buf_size < 2) {
+		return -ENOMEM;
+	}
+
+	lexer_init(&obj.lexer, buf, 0);
+	obj.lexer.read_bytes = read_bytes;
+	obj.lexer.read_data = data;
+	obj.lexer.buf = buf;
+	obj.lexer.buf_end = buf + buf_size;
+
+	ret = obj_init(&obj);
+	if (ret == 0) {
+		ret = obj_parse(&obj, descr, descr_len, index, val);
+	}
+
+	/* A read error or a full buffer is why the parsing failed */
+	if (obj.lexer.error < 0) {
+		return obj.lexer.error;
+	}
+
+	return ret;
 }
 
 static char escape_as(char chr)
@@ -760,6 +1135,10 @@ static int str_encode(const char **str, json_append_bytes_t append_bytes,
 {
 	int ret;
 
+	if (!*str) {
+		return append_bytes("null", 4, data);
+	}
+
 	ret = append_bytes("\"", 1, data);
 	if (ret < 0) {
 		return ret;
@@ -773,21 +1152,87 @@ static int str_encode(const char **str, json_append_bytes_t append_bytes,
 	return ret;
 }
 
+/* Writes the digits of num backwards from end, returns the first one */
+static char *format_digits(u64_t num, char *end)
+{
+	do {
+		*--end = '0' + num % 10U;
+		num /= 10U;
+	} while (num);
+
+	return end;
+}
+
+/* Encodes the magnitude of a number and its sign */
+static int digits_encode(u64_t num, bool negative,
+			 json_append_bytes_t append_bytes, void *data)
+{
+	char buf[3 * sizeof(u64_t)];
+	char *end = buf + sizeof(buf);
+	char *start = format_digits(num, end);
+
+	if (negative) {
+		*--start = '-';
+	}
+
+	return append_bytes(start, end - start, data);
+}
+
+static int int64_encode(const s64_t *num, json_append_bytes_t append_bytes,
+			void *data)
+{
+	u64_t value = *num < 0 ? 0 - (u64_t)*num : (u64_t)*num;
+
+	return digits_encode(value, *num < 0, append_bytes, data);
+}
+
 static int num_encode(const s32_t *num, json_append_bytes_t append_bytes,
 		      void *data)
 {
-	char buf[3 * sizeof(s32_t)];
-	int ret;
+	s64_t value = *num;
 
-	ret = snprintk(buf, sizeof(buf), "%d", *num);
-	if (ret < 0) {
-		return ret;
+	return int64_encode(&value, append_bytes, data);
+}
+
+static int uint64_encode(const u64_t *num, json_append_bytes_t append_bytes,
+			 void *data)
+{
+	return digits_encode(*num, false, append_bytes, data);
+}
+
+static int float_encode(const struct json_float *num,
+			json_append_bytes_t append_bytes, void *data)
+{
+	bool negative = num->val1 < 0 || num->val2 < 0;
+	u32_t val1 = num->val1 < 0 ? -(s64_t)num->val1 : num->val1;
+	u32_t val2 = num->val2 < 0 ? -(s64_t)num->val2 : num->val2;
+	char buf[3 * sizeof(u32_t) + 8];
+	char *end = buf + sizeof(buf);
+	char *start = end;
+	int i;
+
+	if (val2 >= JSON_FLOAT_DEC_MAX) {
+		return -EINVAL;
 	}
-	if (ret >= (int)sizeof(buf)) {
-		return -ENOMEM;
+
+	for (i = 0; i < 6; i++) {
+		*--start = '0' + val2 % 10U;
+		val2 /= 10U;
+	}
+
+	/* Drop the trailing zeros, but keep one decimal */
+	while (end - start > 1 && end[-1] == '0') {
+		end--;
 	}
 
-	return append_bytes(buf, (size_t)ret, data);
+	*--start = '.';
+	start = format_digits(val1, start);
+
+	if (negative) {
+		*--start = '-';
+	}
+
+	return append_bytes(start, end - start, data);
 }
 
 static int bool_encode(const bool *value, json_append_bytes_t append_bytes,
@@ -820,6 +1265,12 @@ static int encode(const struct json_obj_descr *descr, const void *val,
 				       ptr, append_bytes, data);
 	case JSON_TOK_NUMBER:
 		return num_encode(ptr, append_bytes, data);
+	case JSON_TOK_INT64:
+		return int64_encode(ptr, append_bytes, data);
+	case JSON_TOK_UINT64:
+		return uint64_encode(ptr, append_bytes, data);
+	case JSON_TOK_FLOAT:
+		return float_encode(ptr, append_bytes, data);
 	default:
 		return -EINVAL;
 	}
@@ -875,7 +1326,7 @@ static int append_bytes_to_buf(const char *bytes, size_t len, void *data)
 {
 	struct appender *appender = data;
 
-	if (len > appender->size - appender->used) {
+	if (len >= appender->size - appender->used) {
 		return -ENOMEM;
 	}
 
@@ -919,3 +1370,63 @@ ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 
 	return total;
 }
+
+#if defined(CONFIG_NET_BUF)
+static int append_bytes_to_net_buf(const char *bytes, size_t len, void *data)
+{
+	struct net_buf **frag = data;
+
+	while (len) {
+		size_t count;
+
+		if (!*frag) {
+			return -ENOMEM;
+		}
+
+		count = MIN(len, net_buf_tailroom(*frag));
+		net_buf_add_mem(*frag, bytes, count);
+
+		bytes += count;
+		len -= count;
+
+		if (len) {
+			*frag = (*frag)->frags;
+		}
+	}
+
+	return 0;
+}
+
+int json_obj_encode_net_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_buf *buf)
+{
+	struct net_buf *frag;
+	size_t room = 0;
+	ssize_t len;
+	int ret;
+
+	len = json_calc_encoded_len(descr, descr_len, val);
+	if (len < 0) {
+		return len;
+	}
+
+	for (frag = buf; frag; frag = frag->frags) {
+		room += net_buf_tailroom(frag);
+	}
+
+	if ((size_t)len > room) {
+		return -ENOMEM;
+	}
+
+	frag = buf;
+
+	ret = json_obj_encode(descr, descr_len, val, append_bytes_to_net_buf,
+			      &frag);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return len;
+}
+#endif /* CONFIG_NET_BUF */
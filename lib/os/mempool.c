@@ -10,6 +10,13 @@
 #include <misc/mempool_base.h>
 #include <misc/mempool.h>
 
+#ifdef CONFIG_MEM_POOL_TLSF
+static void tlsf_init(struct sys_mem_pool_base *p);
+static int tlsf_alloc(struct sys_mem_pool_base *p, size_t size,
+		      u32_t *level_p, u32_t *block_p, void **data_p);
+static void tlsf_free(struct sys_mem_pool_base *p, u32_t block);
+#endif
+
 static bool level_empty(struct sys_mem_pool_base *p, int l)
 {
 	return sys_dlist_is_empty(&p->levels[l].free_list);
@@ -82,6 +89,13 @@ void _sys_mem_pool_base_init(struct sys_mem_pool_base *p)
 	size_t buflen = p->n_max * p->max_sz, sz = p->max_sz;
 	u32_t *bits = (u32_t *)((u8_t *)p->buf + buflen);
 
+#ifdef CONFIG_MEM_POOL_TLSF
+	if (p->flags & SYS_MEM_POOL_TLSF) {
+		tlsf_init(p);
+		return;
+	}
+#endif
+
 	p->max_inline_level = -1;
 
 	for (i = 0; i < p->n_levels; i++) {
@@ -230,6 +244,12 @@ int _sys_mem_pool_block_alloc(struct sys_mem_pool_base *p, size_t size,
 	void *data = NULL;
 	size_t lsizes[p->n_levels];
 
+#ifdef CONFIG_MEM_POOL_TLSF
+	if (p->flags & SYS_MEM_POOL_TLSF) {
+		return tlsf_alloc(p, size, level_p, block_p, data_p);
+	}
+#endif
+
 	/* Walk down through levels, finding the one from which we
 	 * want to allocate and the smallest one with a free entry
 	 * from which we can split an allocation if needed.  Along the
@@ -301,6 +321,13 @@ void _sys_mem_pool_block_free(struct sys_mem_pool_base *p, u32_t level,
 	size_t lsizes[p->n_levels];
 	int i;
 
+#ifdef CONFIG_MEM_POOL_TLSF
+	if (p->flags & SYS_MEM_POOL_TLSF) {
+		tlsf_free(p, block);
+		return;
+	}
+#endif
+
 	/* As in _sys_mem_pool_block_alloc(), we build a table of level sizes
 	 * to avoid having to store it in precious RAM bytes.
 	 * Overhead here is somewhat higher because block_free()
@@ -315,6 +342,312 @@ void _sys_mem_pool_block_free(struct sys_mem_pool_base *p, u32_t level,
 	block_free(p, level, lsizes, block);
 }
 
+#ifdef CONFIG_MEM_POOL_TLSF
+
+/* Two-level segregated fit backend, used by pools flagged with
+ * SYS_MEM_POOL_TLSF.
+ *
+ * The buffer is carved into physically contiguous blocks, each
+ * starting with a one word header holding the block size in bytes
+ * (including the header) and the TLSF_FREE / TLSF_PREV_FREE flags.
+ * Free blocks additionally store their free list links, as word
+ * offsets into the buffer, right after the header and a copy of
+ * their size in their last word, so that both physical neighbours of
+ * a released block can be found and coalesced in constant time.  Two
+ * free blocks are never adjacent.
+ *
+ * Free blocks live on one of n_levels * _MPOOL_TLSF_SL lists: the
+ * first level index is the power of two size class and the second
+ * level splits it into _MPOOL_TLSF_SL linear ranges.  A bitmap per
+ * level tracks the non-empty lists, so finding a fitting block is two
+ * bit scans regardless of pool size or fragmentation, and the whole
+ * alloc or free runs in a single short locked section.
+ *
+ * Blocks are identified by the word offset of their header, which is
+ * what gets reported as the "block" number (with level 0) to the
+ * k_mem_pool and sys_mem_pool layers.  With 8 byte pointers the
+ * first buffer word is padding.
+ */
+
+#define TLSF_FREE	BIT(0)
+#define TLSF_PREV_FREE	BIT(1)
+#define TLSF_FLAGS	(TLSF_FREE | TLSF_PREV_FREE)
+
+#define TLSF_NONE	UINT32_MAX
+
+/* Header, two links and the size footer */
+#define TLSF_MIN_BLOCK	_MPOOL_TLSF_MINBLK
+
+/* Block sizes are multiples of the alignment and block headers sit
+ * one word before an aligned address
+ */
+#define TLSF_ALIGN	_MPOOL_TLSF_ALIGN
+#define TLSF_FIRST	((TLSF_ALIGN - 4) / 4)
+
+/* Block sizes below this all share first level 0 */
+#define TLSF_SMALL	(_MPOOL_TLSF_SL * 4)
+
+#define TLSF_FL_SHIFT	(_MPOOL_TLSF_SL_LOG2 + 2)
+
+static u32_t *tlsf_word(struct sys_mem_pool_base *p, u32_t w)
+{
+	return (u32_t *)p->buf + w;
+}
+
+static u32_t tlsf_size(struct sys_mem_pool_base *p, u32_t b)
+{
+	return *tlsf_word(p, b) & ~TLSF_FLAGS;
+}
+
+static u32_t *tlsf_next(struct sys_mem_pool_base *p, u32_t b)
+{
+	return tlsf_word(p, b + 1);
+}
+
+static u32_t *tlsf_prev(struct sys_mem_pool_base *p, u32_t b)
+{
+	return tlsf_word(p, b + 2);
+}
+
+static u32_t tlsf_data_words(struct sys_mem_pool_base *p)
+{
+	return _MPOOL_TLSF_DATA_SIZE(p->max_sz, p->n_max) / 4;
+}
+
+/* Control words: first level bitmap, then the second level bitmaps,
+ * then the list heads
+ */
+static u32_t *tlsf_fl_map(struct sys_mem_pool_base *p)
+{
+	return tlsf_word(p, tlsf_data_words(p));
+}
+
+static u32_t *tlsf_sl_map(struct sys_mem_pool_base *p, int fl)
+{
+	return tlsf_fl_map(p) + 1 + fl;
+}
+
+static u32_t *tlsf_head(struct sys_mem_pool_base *p, int fl, int sl)
+{
+	return tlsf_fl_map(p) + 1 + p->n_levels + fl * _MPOOL_TLSF_SL + sl;
+}
+
+static int msb(u32_t v)
+{
+	return 31 - __builtin_clz(v);
+}
+
+static void tlsf_mapping(u32_t sz, int *fl, int *sl)
+{
+	if (sz < TLSF_SMALL) {
+		*fl = 0;
+		*sl = sz / (TLSF_SMALL / _MPOOL_TLSF_SL);
+	} else {
+		int m = msb(sz);
+
+		*fl = m - TLSF_FL_SHIFT + 1;
+		*sl = (sz >> (m - _MPOOL_TLSF_SL_LOG2)) - _MPOOL_TLSF_SL;
+	}
+}
+
+static void tlsf_insert(struct sys_mem_pool_base *p, u32_t b)
+{
+	u32_t *head;
+	int fl, sl;
+
+	tlsf_mapping(tlsf_size(p, b), &fl, &sl);
+	head = tlsf_head(p, fl, sl);
+
+	*tlsf_next(p, b) = *head;
+	*tlsf_prev(p, b) = TLSF_NONE;
+	if (*head != TLSF_NONE) {
+		*tlsf_prev(p, *head) = b;
+	}
+	*head = b;
+
+	*tlsf_fl_map(p) |= BIT(fl);
+	*tlsf_sl_map(p, fl) |= BIT(sl);
+}
+
+static void tlsf_remove(struct sys_mem_pool_base *p, u32_t b)
+{
+	u32_t next = *tlsf_next(p, b), prev = *tlsf_prev(p, b);
+	u32_t *head;
+	int fl, sl;
+
+	tlsf_mapping(tlsf_size(p, b), &fl, &sl);
+	head = tlsf_head(p, fl, sl);
+
+	if (prev != TLSF_NONE) {
+		*tlsf_next(p, prev) = next;
+	} else {
+		*head = next;
+	}
+	if (next != TLSF_NONE) {
+		*tlsf_prev(p, next) = prev;
+	}
+
+	if (*head == TLSF_NONE) {
+		*tlsf_sl_map(p, fl) &= ~BIT(sl);
+		if (*tlsf_sl_map(p, fl) == 0U) {
+			*tlsf_fl_map(p) &= ~BIT(fl);
+		}
+	}
+}
+
+/* Marks b as a free block of sz bytes, the block before it must be
+ * in use
+ */
+static void tlsf_set_free(struct sys_mem_pool_base *p, u32_t b, u32_t sz)
+{
+	*tlsf_word(p, b) = sz | TLSF_FREE;
+	*tlsf_word(p, b + sz / 4 - 1) = sz;
+	*tlsf_word(p, b + sz / 4) |= TLSF_PREV_FREE;
+}
+
+/* Head of the first non-empty list at or above (fl, sl) */
+static u32_t tlsf_find(struct sys_mem_pool_base *p, int fl, int sl)
+{
+	u32_t map;
+
+	if (fl >= p->n_levels) {
+		return TLSF_NONE;
+	}
+
+	map = *tlsf_sl_map(p, fl) & (~0U << sl);
+	if (map == 0U) {
+		map = *tlsf_fl_map(p) & (~0U << (fl + 1));
+		if (map == 0U) {
+			return TLSF_NONE;
+		}
+
+		fl = __builtin_ctz(map);
+		map = *tlsf_sl_map(p, fl);
+	}
+
+	return *tlsf_head(p, fl, __builtin_ctz(map));
+}
+
+static void tlsf_init(struct sys_mem_pool_base *p)
+{
+	u32_t words = tlsf_data_words(p);
+	int i;
+
+	__ASSERT(!(p->flags & SYS_MEM_POOL_KERNEL) || words < BIT(20),
+		 "TLSF k_mem_pool too large for k_mem_block_id");
+
+	*tlsf_fl_map(p) = 0U;
+	for (i = 0; i < p->n_levels; i++) {
+		*tlsf_sl_map(p, i) = 0U;
+	}
+	for (i = 0; i < p->n_levels * _MPOOL_TLSF_SL; i++) {
+		*tlsf_head(p, 0, i) = TLSF_NONE;
+	}
+
+	/* One free block spanning everything but the sentinel */
+	*tlsf_word(p, words - 1) = 0U;
+	tlsf_set_free(p, TLSF_FIRST, (words - 1 - TLSF_FIRST) * 4);
+	tlsf_insert(p, TLSF_FIRST);
+}
+
+static int tlsf_alloc(struct sys_mem_pool_base *p, size_t size,
+		      u32_t *level_p, u32_t *block_p, void **data_p)
+{
+	u32_t need, search, b, sz;
+	unsigned int key;
+	int fl, sl;
+
+	if (size > p->max_sz) {
+		*data_p = NULL;
+		return -ENOMEM;
+	}
+
+	need = ROUND_UP(size + 4, TLSF_ALIGN);
+	need = MAX(need, TLSF_MIN_BLOCK);
+
+	/* Round up to the next list boundary so that any block on
+	 * the list found is large enough ("good fit")
+	 */
+	search = need;
+	if (search >= TLSF_SMALL) {
+		search += BIT(msb(search) - _MPOOL_TLSF_SL_LOG2) - 1;
+	}
+	tlsf_mapping(search, &fl, &sl);
+
+	key = pool_irq_lock(p);
+
+	b = tlsf_find(p, fl, sl);
+	if (b == TLSF_NONE) {
+		/* Nothing in a larger class, but the head of the
+		 * request's own class may still fit (e.g. a request
+		 * for the whole pool)
+		 */
+		tlsf_mapping(need, &fl, &sl);
+		b = *tlsf_head(p, fl, sl);
+		if (b != TLSF_NONE && tlsf_size(p, b) < need) {
+			b = TLSF_NONE;
+		}
+	}
+
+	if (b == TLSF_NONE) {
+		pool_irq_unlock(p, key);
+		*data_p = NULL;
+		return -ENOMEM;
+	}
+
+	tlsf_remove(p, b);
+	sz = tlsf_size(p, b);
+
+	if (sz - need >= TLSF_MIN_BLOCK) {
+		/* Split, the remainder stays free */
+		*tlsf_word(p, b) = need;
+		tlsf_set_free(p, b + need / 4, sz - need);
+		tlsf_insert(p, b + need / 4);
+	} else {
+		*tlsf_word(p, b) &= ~TLSF_FREE;
+		*tlsf_word(p, b + sz / 4) &= ~TLSF_PREV_FREE;
+	}
+
+	pool_irq_unlock(p, key);
+
+	*level_p = 0;
+	*block_p = b;
+	*data_p = tlsf_word(p, b + 1);
+
+	return 0;
+}
+
+static void tlsf_free(struct sys_mem_pool_base *p, u32_t block)
+{
+	u32_t b = block, sz, n;
+	unsigned int key = pool_irq_lock(p);
+
+	__ASSERT(!(*tlsf_word(p, b) & TLSF_FREE), "double free");
+
+	sz = tlsf_size(p, b);
+	n = b + sz / 4;
+
+	if (*tlsf_word(p, n) & TLSF_FREE) {
+		tlsf_remove(p, n);
+		sz += tlsf_size(p, n);
+	}
+
+	if (*tlsf_word(p, b) & TLSF_PREV_FREE) {
+		u32_t psz = *tlsf_word(p, b - 1);
+
+		b -= psz / 4;
+		tlsf_remove(p, b);
+		sz += psz;
+	}
+
+	tlsf_set_free(p, b, sz);
+	tlsf_insert(p, b);
+
+	pool_irq_unlock(p, key);
+}
+
+#endif /* CONFIG_MEM_POOL_TLSF */
+
 /*
  * Functions specific to user-mode blocks
  */
@@ -39,13 +39,17 @@ int ring_buf_item_put(struct ring_buf *buf, u16_t type, u8_t value,
 				index = (i + buf->tail + 1) & buf->mask;
 				buf->buf.buf32[index] = data[i];
 			}
-			buf->tail = (buf->tail + size32 + 1) & buf->mask;
+			z_ring_buf_index_store(&buf->tail,
+					       (buf->tail + size32 + 1) &
+					       buf->mask);
 		} else {
 			for (i = 0U; i < size32; ++i) {
 				index = (i + buf->tail + 1) % buf->size;
 				buf->buf.buf32[index] = data[i];
 			}
-			buf->tail = (buf->tail + size32 + 1) % buf->size;
+			z_ring_buf_index_store(&buf->tail,
+					       (buf->tail + size32 + 1) %
+					       buf->size);
 		}
 		rc = 0U;
 	} else {
@@ -82,13 +86,17 @@ int ring_buf_item_get(struct ring_buf *buf, u16_t *type, u8_t *value,
 			index = (i + buf->head + 1) & buf->mask;
 			data[i] = buf->buf.buf32[index];
 		}
-		buf->head = (buf->head + header->length + 1) & buf->mask;
+		z_ring_buf_index_store(&buf->head,
+				       (buf->head + header->length + 1) &
+				       buf->mask);
 	} else {
 		for (i = 0U; i < header->length; ++i) {
 			index = (i + buf->head + 1) % buf->size;
 			data[i] = buf->buf.buf32[index];
 		}
-		buf->head = (buf->head + header->length + 1) % buf->size;
+		z_ring_buf_index_store(&buf->head,
+				       (buf->head + header->length + 1) %
+				       buf->size);
 	}
 
 	return 0;
@@ -110,7 +118,8 @@ u32_t ring_buf_put_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 {
 	u32_t space, trail_size, allocated;
 
-	space = z_ring_buf_custom_space_get(buf->size, buf->head,
+	space = z_ring_buf_custom_space_get(buf->size,
+					    z_ring_buf_index_load(&buf->head),
 					    buf->misc.byte_mode.tmp_tail);
 
 	/* Limit requested size to available size. */
@@ -133,25 +142,34 @@ int ring_buf_put_finish(struct ring_buf *buf, u32_t size)
 		return -EINVAL;
 	}
 
-	buf->tail = wrap(buf->tail + size, buf->size);
-	buf->misc.byte_mode.tmp_tail = buf->tail;
+	buf->misc.byte_mode.tmp_tail = wrap(buf->tail + size, buf->size);
+	z_ring_buf_index_store(&buf->tail, buf->misc.byte_mode.tmp_tail);
 
 	return 0;
 }
 
+u32_t ring_buf_put_claim_segments(struct ring_buf *buf,
+				  struct ring_buf_segment segs[2],
+				  u32_t size)
+{
+	segs[0].size = ring_buf_put_claim(buf, &segs[0].data, size);
+
+	/* Whatever is left after the wrap point starts at the beginning */
+	segs[1].size = ring_buf_put_claim(buf, &segs[1].data,
+					  size - segs[0].size);
+
+	return segs[0].size + segs[1].size;
+}
+
 u32_t ring_buf_put(struct ring_buf *buf, const u8_t *data, u32_t size)
 {
-	u8_t *dst;
-	u32_t partial_size;
-	u32_t total_size = 0U;
-
-	do {
-		partial_size = ring_buf_put_claim(buf, &dst, size);
-		memcpy(dst, data, partial_size);
-		total_size += partial_size;
-		size -= partial_size;
-		data += partial_size;
-	} while (size && partial_size);
+	struct ring_buf_segment segs[2];
+	u32_t total_size;
+
+	total_size = ring_buf_put_claim_segments(buf, segs, size);
+
+	memcpy(segs[0].data, data, segs[0].size);
+	memcpy(segs[1].data, data + segs[0].size, segs[1].size);
 
 	ring_buf_put_finish(buf, total_size);
 
@@ -165,7 +183,7 @@ u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 	space = (buf->size - 1) -
 		z_ring_buf_custom_space_get(buf->size,
 					    buf->misc.byte_mode.tmp_head,
-					    buf->tail);
+					    z_ring_buf_index_load(&buf->tail));
 	trail_size = buf->size - buf->misc.byte_mode.tmp_head;
 
 	/* Limit requested size to available size. */
@@ -189,25 +207,34 @@ int ring_buf_get_finish(struct ring_buf *buf, u32_t size)
 		return -EINVAL;
 	}
 
-	buf->head = wrap(buf->head + size, buf->size);
-	buf->misc.byte_mode.tmp_head = buf->head;
+	buf->misc.byte_mode.tmp_head = wrap(buf->head + size, buf->size);
+	z_ring_buf_index_store(&buf->head, buf->misc.byte_mode.tmp_head);
 
 	return 0;
 }
 
+u32_t ring_buf_get_claim_segments(struct ring_buf *buf,
+				  struct ring_buf_segment segs[2],
+				  u32_t size)
+{
+	segs[0].size = ring_buf_get_claim(buf, &segs[0].data, size);
+
+	/* Whatever is left after the wrap point starts at the beginning */
+	segs[1].size = ring_buf_get_claim(buf, &segs[1].data,
+					  size - segs[0].size);
+
+	return segs[0].size + segs[1].size;
+}
+
 u32_t ring_buf_get(struct ring_buf *buf, u8_t *data, u32_t size)
 {
-	u8_t *src;
-	u32_t partial_size;
-	u32_t total_size = 0U;
-
-	do {
-		partial_size = ring_buf_get_claim(buf, &src, size);
-		memcpy(data, src, partial_size);
-		total_size += partial_size;
-		size -= partial_size;
-		data += partial_size;
-	} while (size && partial_size);
+	struct ring_buf_segment segs[2];
+	u32_t total_size;
+
+	total_size = ring_buf_get_claim_segments(buf, segs, size);
+
+	memcpy(data, segs[0].data, segs[0].size);
+	memcpy(data + segs[0].size, segs[1].data, segs[1].size);
 
 	ring_buf_get_finish(buf, total_size);
 
@@ -0,0 +1,361 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2019 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Decode dictionary based log output.
+
+With CONFIG_LOG_BACKEND_UART_OUTPUT_DICTIONARY or
+CONFIG_LOG_BACKEND_RTT_OUTPUT_DICTIONARY the target does not format log
+messages. It sends binary packets holding the address of the format
+string, the source and level, the timestamp and the raw arguments, see
+include/logging/log_output_dict.h. This script resolves the addresses
+using the ELF file of the application and prints the messages the way
+the text output would.
+
+Example:
+
+    log_dict_decoder.py build/zephyr/zephyr.elf /dev/ttyACM0
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+PKT_STD = 1
+PKT_HEXDUMP = 2
+PKT_DROPPED = 3
+
+SEVERITY = [None, "err", "wrn", "inf", "dbg"]
+
+COLORS = [None, "\x1B[1;31m", "\x1B[1;33m", None, None]
+COLOR_DEFAULT = "\x1B[0m"
+
+HEXDUMP_BYTES_IN_LINE = 8
+
+# Characters skipped between '%' and the conversion specifier. Must match
+# string_args_get() in subsys/logging/log_output_dict.c.
+SPEC_CHARS = "-+ #*.0123456789hlLjzt"
+
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d*)(?:\.(\*|\d*))?([hlLjzt]*)(.)$")
+
+
+def conversions(fmt):
+    """Yield the conversion specifications of fmt, including "%%"."""
+    i = 0
+    while i < len(fmt):
+        if fmt[i] != "%":
+            i += 1
+            continue
+
+        start = i
+        i += 1
+        if i < len(fmt) and fmt[i] == "%":
+            i += 1
+            yield start, i
+            continue
+
+        while i < len(fmt) and fmt[i] in SPEC_CHARS:
+            i += 1
+        if i >= len(fmt):
+            return
+        i += 1
+        yield start, i
+
+
+def to_signed(val, bits=32):
+    return val - (1 << bits) if val & (1 << (bits - 1)) else val
+
+
+class Image:
+    """Read only data of the application, looked up by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            elf = ELFFile(f)
+
+            self.endian = "<" if elf.little_endian else ">"
+            self.ptr_fmt = "I" if elf.elfclass == 32 else "Q"
+            self.sections = []
+            self.symbols = {}
+
+            for section in elf.iter_sections():
+                if isinstance(section, SymbolTableSection):
+                    for sym in section.iter_symbols():
+                        self.symbols[sym.name] = sym["st_value"]
+                elif (section["sh_flags"] & 0x2 and
+                      section["sh_type"] != "SHT_NOBITS"):
+                    self.sections.append((section["sh_addr"],
+                                          section.data()))
+
+        self.sources = self._sources_get()
+
+    def _read(self, addr, size):
+        for start, data in self.sections:
+            if start <= addr and addr + size <= start + len(data):
+                return data[addr - start:addr + size - start]
+        return None
+
+    def string(self, addr):
+        for start, data in self.sections:
+            if start <= addr < start + len(data):
+                end = data.find(b"\0", addr - start)
+                if end < 0:
+                    end = len(data)
+                return data[addr - start:end].decode("utf-8", "replace")
+        return None
+
+    def _sources_get(self):
+        start = self.symbols.get("__log_const_start")
+        end = self.symbols.get("__log_const_end")
+        if start is None or end is None or end <= start:
+            return []
+
+        # Entry size depends on the architecture, derive it from the
+        # placement of the log_const_* variables.
+        addrs = sorted(set(addr for name, addr in self.symbols.items()
+                           if name.startswith("log_const_") and
+                           start <= addr < end))
+        stride = min([b - a for a, b in zip(addrs, addrs[1:])] +
+                     [end - start])
+
+        ptr_size = struct.calcsize(self.ptr_fmt)
+        names = []
+        for addr in range(start, end, stride):
+            raw = self._read(addr, ptr_size)
+            name = None
+            if raw is not None:
+                ptr = struct.unpack(self.endian + self.ptr_fmt, raw)[0]
+                name = self.string(ptr)
+            names.append(name or "src%d" % len(names))
+
+        return names
+
+    def source_name(self, source_id):
+        if source_id < len(self.sources):
+            return self.sources[source_id]
+        return "src%d" % source_id
+
+
+def string_args_count(fmt, nargs):
+    """Count %s arguments sent inline, the same way the target does."""
+    cnt = 0
+    arg = 0
+    for start, end in conversions(fmt):
+        spec = fmt[start:end]
+        if spec == "%%":
+            continue
+        arg += spec.count("*")
+        if spec[-1] == "s" and arg < nargs:
+            cnt += 1
+        arg += 1
+    return cnt
+
+
+def format_message(fmt, args, strings):
+    """Format fmt the way the target printf implementation would."""
+    args = iter(args)
+    strings = iter(strings)
+    out = []
+    pos = 0
+
+    for start, end in conversions(fmt):
+        out.append(fmt[pos:start])
+        pos = end
+        spec = fmt[start:end]
+
+        if spec == "%%":
+            out.append("%")
+            continue
+
+        m = SPEC_RE.match(spec)
+        if m is None:
+            out.append(spec)
+            continue
+
+        flags, width, prec, length, conv = m.groups()
+        if width == "*":
+            width = str(to_signed(next(args, 0)))
+        if prec == "*":
+            prec = str(to_signed(next(args, 0)))
+        pyspec = "%" + flags + (width or "")
+        if prec is not None:
+            pyspec += "." + (prec or "0")
+
+        val = next(args, 0)
+        bits = {"hh": 8, "h": 16}.get(length, 32)
+        val &= (1 << bits) - 1
+
+        if conv == "s":
+            out.append((pyspec + "s") % next(strings, "(null)"))
+        elif conv in "di":
+            out.append((pyspec + "d") % to_signed(val, bits))
+        elif conv == "u":
+            out.append((pyspec + "d") % val)
+        elif conv in "oxX":
+            out.append((pyspec + conv) % val)
+        elif conv == "c":
+            out.append((pyspec + "c") % chr(val & 0xff))
+        elif conv == "p":
+            out.append("0x%08x" % val)
+        else:
+            # Only 32 bit arguments are stored, floats cannot be shown
+            out.append("<%s:0x%08x>" % (spec, val))
+
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+class Decoder:
+    def __init__(self, image, stream, args):
+        self.image = image
+        self.stream = stream
+        self.freq = args.timestamp_freq
+        self.colors = args.colors
+        self.hdr = struct.Struct(image.endian + "BHII")
+        self.u16 = struct.Struct(image.endian + "H")
+        self.u32 = struct.Struct(image.endian + "I")
+
+    def _read(self, size):
+        data = self.stream.read(size)
+        while len(data) < size:
+            more = self.stream.read(size - len(data))
+            if not more:
+                raise EOFError
+            data += more
+        return data
+
+    def _read_string(self):
+        data = bytearray()
+        while True:
+            c = self._read(1)
+            if c == b"\0":
+                return data.decode("utf-8", "replace")
+            data += c
+
+    def _timestamp(self, timestamp):
+        if not self.freq:
+            return "[%010u]" % timestamp
+
+        us = timestamp * 1000000 // self.freq
+        secs, us = divmod(us, 1000000)
+        mins, secs = divmod(secs, 60)
+        hours, mins = divmod(mins, 60)
+        return "[%02d:%02d:%02d.%03d,%03d]" % (hours, mins, secs,
+                                              us // 1000, us % 1000)
+
+    def _prefix(self, level, source_id, timestamp):
+        return "%s %s<%s> %s: " % (self._timestamp(timestamp),
+                                   self._color(level),
+                                   SEVERITY[level] if level < 5 else "?",
+                                   self.image.source_name(source_id))
+
+    def _color(self, level):
+        if self.colors and level < len(COLORS) and COLORS[level]:
+            return COLORS[level]
+        return ""
+
+    def _postfix(self, level):
+        return COLOR_DEFAULT if self._color(level) else ""
+
+    def _std(self, nargs, level, source_id, timestamp, fmt_addr):
+        args = struct.unpack(self.image.endian + "%dI" % nargs,
+                             self._read(4 * nargs))
+        fmt = self.image.string(fmt_addr)
+        if fmt is None:
+            fmt = "<unknown format string at 0x%08x>" % fmt_addr
+            strings = []
+        else:
+            strings = [self._read_string()
+                       for _ in range(string_args_count(fmt, nargs))]
+
+        return (self._prefix(level, source_id, timestamp) +
+                format_message(fmt, args, strings) + self._postfix(level))
+
+    def _hexdump(self, level, source_id, timestamp, metadata_addr):
+        length = self.u16.unpack(self._read(2))[0]
+        data = self._read(length)
+
+        # Raw strings are stored as hexdump messages without a level
+        if level == 0:
+            return data.decode("utf-8", "replace").rstrip("\r\n")
+
+        prefix = self._prefix(level, source_id, timestamp)
+        lines = [prefix + (self.image.string(metadata_addr) or "")]
+        for i in range(0, length, HEXDUMP_BYTES_IN_LINE):
+            chunk = data[i:i + HEXDUMP_BYTES_IN_LINE]
+            hexs = " ".join("%02x" % b for b in chunk)
+            text = "".join(chr(b) if 32 <= b < 127 else "." for b in chunk)
+            lines.append(" " * len(prefix) + "%-*s |%s" % (
+                3 * HEXDUMP_BYTES_IN_LINE - 1, hexs, text))
+
+        return "\n".join(lines) + self._postfix(level)
+
+    def packet(self):
+        """Decode one packet, returns the text or None at end of input."""
+        try:
+            pkt_type = self._read(1)[0]
+
+            if pkt_type == PKT_DROPPED:
+                cnt = self.u32.unpack(self._read(4))[0]
+                return "--- %d messages dropped ---" % cnt
+
+            if pkt_type not in (PKT_STD, PKT_HEXDUMP):
+                return "--- unknown packet type 0x%02x ---" % pkt_type
+
+            nargs, ids, timestamp, fmt_addr = self.hdr.unpack(
+                self._read(self.hdr.size))
+            level = ids & 0x7
+            source_id = ids >> 6
+
+            if pkt_type == PKT_STD:
+                return self._std(nargs, level, source_id, timestamp,
+                                 fmt_addr)
+
+            return self._hexdump(level, source_id, timestamp, fmt_addr)
+        except EOFError:
+            return None
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+
+    parser.add_argument("elf", help="ELF file of the application")
+    parser.add_argument("input", nargs="?", default="-",
+                        help="Captured log output or serial device, "
+                        "standard input by default")
+    parser.add_argument("-f", "--timestamp-freq", type=int, default=0,
+                        help="Timestamp frequency in Hz, raw timestamps "
+                        "are printed if not given")
+    parser.add_argument("-c", "--colors", action="store_true",
+                        help="Print errors in red and warnings in yellow")
+
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    image = Image(args.elf)
+
+    if args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb", buffering=0)
+
+    decoder = Decoder(image, stream, args)
+    while True:
+        text = decoder.packet()
+        if text is None:
+            break
+        print(text, flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -74,6 +74,36 @@ struct conn_tx_cb {
 
 #define conn_tx(buf) ((struct conn_tx_cb *)net_buf_user_data(buf))
 
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+/* Shared PDUs only contain the headers, their payload is a buffer that is
+ * referenced by the PDUs of several connections. The payload can't be
+ * chained as a fragment since the same buffer would then be queued in
+ * several TX queues, so it's only copied into fragment buffers when the
+ * controller is ready to take it. The user data only has room for the
+ * TX callback and the data is released before the destroy callback runs,
+ * so the payload reference is kept aside, indexed by the PDU buffer.
+ */
+#define SHARED_COUNT (CONFIG_BT_GATT_NOTIFY_ALL_COUNT * CONFIG_BT_MAX_CONN)
+
+static struct net_buf *shared_data[SHARED_COUNT];
+#define shared(buf) (shared_data[net_buf_id(buf)])
+
+/* L2CAP header followed by up to 4 bytes of upper layer header, e.g. the
+ * ATT opcode and attribute handle of a notification.
+ */
+#define SHARED_SIZE (BT_L2CAP_HDR_SIZE + 4)
+
+static void shared_destroy(struct net_buf *buf)
+{
+	net_buf_unref(shared(buf));
+	shared(buf) = NULL;
+	net_buf_destroy(buf);
+}
+
+NET_BUF_POOL_DEFINE(shared_pool, SHARED_COUNT, SHARED_SIZE,
+		    BT_BUF_USER_DATA_MIN, shared_destroy);
+#endif /* CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0 */
+
 static struct bt_conn_tx conn_tx[CONFIG_BT_CONN_TX_MAX];
 static sys_slist_t free_tx = SYS_SLIST_STATIC_INIT(&free_tx);
 
@@ -1319,10 +1349,69 @@ static struct net_buf *create_frag(struct bt_conn *conn, struct net_buf *buf)
 	return frag;
 }
 
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+static bool send_shared(struct bt_conn *conn, struct net_buf *buf)
+{
+	u8_t flags = BT_ACL_START_NO_FLUSH;
+	struct net_buf *frag;
+	size_t offset = 0;
+	size_t len;
+
+	/* Chain the payload only while copying it, the reference is owned
+	 * by the PDU and released when the PDU is destroyed.
+	 */
+	buf->frags = shared(buf);
+	len = net_buf_frags_len(buf);
+
+	BT_DBG("conn %p buf %p len %zu", conn, buf, len);
+
+	while (offset < len) {
+		u16_t frag_len;
+
+		frag = bt_conn_create_pdu(&frag_pool, 0);
+
+		if (conn->state != BT_CONN_CONNECTED) {
+			net_buf_unref(frag);
+			goto fail;
+		}
+
+		frag_len = MIN(MIN(conn_mtu(conn), net_buf_tailroom(frag)),
+			       len - offset);
+
+		net_buf_linearize(net_buf_add(frag, frag_len), frag_len, buf,
+				  offset, frag_len);
+		offset += frag_len;
+
+		/* Only the last fragment completes the PDU */
+		conn_tx(frag)->cb = offset < len ? NULL : conn_tx(buf)->cb;
+
+		if (!send_frag(conn, frag, flags, true)) {
+			goto fail;
+		}
+
+		flags = BT_ACL_CONT;
+	}
+
+	buf->frags = NULL;
+	net_buf_unref(buf);
+	return true;
+
+fail:
+	buf->frags = NULL;
+	return false;
+}
+#endif /* CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0 */
+
 static bool send_buf(struct bt_conn *conn, struct net_buf *buf)
 {
 	struct net_buf *frag;
 
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+	if (net_buf_pool_get(buf->pool_id) == &shared_pool) {
+		return send_shared(conn, buf);
+	}
+#endif /* CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0 */
+
 	BT_DBG("conn %p buf %p len %u", conn, buf, buf->len);
 
 	/* Send directly if the packet fits the ACL MTU */
@@ -2114,6 +2203,33 @@ struct net_buf *bt_conn_create_pdu(struct net_buf_pool *pool, size_t reserve)
 	return buf;
 }
 
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+struct net_buf *bt_conn_create_shared_pdu(struct net_buf *data,
+					  size_t reserve)
+{
+	struct net_buf *buf;
+
+	buf = net_buf_alloc(&shared_pool, K_NO_WAIT);
+	if (!buf) {
+		return NULL;
+	}
+
+	net_buf_reserve(buf, reserve);
+	shared(buf) = net_buf_ref(data);
+
+	return buf;
+}
+
+size_t bt_conn_shared_len(struct net_buf *buf)
+{
+	if (net_buf_pool_get(buf->pool_id) != &shared_pool) {
+		return 0;
+	}
+
+	return shared(buf)->len;
+}
+#endif /* CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0 */
+
 #if defined(CONFIG_BT_SMP) || defined(CONFIG_BT_BREDR)
 int bt_conn_auth_cb_register(const struct bt_conn_auth_cb *cb)
 {
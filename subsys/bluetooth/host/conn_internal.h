@@ -216,6 +216,22 @@ void bt_conn_security_changed(struct bt_conn *conn);
 /* Prepare a PDU to be sent over a connection */
 struct net_buf *bt_conn_create_pdu(struct net_buf_pool *pool, size_t reserve);
 
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+/* Prepare a PDU whose payload is shared with the PDUs of other connections,
+ * the payload is referenced and only copied when the PDU gets sent.
+ */
+struct net_buf *bt_conn_create_shared_pdu(struct net_buf *data,
+					  size_t reserve);
+
+/* Length of the shared payload following the PDU data */
+size_t bt_conn_shared_len(struct net_buf *buf);
+#else
+static inline size_t bt_conn_shared_len(struct net_buf *buf)
+{
+	return 0;
+}
+#endif /* CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0 */
+
 /* Initialize connection management */
 int bt_conn_init(void);
 
@@ -517,6 +517,7 @@ populate:
 		       attrs->perm);
 	}
 
+	/* The handles only increase, so the list stays sorted by handle */
 	sys_slist_append(&db, &svc->node);
 
 	return 0;
@@ -915,21 +916,53 @@ ssize_t bt_gatt_attr_read_chrc(struct bt_conn *conn,
 	return bt_gatt_attr_read(conn, attr, buf, len, offset, &pdu, value_len);
 }
 
+/* Index of the first attribute of the service with a handle not lower
+ * than the given one, the handles of a service are in increasing order.
+ */
+static size_t find_attr_index(const struct bt_gatt_service *svc,
+			      u16_t handle)
+{
+	size_t low = 0, high = svc->attr_count;
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+
+		if (svc->attrs[mid].handle < handle) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
 void bt_gatt_foreach_attr(u16_t start_handle, u16_t end_handle,
 			  bt_gatt_attr_func_t func, void *user_data)
 {
 	struct bt_gatt_service *svc;
 
+	/* gatt_register() keeps the services sorted by handle, so the
+	 * services out of the range are skipped as a whole and the first
+	 * attribute in range is found by bisection.
+	 */
 	SYS_SLIST_FOR_EACH_CONTAINER(&db, svc, node) {
-		int i;
+		size_t i;
+
+		if (svc->attrs[svc->attr_count - 1].handle < start_handle) {
+			continue;
+		}
 
-		for (i = 0; i < svc->attr_count; i++) {
+		if (svc->attrs[0].handle > end_handle) {
+			return;
+		}
+
+		for (i = find_attr_index(svc, start_handle);
+		     i < svc->attr_count; i++) {
 			struct bt_gatt_attr *attr = &svc->attrs[i];
 
-			/* Check if attribute handle is within range */
-			if (attr->handle < start_handle ||
-			    attr->handle > end_handle) {
-				continue;
+			if (attr->handle > end_handle) {
+				return;
 			}
 
 			if (func(attr, user_data) == BT_GATT_ITER_STOP) {
@@ -1126,6 +1159,9 @@ struct notify_data {
 	const void *data;
 	u16_t len;
 	struct bt_gatt_indicate_params *params;
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+	struct net_buf *payload;
+#endif
 };
 
 static int gatt_notify(struct bt_conn *conn, u16_t handle, const void *data,
@@ -1162,6 +1198,90 @@ static int gatt_notify(struct bt_conn *conn, u16_t handle, const void *data,
 	return bt_att_send(conn, buf, cb);
 }
 
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+#define NOTIFY_ALL_MAX_LEN (CONFIG_BT_L2CAP_TX_MTU - \
+			    sizeof(struct bt_att_hdr) - \
+			    sizeof(struct bt_att_notify))
+
+#define notify_all_params(buf) \
+	(*(struct bt_gatt_notify_all_params **)net_buf_user_data(buf))
+
+static void notify_all_destroy(struct net_buf *buf)
+{
+	struct bt_gatt_notify_all_params *params = notify_all_params(buf);
+
+	net_buf_destroy(buf);
+
+	/* The payload is released once it has been sent to all the peers */
+	if (params->count && params->func) {
+		params->func(params, params->count);
+	}
+}
+
+NET_BUF_POOL_DEFINE(notify_all_pool, CONFIG_BT_GATT_NOTIFY_ALL_COUNT,
+		    NOTIFY_ALL_MAX_LEN,
+		    sizeof(struct bt_gatt_notify_all_params *),
+		    notify_all_destroy);
+
+static void notify_all_sent(struct bt_conn *conn)
+{
+	/* Completion is reported for all the peers when the payload is
+	 * released.
+	 */
+}
+
+static int gatt_notify_shared(struct bt_conn *conn, u16_t handle,
+			      struct net_buf *payload)
+{
+	struct net_buf *buf;
+	struct bt_att_hdr *hdr;
+	struct bt_att_notify *nfy;
+	int err;
+
+#if defined(CONFIG_BT_GATT_ENFORCE_CHANGE_UNAWARE)
+	if (!bt_gatt_change_aware(conn, false)) {
+		return -EAGAIN;
+	}
+#endif
+
+	if (sizeof(*hdr) + sizeof(*nfy) + payload->len >
+	    bt_att_get_mtu(conn)) {
+		BT_WARN("ATT MTU exceeded, max %u, wanted %zu",
+			bt_att_get_mtu(conn),
+			sizeof(*hdr) + sizeof(*nfy) + payload->len);
+		return -EMSGSIZE;
+	}
+
+	/* Only the headers are allocated per peer, the payload is shared */
+	buf = bt_conn_create_shared_pdu(payload, sizeof(struct bt_l2cap_hdr));
+	if (!buf) {
+		BT_WARN("No buffer available to send notification");
+		return -ENOMEM;
+	}
+
+	BT_DBG("conn %p handle 0x%04x", conn, handle);
+
+	hdr = net_buf_add(buf, sizeof(*hdr));
+	hdr->code = BT_ATT_OP_NOTIFY;
+
+	nfy = net_buf_add(buf, sizeof(*nfy));
+	nfy->handle = sys_cpu_to_le16(handle);
+
+	/* The shared headers are limited by their own pool so don't wait for
+	 * the ATT TX semaphore. The PDU is sent directly so that a drop on
+	 * a link going down is reported, it must not be counted.
+	 */
+	err = bt_l2cap_send_cb(conn, BT_L2CAP_CID_ATT, buf, notify_all_sent);
+	if (err) {
+		return err;
+	}
+
+	notify_all_params(payload)->count++;
+
+	return 0;
+}
+#endif /* CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0 */
+
 static void gatt_indicate_rsp(struct bt_conn *conn, u8_t err,
 			      const void *pdu, u16_t length, void *user_data)
 {
@@ -1327,6 +1447,11 @@ static u8_t notify_cb(const struct bt_gatt_attr *attr, void *user_data)
 
 		if (data->type == BT_GATT_CCC_INDICATE) {
 			err = gatt_indicate(conn, data->params);
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+		} else if (data->payload) {
+			err = gatt_notify_shared(conn, data->attr->handle,
+						 data->payload);
+#endif
 		} else {
 			err = gatt_notify(conn, data->attr->handle,
 					  data->data, data->len,
@@ -1336,6 +1461,16 @@ static u8_t notify_cb(const struct bt_gatt_attr *attr, void *user_data)
 		bt_conn_unref(conn);
 
 		if (err < 0) {
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+			/* The peers the shared notification was already
+			 * queued for will complete it, the one that failed
+			 * is skipped.
+			 */
+			if (data->payload) {
+				data->err = err;
+				continue;
+			}
+#endif
 			return BT_GATT_ITER_STOP;
 		}
 
@@ -1376,11 +1511,74 @@ int bt_gatt_notify_cb(struct bt_conn *conn, const struct bt_gatt_attr *attr,
 	nfy.type = BT_GATT_CCC_NOTIFY;
 	nfy.data = data;
 	nfy.len = len;
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+	nfy.payload = NULL;
+#endif
+
+	bt_gatt_foreach_attr(attr->handle, 0xffff, notify_cb, &nfy);
+
+	return nfy.err;
+}
+
+#if CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0
+int bt_gatt_notify_all(struct bt_gatt_notify_all_params *params)
+{
+	const struct bt_gatt_attr *attr;
+	struct notify_data nfy;
+	struct net_buf *payload;
+
+	__ASSERT(params, "invalid parameters\n");
+	__ASSERT(params->attr && params->attr->handle, "invalid parameters\n");
 
+	attr = params->attr;
+
+	/* Check if attribute is a characteristic then adjust the handle */
+	if (!bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CHRC)) {
+		struct bt_gatt_chrc *chrc = attr->user_data;
+
+		if (!(chrc->properties & BT_GATT_CHRC_NOTIFY)) {
+			return -EINVAL;
+		}
+
+		attr++;
+	}
+
+	if (params->len > NOTIFY_ALL_MAX_LEN) {
+		return -EINVAL;
+	}
+
+	payload = net_buf_alloc(&notify_all_pool, K_NO_WAIT);
+	if (!payload) {
+		BT_WARN("No buffer available to send notification");
+		return -ENOMEM;
+	}
+
+	params->count = 0U;
+	notify_all_params(payload) = params;
+	net_buf_add_mem(payload, params->data, params->len);
+
+	nfy.err = -ENOTCONN;
+	nfy.attr = attr;
+	nfy.func = NULL;
+	nfy.type = BT_GATT_CCC_NOTIFY;
+	nfy.payload = payload;
+
+	/* Buffer references are not atomic, keep the TX thread from
+	 * releasing the payload while it is being referenced.
+	 */
+	k_sched_lock();
 	bt_gatt_foreach_attr(attr->handle, 0xffff, notify_cb, &nfy);
+	net_buf_unref(payload);
+	k_sched_unlock();
+
+	/* The callback is called if any peer got the notification */
+	if (params->count) {
+		return 0;
+	}
 
 	return nfy.err;
 }
+#endif /* CONFIG_BT_GATT_NOTIFY_ALL_COUNT > 0 */
 
 int bt_gatt_indicate(struct bt_conn *conn,
 		     struct bt_gatt_indicate_params *params)
@@ -28,6 +28,46 @@ static inline size_t _nvs_al_size(struct nvs_fs *fs, size_t len)
 }
 /* end basic routines */
 
+/* lookup cache routines */
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* Each slot holds the address of the newest ATE among all ids mapping to
+ * it, so the newest ATE for an id is never newer than its slot address.
+ */
+static inline u32_t *_nvs_lookup_cache_slot(struct nvs_fs *fs, u16_t id)
+{
+	return &fs->lookup_cache[id % CONFIG_NVS_LOOKUP_CACHE_SIZE];
+}
+
+/* drop the slots that point into a sector that is about to be erased */
+static void _nvs_lookup_cache_invalidate(struct nvs_fs *fs, u32_t addr)
+{
+	for (int i = 0; i < CONFIG_NVS_LOOKUP_CACHE_SIZE; i++) {
+		if ((fs->lookup_cache[i] & ADDR_SECT_MASK) ==
+		    (addr & ADDR_SECT_MASK)) {
+			fs->lookup_cache[i] = NVS_LOOKUP_CACHE_NO_ADDR;
+		}
+	}
+}
+#endif
+
+/* _nvs_lookup_start returns in addr the ATE address to start walking back
+ * from when searching for id. Returns -ENOENT if the lookup cache knows
+ * there is no entry for id.
+ */
+static int _nvs_lookup_start(struct nvs_fs *fs, u16_t id, u32_t *addr)
+{
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	*addr = *_nvs_lookup_cache_slot(fs, id);
+	if (*addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+		return -ENOENT;
+	}
+#else
+	*addr = fs->ate_wra;
+#endif
+	return 0;
+}
+/* end lookup cache routines */
+
 /* flash routines */
 /* basic aligned flash write to nvs address */
 static int _nvs_flash_al_wrt(struct nvs_fs *fs, u32_t addr, const void *data,
@@ -103,6 +143,12 @@ static int _nvs_flash_ate_wrt(struct nvs_fs *fs, const struct nvs_ate *entry)
 
 	rc = _nvs_flash_al_wrt(fs, fs->ate_wra, entry,
 			       sizeof(struct nvs_ate));
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* 0xFFFF is used by the sector close ate, keep it out of the cache */
+	if (!rc && entry->id != 0xFFFF) {
+		*_nvs_lookup_cache_slot(fs, entry->id) = fs->ate_wra;
+	}
+#endif
 	fs->ate_wra -= _nvs_al_size(fs, sizeof(struct nvs_ate));
 
 	return rc;
@@ -243,6 +289,9 @@ static int _nvs_flash_erase_sector(struct nvs_fs *fs, u32_t addr)
 		return rc;
 	}
 	(void) flash_write_protection_set(fs->flash_device, 1);
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	_nvs_lookup_cache_invalidate(fs, addr);
+#endif
 	return 0;
 }
 
@@ -473,7 +522,9 @@ static int _nvs_gc(struct nvs_fs *fs)
 		if (rc) {
 			return rc;
 		}
-		wlk_addr = fs->ate_wra;
+		if (_nvs_lookup_start(fs, gc_ate.id, &wlk_addr)) {
+			wlk_addr = fs->ate_wra;
+		}
 		while (1) {
 			wlk_prev_addr = wlk_addr;
 			rc = _nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
@@ -527,6 +578,39 @@ static int _nvs_gc(struct nvs_fs *fs)
 	return 0;
 }
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* fill the lookup cache by walking all ate's from newest to oldest, the
+ * first valid ate seen for a slot is the newest one.
+ */
+static int _nvs_lookup_cache_rebuild(struct nvs_fs *fs)
+{
+	int rc;
+	u32_t addr, ate_addr, *slot;
+	struct nvs_ate ate;
+
+	(void)memset(fs->lookup_cache, 0xff, sizeof(fs->lookup_cache));
+
+	addr = fs->ate_wra;
+	while (1) {
+		ate_addr = addr;
+		rc = _nvs_prev_ate(fs, &addr, &ate);
+		if (rc) {
+			return rc;
+		}
+		if ((ate.id != 0xFFFF) && (!_nvs_ate_crc8_check(&ate))) {
+			slot = _nvs_lookup_cache_slot(fs, ate.id);
+			if (*slot == NVS_LOOKUP_CACHE_NO_ADDR) {
+				*slot = ate_addr;
+			}
+		}
+		if (addr == fs->ate_wra) {
+			break;
+		}
+	}
+	return 0;
+}
+#endif
+
 static int _nvs_startup(struct nvs_fs *fs)
 {
 	int rc;
@@ -541,6 +625,11 @@ static int _nvs_startup(struct nvs_fs *fs)
 
 	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* an interrupted gc is restarted below, before the cache is built */
+	(void)memset(fs->lookup_cache, 0xff, sizeof(fs->lookup_cache));
+#endif
+
 	ate_size = _nvs_al_size(fs, sizeof(struct nvs_ate));
 	/* step through the sectors to find the last sector */
 	for (u16_t i = 0; i < fs->sector_count; i++) {
@@ -634,6 +723,10 @@ static int _nvs_startup(struct nvs_fs *fs)
 		}
 	}
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	rc = _nvs_lookup_cache_rebuild(fs);
+#endif
+
 end:
 	k_mutex_unlock(&fs->nvs_lock);
 	return rc;
@@ -743,10 +836,10 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 	}
 
 	/* find latest entry with same id */
-	wlk_addr = fs->ate_wra;
+	rc = _nvs_lookup_start(fs, id, &wlk_addr);
 	rd_addr = wlk_addr;
 
-	while (1) {
+	while (!rc) {
 		rd_addr = wlk_addr;
 		rc = _nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
 		if (rc) {
@@ -760,6 +853,11 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 		}
 	}
 
+	if (rc == -ENOENT) {
+		/* no previous entry according to the lookup cache */
+		wlk_addr = fs->ate_wra;
+	}
+
 	if (wlk_addr != fs->ate_wra) {
 		/* previous entry found */
 		rd_addr &= ADDR_SECT_MASK;
@@ -847,7 +945,10 @@ ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 
 	cnt_his = 0U;
 
-	wlk_addr = fs->ate_wra;
+	rc = _nvs_lookup_start(fs, id, &wlk_addr);
+	if (rc) {
+		return rc;
+	}
 	rd_addr = wlk_addr;
 
 	while (cnt_his <= cnt) {
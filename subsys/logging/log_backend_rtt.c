@@ -8,6 +8,7 @@
 #include <logging/log_core.h>
 #include <logging/log_msg.h>
 #include <logging/log_output.h>
+#include <logging/log_output_dict.h>
 #include <SEGGER_RTT.h>
 
 #define DROP_MAX 99
@@ -213,7 +214,11 @@ static void put(const struct log_backend *const backend,
 		flags |= LOG_OUTPUT_FLAG_FORMAT_TIMESTAMP;
 	}
 
-	log_output_msg_process(&log_output, msg, flags);
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_RTT_OUTPUT_DICTIONARY)) {
+		log_output_dict_msg_process(&log_output, msg, flags);
+	} else {
+		log_output_msg_process(&log_output, msg, flags);
+	}
 
 	log_msg_put(msg);
 }
@@ -246,7 +251,11 @@ static void dropped(const struct log_backend *const backend, u32_t cnt)
 {
 	ARG_UNUSED(backend);
 
-	log_output_dropped_process(&log_output, cnt);
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_RTT_OUTPUT_DICTIONARY)) {
+		log_output_dict_dropped_process(&log_output, cnt);
+	} else {
+		log_output_dropped_process(&log_output, cnt);
+	}
 }
 
 static void sync_string(const struct log_backend *const backend,
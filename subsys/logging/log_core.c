@@ -38,6 +38,10 @@
 #define CONFIG_LOG_STRDUP_BUF_COUNT 0
 #endif
 
+#ifndef CONFIG_LOG_PROCESS_BATCH
+#define CONFIG_LOG_PROCESS_BATCH 1
+#endif
+
 struct log_strdup_buf {
 	atomic_t refcount;
 	char buf[CONFIG_LOG_STRDUP_MAX_STRING + 1]; /* for termination */
@@ -52,6 +56,8 @@ static u8_t __noinit __aligned(sizeof(u32_t))
 		log_strdup_pool_buf[LOG_STRDUP_POOL_BUFFER_SIZE];
 
 static struct log_list_t list;
+/* Serializes consumers when producers do not lock */
+static struct k_spinlock consumer_lock;
 static atomic_t initialized;
 static bool panic_mode;
 static bool backend_attached;
@@ -77,11 +83,13 @@ static inline void msg_finalize(struct log_msg *msg,
 
 	atomic_inc(&buffered_cnt);
 
-	key = irq_lock();
-
-	log_list_add_tail(&list, msg);
-
-	irq_unlock(key);
+	if (IS_ENABLED(CONFIG_LOG_LOCKLESS_QUEUE)) {
+		log_list_add_tail(&list, msg);
+	} else {
+		key = irq_lock();
+		log_list_add_tail(&list, msg);
+		irq_unlock(key);
+	}
 
 	if (panic_mode) {
 		(void)log_process(false);
@@ -461,26 +469,42 @@ void dropped_notify(void)
 
 bool log_process(bool bypass)
 {
-	struct log_msg *msg;
+	/* When dropping messages to make room, drop only one */
+	u32_t cnt = bypass ? 1 : CONFIG_LOG_PROCESS_BATCH;
+	struct log_msg *msg, *next;
 
 	if (!backend_attached && !bypass) {
 		return false;
 	}
-	unsigned int key = irq_lock();
 
-	msg = log_list_head_get(&list);
-	irq_unlock(key);
+	if (IS_ENABLED(CONFIG_LOG_LOCKLESS_QUEUE)) {
+		k_spinlock_key_t key = k_spin_lock(&consumer_lock);
 
-	if (msg != NULL) {
+		msg = log_list_head_get_n(&list, &cnt);
+		k_spin_unlock(&consumer_lock, key);
+	} else {
+		unsigned int key = irq_lock();
+
+		msg = log_list_head_get_n(&list, &cnt);
+		irq_unlock(key);
+	}
+
+	for (u32_t i = 0; i < cnt; i++) {
+		next = (i + 1 < cnt) ? msg->next : NULL;
 		atomic_dec(&buffered_cnt);
 		msg_process(msg, bypass);
+		msg = next;
 	}
 
 	if (!bypass && dropped_cnt) {
 		dropped_notify();
 	}
 
-	return (log_list_head_peek(&list) != NULL);
+	/* Nothing taken while the list is not empty means the head
+	 * message is still being added, report it on the next call
+	 * rather than have the caller spin on it.
+	 */
+	return (cnt > 0) && (log_list_head_peek(&list) != NULL);
 }
 
 u32_t log_buffered_cnt(void)
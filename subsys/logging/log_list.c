@@ -6,6 +6,89 @@
 
 #include "log_list.h"
 
+#ifdef CONFIG_LOG_LOCKLESS_QUEUE
+
+/* Lock-free multi-producer single-consumer queue.  Producers claim the
+ * tail with an atomic exchange and then link the previous tail (or
+ * the head, if the queue was empty) to the new message.  Between
+ * those two steps the queue is temporarily cut after the previous
+ * tail; the consumer then treats that message as not yet available
+ * instead of waiting for the producer, which may be preempted by the
+ * consumer itself.
+ */
+
+void log_list_init(struct log_list_t *list)
+{
+	list->tail = NULL;
+	list->head = NULL;
+}
+
+void log_list_add_tail(struct log_list_t *list, struct log_msg *msg)
+{
+	struct log_msg *prev;
+
+	msg->next = NULL;
+
+	prev = __atomic_exchange_n(&list->tail, msg, __ATOMIC_ACQ_REL);
+	if (prev == NULL) {
+		__atomic_store_n(&list->head, msg, __ATOMIC_RELEASE);
+	} else {
+		__atomic_store_n(&prev->next, msg, __ATOMIC_RELEASE);
+	}
+}
+
+struct log_msg *log_list_head_peek(struct log_list_t *list)
+{
+	return __atomic_load_n(&list->head, __ATOMIC_ACQUIRE);
+}
+
+static struct log_msg *next_get(struct log_msg *msg)
+{
+	return __atomic_load_n(&msg->next, __ATOMIC_ACQUIRE);
+}
+
+/* Moves the head past msg, returns false if msg is the last message
+ * and a producer has claimed the tail but not linked it yet.
+ */
+static bool head_advance(struct log_list_t *list, struct log_msg *msg)
+{
+	struct log_msg *next = __atomic_load_n(&msg->next, __ATOMIC_ACQUIRE);
+	struct log_msg *last = msg;
+
+	if (next != NULL) {
+		__atomic_store_n(&list->head, next, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	/* No producer writes the head while the tail is set, so it can
+	 * be cleared before trying to empty the queue.
+	 */
+	__atomic_store_n(&list->head, NULL, __ATOMIC_SEQ_CST);
+	if (__atomic_compare_exchange_n(&list->tail, &last, NULL, false,
+					__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+		return true;
+	}
+
+	next = __atomic_load_n(&msg->next, __ATOMIC_ACQUIRE);
+	__atomic_store_n(&list->head, next != NULL ? next : msg,
+			 __ATOMIC_RELEASE);
+
+	return next != NULL;
+}
+
+struct log_msg *log_list_head_get(struct log_list_t *list)
+{
+	struct log_msg *msg = log_list_head_peek(list);
+
+	if (msg != NULL && !head_advance(list, msg)) {
+		msg = NULL;
+	}
+
+	return msg;
+}
+
+#else
+
 void log_list_init(struct log_list_t *list)
 {
 	list->tail = NULL;
@@ -39,3 +122,53 @@ struct log_msg *log_list_head_get(struct log_list_t *list)
 
 	return msg;
 }
+
+static struct log_msg *next_get(struct log_msg *msg)
+{
+	return msg->next;
+}
+
+static bool head_advance(struct log_list_t *list, struct log_msg *msg)
+{
+	list->head = msg->next;
+
+	return true;
+}
+
+#endif /* CONFIG_LOG_LOCKLESS_QUEUE */
+
+struct log_msg *log_list_head_get_n(struct log_list_t *list, u32_t *cnt)
+{
+	struct log_msg *first = log_list_head_peek(list);
+	struct log_msg *last = first;
+	u32_t n;
+
+	if (first == NULL || *cnt == 0U) {
+		*cnt = 0U;
+		return NULL;
+	}
+
+	/* Find the last message of the batch and detach all of them with
+	 * a single head update, they stay linked through their next field.
+	 */
+	for (n = 1U; n < *cnt; n++) {
+		struct log_msg *next = next_get(last);
+
+		if (next == NULL) {
+			break;
+		}
+
+		last = next;
+	}
+
+	/* The last message is left at the head if its successor is being
+	 * added, the ones before it are detached.
+	 */
+	if (!head_advance(list, last)) {
+		n--;
+	}
+
+	*cnt = n;
+
+	return n ? first : NULL;
+}
@@ -40,6 +40,19 @@ void log_list_add_tail(struct log_list_t *list, struct log_msg *msg);
  */
 struct log_msg *log_list_head_get(struct log_list_t *list);
 
+/** @brief Remove up to @p cnt items from the head of the list.
+ *
+ * The returned messages are chained through their next field, the
+ * next field of the last one must not be used.
+ *
+ * @param list List instance.
+ * @param cnt  In: maximum number of messages, out: number of messages
+ *	       removed.
+ *
+ * @return First message or NULL if none was removed.
+ */
+struct log_msg *log_list_head_get_n(struct log_list_t *list, u32_t *cnt);
+
 /** @brief Peek item from the head of the list.
  *
  * @param list List instance.
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log_output_dict.h>
+#include <logging/log_ctrl.h>
+#include <string.h>
+
+static void dict_write(const struct log_output *log_output,
+		       const void *data, size_t len)
+{
+	struct log_output_control_block *cb = log_output->control_block;
+	const u8_t *src = data;
+
+	while (len > 0) {
+		size_t part = MIN(len, log_output->size - cb->offset);
+
+		(void)memcpy(&log_output->buf[cb->offset], src, part);
+		cb->offset += part;
+		src += part;
+		len -= part;
+
+		if (cb->offset == log_output->size) {
+			log_output_flush(log_output);
+		}
+	}
+}
+
+/* Returns a bit mask of the arguments consumed by %s conversions. Only
+ * conversions are identified, nothing is formatted.
+ */
+static u32_t string_args_get(const char *fmt, u32_t nargs)
+{
+	u32_t mask = 0U;
+	u32_t arg = 0U;
+
+	while ((*fmt != '\0') && (arg < nargs)) {
+		if (*fmt++ != '%') {
+			continue;
+		}
+
+		if (*fmt == '%') {
+			fmt++;
+			continue;
+		}
+
+		/* Skip flags, field width, precision and length modifier */
+		while ((*fmt != '\0') && (strchr("-+ #*.0123456789hlLjzt",
+						 *fmt) != NULL)) {
+			if (*fmt == '*') {
+				arg++;
+			}
+			fmt++;
+		}
+
+		if (*fmt == '\0') {
+			break;
+		}
+
+		if ((*fmt == 's') && (arg < nargs)) {
+			mask |= BIT(arg);
+		}
+
+		fmt++;
+		arg++;
+	}
+
+	return mask;
+}
+
+static void std_msg_process(const struct log_output *log_output,
+			    struct log_msg *msg, struct log_dict_msg_hdr *hdr)
+{
+	u32_t nargs = log_msg_nargs_get(msg);
+	u32_t args[LOG_MAX_NARGS];
+	u32_t strings;
+
+	hdr->type = LOG_DICT_PKT_STD;
+	hdr->nargs = nargs;
+	dict_write(log_output, hdr, sizeof(*hdr));
+
+	for (u32_t i = 0; i < nargs; i++) {
+		args[i] = log_msg_arg_get(msg, i);
+	}
+
+	dict_write(log_output, args, nargs * sizeof(u32_t));
+
+	strings = string_args_get(log_msg_str_get(msg), nargs);
+	while (strings != 0U) {
+		u32_t i = __builtin_ctz(strings);
+		const char *str = (const char *)args[i];
+
+		if (str == NULL) {
+			str = "(null)";
+		}
+
+		dict_write(log_output, str, strlen(str) + 1);
+		strings &= strings - 1U;
+	}
+}
+
+static void hexdump_msg_process(const struct log_output *log_output,
+				struct log_msg *msg,
+				struct log_dict_msg_hdr *hdr)
+{
+	u16_t length = msg->hdr.params.hexdump.length;
+	size_t offset = 0;
+	size_t part;
+
+	hdr->type = LOG_DICT_PKT_HEXDUMP;
+	hdr->nargs = 0U;
+	dict_write(log_output, hdr, sizeof(*hdr));
+	dict_write(log_output, &length, sizeof(length));
+
+	/* Copy the data straight into the output buffer */
+	do {
+		struct log_output_control_block *cb =
+						log_output->control_block;
+
+		part = log_output->size - cb->offset;
+		log_msg_hexdump_data_get(msg, &log_output->buf[cb->offset],
+					 &part, offset);
+		cb->offset += part;
+		offset += part;
+
+		if (cb->offset == log_output->size) {
+			log_output_flush(log_output);
+		}
+	} while (part > 0);
+}
+
+void log_output_dict_msg_process(const struct log_output *log_output,
+				 struct log_msg *msg, u32_t flags)
+{
+	struct log_dict_msg_hdr hdr = {
+		.ids = log_msg_level_get(msg) |
+		       (log_msg_domain_id_get(msg) << 3) |
+		       (log_msg_source_id_get(msg) << 6),
+		.timestamp = log_msg_timestamp_get(msg),
+		.fmt = (u32_t)log_msg_str_get(msg),
+	};
+
+	ARG_UNUSED(flags);
+
+	if (log_msg_is_std(msg)) {
+		std_msg_process(log_output, msg, &hdr);
+	} else {
+		hexdump_msg_process(log_output, msg, &hdr);
+	}
+
+	log_output_flush(log_output);
+}
+
+void log_output_dict_dropped_process(const struct log_output *log_output,
+				     u32_t cnt)
+{
+	struct log_dict_dropped_pkt pkt = {
+		.type = LOG_DICT_PKT_DROPPED,
+		.cnt = cnt,
+	};
+
+	dict_write(log_output, &pkt, sizeof(pkt));
+	log_output_flush(log_output);
+}
@@ -290,6 +290,8 @@ static inline enum net_verdict cache_check(struct net_pkt *pkt,
 				net_pkt_family(pkt), *pos,
 				conn_cache[*pos].value);
 
+			net_stats_update_rx_cycles(pkt, NET_STATS_LAYER_CONN);
+
 			return conn->cb(conn, pkt,
 					ip_hdr, proto_hdr, conn->user_data);
 		}
@@ -837,6 +839,8 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 		return NET_DROP;
 	}
 
+	net_stats_update_rx_cycles(pkt, NET_STATS_LAYER_IP);
+
 	if (is_invalid_packet(pkt, ip_hdr, src_port, dst_port)) {
 		NET_DBG("Dropping invalid packet");
 		return NET_DROP;
@@ -947,6 +951,8 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 			conns[best_match].rank);
 #endif /* CONFIG_NET_CONN_CACHE */
 
+		net_stats_update_rx_cycles(pkt, NET_STATS_LAYER_CONN);
+
 		if (conns[best_match].cb(&conns[best_match], pkt, ip_hdr,
 			proto_hdr, conns[best_match].user_data) == NET_DROP) {
 			goto drop;
@@ -219,6 +219,17 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 
 	net_pkt_set_family(pkt, PF_INET);
 
+	if (ntohs(UNALIGNED_GET((u16_t *)hdr->offset)) &
+	    (NET_IPV4_MORE_FRAG_MASK | NET_IPV4_FRAGH_OFFSET_MASK)) {
+		/* Without reassembly support the fragment is dropped */
+		verdict = net_ipv4_handle_fragment(pkt, hdr);
+		if (verdict == NET_DROP) {
+			goto drop;
+		}
+
+		return verdict;
+	}
+
 	net_pkt_acknowledge_data(pkt, &ipv4_access);
 
 	switch (hdr->proto) {
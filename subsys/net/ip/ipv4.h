@@ -66,4 +66,56 @@ int net_ipv4_create_new(struct net_pkt *pkt,
  */
 int net_ipv4_finalize(struct net_pkt *pkt, u8_t next_header_proto);
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT_MAX_PKT)
+#define NET_IPV4_FRAGMENTS_MAX_PKT CONFIG_NET_IPV4_FRAGMENT_MAX_PKT
+#else
+#define NET_IPV4_FRAGMENTS_MAX_PKT 2
+#endif
+
+/**
+ * @brief Handles IPv4 fragmented packets. The packet is queued for
+ * reassembly and the reassembled packet is fed back to net_ipv4_input()
+ * once all the fragments have been received.
+ *
+ * @param pkt Network packet, the cursor is at the start of the IPv4 header.
+ * @param hdr The IPv4 header of the current packet
+ *
+ * @return Return verdict about the packet
+ */
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+enum net_verdict net_ipv4_handle_fragment(struct net_pkt *pkt,
+					  struct net_ipv4_hdr *hdr);
+#else
+static inline
+enum net_verdict net_ipv4_handle_fragment(struct net_pkt *pkt,
+					  struct net_ipv4_hdr *hdr)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(hdr);
+
+	return NET_DROP;
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+/**
+ * @brief Fragment the IPv4 packet if it does not fit into the MTU of the
+ * network interface.
+ *
+ * @param pkt Network packet
+ *
+ * @return NET_OK if the packet can be sent as is, NET_CONTINUE if the
+ * fragments were sent and the packet was released, NET_DROP if the
+ * packet could not be sent.
+ */
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt);
+#else
+static inline enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return NET_OK;
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #endif /* __IPV4_H */
@@ -0,0 +1,351 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/net_context.h>
+#include "net_private.h"
+#include "connection.h"
+#include "udp_internal.h"
+#include "tcp_internal.h"
+#include "ipv4.h"
+#include "reassembly.h"
+#include "net_stats.h"
+
+/* Largest payload that fits into an IPv4 packet */
+#define IPV4_MAX_PAYLOAD (0xffff - sizeof(struct net_ipv4_hdr))
+
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+/* Identification of the next fragmented packet we send */
+static u16_t fragment_id;
+
+static u16_t fragment_payload_len(struct net_pkt *pkt)
+{
+	return net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt);
+}
+
+static void reassemble_packet(struct net_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+
+	pkt = net_reassembly_chain(reass);
+	if (!pkt) {
+		return;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(pkt, &ipv4_access);
+	if (!hdr) {
+		goto error;
+	}
+
+	hdr->len = htons(net_pkt_get_len(pkt));
+	UNALIGNED_PUT(0, (u16_t *)hdr->offset);
+	hdr->chksum = 0;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	if (net_pkt_set_data(pkt, &ipv4_access)) {
+		goto error;
+	}
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt, net_pkt_get_len(pkt));
+
+	net_pkt_set_ipv4_fragment_flags(pkt, 0);
+	net_pkt_cursor_init(pkt);
+
+	/* The packet no longer has link layer headers so it must not be
+	 * passed to L2 again. It is not a fragment anymore, so feeding it
+	 * back to the IPv4 input nests only once.
+	 */
+	if (net_ipv4_input(pkt) != NET_DROP) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+enum net_verdict net_ipv4_handle_fragment(struct net_pkt *pkt,
+					  struct net_ipv4_hdr *hdr)
+{
+	struct net_reassembly *reass;
+	u16_t offset, len;
+	int ret;
+
+	net_pkt_set_ipv4_fragment_flags(pkt,
+				ntohs(UNALIGNED_GET((u16_t *)hdr->offset)));
+
+	offset = net_pkt_ipv4_fragment_offset(pkt);
+	len = fragment_payload_len(pkt);
+
+	if (net_pkt_ipv4_fragment_more(pkt) && (!len || len % 8)) {
+		NET_DBG("DROP: fragment len %u is not multiple of 8", len);
+		return NET_DROP;
+	}
+
+	if (offset + len > IPV4_MAX_PAYLOAD) {
+		NET_DBG("DROP: fragment offset %u len %u too large",
+			offset, len);
+		return NET_DROP;
+	}
+
+	reass = net_reassembly_get(AF_INET, UNALIGNED_GET((u16_t *)hdr->id),
+				   &hdr->src, &hdr->dst, hdr->proto);
+	if (!reass) {
+		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+		return NET_DROP;
+	}
+
+	ret = net_reassembly_add(reass, pkt);
+	if (ret < 0) {
+		return NET_DROP;
+	}
+
+	if (ret == 0) {
+		NET_DBG("More fragments to be received");
+		return NET_OK;
+	}
+
+	/* All the fragments received, reassemble the packet */
+	reassemble_packet(reass);
+
+	return NET_OK;
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt, u16_t fit_len,
+			      u16_t frag_offset, u16_t flags)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	u16_t hdr_len = net_pkt_ip_hdr_len(pkt);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *frag_pkt;
+	int ret = -ENOBUFS;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt),
+					     hdr_len + fit_len, AF_INET, 0,
+					     BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	/* Copy the IPv4 header and then the payload part of this fragment
+	 * from the original packet.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_copy(frag_pkt, pkt, hdr_len) ||
+	    net_pkt_skip(pkt, frag_offset) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(frag_pkt);
+	net_pkt_set_overwrite(frag_pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(frag_pkt,
+							  &ipv4_access);
+	if (!hdr) {
+		goto fail;
+	}
+
+	hdr->len = htons(hdr_len + fit_len);
+	UNALIGNED_PUT(htons(flags), (u16_t *)hdr->offset);
+	hdr->chksum = 0;
+
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(frag_pkt))) {
+		hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	if (net_pkt_set_data(frag_pkt, &ipv4_access)) {
+		goto fail;
+	}
+
+	net_pkt_set_ip_hdr_len(frag_pkt, hdr_len);
+	net_pkt_set_ipv4_ttl(frag_pkt, net_pkt_ipv4_ttl(pkt));
+	net_pkt_set_overwrite(frag_pkt, false);
+
+	/* If everything has been ok so far, we can send the packet. */
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+static int send_fragmented_pkt(struct net_pkt *pkt, u16_t mtu, u16_t flags)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	u16_t hdr_len = net_pkt_ip_hdr_len(pkt);
+	struct net_ipv4_hdr *hdr;
+	u16_t frag_offset, base;
+	size_t length;
+	int fit_len;
+	int ret;
+
+	/* Every fragment but the last one carries a multiple of 8 bytes */
+	fit_len = (mtu - hdr_len) & ~7;
+	if (fit_len <= 0) {
+		NET_DBG("No room for IPv4 payload MTU %u hdr_len %u",
+			mtu, hdr_len);
+		return -EINVAL;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	/* A packet being forwarded might be a fragment already, it keeps
+	 * its identification. Otherwise allocate a new one.
+	 */
+	if (!(flags & (NET_IPV4_MORE_FRAG_MASK | NET_IPV4_FRAGH_OFFSET_MASK))) {
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(pkt,
+								  &ipv4_access);
+		if (!hdr) {
+			return -ENOBUFS;
+		}
+
+		if (!fragment_id) {
+			fragment_id = sys_rand32_get();
+		}
+
+		UNALIGNED_PUT(htons(fragment_id), (u16_t *)hdr->id);
+		fragment_id++;
+
+		if (net_pkt_set_data(pkt, &ipv4_access)) {
+			return -ENOBUFS;
+		}
+	}
+
+	/* The transport checksum cannot be offloaded once the payload is
+	 * split, so calculate it here.
+	 */
+	if (!net_if_need_calc_tx_checksum(net_pkt_iface(pkt)) &&
+	    !(flags & NET_IPV4_FRAGH_OFFSET_MASK)) {
+		net_pkt_cursor_init(pkt);
+
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(pkt,
+								  &ipv4_access);
+		if (!hdr || net_pkt_skip(pkt, hdr_len)) {
+			return -ENOBUFS;
+		}
+
+		if (IS_ENABLED(CONFIG_NET_UDP) && hdr->proto == IPPROTO_UDP) {
+			ret = net_udp_finalize(pkt);
+		} else if (IS_ENABLED(CONFIG_NET_TCP) &&
+			   hdr->proto == IPPROTO_TCP) {
+			ret = net_tcp_finalize(pkt);
+		} else {
+			ret = 0;
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	base = flags & NET_IPV4_FRAGH_OFFSET_MASK;
+	frag_offset = 0U;
+
+	length = fragment_payload_len(pkt);
+	while (length) {
+		u16_t frag_flags;
+
+		if (fit_len >= length) {
+			/* The last fragment inherits the MF flag of the
+			 * packet being fragmented.
+			 */
+			fit_len = length;
+			frag_flags = flags & NET_IPV4_MORE_FRAG_MASK;
+		} else {
+			frag_flags = NET_IPV4_MORE_FRAG_MASK;
+		}
+
+		frag_flags |= base + frag_offset / 8;
+
+		ret = send_ipv4_fragment(pkt, fit_len, frag_offset,
+					 frag_flags);
+		if (ret < 0) {
+			return ret;
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	u16_t mtu = net_if_get_mtu(net_pkt_iface(pkt));
+	struct net_ipv4_hdr *hdr;
+	u16_t flags;
+	int ret;
+
+	if (!mtu || net_pkt_get_len(pkt) <= mtu) {
+		return NET_OK;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data_new(pkt, &ipv4_access);
+	if (!hdr) {
+		return NET_DROP;
+	}
+
+	flags = ntohs(UNALIGNED_GET((u16_t *)hdr->offset));
+	if (flags & NET_IPV4_DO_NOT_FRAG_MASK) {
+		NET_DBG("DROP: pkt %p len %zd exceeds MTU %u and DF is set",
+			pkt, net_pkt_get_len(pkt), mtu);
+		return NET_DROP;
+	}
+
+	ret = send_fragmented_pkt(pkt, mtu, flags);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+		return NET_DROP;
+	}
+
+	/* We "fake" the sending of the packet here so that
+	 * tcp.c:tcp_retry_expired() will increase the ref
+	 * count when re-sending the packet.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* We need to unref here because we simulate the packet sending. */
+	net_pkt_unref(pkt);
+
+	/* No need to continue with the sending as the packet is now split
+	 * and its fragments have been sent.
+	 */
+	return NET_CONTINUE;
+}
@@ -403,6 +403,7 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 	int real_len = net_pkt_get_len(pkt);
 	u8_t ext_bitmap = 0U;
 	u16_t ext_len = 0U;
+	u16_t prev_hdr = offsetof(struct net_ipv6_hdr, nexthdr);
 	u8_t nexthdr, next_nexthdr;
 	union net_proto_header proto_hdr;
 	struct net_ipv6_hdr *hdr;
@@ -486,6 +487,7 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 	nexthdr = hdr->nexthdr;
 	while (!net_ipv6_is_nexthdr_upper_layer(nexthdr)) {
+		u16_t hdr_start = net_pkt_get_current_offset(pkt);
 		u16_t exthdr_len;
 
 		NET_DBG("IPv6 next header %d", nexthdr);
@@ -526,8 +528,9 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 		case NET_IPV6_NEXTHDR_FRAG:
 			if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT)) {
-				net_pkt_set_ipv6_fragment_start(
-					pkt, net_pkt_get_current_offset(pkt));
+				net_pkt_set_ipv6_hdr_prev(pkt, prev_hdr);
+				net_pkt_set_ipv6_fragment_start(pkt,
+								hdr_start);
 				return net_ipv6_handle_fragment_hdr(pkt, hdr,
 								    nexthdr);
 			}
@@ -553,6 +556,7 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 		ext_len += exthdr_len;
 		nexthdr = next_nexthdr;
+		prev_hdr = hdr_start;
 	}
 
 	net_pkt_set_ipv6_ext_len(pkt, ext_len);
@@ -1458,9 +1458,69 @@ int net_context_sendto(struct net_pkt *pkt,
 	return ret;
 }
 
+/* Copy len bytes of the payload, for packets without transport checksum */
+static int context_write_raw(struct net_pkt *pkt, const struct iovec *iov,
+			     size_t iovlen, size_t len)
+{
+	while (len && iovlen--) {
+		size_t part = MIN(iov->iov_len, len);
+		int ret;
+
+		ret = net_pkt_write_new(pkt, iov->iov_base, part);
+		if (ret < 0) {
+			return ret;
+		}
+
+		len -= part;
+		iov++;
+	}
+
+	return 0;
+}
+
+/* Copy len bytes of the payload and sum them in the same pass, the
+ * transport checksum then only needs to read the headers.
+ */
+static int context_write_data(struct net_pkt *pkt, const struct iovec *iov,
+			      size_t iovlen, size_t len)
+{
+	size_t offset = 0;
+	u16_t sum = 0U;
+
+	while (offset < len && iovlen--) {
+		size_t part = MIN(iov->iov_len, len - offset);
+		u16_t part_sum = 0U;
+		int ret;
+
+		ret = net_pkt_write_chksum(pkt, iov->iov_base, part, &part_sum);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Data at an odd offset sums with its bytes swapped */
+		if (offset & 1) {
+			part_sum = (part_sum << 8) | (part_sum >> 8);
+		}
+
+		sum += part_sum;
+		if (sum < part_sum) {
+			sum++;
+		}
+
+		offset += part;
+		iov++;
+	}
+
+	net_pkt_set_appdatalen(pkt, len);
+	net_pkt_set_payload_chksum(pkt, sum);
+
+	return 0;
+}
+
 static int context_setup_udp_packet(struct net_context *context,
 				    struct net_pkt *pkt,
-				    const void *buf,
+				    const struct iovec *iov,
+				    size_t iovlen,
 				    size_t len,
 				    const struct sockaddr *dst_addr,
 				    socklen_t addrlen)
@@ -1503,9 +1563,12 @@ static int context_setup_udp_packet(struct net_context *context,
 		return ret;
 	}
 
-	ret = net_pkt_write_new(pkt, buf, len);
-	if (ret) {
-		return ret;
+	/* A buffer chain is appended as is by the caller */
+	if (iov) {
+		ret = context_write_data(pkt, iov, iovlen, len);
+		if (ret) {
+			return ret;
+		}
 	}
 
 	return 0;
@@ -1529,9 +1592,15 @@ static void context_finalize_packet(struct net_context *context,
 	}
 }
 
+/* The payload is either the len first bytes of the iov array, or the
+ * buffer chain frags points to. The pointer is cleared once the packet
+ * owns the chain.
+ */
 static int context_sendto_new(struct net_context *context,
-			      const void *buf,
+			      const struct iovec *iov,
+			      size_t iovlen,
 			      size_t len,
+			      struct net_buf **frags,
 			      const struct sockaddr *dst_addr,
 			      socklen_t addrlen,
 			      net_context_send_cb_t cb,
@@ -1545,6 +1614,8 @@ static int context_sendto_new(struct net_context *context,
 
 	NET_ASSERT(PART_OF_ARRAY(contexts, context));
 
+	net_stats_update_tx_socket_cycles(context);
+
 	if (!net_context_is_used(context)) {
 		return -EBADF;
 	}
@@ -1627,7 +1698,27 @@ static int context_sendto_new(struct net_context *context,
 		return -EINVAL;
 	}
 
-	pkt = net_pkt_alloc_with_buffer(net_context_get_iface(context), len,
+	if (frags && net_context_get_ip_proto(context) != IPPROTO_UDP) {
+		return -EOPNOTSUPP;
+	}
+
+#if defined(CONFIG_NET_TCP)
+	if (net_context_get_ip_proto(context) == IPPROTO_TCP) {
+		/* Send only what fits into the send buffer */
+		tmp_len = net_tcp_get_send_space(context->tcp);
+		if (!tmp_len) {
+			return -EAGAIN;
+		}
+
+		if (tmp_len < len) {
+			len = tmp_len;
+		}
+	}
+#endif
+
+	/* The buffer chain only needs room for the headers in front */
+	pkt = net_pkt_alloc_with_buffer(net_context_get_iface(context),
+					frags ? 0 : len,
 					net_context_get_family(context),
 					net_context_get_ip_proto(context),
 					PKT_WAIT_TIME);
@@ -1637,7 +1728,7 @@ static int context_sendto_new(struct net_context *context,
 
 	tmp_len = net_pkt_available_payload_buffer(
 				pkt, net_context_get_ip_proto(context));
-	if (tmp_len < len) {
+	if (!frags && tmp_len < len) {
 		len = tmp_len;
 	}
 
@@ -1648,18 +1739,24 @@ static int context_sendto_new(struct net_context *context,
 
 	if (IS_ENABLED(CONFIG_NET_UDP) &&
 	    net_context_get_ip_proto(context) == IPPROTO_UDP) {
-		ret = context_setup_udp_packet(context, pkt, buf, len,
+		ret = context_setup_udp_packet(context, pkt, iov, iovlen, len,
 					       dst_addr, addrlen);
 		if (ret < 0) {
 			goto fail;
 		}
 
+		if (frags) {
+			net_pkt_append_buffer(pkt, *frags);
+			net_pkt_set_appdatalen(pkt, len);
+			*frags = NULL;
+		}
+
 		context_finalize_packet(context, pkt);
 
 		ret = net_send_data(pkt);
 	} else if (IS_ENABLED(CONFIG_NET_TCP) &&
 		   net_context_get_ip_proto(context) == IPPROTO_TCP) {
-		ret = net_pkt_write_new(pkt, buf, len);
+		ret = context_write_data(pkt, iov, iovlen, len);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1673,7 +1770,7 @@ static int context_sendto_new(struct net_context *context,
 		ret = net_tcp_send_data(context, cb, token, user_data);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_context_get_family(context) == AF_PACKET) {
-		ret = net_pkt_write_new(pkt, buf, len);
+		ret = context_write_raw(pkt, iov, iovlen, len);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1684,7 +1781,7 @@ static int context_sendto_new(struct net_context *context,
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
 		   net_context_get_family(context) == AF_CAN &&
 		   net_context_get_ip_proto(context) == CAN_RAW) {
-		ret = net_pkt_write_new(pkt, buf, len);
+		ret = context_write_raw(pkt, iov, iovlen, len);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1709,6 +1806,52 @@ fail:
 	return ret;
 }
 
+/* Must be called with the context lock held, it is released while
+ * waiting for the send buffer to drain.
+ */
+static int context_wait_send_space(struct net_context *context,
+				   s32_t timeout)
+{
+#if defined(CONFIG_NET_TCP)
+	if (net_context_get_ip_proto(context) == IPPROTO_TCP &&
+	    context->tcp) {
+		return net_tcp_wait_send_space(context->tcp, timeout);
+	}
+#endif
+
+	return 0;
+}
+
+/* Length of the address set by net_context_connect(), must be called with
+ * the context lock held.
+ */
+static int context_remote_addrlen(struct net_context *context,
+				  socklen_t *addrlen)
+{
+	if (!(context->flags & NET_CONTEXT_REMOTE_ADDR_SET) ||
+	    !net_sin(&context->remote)->sin_port) {
+		return -EDESTADDRREQ;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) &&
+	    net_context_get_family(context) == AF_INET) {
+		*addrlen = sizeof(struct sockaddr_in);
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_context_get_family(context) == AF_INET6) {
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
+		   net_context_get_family(context) == AF_PACKET) {
+		return -EOPNOTSUPP;
+	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
+		   net_context_get_family(context) == AF_CAN) {
+		*addrlen = sizeof(struct sockaddr_can);
+	} else {
+		*addrlen = 0;
+	}
+
+	return 0;
+}
+
 int net_context_send_new(struct net_context *context,
 			 const void *buf,
 			 size_t len,
@@ -1717,36 +1860,28 @@ int net_context_send_new(struct net_context *context,
 			 void *token,
 			 void *user_data)
 {
+	struct iovec iov = {
+		.iov_base = (void *)buf,
+		.iov_len = len,
+	};
 	socklen_t addrlen;
 	int ret = 0;
 
 	k_mutex_lock(&context->lock, K_FOREVER);
 
-	if (!(context->flags & NET_CONTEXT_REMOTE_ADDR_SET) ||
-	    !net_sin(&context->remote)->sin_port) {
-		ret = -EDESTADDRREQ;
+	ret = context_wait_send_space(context, timeout);
+	if (ret < 0) {
 		goto unlock;
 	}
 
-	if (IS_ENABLED(CONFIG_NET_IPV4) &&
-	    net_context_get_family(context) == AF_INET) {
-		addrlen = sizeof(struct sockaddr_in);
-	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
-		   net_context_get_family(context) == AF_INET6) {
-		addrlen = sizeof(struct sockaddr_in6);
-	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
-		   net_context_get_family(context) == AF_PACKET) {
-		ret = -EOPNOTSUPP;
+	ret = context_remote_addrlen(context, &addrlen);
+	if (ret < 0) {
 		goto unlock;
-	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
-		   net_context_get_family(context) == AF_CAN) {
-		addrlen = sizeof(struct sockaddr_can);
-	} else {
-		addrlen = 0;
 	}
 
-	ret = context_sendto_new(context, buf, len, &context->remote,
-				 addrlen, cb, timeout, token, user_data);
+	ret = context_sendto_new(context, &iov, 1, len, NULL,
+				 &context->remote, addrlen, cb, timeout,
+				 token, user_data);
 unlock:
 	k_mutex_unlock(&context->lock);
 
@@ -1764,15 +1899,107 @@ int net_context_sendto_new(struct net_context *context,
 			   void *token,
 			   void *user_data)
 {
+	struct iovec iov = {
+		.iov_base = (void *)buf,
+		.iov_len = len,
+	};
+	int ret;
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	ret = context_wait_send_space(context, timeout);
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	ret = context_sendto_new(context, &iov, 1, len, NULL, dst_addr,
+				 addrlen, cb, timeout, token, user_data);
+unlock:
+	k_mutex_unlock(&context->lock);
+
+	return ret;
+}
+
+int net_context_sendmsg(struct net_context *context,
+			const struct msghdr *msghdr,
+			net_context_send_cb_t cb,
+			s32_t timeout,
+			void *token,
+			void *user_data)
+{
+	const struct sockaddr *dst_addr = msghdr->msg_name;
+	socklen_t addrlen = msghdr->msg_namelen;
+	size_t len = 0;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < msghdr->msg_iovlen; i++) {
+		len += msghdr->msg_iov[i].iov_len;
+	}
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	ret = context_wait_send_space(context, timeout);
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	if (!dst_addr) {
+		ret = context_remote_addrlen(context, &addrlen);
+		if (ret < 0) {
+			goto unlock;
+		}
+
+		dst_addr = &context->remote;
+	}
+
+	ret = context_sendto_new(context, msghdr->msg_iov, msghdr->msg_iovlen,
+				 len, NULL, dst_addr, addrlen, cb, timeout,
+				 token, user_data);
+unlock:
+	k_mutex_unlock(&context->lock);
+
+	return ret;
+}
+
+int net_context_sendto_buf(struct net_context *context,
+			   struct net_buf *frags,
+			   const struct sockaddr *dst_addr,
+			   socklen_t addrlen,
+			   net_context_send_cb_t cb,
+			   s32_t timeout,
+			   void *token,
+			   void *user_data)
+{
+	size_t len = net_buf_frags_len(frags);
 	int ret;
 
 	k_mutex_lock(&context->lock, K_FOREVER);
 
-	ret = context_sendto_new(context, buf, len, dst_addr, addrlen,
-				 cb, timeout, token, user_data);
+	if (!dst_addr) {
+		ret = context_remote_addrlen(context, &addrlen);
+		if (ret < 0) {
+			goto unlock;
+		}
+
+		dst_addr = &context->remote;
+	}
+
+	if (len > UINT16_MAX - NET_UDPH_LEN) {
+		ret = -EMSGSIZE;
+		goto unlock;
+	}
+
+	ret = context_sendto_new(context, NULL, 0, len, &frags, dst_addr,
+				 addrlen, cb, timeout, token, user_data);
 
+unlock:
 	k_mutex_unlock(&context->lock);
 
+	if (frags) {
+		net_buf_unref(frags);
+	}
+
 	return ret;
 }
 
@@ -1805,6 +2032,8 @@ enum net_verdict net_context_packet_received(struct net_conn *conn,
 					  net_pkt_appdatalen(pkt));
 	}
 
+	net_stats_update_rx_cycles(pkt, NET_STATS_LAYER_CONTEXT);
+
 	context->recv_cb(context, pkt, ip_hdr, proto_hdr, 0, user_data);
 
 #if defined(CONFIG_NET_CONTEXT_SYNC_RECV)
@@ -2082,6 +2311,53 @@ static int get_context_priority(struct net_context *context,
 #endif
 }
 
+static int set_context_buf_size(struct net_context *context,
+				const void *value, size_t len, bool recv)
+{
+#if defined(CONFIG_NET_TCP)
+	int size;
+
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP ||
+	    !context->tcp) {
+		return -ENOTSUP;
+	}
+
+	if (len != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	size = *((int *)value);
+	if (size < 0) {
+		return -EINVAL;
+	}
+
+	return net_tcp_set_buf_size(context->tcp, recv, size);
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int get_context_buf_size(struct net_context *context,
+				void *value, size_t *len, bool recv)
+{
+#if defined(CONFIG_NET_TCP)
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP ||
+	    !context->tcp) {
+		return -ENOTSUP;
+	}
+
+	*((int *)value) = net_tcp_get_buf_size(context->tcp, recv);
+
+	if (len) {
+		*len = sizeof(int);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 int net_context_set_option(struct net_context *context,
 			   enum net_context_option option,
 			   const void *value, size_t len)
@@ -2100,6 +2376,12 @@ int net_context_set_option(struct net_context *context,
 	case NET_OPT_PRIORITY:
 		ret = set_context_priority(context, value, len);
 		break;
+	case NET_OPT_RCVBUF:
+		ret = set_context_buf_size(context, value, len, true);
+		break;
+	case NET_OPT_SNDBUF:
+		ret = set_context_buf_size(context, value, len, false);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -2125,6 +2407,12 @@ int net_context_get_option(struct net_context *context,
 	case NET_OPT_PRIORITY:
 		ret = get_context_priority(context, value, len);
 		break;
+	case NET_OPT_RCVBUF:
+		ret = get_context_buf_size(context, value, len, true);
+		break;
+	case NET_OPT_SNDBUF:
+		ret = get_context_buf_size(context, value, len, false);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
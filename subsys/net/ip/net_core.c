@@ -109,6 +109,8 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 		}
 	}
 
+	net_stats_update_rx_cycles(pkt, NET_STATS_LAYER_L2);
+
 	ret = net_canbus_socket_input(pkt);
 	if (ret != NET_CONTINUE) {
 		return ret;
@@ -298,6 +300,8 @@ int net_send_data(struct net_pkt *pkt)
 		return -EINVAL;
 	}
 
+	net_stats_update_tx_cycles(pkt, NET_STATS_LAYER_CONTEXT);
+
 #if defined(CONFIG_NET_STATISTICS)
 	switch (net_pkt_family(pkt)) {
 	case AF_INET:
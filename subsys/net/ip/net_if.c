@@ -20,6 +20,7 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 
 #include "net_private.h"
 #include "ipv6.h"
+#include "ipv4.h"
 #include "ipv4_autoconf_internal.h"
 
 #include "net_stats.h"
@@ -152,6 +153,7 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 	struct net_linkaddr *dst;
 	struct net_context *context;
 	void *context_token;
+	u32_t stamp = 0U;
 	int status;
 
 	if (!pkt) {
@@ -171,7 +173,23 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 			net_pkt_set_queued(pkt, false);
 		}
 
+		if (IS_ENABLED(CONFIG_NET_STATISTICS_LAYER_CYCLES)) {
+			net_stats_update_tx_cycles(pkt, NET_STATS_LAYER_IP);
+
+			/* The packet can be gone after the send, and a
+			 * resent TCP segment is not accounted again.
+			 */
+			stamp = net_pkt_cycle_stamp(pkt);
+			net_pkt_set_cycle_stamp(pkt, 0U);
+		}
+
 		status = net_if_l2(iface)->send(iface, pkt);
+
+		if (stamp) {
+			net_stats_update_tx_layer_cycles(NET_STATS_LAYER_L2,
+							 k_cycle_get_32() -
+							 stamp);
+		}
 	} else {
 		/* Drop packet if interface is not up */
 		NET_WARN("iface %p is down", iface);
@@ -179,11 +197,10 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 	}
 
 	if (status < 0) {
-		if (IS_ENABLED(CONFIG_NET_TCP)
-		    && net_pkt_family(pkt) != AF_UNSPEC) {
-			net_pkt_set_sent(pkt, false);
-		}
-
+		/* A TCP segment keeps its sent flag: the reference taken for
+		 * this transmission is released here, so a retransmission
+		 * has to take a new one.
+		 */
 		net_pkt_unref(pkt);
 	} else {
 		net_stats_update_bytes_sent(iface, status);
@@ -281,6 +298,13 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4)
+	/* Fragment the packet if it does not fit into the MTU */
+	if (net_pkt_family(pkt) == AF_INET) {
+		verdict = net_ipv4_prepare_for_send(pkt);
+	}
+#endif
+
 #if defined(CONFIG_NET_IPV6)
 	/* If the ll dst address is not set check if it is present in the nbr
 	 * cache.
@@ -394,6 +394,10 @@ struct net_pkt *net_pkt_get_reserve(struct k_mem_slab *slab,
 	net_pkt_set_priority(pkt, CONFIG_NET_TX_DEFAULT_PRIORITY);
 	net_pkt_set_vlan_tag(pkt, NET_VLAN_TAG_UNSPEC);
 
+	if (IS_ENABLED(CONFIG_NET_STATISTICS_LAYER_CYCLES)) {
+		net_pkt_set_cycle_stamp(pkt, k_cycle_get_32());
+	}
+
 	net_pkt_alloc_add(pkt, true, caller, line);
 
 #if CONFIG_NET_PKT_LOG_LEVEL >= LOG_LEVEL_DBG
@@ -1725,7 +1729,16 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 	if (IS_ENABLED(CONFIG_NET_IPV6) && family == AF_INET6) {
 		max_len = MAX(max_len, NET_IPV6_MTU);
 	} else if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
-		max_len = MAX(max_len, NET_IPV4_MTU);
+		if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) &&
+		    proto != IPPROTO_TCP) {
+			/* Larger UDP or raw packets than the MTU get
+			 * fragmented when sent, the only limit is the IPv4
+			 * total length. TCP segments stay within the MTU.
+			 */
+			max_len = 0xffff;
+		} else {
+			max_len = MAX(max_len, NET_IPV4_MTU);
+		}
 	} else { /* family == AF_UNSPEC */
 #if defined (CONFIG_NET_L2_ETHERNET)
 		if (net_if_l2(net_pkt_iface(pkt)) ==
@@ -1948,6 +1961,10 @@ static struct net_pkt *pkt_alloc(struct k_mem_slab *slab, s32_t timeout)
 	net_pkt_set_priority(pkt, CONFIG_NET_TX_DEFAULT_PRIORITY);
 	net_pkt_set_vlan_tag(pkt, NET_VLAN_TAG_UNSPEC);
 
+	if (IS_ENABLED(CONFIG_NET_STATISTICS_LAYER_CYCLES)) {
+		net_pkt_set_cycle_stamp(pkt, k_cycle_get_32());
+	}
+
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 	net_pkt_alloc_add(pkt, true, caller, line);
 #endif
@@ -2162,6 +2179,33 @@ void net_pkt_append_buffer(struct net_pkt *pkt, struct net_buf *buffer)
 	}
 }
 
+struct net_buf *net_pkt_detach_buffer(struct net_pkt *pkt)
+{
+	struct net_buf *buf = pkt->cursor.buf;
+	u8_t *pos = pkt->cursor.pos;
+
+	/* Release what is before the cursor, all of it if the cursor
+	 * reached the end.
+	 */
+	while (pkt->buffer && pkt->buffer != buf) {
+		pkt->buffer = net_buf_frag_del(NULL, pkt->buffer);
+	}
+
+	pkt->buffer = NULL;
+	net_pkt_cursor_init(pkt);
+
+	if (!buf) {
+		return NULL;
+	}
+
+	net_buf_pull(buf, pos - buf->data);
+	if (!buf->len) {
+		buf = net_buf_frag_del(NULL, buf);
+	}
+
+	return buf;
+}
+
 void net_pkt_cursor_init(struct net_pkt *pkt)
 {
 	pkt->cursor.buf = pkt->buffer;
@@ -2231,10 +2275,11 @@ static void pkt_cursor_update(struct net_pkt *pkt,
 /* Internal function that does all operation (skip/read/write/memset) */
 static int net_pkt_cursor_operate(struct net_pkt *pkt,
 				  void *data, size_t length,
-				  bool copy, bool write)
+				  bool copy, bool write, u16_t *chksum)
 {
 	/* We use such variable to avoid lengthy lines */
 	struct net_pkt_cursor *c_op = &pkt->cursor;
+	bool odd = false;
 
 	while (c_op->buf && length) {
 		size_t d_len, len;
@@ -2261,7 +2306,11 @@ static int net_pkt_cursor_operate(struct net_pkt *pkt,
 			len = d_len;
 		}
 
-		if (copy) {
+		if (chksum) {
+			*chksum = net_calc_chksum_copy(*chksum, c_op->pos,
+						       data, len, odd);
+			odd ^= len & 1;
+		} else if (copy) {
 			memcpy(write ? c_op->pos : data,
 			       write ? data : c_op->pos,
 			       len);
@@ -2294,21 +2343,21 @@ int net_pkt_skip(struct net_pkt *pkt, size_t skip)
 {
 	NET_DBG("pkt %p skip %zu", pkt, skip);
 
-	return net_pkt_cursor_operate(pkt, NULL, skip, false, true);
+	return net_pkt_cursor_operate(pkt, NULL, skip, false, true, NULL);
 }
 
 int net_pkt_memset(struct net_pkt *pkt, int byte, size_t amount)
 {
 	NET_DBG("pkt %p byte %d amount %zu", pkt, byte, amount);
 
-	return net_pkt_cursor_operate(pkt, &byte, amount, false, true);
+	return net_pkt_cursor_operate(pkt, &byte, amount, false, true, NULL);
 }
 
 int net_pkt_read_new(struct net_pkt *pkt, void *data, size_t length)
 {
 	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
 
-	return net_pkt_cursor_operate(pkt, data, length, true, false);
+	return net_pkt_cursor_operate(pkt, data, length, true, false, NULL);
 }
 
 int net_pkt_read_be16_new(struct net_pkt *pkt, u16_t *data)
@@ -2343,7 +2392,17 @@ int net_pkt_write_new(struct net_pkt *pkt, const void *data, size_t length)
 		return net_pkt_skip(pkt, length);
 	}
 
-	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true);
+	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true,
+				      NULL);
+}
+
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data,
+			 size_t length, u16_t *chksum)
+{
+	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
+
+	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true,
+				      chksum);
 }
 
 int net_pkt_copy(struct net_pkt *pkt_dst,
@@ -2504,7 +2563,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 	net_pkt_cursor_backup(pkt, &backup);
 
 	while (length) {
-		u8_t left, rem;
+		size_t left, rem;
 
 		pkt_cursor_advance(pkt, false);
 
@@ -2521,7 +2580,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 		c_op->buf->len -= rem;
 		left -= rem;
 		if (left) {
-			memmove(c_op->pos, c_op->pos+rem, rem);
+			memmove(c_op->pos, c_op->pos+rem, left);
 		}
 
 		/* For now, empty buffer are not freed, and there is no
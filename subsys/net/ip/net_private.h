@@ -87,6 +87,16 @@ extern char *net_sprint_ll_addr_buf(const u8_t *ll, u8_t ll_len,
 				    char *buf, int buflen);
 extern u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto);
 
+/* Add the ones' complement sum of data, as big endian 16-bit words, to sum.
+ * Set odd if data continues a sum of an odd number of bytes.
+ */
+extern u16_t net_calc_chksum_data(u16_t sum, const void *data, size_t len,
+				  bool odd);
+
+/* Like net_calc_chksum_data(), also copying the data from src to dst */
+extern u16_t net_calc_chksum_copy(u16_t sum, void *dst, const void *src,
+				  size_t len, bool odd);
+
 enum net_verdict net_context_packet_received(struct net_conn *conn,
 					     struct net_pkt *pkt,
 					     union net_ip_header *ip_hdr,
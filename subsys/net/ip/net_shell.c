@@ -33,6 +33,8 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #endif
 
 #include "ipv6.h"
+#include "ipv4.h"
+#include "reassembly.h"
 
 #if defined(CONFIG_NET_ARP)
 #include "ethernet/arp.h"
@@ -1025,8 +1027,41 @@ static void tcp_sent_list_cb(struct net_tcp *tcp, void *user_data)
 #endif /* CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG */
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static void ipv4_frag_cb(struct net_reassembly *reass,
+			 void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int *count = data->user_data;
+	char src[ADDR_LEN];
+	int i;
+
+	if (!*count) {
+		PR("\nIPv4 reassembly Id     Remain Src             \tDst\n");
+	}
+
+	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv4_addr(&reass->src.in_addr));
+
+	PR("%p      0x%04x  %5d %16s\t%16s\n",
+	   reass, reass->id,
+	   k_delayed_work_remaining_get(&reass->timer),
+	   src, net_sprint_ipv4_addr(&reass->dst.in_addr));
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		if (reass->pkt[i]) {
+			PR("[%d] pkt %p offset %u len %zd\n", i, reass->pkt[i],
+			   net_pkt_ipv4_fragment_offset(reass->pkt[i]),
+			   net_pkt_get_len(reass->pkt[i]));
+		}
+	}
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
-static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
+static void ipv6_frag_cb(struct net_reassembly *reass,
 			 void *user_data)
 {
 	struct net_shell_user_data *data = user_data;
@@ -1040,12 +1075,12 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 		   "Src             \tDst\n");
 	}
 
-	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv6_addr(&reass->src));
+	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv6_addr(&reass->src.in6_addr));
 
 	PR("%p      0x%08x  %5d %16s\t%16s\n",
 	   reass, reass->id,
 	   k_delayed_work_remaining_get(&reass->timer),
-	   src, net_sprint_ipv6_addr(&reass->dst));
+	   src, net_sprint_ipv6_addr(&reass->dst.in6_addr));
 
 	for (i = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
 		if (reass->pkt[i]) {
@@ -1282,10 +1317,16 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	count = 0;
+
+	net_reassembly_foreach(AF_INET, ipv4_frag_cb, &user_data);
+#endif
+
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 	count = 0;
 
-	net_ipv6_frag_foreach(ipv6_frag_cb, &user_data);
+	net_reassembly_foreach(AF_INET6, ipv6_frag_cb, &user_data);
 
 	/* Do not print anything if no fragments are pending atm */
 #endif
@@ -12,6 +12,8 @@
 #include <net/net_ip.h>
 #include <net/net_stats.h>
 #include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_context.h>
 
 extern struct net_stats net_stats;
 
@@ -351,6 +353,77 @@ static inline void net_stats_update_tc_recv_priority(struct net_if *iface,
 #define net_stats_update_tc_recv_priority(iface, tc, priority)
 #endif /* NET_TC_COUNT > 1 */
 
+#if defined(CONFIG_NET_STATISTICS_LAYER_CYCLES)
+/* Layer cycles are only kept globally as a packet can change interface
+ * on its way through the stack.
+ */
+static inline void net_stats_update_tx_layer_cycles(enum net_stats_layer layer,
+						    u32_t cycles)
+{
+	UPDATE_STAT_GLOBAL(stats.layer_cycles.tx[layer] += cycles);
+}
+
+static inline void net_stats_update_rx_layer_cycles(enum net_stats_layer layer,
+						    u32_t cycles)
+{
+	UPDATE_STAT_GLOBAL(stats.layer_cycles.rx[layer] += cycles);
+}
+
+/* Account the cycles since the packet left the previous layer to the
+ * given layer.
+ */
+static inline void net_stats_update_tx_cycles(struct net_pkt *pkt,
+					      enum net_stats_layer layer)
+{
+	u32_t stamp = net_pkt_cycle_stamp(pkt);
+	u32_t now = k_cycle_get_32();
+
+	if (stamp) {
+		net_stats_update_tx_layer_cycles(layer, now - stamp);
+	}
+
+	net_pkt_set_cycle_stamp(pkt, now);
+}
+
+static inline void net_stats_update_rx_cycles(struct net_pkt *pkt,
+					      enum net_stats_layer layer)
+{
+	u32_t stamp = net_pkt_cycle_stamp(pkt);
+	u32_t now = k_cycle_get_32();
+
+	if (stamp) {
+		net_stats_update_rx_layer_cycles(layer, now - stamp);
+	}
+
+	net_pkt_set_cycle_stamp(pkt, now);
+}
+
+/* The socket layer runs before the packet to send is allocated, so the
+ * context holds the stamp until then.
+ */
+static inline void net_stats_start_tx_cycles(struct net_context *context)
+{
+	context->cycle_stamp = k_cycle_get_32();
+}
+
+static inline void net_stats_update_tx_socket_cycles(struct net_context *context)
+{
+	if (context->cycle_stamp) {
+		net_stats_update_tx_layer_cycles(NET_STATS_LAYER_SOCKET,
+						 k_cycle_get_32() -
+						 context->cycle_stamp);
+		context->cycle_stamp = 0U;
+	}
+}
+#else
+#define net_stats_update_tx_layer_cycles(layer, cycles)
+#define net_stats_update_rx_layer_cycles(layer, cycles)
+#define net_stats_update_tx_cycles(pkt, layer)
+#define net_stats_update_rx_cycles(pkt, layer)
+#define net_stats_start_tx_cycles(context)
+#define net_stats_update_tx_socket_cycles(context)
+#endif /* CONFIG_NET_STATISTICS_LAYER_CYCLES */
+
 #if defined(CONFIG_NET_STATISTICS_PERIODIC_OUTPUT)
 /* A simple periodic statistic printer, used only in net core */
 void net_print_statistics_all(void);
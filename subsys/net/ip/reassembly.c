@@ -0,0 +1,396 @@
+/** @file
+ * @brief IP fragment reassembly shared by IPv4 and IPv6
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_reassembly, CONFIG_NET_REASSEMBLY_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include "net_private.h"
+#include "reassembly.h"
+
+/* Reassembly slots of one address family */
+struct reassembly_table {
+	struct net_reassembly *slots;
+	u8_t count;
+	u8_t max_pkt;
+	s32_t timeout;
+	bool init_done;
+};
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static struct net_reassembly
+ipv4_slots[CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT];
+
+static struct reassembly_table ipv4_table = {
+	.slots = ipv4_slots,
+	.count = ARRAY_SIZE(ipv4_slots),
+	.max_pkt = NET_IPV4_FRAGMENTS_MAX_PKT,
+	.timeout = K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT),
+};
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+static struct net_reassembly
+ipv6_slots[CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT];
+
+static struct reassembly_table ipv6_table = {
+	.slots = ipv6_slots,
+	.count = ARRAY_SIZE(ipv6_slots),
+	.max_pkt = NET_IPV6_FRAGMENTS_MAX_PKT,
+	.timeout = K_SECONDS(CONFIG_NET_IPV6_FRAGMENT_TIMEOUT),
+};
+#endif /* CONFIG_NET_IPV6_FRAGMENT */
+
+static void reassembly_timeout(struct k_work *work);
+
+static struct reassembly_table *table_get(sa_family_t family)
+{
+	struct reassembly_table *table = NULL;
+	int i;
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	if (family == AF_INET) {
+		table = &ipv4_table;
+	}
+#endif
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+	if (family == AF_INET6) {
+		table = &ipv6_table;
+	}
+#endif
+
+	if (table && !table->init_done) {
+		/* Static initializing does not work here because of the array
+		 * so we must do it at runtime.
+		 */
+		for (i = 0; i < table->count; i++) {
+			k_delayed_work_init(&table->slots[i].timer,
+					    reassembly_timeout);
+		}
+
+		table->init_done = true;
+	}
+
+	return table;
+}
+
+static void *addr_get(struct net_addr *addr)
+{
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	if (addr->family == AF_INET) {
+		return &addr->in_addr;
+	}
+#endif
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+	if (addr->family == AF_INET6) {
+		return &addr->in6_addr;
+	}
+#endif
+
+	return NULL;
+}
+
+static size_t addr_len(sa_family_t family)
+{
+	return family == AF_INET6 ? sizeof(struct in6_addr) :
+				    sizeof(struct in_addr);
+}
+
+static u16_t fragment_offset(sa_family_t family, struct net_pkt *pkt)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT) && family == AF_INET6) {
+		return net_pkt_ipv6_fragment_offset(pkt);
+	}
+
+	return net_pkt_ipv4_fragment_offset(pkt);
+}
+
+static bool fragment_more(sa_family_t family, struct net_pkt *pkt)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT) && family == AF_INET6) {
+		return net_pkt_ipv6_fragment_more(pkt);
+	}
+
+	return net_pkt_ipv4_fragment_more(pkt);
+}
+
+/* Length of the headers in front of the fragment payload */
+static u16_t fragment_hdr_len(sa_family_t family, struct net_pkt *pkt)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT) && family == AF_INET6) {
+		return net_pkt_ipv6_fragment_start(pkt) +
+			sizeof(struct net_ipv6_frag_hdr);
+	}
+
+	return net_pkt_ip_hdr_len(pkt);
+}
+
+static u16_t fragment_payload_len(sa_family_t family, struct net_pkt *pkt)
+{
+	return net_pkt_get_len(pkt) - fragment_hdr_len(family, pkt);
+}
+
+struct net_reassembly *net_reassembly_get(sa_family_t family, u32_t id,
+					  const void *src, const void *dst,
+					  u8_t proto)
+{
+	struct reassembly_table *table = table_get(family);
+	struct net_reassembly *reass;
+	int i, avail = -1;
+
+	if (!table) {
+		return NULL;
+	}
+
+	for (i = 0; i < table->count; i++) {
+		reass = &table->slots[i];
+
+		if (!k_delayed_work_remaining_get(&reass->timer)) {
+			if (avail < 0) {
+				avail = i;
+			}
+
+			continue;
+		}
+
+		if (reass->id == id && reass->proto == proto &&
+		    !memcmp(addr_get(&reass->src), src, addr_len(family)) &&
+		    !memcmp(addr_get(&reass->dst), dst, addr_len(family))) {
+			return reass;
+		}
+	}
+
+	if (avail < 0) {
+		return NULL;
+	}
+
+	reass = &table->slots[avail];
+
+	k_delayed_work_submit(&reass->timer, table->timeout);
+
+	reass->src.family = family;
+	reass->dst.family = family;
+	memcpy(addr_get(&reass->src), src, addr_len(family));
+	memcpy(addr_get(&reass->dst), dst, addr_len(family));
+
+	reass->id = id;
+	reass->proto = proto;
+
+	return reass;
+}
+
+void net_reassembly_cancel(struct net_reassembly *reass)
+{
+	int i;
+
+	NET_DBG("Cancel 0x%x", reass->id);
+
+	k_delayed_work_cancel(&reass->timer);
+
+	for (i = 0; i < NET_REASSEMBLY_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			continue;
+		}
+
+		NET_DBG("[%d] reassembly pkt %p %zd bytes data",
+			i, reass->pkt[i], net_pkt_get_len(reass->pkt[i]));
+
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+}
+
+static void reassembly_info(char *str, struct net_reassembly *reass)
+{
+	sa_family_t family = reass->src.family;
+	int i, len;
+
+	for (i = 0, len = 0; i < NET_REASSEMBLY_MAX_PKT; i++) {
+		if (reass->pkt[i]) {
+			len += fragment_payload_len(family, reass->pkt[i]);
+		}
+	}
+
+	NET_DBG("%s id 0x%x src %s dst %s remain %d ms len %d", str, reass->id,
+		log_strdup(net_sprint_addr(family, addr_get(&reass->src))),
+		log_strdup(net_sprint_addr(family, addr_get(&reass->dst))),
+		k_delayed_work_remaining_get(&reass->timer), len);
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct net_reassembly *reass =
+		CONTAINER_OF(work, struct net_reassembly, timer);
+
+	reassembly_info("Reassembly cancelled", reass);
+
+	net_reassembly_cancel(reass);
+}
+
+/* Check whether the sorted fragments cover the whole packet.
+ * Return 1 if so, 0 if some fragments are still missing and a negative
+ * value if the fragments overlap.
+ */
+static int fragments_complete(struct net_reassembly *reass, int max_pkt)
+{
+	sa_family_t family = reass->src.family;
+	u32_t expected = 0U;
+	u16_t offset;
+	int i;
+
+	for (i = 0; i < max_pkt && reass->pkt[i]; i++) {
+		offset = fragment_offset(family, reass->pkt[i]);
+
+		NET_DBG("pkt %p offset %u expected %u", reass->pkt[i],
+			offset, expected);
+
+		if (offset > expected) {
+			return 0;
+		}
+
+		if (offset < expected) {
+			return -EINVAL;
+		}
+
+		expected += fragment_payload_len(family, reass->pkt[i]);
+
+		if (!fragment_more(family, reass->pkt[i])) {
+			/* Nothing can follow the last fragment */
+			if (i + 1 < max_pkt && reass->pkt[i + 1]) {
+				return -EINVAL;
+			}
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int net_reassembly_add(struct net_reassembly *reass, struct net_pkt *pkt)
+{
+	sa_family_t family = reass->src.family;
+	int max_pkt = table_get(family)->max_pkt;
+	u16_t offset = fragment_offset(family, pkt);
+	int i, ret;
+
+	if (reass->pkt[max_pkt - 1]) {
+		/* We could not add this fragment into our saved fragment
+		 * list. We must discard the whole packet at this point.
+		 */
+		NET_DBG("No slots available for 0x%x", reass->id);
+		net_reassembly_cancel(reass);
+		return -ENOMEM;
+	}
+
+	/* The fragments might come in wrong order so place them
+	 * in reassembly chain in correct order.
+	 */
+	for (i = 0; i < max_pkt && reass->pkt[i]; i++) {
+		u16_t pos = fragment_offset(family, reass->pkt[i]);
+
+		if (pos == offset) {
+			NET_DBG("Duplicate fragment offset 0x%x", offset);
+			return -EEXIST;
+		}
+
+		if (pos > offset) {
+			break;
+		}
+	}
+
+	memmove(&reass->pkt[i + 1], &reass->pkt[i],
+		sizeof(void *) * (max_pkt - i - 1));
+
+	NET_DBG("Storing pkt %p to slot %d offset 0x%x", pkt, i, offset);
+	reass->pkt[i] = pkt;
+
+	ret = fragments_complete(reass, max_pkt);
+	if (ret < 0) {
+		/* The caller drops this fragment, the others go with the
+		 * reassembly.
+		 */
+		memmove(&reass->pkt[i], &reass->pkt[i + 1],
+			sizeof(void *) * (max_pkt - i - 1));
+		reass->pkt[max_pkt - 1] = NULL;
+
+		NET_DBG("Overlapping fragments, dropping id 0x%x", reass->id);
+		net_reassembly_cancel(reass);
+		return ret;
+	}
+
+	if (ret == 0) {
+		reassembly_info("Reassembly nth pkt", reass);
+	} else {
+		reassembly_info("Reassembly last pkt", reass);
+	}
+
+	return ret;
+}
+
+struct net_pkt *net_reassembly_chain(struct net_reassembly *reass)
+{
+	sa_family_t family = reass->src.family;
+	struct net_pkt *pkt;
+	struct net_buf *last;
+	int i;
+
+	k_delayed_work_cancel(&reass->timer);
+
+	NET_ASSERT(reass->pkt[0]);
+
+	last = net_buf_frag_last(reass->pkt[0]->buffer);
+
+	/* The payload of the other fragments is appended to the first one,
+	 * which keeps its headers.
+	 */
+	for (i = 1; i < NET_REASSEMBLY_MAX_PKT && reass->pkt[i]; i++) {
+		pkt = reass->pkt[i];
+
+		net_pkt_cursor_init(pkt);
+
+		if (net_pkt_pull(pkt, fragment_hdr_len(family, pkt))) {
+			NET_ERR("Failed to pull headers");
+			net_reassembly_cancel(reass);
+			return NULL;
+		}
+
+		last->frags = pkt->buffer;
+		last = net_buf_frag_last(pkt->buffer);
+
+		pkt->buffer = NULL;
+		reass->pkt[i] = NULL;
+
+		net_pkt_unref(pkt);
+	}
+
+	pkt = reass->pkt[0];
+	reass->pkt[0] = NULL;
+
+	return pkt;
+}
+
+void net_reassembly_foreach(sa_family_t family, net_reassembly_cb_t cb,
+			    void *user_data)
+{
+	struct reassembly_table *table = table_get(family);
+	int i;
+
+	for (i = 0; table && i < table->count; i++) {
+		if (!k_delayed_work_remaining_get(&table->slots[i].timer)) {
+			continue;
+		}
+
+		cb(&table->slots[i], user_data);
+	}
+}
@@ -0,0 +1,121 @@
+/** @file
+ @brief IP fragment reassembly shared by IPv4 and IPv6
+
+ This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __REASSEMBLY_H
+#define __REASSEMBLY_H
+
+#include <zephyr/types.h>
+#include <kernel.h>
+
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+
+#include "ipv4.h"
+#include "ipv6.h"
+
+#define NET_REASSEMBLY_MAX_PKT MAX(NET_IPV4_FRAGMENTS_MAX_PKT, \
+				   NET_IPV6_FRAGMENTS_MAX_PKT)
+
+/** Store pending IP fragment information that is needed for reassembly. */
+struct net_reassembly {
+	/** Source address of the fragment, its family tells which table
+	 * the reassembly belongs to.
+	 */
+	struct net_addr src;
+
+	/** Destination address of the fragment */
+	struct net_addr dst;
+
+	/**
+	 * Timeout for cancelling the reassembly. The timer is used
+	 * also to detect if this reassembly slot is used or not.
+	 */
+	struct k_delayed_work timer;
+
+	/** Pointers to pending fragments, sorted by fragment offset */
+	struct net_pkt *pkt[NET_REASSEMBLY_MAX_PKT];
+
+	/** Fragment identification */
+	u32_t id;
+
+	/** Upper layer protocol, only part of the key for IPv4 */
+	u8_t proto;
+};
+
+/**
+ * @typedef net_reassembly_cb_t
+ * @brief Callback used while iterating over pending reassemblies.
+ *
+ * @param reass Fragment reassembly struct
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*net_reassembly_cb_t)(struct net_reassembly *reass,
+				    void *user_data);
+
+/**
+ * @brief Find the reassembly of a fragment, or start a new one.
+ *
+ * @param family AF_INET or AF_INET6
+ * @param id Fragment identification
+ * @param src Source address of the fragment
+ * @param dst Destination address of the fragment
+ * @param proto Upper layer protocol of the fragment
+ *
+ * @return Reassembly struct, NULL if all the slots are in use.
+ */
+struct net_reassembly *net_reassembly_get(sa_family_t family, u32_t id,
+					  const void *src, const void *dst,
+					  u8_t proto);
+
+/**
+ * @brief Queue a fragment for reassembly. The fragment offset, the more
+ * fragments flag and the header length of the fragment must be set in
+ * the packet.
+ *
+ * @param reass Reassembly struct
+ * @param pkt Fragment
+ *
+ * @return 1 if all the fragments have been received, 0 if more fragments
+ * are needed, a negative errno if the fragment was not queued. The
+ * reassembly is cancelled if the fragments overlap or do not fit.
+ */
+int net_reassembly_add(struct net_reassembly *reass, struct net_pkt *pkt);
+
+/**
+ * @brief Link the payload of the received fragments after the first
+ * fragment and release the reassembly slot. The first fragment keeps
+ * its headers, fixing them is left to the caller.
+ *
+ * @param reass Reassembly struct, all the fragments must be received.
+ *
+ * @return Reassembled packet, NULL if it could not be built.
+ */
+struct net_pkt *net_reassembly_chain(struct net_reassembly *reass);
+
+/**
+ * @brief Cancel a reassembly and release its fragments.
+ *
+ * @param reass Reassembly struct
+ */
+void net_reassembly_cancel(struct net_reassembly *reass);
+
+/**
+ * @brief Go through all the currently pending reassemblies of a family.
+ *
+ * @param family AF_INET or AF_INET6
+ * @param cb Callback to call for each pending reassembly.
+ * @param user_data User specified data or NULL.
+ */
+void net_reassembly_foreach(sa_family_t family, net_reassembly_cb_t cb,
+			    void *user_data);
+
+#endif /* __REASSEMBLY_H */
@@ -36,7 +36,255 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
+
+/* The routes are indexed by a path compressed binary trie over their
+ * prefixes, so that a lookup visits at most one node per distinct prefix
+ * length on the path to the destination. Every node without routes has
+ * two children, which bounds the number of nodes to twice the number of
+ * routes.
+ */
+struct route_trie_node {
+	struct route_trie_node *child[2];
+
+	/* Routes to this prefix, linked by trie_next */
+	struct net_route_entry *routes;
+
+	struct in6_addr prefix;
+	u8_t prefix_len;
+};
+
+static struct route_trie_node trie_nodes[2 * CONFIG_NET_MAX_ROUTES];
+static struct route_trie_node *trie_free;
+static struct route_trie_node *trie_root;
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+/* Recent lookups, flushed whenever a route is added or deleted */
+struct route_cache_entry {
+	struct in6_addr dst;
+	struct net_if *iface;
+	struct net_route_entry *route;
+};
+
+static struct route_cache_entry route_cache[CONFIG_NET_ROUTE_CACHE_SIZE];
+
+static inline struct route_cache_entry *route_cache_slot(struct in6_addr *dst)
+{
+	return &route_cache[UNALIGNED_GET(&dst->s6_addr32[3]) %
+			    CONFIG_NET_ROUTE_CACHE_SIZE];
+}
+
+static struct net_route_entry *route_cache_get(struct net_if *iface,
+					       struct in6_addr *dst)
+{
+	struct route_cache_entry *entry = route_cache_slot(dst);
+
+	if (entry->route && entry->iface == iface &&
+	    net_ipv6_addr_cmp(&entry->dst, dst)) {
+		return entry->route;
+	}
+
+	return NULL;
+}
+
+static void route_cache_put(struct net_if *iface, struct in6_addr *dst,
+			    struct net_route_entry *route)
+{
+	struct route_cache_entry *entry = route_cache_slot(dst);
+
+	net_ipaddr_copy(&entry->dst, dst);
+	entry->iface = iface;
+	entry->route = route;
+}
+
+static inline void route_cache_flush(void)
+{
+	(void)memset(route_cache, 0, sizeof(route_cache));
+}
+#else
+#define route_cache_get(iface, dst) NULL
+#define route_cache_put(iface, dst, route)
+#define route_cache_flush()
+#endif /* CONFIG_NET_ROUTE_CACHE_SIZE > 0 */
+
+static inline int trie_bit(const struct in6_addr *addr, u8_t pos)
+{
+	return (addr->s6_addr[pos / 8] >> (7 - pos % 8)) & 1;
+}
+
+/* Number of leading bits that are the same in both addresses, at most
+ * max_len.
+ */
+static u8_t trie_common_len(const struct in6_addr *addr1,
+			    const struct in6_addr *addr2, u8_t max_len)
+{
+	u8_t len = 0U;
+	int i;
+
+	for (i = 0; i < 16 && len < max_len; i++) {
+		u8_t diff = addr1->s6_addr[i] ^ addr2->s6_addr[i];
+
+		if (diff) {
+			len += __builtin_clz(diff) - (32 - 8);
+			break;
+		}
+
+		len += 8;
+	}
+
+	return MIN(len, max_len);
+}
+
+static struct route_trie_node *trie_node_alloc(const struct in6_addr *prefix,
+					       u8_t prefix_len)
+{
+	struct route_trie_node *node = trie_free;
+
+	NET_ASSERT_INFO(node, "Route trie exhausted");
+
+	trie_free = node->child[0];
+
+	node->child[0] = NULL;
+	node->child[1] = NULL;
+	node->routes = NULL;
+	net_ipaddr_copy(&node->prefix, prefix);
+	node->prefix_len = prefix_len;
+
+	return node;
+}
+
+static void trie_node_free(struct route_trie_node *node)
+{
+	node->child[0] = trie_free;
+	trie_free = node;
+}
+
+static void trie_insert(struct net_route_entry *route)
+{
+	struct route_trie_node **link = &trie_root;
+	struct route_trie_node *node, *parent;
+	u8_t len = route->prefix_len;
+	u8_t common;
+
+	while (*link) {
+		node = *link;
+		common = trie_common_len(&route->addr, &node->prefix,
+					 MIN(len, node->prefix_len));
+
+		if (common < node->prefix_len) {
+			/* The new prefix branches off above this node */
+			if (common == len) {
+				parent = trie_node_alloc(&route->addr, len);
+				parent->child[trie_bit(&node->prefix, len)] =
+					node;
+				*link = parent;
+				node = parent;
+			} else {
+				parent = trie_node_alloc(&route->addr, common);
+				parent->child[trie_bit(&node->prefix, common)] =
+					node;
+				*link = parent;
+
+				node = trie_node_alloc(&route->addr, len);
+				parent->child[trie_bit(&route->addr, common)] =
+					node;
+			}
+
+			goto attach;
+		}
+
+		if (node->prefix_len == len) {
+			goto attach;
+		}
+
+		link = &node->child[trie_bit(&route->addr, node->prefix_len)];
+	}
+
+	node = trie_node_alloc(&route->addr, len);
+	*link = node;
+
+attach:
+	route->trie_next = node->routes;
+	node->routes = route;
+}
+
+/* Drop a node that no longer has routes unless it still joins two
+ * subtries.
+ */
+static void trie_prune(struct route_trie_node **link)
+{
+	struct route_trie_node *node = *link;
+
+	if (node->routes || (node->child[0] && node->child[1])) {
+		return;
+	}
+
+	*link = node->child[0] ? node->child[0] : node->child[1];
+	trie_node_free(node);
+}
+
+static void trie_remove(struct net_route_entry *route)
+{
+	struct route_trie_node **link = &trie_root, **parent_link = NULL;
+	struct net_route_entry **prev;
+	struct route_trie_node *node;
+
+	while ((node = *link) && node->prefix_len < route->prefix_len) {
+		parent_link = link;
+		link = &node->child[trie_bit(&route->addr, node->prefix_len)];
+	}
+
+	if (!node || node->prefix_len != route->prefix_len) {
+		return;
+	}
+
+	for (prev = &node->routes; *prev; prev = &(*prev)->trie_next) {
+		if (*prev == route) {
+			*prev = route->trie_next;
+			break;
+		}
+	}
+
+	trie_prune(link);
+
+	if (parent_link) {
+		trie_prune(parent_link);
+	}
+}
+
+/* Longest prefix match. With exact set, only a route to the same prefix
+ * is returned.
+ */
+static struct net_route_entry *trie_lookup(struct net_if *iface,
+					   struct in6_addr *dst,
+					   u8_t len, bool exact)
+{
+	struct route_trie_node *node = trie_root;
+	struct net_route_entry *found = NULL;
+	struct net_route_entry *route;
+
+	while (node && node->prefix_len <= len &&
+	       net_ipv6_is_prefix((u8_t *)dst, (u8_t *)&node->prefix,
+				  node->prefix_len)) {
+		if (!exact || node->prefix_len == len) {
+			for (route = node->routes; route;
+			     route = route->trie_next) {
+				if (!iface || route->iface == iface) {
+					found = route;
+					break;
+				}
+			}
+		}
+
+		if (node->prefix_len == 128) {
+			break;
+		}
+
+		node = node->child[trie_bit(dst, node->prefix_len)];
+	}
+
+	return found;
+}
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -252,36 +500,20 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
 }
 
 struct net_route_entry *net_route_lookup(struct net_if *iface,
 					 struct in6_addr *dst)
 {
-	struct net_route_entry *route, *found = NULL;
-	u8_t longest_match = 0U;
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
-		struct net_nbr *nbr = get_nbr(i);
-
-		if (!nbr->ref) {
-			continue;
-		}
-
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
-
-		route = net_route_data(nbr);
+	struct net_route_entry *found;
 
-		if (route->prefix_len >= longest_match &&
-		    net_ipv6_is_prefix((u8_t *)dst,
-				       (u8_t *)&route->addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
+	found = route_cache_get(iface, dst);
+	if (!found) {
+		found = trie_lookup(iface, dst, 128, false);
+		if (found) {
+			route_cache_put(iface, dst, found);
 		}
 	}
 
@@ -332,7 +564,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 		log_strdup(net_sprint_ll_addr(nexthop_lladdr->addr,
 					      nexthop_lladdr->len)));
 
-	route = net_route_lookup(iface, addr);
+	route = trie_lookup(iface, addr, prefix_len, true);
 	if (route) {
 		/* Update nexthop if not the same */
 		struct in6_addr *nexthop_addr;
@@ -352,9 +584,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -400,7 +630,10 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_prepend(&routes, &route->node);
+
+	trie_insert(route);
+	route_cache_flush();
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -453,7 +686,11 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
+	if (sys_dnode_is_linked(&route->node)) {
+		sys_dlist_remove(&route->node);
+		trie_remove(route);
+		route_cache_flush();
+	}
 
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
@@ -826,6 +1063,12 @@ int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop)
 
 void net_route_init(void)
 {
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(trie_nodes); i++) {
+		trie_node_free(&trie_nodes[i]);
+	}
+
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
 		CONFIG_NET_MAX_ROUTES, sizeof(net_route_entries_pool));
 
@@ -15,6 +15,7 @@
 
 #include <kernel.h>
 #include <misc/slist.h>
+#include <misc/dlist.h>
 
 #include <net/net_ip.h>
 
@@ -46,7 +47,10 @@ struct net_route_entry {
 	 * we can remove it if we run out of available routes.
 	 * The oldest one is the last entry in the list.
 	 */
-	sys_snode_t node;
+	sys_dnode_t node;
+
+	/** Next route with the same prefix, on another interface. */
+	struct net_route_entry *trie_next;
 
 	/** List of neighbors that the routes go through. */
 	sys_slist_t nexthop;
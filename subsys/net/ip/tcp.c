@@ -52,8 +52,18 @@ static struct tcp_backlog_entry {
 	struct k_delayed_work ack_timer;
 	struct sockaddr remote;
 	u16_t send_mss;
+	u8_t recv_wscale;
+	u8_t send_wscale;
+	bool sack_permitted;
+	bool wscale_ok;
 } tcp_backlog[CONFIG_NET_TCP_BACKLOG_SIZE];
 
+#if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+#define RX_DATA_POOL_SIZE (CONFIG_NET_BUF_RX_COUNT * CONFIG_NET_BUF_DATA_SIZE)
+#else
+#define RX_DATA_POOL_SIZE CONFIG_NET_BUF_DATA_POOL_SIZE
+#endif
+
 #if defined(CONFIG_NET_TCP_ACK_TIMEOUT)
 #define ACK_TIMEOUT CONFIG_NET_TCP_ACK_TIMEOUT
 #else
@@ -161,10 +171,20 @@ static void net_tcp_trace(struct net_pkt *pkt,
 		ntohs(tcp_hdr->chksum));
 }
 
+/* Upper bound of the RTO, RFC 6298 allows 60 seconds or more */
+#define NET_TCP_MAX_RETRANSMISSION_TIMEOUT 60000
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+/* Duplicate ACKs that trigger a fast retransmit (RFC 5681) */
+#define NET_TCP_DUP_ACK_THRESHOLD 3
+
+/* Largest value the dup_acks counter can hold */
+#define NET_TCP_MAX_DUP_ACKS 15
+#endif
+
 static inline u32_t retry_timeout(const struct net_tcp *tcp)
 {
-	return ((u32_t)1 << tcp->retry_timeout_shift) *
-				CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
+	return ((u32_t)1 << tcp->retry_timeout_shift) * tcp->rto;
 }
 
 #define is_6lo_technology(pkt)						\
@@ -193,6 +213,350 @@ static inline u32_t retry_timeout(const struct net_tcp *tcp)
 		}							\
 	} while (0)
 
+/* Sequence number of the first byte of a queued segment */
+static int tcp_pkt_seq(struct net_pkt *pkt, u32_t *seq)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_tcp_hdr *tcp_hdr;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+			 net_pkt_ipv6_ext_len(pkt))) {
+		return -EMSGSIZE;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data_new(pkt, &tcp_access);
+	if (!tcp_hdr) {
+		return -EMSGSIZE;
+	}
+
+	*seq = sys_get_be32(tcp_hdr->seq);
+
+	return 0;
+}
+
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+/* Sequence number and payload length of a received segment, leaves the
+ * cursor at the start of the payload.
+ */
+static int ooo_seg_get(struct net_pkt *pkt, u32_t *seq, u16_t *len)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_tcp_hdr *tcp_hdr;
+	u16_t hdr_len;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt);
+	if (net_pkt_skip(pkt, hdr_len)) {
+		return -EMSGSIZE;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data_new(pkt, &tcp_access);
+	if (!tcp_hdr) {
+		return -EMSGSIZE;
+	}
+
+	*seq = sys_get_be32(tcp_hdr->seq);
+	*len = net_pkt_get_len(pkt) - hdr_len - NET_TCP_HDR_LEN(tcp_hdr);
+
+	return net_pkt_skip(pkt, NET_TCP_HDR_LEN(tcp_hdr));
+}
+#endif
+
+/* Update the smoothed round-trip time and the RTO with a new
+ * measurement (in ms), as described in RFC 6298 chapter 2.
+ */
+static void rtt_update(struct net_tcp *tcp, u32_t rtt)
+{
+	s32_t delta;
+	u32_t rto;
+
+	if (tcp->srtt == 0U) {
+		tcp->srtt = rtt << 3;
+		tcp->rttvar = rtt << 1;
+	} else {
+		/* srtt += (rtt - srtt) / 8, rttvar += (|err| - rttvar) / 4
+		 * with srtt scaled by 8 and rttvar scaled by 4
+		 */
+		delta = (s32_t)rtt - (s32_t)(tcp->srtt >> 3);
+		tcp->srtt += delta;
+
+		if (delta < 0) {
+			delta = -delta;
+		}
+
+		delta -= tcp->rttvar >> 2;
+		tcp->rttvar += delta;
+	}
+
+	rto = (tcp->srtt >> 3) + tcp->rttvar;
+	tcp->rto = MAX(MIN(rto, NET_TCP_MAX_RETRANSMISSION_TIMEOUT),
+		       CONFIG_NET_TCP_MIN_RETRANSMISSION_TIMEOUT);
+
+	NET_DBG("[%p] rtt %u srtt %u rttvar %u rto %u", tcp, rtt,
+		tcp->srtt >> 3, tcp->rttvar >> 2, tcp->rto);
+}
+
+/* Resend the first unacknowledged segment */
+static void tcp_retransmit(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	if (net_pkt_sent(pkt)) {
+		do_ref_if_needed(tcp, pkt);
+		net_pkt_set_sent(pkt, false);
+	}
+
+	net_pkt_set_queued(pkt, true);
+
+	/* Karn's algorithm: an ACK covering a retransmitted segment
+	 * cannot be used to measure the round-trip time.
+	 */
+	tcp->rtt_timing = 0U;
+
+	if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
+		NET_DBG("retry %u: [%p] pkt %p send failed",
+			tcp->retry_timeout_shift, tcp, pkt);
+		net_pkt_unref(pkt);
+		net_pkt_set_sent(pkt, true);
+	} else {
+		NET_DBG("retry %u: [%p] sent pkt %p",
+			tcp->retry_timeout_shift, tcp, pkt);
+		if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
+		    !is_6lo_technology(pkt)) {
+			net_stats_update_tcp_seg_rexmit(net_pkt_iface(pkt));
+		}
+	}
+}
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+/* Window advertised by the peer in a received segment */
+static u32_t tcp_peer_wnd(struct net_tcp *tcp, struct net_tcp_hdr *tcp_hdr)
+{
+	u32_t wnd = sys_get_be16(tcp_hdr->wnd);
+
+	if (tcp_hdr->flags & NET_TCP_SYN) {
+		return wnd;
+	}
+
+	return wnd << tcp->send_wscale;
+}
+
+/* Bytes sent but not yet acknowledged */
+static u32_t flight_size(struct net_tcp *tcp)
+{
+	struct net_pkt *pkt;
+	u32_t flight = 0U;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (!net_pkt_sent(pkt) && !net_pkt_queued(pkt)) {
+			break;
+		}
+
+		flight += net_pkt_appdatalen(pkt);
+	}
+
+	return flight;
+}
+
+static void cc_init(struct net_tcp *tcp, struct net_tcp_hdr *tcp_hdr)
+{
+	/* Initial window as per RFC 3390 */
+	tcp->cwnd = MIN(4 * tcp->send_mss, MAX(2 * tcp->send_mss, 4380));
+	tcp->ssthresh = UINT32_MAX;
+	tcp->recover = tcp->send_seq;
+	tcp->send_wnd = tcp_peer_wnd(tcp, tcp_hdr);
+	tcp->dup_acks = 0U;
+	tcp->flags &= ~(NET_TCP_FAST_RECOVERY | NET_TCP_LOSS_RECOVERY);
+}
+
+/* Can a segment of len bytes be sent when flight bytes are in flight */
+static bool cc_can_send(struct net_tcp *tcp, u32_t flight, u32_t len)
+{
+	/* Always allow one segment so that a zero or very small window
+	 * cannot stall the connection, the retry timer probes it.
+	 */
+	if (flight == 0U) {
+		return true;
+	}
+
+	return flight + len <= MIN(tcp->cwnd, tcp->send_wnd);
+}
+
+/* Reduce the window after a loss, RFC 5681 equation (4) */
+static void cc_loss(struct net_tcp *tcp, u32_t flight)
+{
+	tcp->ssthresh = MAX(flight / 2, 2 * (u32_t)tcp->send_mss);
+}
+
+static void cc_retry_expired(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	u32_t flight = flight_size(tcp);
+	u32_t seq;
+
+	/* Do not reduce ssthresh again for a retransmission that is
+	 * itself lost.
+	 */
+	if (tcp->retry_timeout_shift == 1U) {
+		cc_loss(tcp, flight);
+	}
+
+	tcp->cwnd = tcp->send_mss;
+	tcp->dup_acks = 0U;
+	tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+	tcp->flags |= NET_TCP_LOSS_RECOVERY;
+
+	if (tcp_pkt_seq(pkt, &seq) == 0) {
+		tcp->recover = seq + flight;
+	}
+}
+
+/* Called for a duplicate ACK of the segment starting at seq */
+static void cc_dup_ack(struct net_tcp *tcp, u32_t seq)
+{
+	struct net_pkt *pkt, *unsent = NULL;
+	u32_t flight = 0U;
+	u32_t segs, thresh;
+
+	if (tcp->dup_acks < NET_TCP_MAX_DUP_ACKS) {
+		tcp->dup_acks++;
+	}
+
+	if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+		/* Each duplicate ACK means a segment has left the network */
+		tcp->cwnd += tcp->send_mss;
+		return;
+	}
+
+	if (tcp->flags & NET_TCP_LOSS_RECOVERY) {
+		return;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (!net_pkt_sent(pkt) && !net_pkt_queued(pkt)) {
+			unsent = pkt;
+			break;
+		}
+
+		flight += net_pkt_appdatalen(pkt);
+	}
+
+	thresh = NET_TCP_DUP_ACK_THRESHOLD;
+
+	/* Early retransmit (RFC 5827): with less than four segments
+	 * in flight and no new data allowed to be sent, three duplicate
+	 * ACKs can never arrive.
+	 */
+	segs = (flight + tcp->send_mss - 1) / tcp->send_mss;
+	if (segs < 4 && (!unsent || !cc_can_send(tcp, flight,
+				     net_pkt_appdatalen(unsent)))) {
+		thresh = MAX(segs, 2U) - 1;
+	}
+
+	if (tcp->dup_acks < thresh) {
+		return;
+	}
+
+	NET_DBG("[%p] fast retransmit of seq %u after %u duplicate ACKs",
+		tcp, seq, tcp->dup_acks);
+
+	cc_loss(tcp, flight);
+	tcp->cwnd = tcp->ssthresh + tcp->dup_acks * tcp->send_mss;
+	tcp->recover = seq + flight;
+	tcp->flags |= NET_TCP_FAST_RECOVERY;
+
+	tcp_retransmit(tcp, CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+					 struct net_pkt, sent_list));
+}
+
+/* Called when acked new bytes have been acknowledged up to ack */
+static void cc_new_ack(struct net_tcp *tcp, u32_t ack, u32_t acked)
+{
+	u32_t mss = tcp->send_mss;
+
+	tcp->dup_acks = 0U;
+
+	if (tcp->flags & (NET_TCP_FAST_RECOVERY | NET_TCP_LOSS_RECOVERY)) {
+		if (!net_tcp_seq_greater(tcp->recover, ack)) {
+			/* Full ACK, leave recovery (RFC 6582 chapter 3.2) */
+			if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+				tcp->cwnd = MIN(tcp->ssthresh,
+						MAX(flight_size(tcp), mss) +
+						mss);
+			}
+
+			tcp->flags &= ~(NET_TCP_FAST_RECOVERY |
+					NET_TCP_LOSS_RECOVERY);
+			return;
+		}
+
+		/* Partial ACK, the next segment was lost as well */
+		if (!sys_slist_is_empty(&tcp->sent_list)) {
+			tcp_retransmit(tcp, CONTAINER_OF(
+					       sys_slist_peek_head(&tcp->sent_list),
+					       struct net_pkt, sent_list));
+		}
+
+		if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+			tcp->cwnd -= MIN(tcp->cwnd, acked);
+			tcp->cwnd = MAX(tcp->cwnd + (acked >= mss ? mss : 0),
+					mss);
+			return;
+		}
+	}
+
+	/* A window far beyond what the peer accepts is of no use */
+	if (tcp->cwnd >= 2 * tcp->send_wnd) {
+		return;
+	}
+
+	if (tcp->cwnd < tcp->ssthresh) {
+		/* Slow start */
+		tcp->cwnd += MIN(acked, mss);
+	} else {
+		/* Congestion avoidance, about one segment per RTT */
+		tcp->cwnd += MAX(mss * mss / tcp->cwnd, 1U);
+	}
+}
+
+/* Check an ACK received on a synchronized connection for a duplicate ACK
+ * and update the send window, before net_tcp_ack_received().
+ */
+static void tcp_ack_check(struct net_tcp *tcp, struct net_tcp_hdr *tcp_hdr,
+			  u16_t data_len)
+{
+	u32_t wnd = tcp_peer_wnd(tcp, tcp_hdr);
+	u32_t ack = sys_get_be32(tcp_hdr->ack);
+	bool same_wnd = (wnd == tcp->send_wnd);
+	struct net_pkt *pkt;
+	u32_t seq;
+
+	tcp->send_wnd = wnd;
+
+	/* Duplicate ACK as defined in RFC 5681 chapter 2 */
+	if (data_len > 0 || !same_wnd ||
+	    (tcp_hdr->flags & (NET_TCP_SYN | NET_TCP_FIN)) ||
+	    sys_slist_is_empty(&tcp->sent_list)) {
+		return;
+	}
+
+	pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+			   struct net_pkt, sent_list);
+
+	if (!net_pkt_sent(pkt) && !net_pkt_queued(pkt)) {
+		return;
+	}
+
+	if (tcp_pkt_seq(pkt, &seq) < 0 || seq != ack) {
+		return;
+	}
+
+	cc_dup_ack(tcp, seq);
+}
+#endif /* CONFIG_NET_TCP_CONGESTION_CONTROL */
+
 static void abort_connection(struct net_tcp *tcp)
 {
 	struct net_context *ctx = tcp->context;
@@ -229,26 +593,11 @@ static void tcp_retry_expired(struct k_work *work)
 		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
 				   struct net_pkt, sent_list);
 
-		if (net_pkt_sent(pkt)) {
-			do_ref_if_needed(tcp, pkt);
-			net_pkt_set_sent(pkt, false);
-		}
-
-		net_pkt_set_queued(pkt, true);
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		cc_retry_expired(tcp, pkt);
+#endif
 
-		if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
-			NET_DBG("retry %u: [%p] pkt %p send failed",
-				tcp->retry_timeout_shift, tcp, pkt);
-			net_pkt_unref(pkt);
-		} else {
-			NET_DBG("retry %u: [%p] sent pkt %p",
-				tcp->retry_timeout_shift, tcp, pkt);
-			if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
-			    !is_6lo_technology(pkt)) {
-				net_stats_update_tcp_seg_rexmit(
-							net_pkt_iface(pkt));
-			}
-		}
+		tcp_retransmit(tcp, pkt);
 	} else if (CONFIG_NET_TCP_TIME_WAIT_DELAY != 0) {
 		if (tcp->fin_sent && tcp->fin_rcvd) {
 			NET_DBG("[%p] Closing connection (context %p)",
@@ -282,13 +631,16 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 	tcp_context[i].context = context;
 
 	tcp_context[i].send_seq = tcp_init_isn();
-	tcp_context[i].recv_wnd = MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
+	tcp_context[i].recv_buf_size = CONFIG_NET_TCP_RECV_BUF_SIZE;
+	tcp_context[i].send_buf_size = CONFIG_NET_TCP_SEND_BUF_SIZE;
 	tcp_context[i].send_mss = NET_TCP_DEFAULT_MSS;
+	tcp_context[i].rto = CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
 
 	tcp_context[i].accept_cb = NULL;
 
 	k_delayed_work_init(&tcp_context[i].retry_timer, tcp_retry_expired);
 	k_sem_init(&tcp_context[i].connect_wait, 0, UINT_MAX);
+	k_sem_init(&tcp_context[i].send_wait, 0, 1);
 
 	return &tcp_context[i];
 }
@@ -329,6 +681,18 @@ int net_tcp_release(struct net_tcp *tcp)
 		net_pkt_unref(pkt);
 	}
 
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&tcp->ooo_list, pkt, tmp,
+					  sent_list) {
+		sys_slist_remove(&tcp->ooo_list, NULL, &pkt->sent_list);
+		net_pkt_unref(pkt);
+	}
+
+	tcp->ooo_count = 0U;
+#endif
+
+	k_sem_give(&tcp->send_wait);
+
 	retry_timer_cancel(tcp);
 	k_sem_reset(&tcp->connect_wait);
 
@@ -507,7 +871,50 @@ fail:
 
 u32_t net_tcp_get_recv_wnd(const struct net_tcp *tcp)
 {
-	return tcp->recv_wnd;
+	if (tcp->recv_queued >= tcp->recv_buf_size) {
+		return 0;
+	}
+
+	return tcp->recv_buf_size - tcp->recv_queued;
+}
+
+/* Unread data of all connections is held in RX buffers, so do not offer
+ * more than the RX data pool can still take. A quarter of the pool is
+ * left for headers and other traffic. This is an estimate only, the
+ * buffers in use by packets in flight are not known.
+ */
+static u32_t rx_pool_space(void)
+{
+	u32_t space = RX_DATA_POOL_SIZE - RX_DATA_POOL_SIZE / 4;
+	int i;
+
+	for (i = 0; i < NET_MAX_TCP_CONTEXT; i++) {
+		if (!net_tcp_is_used(&tcp_context[i])) {
+			continue;
+		}
+
+		if (tcp_context[i].recv_queued >= space) {
+			return 0;
+		}
+
+		space -= tcp_context[i].recv_queued;
+	}
+
+	return space;
+}
+
+/* Window to put into an outgoing segment. The window of a SYN is never
+ * scaled (RFC 7323 chapter 2.2).
+ */
+static u16_t tcp_adv_wnd(struct net_tcp *tcp, u8_t flags)
+{
+	u32_t wnd = MIN(net_tcp_get_recv_wnd(tcp), rx_pool_space());
+
+	if (!(flags & NET_TCP_SYN)) {
+		wnd >>= tcp->recv_wscale;
+	}
+
+	return MIN(wnd, UINT16_MAX);
 }
 
 int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
@@ -563,7 +970,7 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 		}
 	}
 
-	wnd = net_tcp_get_recv_wnd(tcp);
+	wnd = tcp_adv_wnd(tcp, flags);
 
 	segment.src_addr = (struct sockaddr_ptr *)local;
 	segment.dst_addr = remote;
@@ -656,6 +1063,116 @@ u16_t net_tcp_get_recv_mss(const struct net_tcp *tcp)
 	return 0;
 }
 
+static void net_tcp_set_sack_perm_opt(struct net_tcp *tcp, u8_t *options,
+				      u8_t *optionlen)
+{
+#if defined(CONFIG_NET_TCP_SACK)
+	/* The SYN always offers SACK, the SYN-ACK only if the SYN did */
+	if (net_tcp_get_state(tcp) == NET_TCP_SYN_RCVD &&
+	    !tcp->sack_permitted) {
+		return;
+	}
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_PERM_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_PERM_SIZE;
+#endif
+}
+
+/* Smallest shift that lets the window field cover the receive buffer */
+static u8_t tcp_wscale(u32_t buf_size)
+{
+	u8_t shift = 0U;
+
+	while (shift < NET_TCP_MAX_WINDOW_SCALE &&
+	       (buf_size >> shift) > UINT16_MAX) {
+		shift++;
+	}
+
+	return shift;
+}
+
+static void net_tcp_set_wscale_opt(struct net_tcp *tcp, u8_t *options,
+				   u8_t *optionlen)
+{
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE)
+	/* The SYN always offers scaling, the SYN-ACK only if the SYN did */
+	if (net_tcp_get_state(tcp) == NET_TCP_SYN_RCVD) {
+		if (!tcp->wscale_ok) {
+			return;
+		}
+	} else {
+		tcp->recv_wscale = tcp_wscale(tcp->recv_buf_size);
+	}
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_OPT;
+	options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_SIZE;
+	options[(*optionlen)++] = tcp->recv_wscale;
+#endif
+}
+
+#if defined(CONFIG_NET_TCP_SACK)
+/* Report the out-of-order queue in a SACK option (RFC 2018). The first
+ * block must hold the most recently received segment, the rest follow
+ * in sequence order.
+ */
+static void net_tcp_set_sack_opt(struct net_tcp *tcp, u8_t *options,
+				 u8_t *optionlen)
+{
+	u32_t blocks[CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE_LEN][2];
+	struct net_pkt *pkt;
+	int count = 0;
+	int first = 0;
+	int i, n;
+
+	*optionlen = 0U;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, pkt, sent_list) {
+		u32_t seq;
+		u16_t len;
+
+		if (ooo_seg_get(pkt, &seq, &len) < 0) {
+			continue;
+		}
+
+		if (count > 0 && blocks[count - 1][1] == seq) {
+			blocks[count - 1][1] += len;
+		} else {
+			blocks[count][0] = seq;
+			blocks[count][1] = seq + len;
+			count++;
+		}
+
+		if (seq == tcp->ooo_last_seq) {
+			first = count - 1;
+		}
+	}
+
+	if (count == 0) {
+		return;
+	}
+
+	n = MIN(count, NET_TCP_SACK_MAX_BLOCKS);
+
+	options[0] = NET_TCP_NOP_OPT;
+	options[1] = NET_TCP_NOP_OPT;
+	options[2] = NET_TCP_SACK_OPT;
+	options[3] = 2 + 8 * n;
+	*optionlen = 4U;
+
+	for (i = 0; i < count && *optionlen < 4 + 8 * n; i++) {
+		/* Start with the first block, then the others in order */
+		int b = (i == 0) ? first : (i <= first ? i - 1 : i);
+
+		sys_put_be32(blocks[b][0], options + *optionlen);
+		sys_put_be32(blocks[b][1], options + *optionlen + 4);
+		*optionlen += 8U;
+	}
+}
+#endif
+
 static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 				u8_t *optionlen)
 {
@@ -675,12 +1192,15 @@ static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 		      (u32_t *)(options + *optionlen));
 
 	*optionlen += NET_TCP_MSS_SIZE;
+
+	net_tcp_set_wscale_opt(tcp, options, optionlen);
+	net_tcp_set_sack_perm_opt(tcp, options, optionlen);
 }
 
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 			struct net_pkt **pkt)
 {
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
+	u8_t options[NET_TCP_MAX_SYN_OPT_SIZE];
 	u8_t optionlen;
 
 	switch (net_tcp_get_state(tcp)) {
@@ -701,6 +1221,19 @@ int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 		return net_tcp_prepare_segment(tcp, NET_TCP_FIN | NET_TCP_ACK,
 					       0, 0, NULL, remote, pkt);
 	default:
+#if defined(CONFIG_NET_TCP_SACK)
+		if (tcp->sack_permitted && tcp->ooo_count > 0) {
+			u8_t sack[NET_TCP_MAX_SACK_OPT_SIZE];
+			u8_t sacklen;
+
+			net_tcp_set_sack_opt(tcp, sack, &sacklen);
+
+			return net_tcp_prepare_segment(tcp, NET_TCP_ACK, sack,
+						       sacklen, NULL, remote,
+						       pkt);
+		}
+#endif
+
 		return net_tcp_prepare_segment(tcp, NET_TCP_ACK, 0, 0, NULL,
 					       remote, pkt);
 	}
@@ -996,34 +1529,62 @@ static void restart_timer(struct net_tcp *tcp)
 int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
 		      void *token, void *user_data)
 {
+	struct net_tcp *tcp = context->tcp;
 	struct net_pkt *pkt;
+	u32_t flight = 0U;
 
-	/* For now, just send all queued data synchronously.  Need to
-	 * add window handling and retry/ACK logic.
+	/* Send queued data synchronously, as far as the congestion and
+	 * receive windows allow. The rest is sent when ACKs arrive.
 	 */
-	SYS_SLIST_FOR_EACH_CONTAINER(&context->tcp->sent_list, pkt, sent_list) {
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
 		/* Do not resend packets that were sent by expire timer */
 		if (net_pkt_queued(pkt)) {
 			NET_DBG("[%p] Skipping pkt %p because it was already "
-				"sent.", context->tcp, pkt);
+				"sent.", tcp, pkt);
+			flight += net_pkt_appdatalen(pkt);
 			continue;
 		}
 
 		if (!net_pkt_sent(pkt)) {
+			u32_t seq;
 			int ret;
 
-			NET_DBG("[%p] Sending pkt %p (%zd bytes)", context->tcp,
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+			if (!cc_can_send(tcp, flight,
+					 net_pkt_appdatalen(pkt))) {
+				NET_DBG("[%p] window full, %u bytes in flight",
+					tcp, flight);
+				break;
+			}
+#endif
+
+			/* Time one segment per round trip */
+			if (!tcp->rtt_timing && net_pkt_appdatalen(pkt) &&
+			    tcp_pkt_seq(pkt, &seq) == 0) {
+				tcp->rtt_seq = seq + net_pkt_appdatalen(pkt);
+				tcp->rtt_start = k_uptime_get_32();
+				tcp->rtt_timing = 1U;
+			}
+
+			NET_DBG("[%p] Sending pkt %p (%zd bytes)", tcp,
 				pkt, net_pkt_get_len(pkt));
 
 			ret = net_tcp_send_pkt(pkt);
 			if (ret < 0 && !is_6lo_technology(pkt)) {
 				NET_DBG("[%p] pkt %p not sent (%d)",
-					context->tcp, pkt, ret);
+					tcp, pkt, ret);
 				net_pkt_unref(pkt);
+
+				/* The transmission reference is gone, the
+				 * retransmit timer resends it with a new one.
+				 */
+				net_pkt_set_sent(pkt, true);
 			}
 
 			net_pkt_set_queued(pkt, true);
 		}
+
+		flight += net_pkt_appdatalen(pkt);
 	}
 
 	/* Just make the callback synchronously even if it didn't
@@ -1046,6 +1607,8 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 	sys_snode_t *head;
 	struct net_pkt *pkt;
 	bool valid_ack = false;
+	bool first = true;
+	u32_t una = ack;
 
 	if (net_tcp_seq_greater(ack, ctx->tcp->send_seq)) {
 		NET_ERR("ctx %p: ACK for unsent data", ctx);
@@ -1100,6 +1663,11 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 			seq_len += 1;
 		}
 
+		if (first) {
+			una = sys_get_be32(tcp_hdr->seq);
+			first = false;
+		}
+
 		/* Last sequence number in this packet. */
 		last_seq = sys_get_be32(tcp_hdr->seq) + seq_len - 1;
 
@@ -1133,6 +1701,20 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 	 * sent times.
 	 */
 	if (valid_ack) {
+		if (tcp->rtt_timing &&
+		    !net_tcp_seq_greater(tcp->rtt_seq, ack)) {
+			rtt_update(tcp, k_uptime_get_32() - tcp->rtt_start);
+			tcp->rtt_timing = 0U;
+		}
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		cc_new_ack(tcp, ack, ack - una);
+#endif
+
+		if (tcp->send_buf_size) {
+			k_sem_give(&tcp->send_wait);
+		}
+
 		restart_timer(ctx->tcp);
 	}
 
@@ -1335,6 +1917,29 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 				goto error;
 			}
 
+			break;
+		case NET_TCP_SACK_PERM_OPT:
+			if (optlen != 0) {
+				goto error;
+			}
+
+			opts->sack_permitted = true;
+
+			break;
+		case NET_TCP_WINDOW_SCALE_OPT:
+			if (optlen != 1) {
+				goto error;
+			}
+
+			if (net_pkt_read_u8_new(pkt, &opts->wscale)) {
+				goto error;
+			}
+
+			/* RFC 7323 chapter 2.3 */
+			opts->wscale = MIN(opts->wscale,
+					   NET_TCP_MAX_WINDOW_SCALE);
+			opts->wscale_present = true;
+
 			break;
 		default:
 			if (net_pkt_skip(pkt, optlen)) {
@@ -1419,19 +2024,109 @@ int net_tcp_listen(struct net_context *context)
 
 int net_tcp_update_recv_wnd(struct net_context *context, s32_t delta)
 {
-	s32_t new_win;
-
 	if (!context->tcp) {
 		NET_ERR("context->tcp == NULL");
 		return -EPROTOTYPE;
 	}
 
-	new_win = context->tcp->recv_wnd + delta;
-	if (new_win < 0 || new_win > UINT16_MAX) {
+	/* Data handed to the application closes the window, data read by
+	 * it opens the window again.
+	 */
+	if (delta > 0 && (u32_t)delta > context->tcp->recv_queued) {
 		return -EINVAL;
 	}
 
-	context->tcp->recv_wnd = new_win;
+	context->tcp->recv_queued -= delta;
+
+	return 0;
+}
+
+int net_tcp_set_buf_size(struct net_tcp *tcp, bool recv, u32_t size)
+{
+	if (recv) {
+		/* The window offered in the SYN must not be retracted */
+		if (size < NET_TCP_DEFAULT_MSS ||
+		    (net_tcp_get_state(tcp) != NET_TCP_CLOSED &&
+		     net_tcp_get_state(tcp) != NET_TCP_LISTEN &&
+		     size < tcp->recv_buf_size)) {
+			return -EINVAL;
+		}
+
+		tcp->recv_buf_size = size;
+	} else {
+		tcp->send_buf_size = size;
+		k_sem_give(&tcp->send_wait);
+	}
+
+	return 0;
+}
+
+u32_t net_tcp_get_buf_size(struct net_tcp *tcp, bool recv)
+{
+	return recv ? tcp->recv_buf_size : tcp->send_buf_size;
+}
+
+u32_t net_tcp_get_send_space(struct net_tcp *tcp)
+{
+	struct net_pkt *pkt;
+	u32_t queued = 0U;
+
+	if (!tcp->send_buf_size) {
+		return UINT32_MAX;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		queued += net_pkt_appdatalen(pkt);
+	}
+
+	if (queued >= tcp->send_buf_size) {
+		return 0;
+	}
+
+	return tcp->send_buf_size - queued;
+}
+
+int net_tcp_wait_send_space(struct net_tcp *tcp, s32_t timeout)
+{
+	struct net_context *context = tcp->context;
+	s64_t end = k_uptime_get() + timeout;
+	int ret;
+
+	if (net_tcp_get_send_space(tcp) > 0) {
+		return 0;
+	}
+
+	if (timeout == K_NO_WAIT) {
+		return -EAGAIN;
+	}
+
+	/* Space is only freed with the context lock held, so it cannot be
+	 * missed between the check above and the wait.
+	 */
+	k_sem_reset(&tcp->send_wait);
+
+	do {
+		if (timeout != K_FOREVER) {
+			timeout = MAX(end - k_uptime_get(), 0);
+		}
+
+		k_mutex_unlock(&context->lock);
+		ret = k_sem_take(&tcp->send_wait, timeout);
+		k_mutex_lock(&context->lock, K_FOREVER);
+
+		/* The semaphore is also given when the connection is
+		 * released.
+		 */
+		if (context->tcp != tcp) {
+			return -ENOTCONN;
+		}
+
+		if (ret < 0) {
+			return -EAGAIN;
+		}
+
+		/* Another sender may have used the space meanwhile */
+	} while (net_tcp_get_send_space(tcp) == 0);
 
 	return 0;
 }
@@ -1554,7 +2249,7 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 			   union net_ip_header *ip_hdr,
 			   struct net_tcp_hdr *tcp_hdr,
 			   struct net_context *context,
-			   u16_t send_mss)
+			   const struct net_tcp_options *opts)
 {
 	int empty_slot = -1;
 
@@ -1573,7 +2268,11 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 
 	tcp_backlog[empty_slot].send_seq = context->tcp->send_seq;
 	tcp_backlog[empty_slot].send_ack = context->tcp->send_ack;
-	tcp_backlog[empty_slot].send_mss = send_mss;
+	tcp_backlog[empty_slot].send_mss = opts->mss;
+	tcp_backlog[empty_slot].sack_permitted = opts->sack_permitted;
+	tcp_backlog[empty_slot].wscale_ok = context->tcp->wscale_ok;
+	tcp_backlog[empty_slot].recv_wscale = context->tcp->recv_wscale;
+	tcp_backlog[empty_slot].send_wscale = context->tcp->send_wscale;
 
 	k_delayed_work_init(&tcp_backlog[empty_slot].ack_timer,
 			    backlog_ack_timeout);
@@ -1604,6 +2303,14 @@ static int tcp_backlog_ack(struct net_pkt *pkt,
 	context->tcp->send_seq = tcp_backlog[r].send_seq + 1;
 	context->tcp->send_ack = tcp_backlog[r].send_ack;
 	context->tcp->send_mss = tcp_backlog[r].send_mss;
+	context->tcp->sack_permitted = tcp_backlog[r].sack_permitted;
+	context->tcp->wscale_ok = tcp_backlog[r].wscale_ok;
+	context->tcp->recv_wscale = tcp_backlog[r].recv_wscale;
+	context->tcp->send_wscale = tcp_backlog[r].send_wscale;
+
+	/* Buffer sizes are inherited from the listening context */
+	context->tcp->recv_buf_size = tcp_backlog[r].tcp->recv_buf_size;
+	context->tcp->send_buf_size = tcp_backlog[r].tcp->send_buf_size;
 
 	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
 	(void)memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
@@ -1790,11 +2497,14 @@ static inline int send_syn_segment(struct net_context *context,
 {
 	struct net_pkt *pkt = NULL;
 	int ret;
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
+	u8_t options[NET_TCP_MAX_SYN_OPT_SIZE];
 	u8_t optionlen = 0U;
 
 	if (flags == NET_TCP_SYN) {
 		net_tcp_set_syn_opt(context->tcp, options, &optionlen);
+	} else {
+		net_tcp_set_wscale_opt(context->tcp, options, &optionlen);
+		net_tcp_set_sack_perm_opt(context->tcp, options, &optionlen);
 	}
 
 	ret = net_tcp_prepare_segment(context->tcp, flags, options, optionlen,
@@ -1883,6 +2593,149 @@ static int send_reset(struct net_context *context,
 	return ret;
 }
 
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+/* Keep a segment that starts after the next expected sequence number.
+ * Returns 0 if the segment was queued, the caller no longer owns it then.
+ */
+static int tcp_ooo_queue(struct net_tcp *tcp, struct net_pkt *pkt,
+			 struct net_tcp_hdr *tcp_hdr)
+{
+	struct net_pkt *cur, *prev = NULL;
+	u32_t seq = sys_get_be32(tcp_hdr->seq);
+	u32_t cur_seq;
+	u16_t len, cur_len;
+
+	/* Only plain data is queued, anything else is resent by the peer */
+	if (NET_TCP_FLAGS(tcp_hdr) & (NET_TCP_SYN | NET_TCP_FIN |
+				      NET_TCP_RST | NET_TCP_URG)) {
+		return -EINVAL;
+	}
+
+	if (tcp->ooo_count >= CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE_LEN) {
+		return -ENOBUFS;
+	}
+
+	len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+	      net_pkt_ipv6_ext_len(pkt) - NET_TCP_HDR_LEN(tcp_hdr);
+
+	if (len == 0U ||
+	    net_tcp_seq_greater(seq + len,
+				tcp->send_ack + net_tcp_get_recv_wnd(tcp))) {
+		return -EINVAL;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, cur, sent_list) {
+		if (ooo_seg_get(cur, &cur_seq, &cur_len) < 0) {
+			return -EINVAL;
+		}
+
+		if (!net_tcp_seq_greater(cur_seq + cur_len, seq)) {
+			prev = cur;
+			continue;
+		}
+
+		if (!net_tcp_seq_greater(seq + len, cur_seq)) {
+			break;
+		}
+
+		/* Overlaps a queued segment, keep the one we have */
+		return -EEXIST;
+	}
+
+	sys_slist_insert(&tcp->ooo_list, prev ? &prev->sent_list : NULL,
+			 &pkt->sent_list);
+	tcp->ooo_count++;
+
+#if defined(CONFIG_NET_TCP_SACK)
+	tcp->ooo_last_seq = seq;
+#endif
+
+	NET_DBG("[%p] queued seq %u len %u, %u segments out of order",
+		tcp, seq, len, tcp->ooo_count);
+
+	return 0;
+}
+
+/* Pass the queued segments that have become in order to the application */
+static void tcp_ooo_deliver(struct net_conn *conn, struct net_context *context)
+{
+	struct net_tcp *tcp = context->tcp;
+	sys_snode_t *node;
+
+	while ((node = sys_slist_peek_head(&tcp->ooo_list)) != NULL) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+		struct net_pkt *pkt = CONTAINER_OF(node, struct net_pkt,
+						   sent_list);
+		union net_proto_header proto_hdr;
+		union net_ip_header ip_hdr;
+		u32_t seq;
+		u16_t len;
+		int ret;
+
+		ret = ooo_seg_get(pkt, &seq, &len);
+		if (ret == 0 && net_tcp_seq_greater(seq, tcp->send_ack)) {
+			break;
+		}
+
+		sys_slist_remove(&tcp->ooo_list, NULL, node);
+		tcp->ooo_count--;
+
+		/* Drop what is already covered by in order data */
+		if (ret < 0 || !net_tcp_seq_greater(seq + len, tcp->send_ack)) {
+			net_pkt_unref(pkt);
+			continue;
+		}
+
+		/* The headers are read again so that recv_cb gets them like
+		 * for a segment received in order.
+		 */
+		net_pkt_cursor_init(pkt);
+
+		if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		    net_pkt_family(pkt) == AF_INET) {
+			ip_hdr.ipv4 = (struct net_ipv4_hdr *)
+				net_pkt_get_data_new(pkt, &ipv4_access);
+		} else {
+			ip_hdr.ipv6 = (struct net_ipv6_hdr *)
+				net_pkt_get_data_new(pkt, &ipv6_access);
+		}
+
+		if (!ip_hdr.ipv4 ||
+		    net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+				 net_pkt_ipv6_ext_len(pkt))) {
+			net_pkt_unref(pkt);
+			continue;
+		}
+
+		proto_hdr.tcp = (struct net_tcp_hdr *)
+			net_pkt_get_data_new(pkt, &tcp_access);
+		if (!proto_hdr.tcp ||
+		    net_pkt_skip(pkt, NET_TCP_HDR_LEN(proto_hdr.tcp) +
+				 tcp->send_ack - seq)) {
+			net_pkt_unref(pkt);
+			continue;
+		}
+
+		len -= tcp->send_ack - seq;
+
+		net_pkt_set_appdatalen(pkt, len);
+		net_pkt_set_appdata(pkt, net_pkt_cursor_get_pos(pkt));
+
+		tcp->send_ack += len;
+
+		if (net_context_packet_received(conn, pkt, &ip_hdr, &proto_hdr,
+						tcp->recv_user_data) ==
+		    NET_DROP) {
+			net_pkt_unref(pkt);
+		}
+	}
+}
+#endif /* CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE */
+
 /* This is called when we receive data after the connection has been
  * established. The core TCP logic is located here.
  *
@@ -1933,12 +2786,30 @@ resend_ack:
 
 	if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
 			    context->tcp->send_ack) > 0) {
-		/* Don't try to reorder packets.  If it doesn't
-		 * match the next segment exactly, drop and wait for
-		 * retransmit
+		/* A segment without data tells nothing about a loss. It is
+		 * dropped silently, answering it could make two peers that
+		 * missed each other's FIN exchange ACKs forever.
 		 */
-		ret = NET_DROP;
-		goto unlock;
+		if (net_pkt_get_len(pkt) == net_pkt_ip_hdr_len(pkt) +
+		    net_pkt_ipv6_ext_len(pkt) + NET_TCP_HDR_LEN(tcp_hdr) &&
+		    !(tcp_flags & (NET_TCP_SYN | NET_TCP_FIN))) {
+			ret = NET_DROP;
+			goto unlock;
+		}
+
+		/* Keep the segment for later if possible, otherwise drop
+		 * and wait for retransmit. Send a duplicate ACK right away
+		 * so that the peer can detect the loss (RFC 5681 chapter
+		 * 4.2).
+		 */
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+		if (tcp_ooo_queue(context->tcp, pkt, tcp_hdr) == 0) {
+			send_ack(context, &conn->remote_addr, true);
+			goto unlock;
+		}
+#endif
+
+		goto resend_ack;
 	}
 
 	/*
@@ -1970,12 +2841,24 @@ resend_ack:
 
 	/* Handle TCP state transition */
 	if (tcp_flags & NET_TCP_ACK) {
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		tcp_ack_check(context->tcp, tcp_hdr,
+			      net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+			      net_pkt_ipv6_ext_len(pkt) -
+			      NET_TCP_HDR_LEN(tcp_hdr));
+#endif
+
 		if (!net_tcp_ack_received(context,
 					  sys_get_be32(tcp_hdr->ack))) {
 			ret = NET_DROP;
 			goto unlock;
 		}
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		/* The ACK might have opened the window for queued data */
+		net_tcp_send_data(context, NULL, NULL, NULL);
+#endif
+
 		/* TCP state might be changed after maintaining the sent pkt
 		 * list, e.g., an ack of FIN is received.
 		 */
@@ -2022,6 +2905,15 @@ resend_ack:
 			       net_pkt_ipv6_ext_len(pkt) -
 			       NET_TCP_HDR_LEN(tcp_hdr));
 
+	/* The payload follows the options, e.g. SACK blocks from a peer
+	 * that has our data queued out of order.
+	 */
+	if (net_pkt_skip(pkt, NET_TCP_HDR_LEN(tcp_hdr) -
+			 sizeof(struct net_tcp_hdr))) {
+		ret = NET_DROP;
+		goto unlock;
+	}
+
 	net_pkt_set_appdata(pkt, net_pkt_cursor_get_pos(pkt));
 
 	data_len = net_pkt_appdatalen(pkt);
@@ -2061,6 +2953,13 @@ resend_ack:
 		context->tcp->send_ack += 1;
 	}
 
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+	/* The segment might have filled a hole */
+	if (data_len > 0 && !(tcp_flags & NET_TCP_FIN)) {
+		tcp_ooo_deliver(conn, context);
+	}
+#endif
+
 	send_ack(context, &conn->remote_addr, false);
 
 clean_up:
@@ -2144,9 +3043,33 @@ NET_CONN_CB(tcp_synack_received)
 		/* Remove the temporary connection handler and register
 		 * a proper now as we have an established connection.
 		 */
+		struct net_tcp_options tcp_opts = {
+			.mss = NET_TCP_DEFAULT_MSS,
+		};
 		struct sockaddr local_addr;
 		struct sockaddr remote_addr;
 
+		if (net_tcp_parse_opts(pkt, NET_TCP_HDR_LEN(tcp_hdr) -
+				       sizeof(struct net_tcp_hdr),
+				       &tcp_opts) < 0) {
+			return NET_DROP;
+		}
+
+		context->tcp->send_mss = tcp_opts.mss;
+		context->tcp->sack_permitted =
+			IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+			tcp_opts.sack_permitted;
+
+		/* Scaling is used only if both ends offered it */
+		context->tcp->wscale_ok =
+			IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+			tcp_opts.wscale_present;
+		if (context->tcp->wscale_ok) {
+			context->tcp->send_wscale = tcp_opts.wscale;
+		} else {
+			context->tcp->recv_wscale = 0U;
+		}
+
 		tcp_copy_ip_addr_from_hdr(net_pkt_family(pkt), ip_hdr, tcp_hdr,
 					  &remote_addr, true);
 		tcp_copy_ip_addr_from_hdr(net_pkt_family(pkt), ip_hdr, tcp_hdr,
@@ -2171,6 +3094,10 @@ NET_CONN_CB(tcp_synack_received)
 		net_tcp_change_state(context->tcp, NET_TCP_ESTABLISHED);
 		net_context_set_state(context, NET_CONTEXT_CONNECTED);
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		cc_init(context->tcp, tcp_hdr);
+#endif
+
 		send_ack(context, &remote_addr, false);
 
 		k_sem_give(&context->tcp->connect_wait);
@@ -2295,10 +3222,26 @@ NET_CONN_CB(tcp_syn_rcvd)
 		context->tcp->send_ack =
 			sys_get_be32(tcp_hdr->seq) + 1;
 
-		/* Get MSS from TCP options here*/
+		/* Answer the SACK offer in the SYN-ACK */
+		context->tcp->sack_permitted = IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+					       tcp_opts.sack_permitted;
+		tcp_opts.sack_permitted = context->tcp->sack_permitted;
+
+		/* Likewise the window scale offer */
+		context->tcp->wscale_ok =
+			IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+			tcp_opts.wscale_present;
+		if (context->tcp->wscale_ok) {
+			context->tcp->send_wscale = tcp_opts.wscale;
+			context->tcp->recv_wscale =
+				tcp_wscale(context->tcp->recv_buf_size);
+		} else {
+			context->tcp->send_wscale = 0U;
+			context->tcp->recv_wscale = 0U;
+		}
 
 		r = tcp_backlog_syn(pkt, ip_hdr, tcp_hdr,
-				    context, tcp_opts.mss);
+				    context, &tcp_opts);
 		if (r < 0) {
 			if (r == -EADDRINUSE) {
 				NET_DBG("TCP connection already exists");
@@ -2412,6 +3355,10 @@ NET_CONN_CB(tcp_syn_rcvd)
 		 */
 		new_context->tcp->state = NET_TCP_ESTABLISHED;
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		cc_init(new_context->tcp, tcp_hdr);
+#endif
+
 		net_context_set_state(new_context, NET_CONTEXT_CONNECTED);
 
 		if (new_context->remote.sa_family == AF_INET) {
@@ -29,7 +29,11 @@ extern "C" {
 /** Is this TCP context/socket used or not */
 #define NET_TCP_IN_USE BIT(0)
 
-/* BIT(1), BIT(2) are unused and available */
+/** Fast recovery after a fast retransmit is in progress */
+#define NET_TCP_FAST_RECOVERY BIT(1)
+
+/** Recovery after a retransmission timeout is in progress */
+#define NET_TCP_LOSS_RECOVERY BIT(2)
 
 /** Is the socket shutdown for read/write */
 #define NET_TCP_IS_SHUTDOWN BIT(3)
@@ -77,34 +81,46 @@ enum net_tcp_state {
  */
 #define NET_TCP_DEFAULT_MSS   536
 
-/* TCP max window size */
-#define NET_TCP_MAX_WIN   (4 * 1024)
-
 /* Maximal value of the sequence number */
 #define NET_TCP_MAX_SEQ   0xffffffff
 
 #define NET_TCP_MAX_OPT_SIZE  8
 
+/* MSS, window scale and SACK permitted options of a SYN, with padding */
+#define NET_TCP_MAX_SYN_OPT_SIZE 12
+
+/* Largest window scale shift, RFC 7323 chapter 2.3 */
+#define NET_TCP_MAX_WINDOW_SCALE 14
+
 /* TCP Option codes */
 #define NET_TCP_END_OPT          0
 #define NET_TCP_NOP_OPT          1
 #define NET_TCP_MSS_OPT          2
 #define NET_TCP_WINDOW_SCALE_OPT 3
+#define NET_TCP_SACK_PERM_OPT    4
+#define NET_TCP_SACK_OPT         5
 
 /* TCP Option sizes */
 #define NET_TCP_END_SIZE          1
 #define NET_TCP_NOP_SIZE          1
 #define NET_TCP_MSS_SIZE          4
 #define NET_TCP_WINDOW_SCALE_SIZE 3
+#define NET_TCP_SACK_PERM_SIZE    2
+
+/* Max number of blocks in a SACK option, leaving room for other options */
+#define NET_TCP_SACK_MAX_BLOCKS   3
+
+/* Two NOPs, kind, length and the blocks */
+#define NET_TCP_MAX_SACK_OPT_SIZE (4 + 8 * NET_TCP_SACK_MAX_BLOCKS)
 
 /** Parsed TCP option values for net_tcp_parse_opts()  */
 struct net_tcp_options {
 	u16_t mss;
+	bool sack_permitted;
+	bool wscale_present;
+	u8_t wscale;
 };
 
-/* Max received bytes to buffer internally */
-#define NET_TCP_BUF_MAX_LEN 1280
-
 /* Max segment lifetime, in seconds */
 #define NET_TCP_MAX_SEG_LIFETIME 60
 
@@ -152,15 +168,75 @@ struct net_tcp {
 	struct k_sem connect_wait;
 
 	/**
-	 * Current TCP receive window for our side
+	 * Received bytes not yet read by the application
+	 */
+	u32_t recv_queued;
+
+	/**
+	 * Receive buffer size, the largest receive window
 	 */
-	u16_t recv_wnd;
+	u32_t recv_buf_size;
+
+	/**
+	 * Send buffer size, 0 if unlimited
+	 */
+	u32_t send_buf_size;
+
+	/**
+	 * Semaphore to signal space in the send buffer
+	 */
+	struct k_sem send_wait;
 
 	/**
 	 * Send MSS for the peer
 	 */
 	u16_t send_mss;
 
+	/** Shift applied to the windows we advertise */
+	u8_t recv_wscale;
+
+	/** Shift applied to the windows the peer advertises */
+	u8_t send_wscale;
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	/** Congestion window, in bytes */
+	u32_t cwnd;
+
+	/** Slow start threshold, in bytes */
+	u32_t ssthresh;
+
+	/** Highest sequence number sent when loss recovery started */
+	u32_t recover;
+
+	/** Receive window advertised by the peer */
+	u32_t send_wnd;
+#endif
+
+	/** Smoothed round-trip time in ms, scaled by 8 */
+	u32_t srtt;
+
+	/** Round-trip time variation in ms, scaled by 4 */
+	u32_t rttvar;
+
+	/** Retransmission timeout in ms, before backoff */
+	u32_t rto;
+
+	/** Round-trip time is measured until this sequence number is ACKed */
+	u32_t rtt_seq;
+
+	/** Uptime when the measured segment was sent */
+	u32_t rtt_start;
+
+#if defined(CONFIG_NET_TCP_OUT_OF_ORDER_QUEUE)
+	/** Segments received out of order, sorted by sequence number */
+	sys_slist_t ooo_list;
+#endif
+
+#if defined(CONFIG_NET_TCP_SACK)
+	/** Sequence number of the last segment added to ooo_list */
+	u32_t ooo_last_seq;
+#endif
+
 	/** Current retransmit period */
 	u32_t retry_timeout_shift : 5;
 	/** Flags for the TCP */
@@ -171,8 +247,18 @@ struct net_tcp {
 	u32_t fin_sent : 1;
 	/* An inbound FIN packet has been received */
 	u32_t fin_rcvd : 1;
+	/* A round-trip time measurement is in progress */
+	u32_t rtt_timing : 1;
+	/* Number of consecutive duplicate ACKs received */
+	u32_t dup_acks : 4;
+	/* Number of segments in ooo_list */
+	u32_t ooo_count : 4;
+	/* Both ends agreed on using SACK */
+	u32_t sack_permitted : 1;
+	/* Both ends agreed on window scaling */
+	u32_t wscale_ok : 1;
 	/** Remaining bits in this u32_t */
-	u32_t _padding : 13;
+	u32_t _padding : 2;
 };
 
 typedef void (*net_tcp_cb_t)(struct net_tcp *tcp, void *user_data);
@@ -662,6 +748,94 @@ static inline int net_tcp_update_recv_wnd(struct net_context *context,
 }
 #endif
 
+/**
+ * @brief Set the receive or send buffer size of a TCP context
+ *
+ * @param tcp TCP context
+ * @param recv True for the receive buffer, false for the send buffer
+ * @param size New size in bytes, 0 means unlimited for the send buffer
+ *
+ * @return 0 on success, -EINVAL if the size is out of range,
+ *         -EPROTONOSUPPORT if TCP is not supported
+ */
+#if defined(CONFIG_NET_TCP)
+int net_tcp_set_buf_size(struct net_tcp *tcp, bool recv, u32_t size);
+#else
+static inline int net_tcp_set_buf_size(struct net_tcp *tcp, bool recv,
+				       u32_t size)
+{
+	ARG_UNUSED(tcp);
+	ARG_UNUSED(recv);
+	ARG_UNUSED(size);
+
+	return -EPROTONOSUPPORT;
+}
+#endif
+
+/**
+ * @brief Get the receive or send buffer size of a TCP context
+ *
+ * @param tcp TCP context
+ * @param recv True for the receive buffer, false for the send buffer
+ *
+ * @return Buffer size in bytes
+ */
+#if defined(CONFIG_NET_TCP)
+u32_t net_tcp_get_buf_size(struct net_tcp *tcp, bool recv);
+#else
+static inline u32_t net_tcp_get_buf_size(struct net_tcp *tcp, bool recv)
+{
+	ARG_UNUSED(tcp);
+	ARG_UNUSED(recv);
+
+	return 0;
+}
+#endif
+
+/**
+ * @brief Free space in the send buffer of a TCP context
+ *
+ * @param tcp TCP context
+ *
+ * @return Number of bytes that can be queued for sending, UINT32_MAX if
+ *         the send buffer is unlimited
+ */
+#if defined(CONFIG_NET_TCP)
+u32_t net_tcp_get_send_space(struct net_tcp *tcp);
+#else
+static inline u32_t net_tcp_get_send_space(struct net_tcp *tcp)
+{
+	ARG_UNUSED(tcp);
+
+	return UINT32_MAX;
+}
+#endif
+
+/**
+ * @brief Wait for free space in the send buffer of a TCP context
+ *
+ * Must be called with the lock of the network context held. The lock is
+ * released while waiting as the send buffer drains when the peer
+ * acknowledges data, which needs the lock.
+ *
+ * @param tcp TCP context
+ * @param timeout Timeout for the wait
+ *
+ * @return 0 if there is space, -EAGAIN if the timeout expired, -ENOTCONN
+ *         if the connection was released meanwhile
+ */
+#if defined(CONFIG_NET_TCP)
+int net_tcp_wait_send_space(struct net_tcp *tcp, s32_t timeout);
+#else
+static inline int net_tcp_wait_send_space(struct net_tcp *tcp, s32_t timeout)
+{
+	ARG_UNUSED(tcp);
+	ARG_UNUSED(timeout);
+
+	return 0;
+}
+#endif
+
 /**
  * @brief Initialize TCP parts of a context
  *
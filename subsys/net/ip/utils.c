@@ -23,6 +23,8 @@ LOG_MODULE_REGISTER(net_utils, CONFIG_NET_UTILS_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/socket_can.h>
 
+#include "net_private.h"
+
 char *net_sprint_addr(sa_family_t af, const void *addr)
 {
 #define NBUFS 3
@@ -400,47 +402,182 @@ int net_addr_pton(sa_family_t family, const char *src,
 	return 0;
 }
 
-static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CHKSUM_TO_BE(sum) chksum_swap(sum)
+#define CHKSUM_BYTE(byte) (byte)
+#else
+#define CHKSUM_TO_BE(sum) (sum)
+#define CHKSUM_BYTE(byte) ((u32_t)(byte) << 8)
+#endif
+
+static inline u16_t chksum_swap(u16_t sum)
+{
+	return (sum >> 8) | (sum << 8);
+}
+
+static inline u16_t chksum_add(u16_t sum, u16_t val)
+{
+	u32_t tmp = (u32_t)sum + val;
+
+	return (tmp & 0xffff) + (tmp >> 16);
+}
+
+/* Fold a sum of 32-bit words to a 16-bit ones' complement sum */
+static inline u16_t chksum_fold(u64_t acc)
 {
-	const u8_t *end;
-	u16_t tmp;
+	u32_t sum;
+
+	acc = (acc & 0xffffffff) + (acc >> 32);
+	acc = (acc & 0xffffffff) + (acc >> 32);
 
-	end = data + len - 1;
+	sum = (u32_t)acc;
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return sum;
+}
+
+/* Ones' complement sum of 16-bit aligned data, in native byte order. The
+ * sum does not depend on the byte order (RFC 1071 chapter 2), so words are
+ * loaded 32 bits at a time and accumulated in 64 bits, which needs no carry
+ * handling in the loop. If dst is given, data is also copied there.
+ */
+static ALWAYS_INLINE u16_t chksum_native(const u8_t *data, u8_t *dst,
+					 size_t len)
+{
+	u64_t acc = 0U;
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
+	if (((uintptr_t)data & 2) && len >= 2) {
+		u16_t w = *(const u16_t *)data;
+
+		if (dst) {
+			UNALIGNED_PUT(w, (u16_t *)dst);
+			dst += 2;
 		}
 
+		acc += w;
 		data += 2;
+		len -= 2;
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
+	while (len >= 16) {
+		const u32_t *w = (const u32_t *)data;
+		u32_t w0 = w[0], w1 = w[1], w2 = w[2], w3 = w[3];
+
+		if (dst) {
+			UNALIGNED_PUT(w0, (u32_t *)dst);
+			UNALIGNED_PUT(w1, (u32_t *)(dst + 4));
+			UNALIGNED_PUT(w2, (u32_t *)(dst + 8));
+			UNALIGNED_PUT(w3, (u32_t *)(dst + 12));
+			dst += 16;
 		}
+
+		acc += (u64_t)w0 + w1 + w2 + w3;
+		data += 16;
+		len -= 16;
 	}
 
-	return sum;
+	while (len >= 4) {
+		u32_t w = *(const u32_t *)data;
+
+		if (dst) {
+			UNALIGNED_PUT(w, (u32_t *)dst);
+			dst += 4;
+		}
+
+		acc += w;
+		data += 4;
+		len -= 4;
+	}
+
+	if (len >= 2) {
+		u16_t w = *(const u16_t *)data;
+
+		if (dst) {
+			UNALIGNED_PUT(w, (u16_t *)dst);
+			dst += 2;
+		}
+
+		acc += w;
+		data += 2;
+		len -= 2;
+	}
+
+	if (len) {
+		if (dst) {
+			*dst = *data;
+		}
+
+		acc += CHKSUM_BYTE(*data);
+	}
+
+	return chksum_fold(acc);
+}
+
+/* Add the sum of data, as big endian 16-bit words, to sum. If odd is set,
+ * data starts in the middle of a word, which swaps the bytes of its sum.
+ */
+static ALWAYS_INLINE u16_t calc_chksum(u16_t sum, const u8_t *data,
+				       u8_t *dst, size_t len, bool odd)
+{
+	u16_t part;
+
+	if (!len) {
+		return sum;
+	}
+
+	if ((uintptr_t)data & 1) {
+		/* Align the data, the remainder is then offset by a byte */
+		if (dst) {
+			*dst++ = *data;
+		}
+
+		part = chksum_swap(CHKSUM_TO_BE(chksum_native(data + 1, dst,
+							      len - 1)));
+		part = chksum_add(part, *data << 8);
+	} else {
+		part = CHKSUM_TO_BE(chksum_native(data, dst, len));
+	}
+
+	if (odd) {
+		part = chksum_swap(part);
+	}
+
+	return chksum_add(sum, part);
 }
 
-static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
+u16_t net_calc_chksum_data(u16_t sum, const void *data, size_t len,
+			   bool odd)
+{
+	return calc_chksum(sum, data, NULL, len, odd);
+}
+
+u16_t net_calc_chksum_copy(u16_t sum, void *dst, const void *src,
+			   size_t len, bool odd)
+{
+	return calc_chksum(sum, src, dst, len, odd);
+}
+
+/* Sum len bytes from the cursor, across fragments */
+static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum,
+				    size_t len)
 {
 	struct net_pkt_cursor *cur = &pkt->cursor;
-	size_t len;
+	bool odd = false;
+	size_t part;
 
 	if (!cur->buf || !cur->pos) {
 		return sum;
 	}
 
-	len = cur->buf->len - (cur->pos - cur->buf->data);
+	part = cur->buf->len - (cur->pos - cur->buf->data);
+
+	while (len) {
+		part = MIN(part, len);
 
-	while (cur->buf) {
-		sum = calc_chksum(sum, cur->pos, len);
+		sum = calc_chksum(sum, cur->pos, NULL, part, odd);
+		odd ^= part & 1;
+		len -= part;
 
 		cur->buf = cur->buf->frags;
 		if (!cur->buf || !cur->buf->len) {
@@ -448,18 +585,7 @@ static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 		}
 
 		cur->pos = cur->buf->data;
-
-		if (len % 2) {
-			sum += *cur->pos;
-			if (sum < *cur->pos) {
-				sum++;
-			}
-
-			cur->pos++;
-			len = cur->buf->len - 1;
-		} else {
-			len = cur->buf->len;
-		}
+		part = cur->buf->len;
 	}
 
 	return sum;
@@ -468,23 +594,26 @@ static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto)
 {
 	size_t len = 0U;
+	size_t data_len;
 	u16_t sum = 0U;
 	struct net_pkt_cursor backup;
 	bool ow;
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_pkt_family(pkt) == AF_INET) {
+		data_len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt);
+
 		if (proto != IPPROTO_ICMP) {
 			len = 2 * sizeof(struct in_addr);
-			sum = net_pkt_get_len(pkt) -
-				net_pkt_ip_hdr_len(pkt) + proto;
+			sum = data_len + proto;
 		}
 	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
 		   net_pkt_family(pkt) == AF_INET6) {
+		data_len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+			   net_pkt_ipv6_ext_len(pkt);
+
 		len = 2 * sizeof(struct in6_addr);
-		sum =  net_pkt_get_len(pkt) -
-			net_pkt_ip_hdr_len(pkt) -
-			net_pkt_ipv6_ext_len(pkt) + proto;
+		sum = data_len + proto;
 	} else {
 		NET_DBG("Unknown protocol family %d", net_pkt_family(pkt));
 		return 0;
@@ -498,11 +627,22 @@ u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto)
 
 	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) - len);
 
-	sum = calc_chksum(sum, pkt->cursor.pos, len);
+	sum = calc_chksum(sum, pkt->cursor.pos, NULL, len, false);
 
 	net_pkt_skip(pkt, len + net_pkt_ipv6_ext_len(pkt));
 
-	sum = pkt_calc_chksum(pkt, sum);
+	if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP) &&
+	    net_pkt_has_payload_chksum(pkt) &&
+	    net_pkt_appdatalen(pkt) <= data_len) {
+		/* The payload was summed when it was written, and follows
+		 * a header of even length.
+		 */
+		sum = pkt_calc_chksum(pkt, sum,
+				      data_len - net_pkt_appdatalen(pkt));
+		sum = chksum_add(sum, net_pkt_payload_chksum(pkt));
+	} else {
+		sum = pkt_calc_chksum(pkt, sum, data_len);
+	}
 
 	sum = (sum == 0) ? 0xffff : htons(sum);
 
@@ -518,7 +658,7 @@ u16_t net_calc_chksum_ipv4(struct net_pkt *pkt)
 {
 	u16_t sum;
 
-	sum = calc_chksum(0, pkt->buffer->data, NET_IPV4H_LEN);
+	sum = calc_chksum(0, pkt->buffer->data, NULL, NET_IPV4H_LEN, false);
 
 	sum = (sum == 0) ? 0xffff : htons(sum);
 
@@ -19,6 +19,7 @@ LOG_MODULE_REGISTER(net_sock, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <misc/fdtable.h>
 
 #include "sockets_internal.h"
+#include "net_stats.h"
 
 #define SET_ERRNO(x) \
 	{ int _err = x; if (_err < 0) { errno = -_err; return -1; } }
@@ -101,6 +102,7 @@ int zsock_socket_internal(int family, int type, int proto)
 
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
+	zsock_epoll_init_ctx(ctx);
 
 #ifdef CONFIG_USERSPACE
 	/* Set net context object as initialized and grant access to the
@@ -164,6 +166,7 @@ int zsock_close_ctx(struct net_context *ctx)
 		(void)net_context_recv(ctx, NULL, K_NO_WAIT, NULL);
 	}
 
+	zsock_epoll_close_ctx(ctx);
 	zsock_flush_queue(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
@@ -221,12 +224,15 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 	NET_DBG("parent=%p, ctx=%p, st=%d", parent, new_ctx, status);
 
 	if (status == 0) {
+		zsock_epoll_init_ctx(new_ctx);
+
 		/* This just installs a callback, so cannot fail. */
 		(void)net_context_recv(new_ctx, zsock_received_cb, K_NO_WAIT,
 				       NULL);
 		k_fifo_init(&new_ctx->recv_q);
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		zsock_epoll_notify(parent);
 	}
 }
 
@@ -256,6 +262,8 @@ static void zsock_received_cb(struct net_context *ctx,
 			net_pkt_set_eof(last_pkt, true);
 			NET_DBG("Set EOF flag on pkt %p", last_pkt);
 		}
+
+		zsock_epoll_notify(ctx);
 		return;
 	}
 
@@ -267,6 +275,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	}
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_notify(ctx);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -430,6 +439,8 @@ ssize_t zsock_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 	s32_t timeout = K_FOREVER;
 	int status;
 
+	net_stats_start_tx_cycles(ctx);
+
 	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
 		timeout = K_NO_WAIT;
 	}
@@ -461,6 +472,78 @@ ssize_t zsock_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 	return status;
 }
 
+ssize_t zsock_sendmsg_ctx(struct net_context *ctx, const struct msghdr *msg,
+			  int flags)
+{
+	s32_t timeout = K_FOREVER;
+	int status;
+
+	net_stats_start_tx_cycles(ctx);
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	/* Register the callback before sending in order to receive the response
+	 * from the peer.
+	 */
+	status = net_context_recv(ctx, zsock_received_cb,
+				  K_NO_WAIT, ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	status = net_context_sendmsg(ctx, msg, NULL, timeout, NULL,
+				     ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	return status;
+}
+
+ssize_t zsock_sendto_buf(int sock, struct net_buf *buf, int flags,
+			 const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	struct net_context *ctx;
+	s32_t timeout = K_FOREVER;
+	int status;
+
+	ctx = z_get_fd_obj(sock, &sock_fd_op_vtable.fd_vtable, EOPNOTSUPP);
+	if (ctx == NULL) {
+		net_buf_unref(buf);
+		return -1;
+	}
+
+	net_stats_start_tx_cycles(ctx);
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	/* Register the callback before sending in order to receive the response
+	 * from the peer.
+	 */
+	status = net_context_recv(ctx, zsock_received_cb,
+				  K_NO_WAIT, ctx->user_data);
+	if (status < 0) {
+		net_buf_unref(buf);
+		errno = -status;
+		return -1;
+	}
+
+	status = net_context_sendto_buf(ctx, buf, dest_addr, addrlen, NULL,
+					timeout, NULL, ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	return status;
+}
+
 ssize_t _impl_zsock_sendto(int sock, const void *buf, size_t len, int flags,
 			   const struct sockaddr *dest_addr, socklen_t addrlen)
 {
@@ -586,17 +669,45 @@ error:
 	return ret;
 }
 
+/* Sets addrlen to the actual size of the source address */
+static int sock_get_src_addr(struct net_context *ctx, struct net_pkt *pkt,
+			     struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	int rv;
+
+	rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
+				   src_addr, *addrlen);
+	if (rv < 0) {
+		return rv;
+	}
+
+	if (src_addr->sa_family == AF_INET) {
+		*addrlen = sizeof(struct sockaddr_in);
+	} else if (src_addr->sa_family == AF_INET6) {
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+/* Scatters one datagram over the iovecs, ZSOCK_MSG_TRUNC is set in
+ * msg_flags if it did not fit.
+ */
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
-				       void *buf,
-				       size_t max_len,
+				       const struct iovec *iov,
+				       size_t iovlen,
 				       int flags,
 				       struct sockaddr *src_addr,
-				       socklen_t *addrlen)
+				       socklen_t *addrlen,
+				       int *msg_flags)
 {
 	s32_t timeout = K_FOREVER;
 	size_t recv_len = 0;
 	struct net_pkt_cursor backup;
 	struct net_pkt *pkt;
+	size_t i;
 
 	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
 		timeout = K_NO_WAIT;
@@ -627,37 +738,31 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	if (src_addr && addrlen) {
 		int rv;
 
-		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-					   src_addr, *addrlen);
+		/* addrlen is a value-result argument */
+		rv = sock_get_src_addr(ctx, pkt, src_addr, addrlen);
 		if (rv < 0) {
 			errno = -rv;
 			return -1;
 		}
+	}
 
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
+	for (i = 0; i < iovlen; i++) {
+		size_t len = MIN(iov[i].iov_len, net_pkt_remaining_data(pkt));
+
+		if (net_pkt_read_new(pkt, iov[i].iov_base, len)) {
+			errno = ENOBUFS;
 			return -1;
 		}
-	}
 
-	recv_len = net_pkt_remaining_data(pkt);
-	if (recv_len > max_len) {
-		recv_len = max_len;
+		recv_len += len;
 	}
 
-	if (net_pkt_read_new(pkt, buf, recv_len)) {
-		errno = ENOBUFS;
-		return -1;
+	if (msg_flags && net_pkt_remaining_data(pkt)) {
+		*msg_flags |= ZSOCK_MSG_TRUNC;
 	}
 
 	if (!(flags & ZSOCK_MSG_PEEK)) {
+		net_stats_update_rx_cycles(pkt, NET_STATS_LAYER_SOCKET);
 		net_pkt_unref(pkt);
 	} else {
 		net_pkt_cursor_restore(pkt, &backup);
@@ -733,6 +838,8 @@ static inline ssize_t zsock_recv_stream(struct net_context *ctx,
 					sock_set_eof(ctx);
 				}
 
+				net_stats_update_rx_cycles(
+					pkt, NET_STATS_LAYER_SOCKET);
 				net_pkt_unref(pkt);
 			}
 		} else {
@@ -754,7 +861,13 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 	enum net_sock_type sock_type = net_context_get_type(ctx);
 
 	if (sock_type == SOCK_DGRAM) {
-		return zsock_recv_dgram(ctx, buf, max_len, flags, src_addr, addrlen);
+		struct iovec iov = {
+			.iov_base = buf,
+			.iov_len = max_len,
+		};
+
+		return zsock_recv_dgram(ctx, &iov, 1, flags, src_addr, addrlen,
+					NULL);
 	} else if (sock_type == SOCK_STREAM) {
 		return zsock_recv_stream(ctx, buf, max_len, flags);
 	} else {
@@ -764,6 +877,148 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 	return 0;
 }
 
+ssize_t zsock_recvmsg_ctx(struct net_context *ctx, struct msghdr *msg,
+			  int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+	ssize_t recv_len = 0;
+	int saved_errno;
+	size_t i;
+
+	msg->msg_flags = 0;
+	msg->msg_controllen = 0;
+
+	if (sock_type == SOCK_DGRAM) {
+		socklen_t *addrlen = msg->msg_name ? &msg->msg_namelen : NULL;
+
+		return zsock_recv_dgram(ctx, msg->msg_iov, msg->msg_iovlen,
+					flags, msg->msg_name, addrlen,
+					&msg->msg_flags);
+	} else if (sock_type != SOCK_STREAM) {
+		__ASSERT(0, "Unknown socket type");
+		return 0;
+	}
+
+	msg->msg_namelen = 0;
+	saved_errno = errno;
+
+	/* Only the first read may block, the following iovecs take what is
+	 * already queued.
+	 */
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		size_t iov_len = msg->msg_iov[i].iov_len;
+		ssize_t len;
+
+		if (iov_len == 0) {
+			continue;
+		}
+
+		len = zsock_recv_stream(ctx, msg->msg_iov[i].iov_base, iov_len,
+					flags);
+		if (len < 0) {
+			if (recv_len == 0) {
+				return -1;
+			}
+
+			/* A partial read succeeds, the error (typically
+			 * EAGAIN) is not reported.
+			 */
+			errno = saved_errno;
+			break;
+		}
+
+		recv_len += len;
+
+		if ((size_t)len < iov_len || (flags & ZSOCK_MSG_PEEK)) {
+			break;
+		}
+
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return recv_len;
+}
+
+static ssize_t zsock_recvfrom_buf_ctx(struct net_context *ctx,
+				      struct net_buf **buf, int flags,
+				      struct sockaddr *src_addr,
+				      socklen_t *addrlen)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+	s32_t timeout = K_FOREVER;
+	struct net_pkt *pkt;
+	ssize_t len;
+	int res;
+
+	if (flags & ZSOCK_MSG_PEEK) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	*buf = NULL;
+
+	if (sock_type == SOCK_STREAM && sock_is_eof(ctx)) {
+		return 0;
+	}
+
+	res = _k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+	/* EAGAIN when timeout expired, EINTR when cancelled */
+	if (res && res != -EAGAIN && res != -EINTR) {
+		errno = -res;
+		return -1;
+	}
+
+	pkt = k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+	if (!pkt) {
+		if (sock_type == SOCK_STREAM && sock_is_eof(ctx)) {
+			return 0;
+		}
+
+		errno = EAGAIN;
+		return -1;
+	}
+
+	len = net_pkt_remaining_data(pkt);
+
+	if (sock_type == SOCK_STREAM) {
+		if (net_pkt_eof(pkt)) {
+			sock_set_eof(ctx);
+		}
+
+		net_context_update_recv_wnd(ctx, len);
+	} else if (src_addr && addrlen) {
+		res = sock_get_src_addr(ctx, pkt, src_addr, addrlen);
+		if (res < 0) {
+			net_pkt_unref(pkt);
+			errno = -res;
+			return -1;
+		}
+	}
+
+	*buf = net_pkt_detach_buffer(pkt);
+	net_stats_update_rx_cycles(pkt, NET_STATS_LAYER_SOCKET);
+	net_pkt_unref(pkt);
+
+	return len;
+}
+
+ssize_t zsock_recvfrom_buf(int sock, struct net_buf **buf, int flags,
+			   struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	struct net_context *ctx;
+
+	ctx = z_get_fd_obj(sock, &sock_fd_op_vtable.fd_vtable, EOPNOTSUPP);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return zsock_recvfrom_buf_ctx(ctx, buf, flags, src_addr, addrlen);
+}
+
 ssize_t _impl_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 			     struct sockaddr *src_addr, socklen_t *addrlen)
 {
@@ -803,6 +1058,304 @@ Z_SYSCALL_HANDLER(zsock_recvfrom, sock, buf, max_len, flags, src_addr,
 }
 #endif /* CONFIG_USERSPACE */
 
+/* Sockets without scatter-gather support take a single buffer */
+static ssize_t sock_sendmsg(void *ctx, const struct socket_op_vtable *vtable,
+			    const struct msghdr *msg, int flags)
+{
+	if (vtable->sendmsg) {
+		return vtable->sendmsg(ctx, msg, flags);
+	}
+
+	if (msg->msg_iovlen > 1) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	return vtable->sendto(ctx,
+			      msg->msg_iovlen ? msg->msg_iov[0].iov_base : NULL,
+			      msg->msg_iovlen ? msg->msg_iov[0].iov_len : 0,
+			      flags, msg->msg_name, msg->msg_namelen);
+}
+
+static ssize_t sock_recvmsg(void *ctx, const struct socket_op_vtable *vtable,
+			    struct msghdr *msg, int flags)
+{
+	if (vtable->recvmsg) {
+		return vtable->recvmsg(ctx, msg, flags);
+	}
+
+	if (msg->msg_iovlen > 1) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	msg->msg_flags = 0;
+	msg->msg_controllen = 0;
+
+	return vtable->recvfrom(ctx,
+				msg->msg_iovlen ? msg->msg_iov[0].iov_base : NULL,
+				msg->msg_iovlen ? msg->msg_iov[0].iov_len : 0,
+				flags, msg->msg_name,
+				msg->msg_name ? &msg->msg_namelen : NULL);
+}
+
+ssize_t _impl_zsock_sendmsg(int sock, const struct msghdr *msg, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return sock_sendmsg(ctx, vtable, msg, flags);
+}
+
+ssize_t _impl_zsock_recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return sock_recvmsg(ctx, vtable, msg, flags);
+}
+
+int _impl_zsock_sendmmsg(int sock, struct mmsghdr *msgvec, unsigned int vlen,
+			 int flags)
+{
+	const struct socket_op_vtable *vtable;
+	unsigned int i;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = sock_sendmsg(ctx, vtable, &msgvec[i].msg_hdr,
+					   flags);
+
+		if (len < 0) {
+			/* The error is reported by the next call */
+			return i > 0 ? i : -1;
+		}
+
+		msgvec[i].msg_len = len;
+	}
+
+	return i;
+}
+
+int _impl_zsock_recvmmsg(int sock, struct mmsghdr *msgvec, unsigned int vlen,
+			 int flags)
+{
+	const struct socket_op_vtable *vtable;
+	unsigned int i;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = sock_recvmsg(ctx, vtable, &msgvec[i].msg_hdr,
+					   flags);
+
+		if (len < 0) {
+			return i > 0 ? i : -1;
+		}
+
+		msgvec[i].msg_len = len;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	return i;
+}
+
+#ifdef CONFIG_USERSPACE
+/* Upper limit of the iovecs accepted from user mode */
+#define SOCK_USER_IOV_MAX 16
+
+struct sock_user_msg {
+	struct msghdr msg;
+	struct iovec iov[SOCK_USER_IOV_MAX];
+	struct sockaddr_storage addr;
+};
+
+/* Copies a message header from user mode and validates the buffers it
+ * points to, returns nonzero on failure.
+ */
+static int sock_user_msg_copy(struct sock_user_msg *copy,
+			      const struct msghdr *msg, bool write)
+{
+	size_t i;
+
+	if (z_user_from_copy(&copy->msg, (void *)msg, sizeof(copy->msg)) ||
+	    Z_SYSCALL_VERIFY(copy->msg.msg_iovlen <= SOCK_USER_IOV_MAX) ||
+	    z_user_from_copy(copy->iov, copy->msg.msg_iov,
+			     copy->msg.msg_iovlen * sizeof(struct iovec))) {
+		return -1;
+	}
+
+	for (i = 0; i < copy->msg.msg_iovlen; i++) {
+		if (Z_SYSCALL_MEMORY(copy->iov[i].iov_base,
+				     copy->iov[i].iov_len, write)) {
+			return -1;
+		}
+	}
+
+	copy->msg.msg_iov = copy->iov;
+	copy->msg.msg_control = NULL;
+	copy->msg.msg_controllen = 0;
+
+	if (copy->msg.msg_name) {
+		if (Z_SYSCALL_VERIFY(copy->msg.msg_namelen <=
+				     sizeof(copy->addr))) {
+			return -1;
+		}
+
+		if (write) {
+			if (Z_SYSCALL_MEMORY_WRITE(copy->msg.msg_name,
+						   copy->msg.msg_namelen)) {
+				return -1;
+			}
+		} else if (z_user_from_copy(&copy->addr, copy->msg.msg_name,
+					    copy->msg.msg_namelen)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* Returns the results of a receive to user mode, nonzero on failure */
+static int sock_user_msg_update(struct msghdr *msg,
+				struct sock_user_msg *copy)
+{
+	void *name = copy->msg.msg_name;
+
+	if (name && z_user_to_copy(name, &copy->addr,
+				   MIN(copy->msg.msg_namelen,
+				       sizeof(copy->addr)))) {
+		return -1;
+	}
+
+	return z_user_to_copy(&msg->msg_namelen, &copy->msg.msg_namelen,
+			      sizeof(msg->msg_namelen)) ||
+	       z_user_to_copy(&msg->msg_controllen, &copy->msg.msg_controllen,
+			      sizeof(msg->msg_controllen)) ||
+	       z_user_to_copy(&msg->msg_flags, &copy->msg.msg_flags,
+			      sizeof(msg->msg_flags));
+}
+
+static ssize_t sock_user_sendmsg(int sock, const struct msghdr *msg,
+				 int flags, void *ssf)
+{
+	struct sock_user_msg copy;
+
+	Z_OOPS(sock_user_msg_copy(&copy, msg, false));
+
+	if (copy.msg.msg_name) {
+		copy.msg.msg_name = &copy.addr;
+	}
+
+	return _impl_zsock_sendmsg(sock, &copy.msg, flags);
+}
+
+static ssize_t sock_user_recvmsg(int sock, struct msghdr *msg, int flags,
+				 void *ssf)
+{
+	struct sock_user_msg copy;
+	void *name;
+	ssize_t ret;
+
+	Z_OOPS(sock_user_msg_copy(&copy, msg, true));
+
+	name = copy.msg.msg_name;
+	if (name) {
+		copy.msg.msg_name = &copy.addr;
+	}
+
+	ret = _impl_zsock_recvmsg(sock, &copy.msg, flags);
+
+	copy.msg.msg_name = name;
+	if (ret >= 0) {
+		Z_OOPS(sock_user_msg_update(msg, &copy));
+	}
+
+	return ret;
+}
+
+Z_SYSCALL_HANDLER(zsock_sendmsg, sock, msg, flags)
+{
+	return sock_user_sendmsg(sock, (const struct msghdr *)msg, flags, ssf);
+}
+
+Z_SYSCALL_HANDLER(zsock_recvmsg, sock, msg, flags)
+{
+	return sock_user_recvmsg(sock, (struct msghdr *)msg, flags, ssf);
+}
+
+/* User mode messages are copied one by one, each of them looks up the
+ * socket again.
+ */
+Z_SYSCALL_HANDLER(zsock_sendmmsg, sock, msgvec, vlen, flags)
+{
+	struct mmsghdr *vec = (struct mmsghdr *)msgvec;
+	unsigned int i;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(vec, vlen, sizeof(*vec)));
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = sock_user_sendmsg(sock, &vec[i].msg_hdr, flags,
+						ssf);
+
+		if (len < 0) {
+			return i > 0 ? i : -1;
+		}
+
+		vec[i].msg_len = len;
+	}
+
+	return i;
+}
+
+Z_SYSCALL_HANDLER(zsock_recvmmsg, sock, msgvec, vlen, flags)
+{
+	struct mmsghdr *vec = (struct mmsghdr *)msgvec;
+	unsigned int i;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(vec, vlen, sizeof(*vec)));
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = sock_user_recvmsg(sock, &vec[i].msg_hdr, flags,
+						ssf);
+
+		if (len < 0) {
+			return i > 0 ? i : -1;
+		}
+
+		vec[i].msg_len = len;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	return i;
+}
+#endif /* CONFIG_USERSPACE */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -1066,11 +1619,47 @@ Z_SYSCALL_HANDLER(zsock_inet_pton, family, src, dst)
 }
 #endif
 
+static int sol_socket_option(int optname, enum net_context_option *option)
+{
+	switch (optname) {
+	case SO_RCVBUF:
+		*option = NET_OPT_RCVBUF;
+		return 0;
+	case SO_SNDBUF:
+		*option = NET_OPT_SNDBUF;
+		return 0;
+	}
+
+	return -ENOPROTOOPT;
+}
+
 int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 void *optval, socklen_t *optlen)
 {
-	errno = ENOPROTOOPT;
-	return -1;
+	enum net_context_option option;
+	size_t len;
+	int ret;
+
+	if (level != SOL_SOCKET ||
+	    sol_socket_option(optname, &option) < 0) {
+		errno = ENOPROTOOPT;
+		return -1;
+	}
+
+	if (!optval || !optlen || *optlen < sizeof(int)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = net_context_get_option(ctx, option, optval, &len);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	*optlen = len;
+
+	return 0;
 }
 
 int zsock_getsockopt(int sock, int level, int optname,
@@ -1082,8 +1671,27 @@ int zsock_getsockopt(int sock, int level, int optname,
 int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 const void *optval, socklen_t optlen)
 {
-	errno = ENOPROTOOPT;
-	return -1;
+	enum net_context_option option;
+	int ret;
+
+	if (level != SOL_SOCKET ||
+	    sol_socket_option(optname, &option) < 0) {
+		errno = ENOPROTOOPT;
+		return -1;
+	}
+
+	if (!optval || optlen != sizeof(int)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = net_context_set_option(ctx, option, optval, optlen);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
 }
 
 int zsock_setsockopt(int sock, int level, int optname,
@@ -1197,6 +1805,17 @@ static ssize_t sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				  src_addr, addrlen);
 }
 
+static ssize_t sock_sendmsg_vmeth(void *obj, const struct msghdr *msg,
+				  int flags)
+{
+	return zsock_sendmsg_ctx(obj, msg, flags);
+}
+
+static ssize_t sock_recvmsg_vmeth(void *obj, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg_ctx(obj, msg, flags);
+}
+
 static int sock_getsockopt_vmeth(void *obj, int level, int optname,
 				 void *optval, socklen_t *optlen)
 {
@@ -1222,6 +1841,8 @@ const struct socket_op_vtable sock_fd_op_vtable = {
 	.accept = sock_accept_vmeth,
 	.sendto = sock_sendto_vmeth,
 	.recvfrom = sock_recvfrom_vmeth,
+	.sendmsg = sock_sendmsg_vmeth,
+	.recvmsg = sock_recvmsg_vmeth,
 	.getsockopt = sock_getsockopt_vmeth,
 	.setsockopt = sock_setsockopt_vmeth,
 };
@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief epoll() style readiness notification for sockets
+ *
+ * A socket registered in an epoll instance is linked to it through an item.
+ * The socket receive callbacks queue the items of their socket on the ready
+ * list of the instance and raise its k_poll signal, so epoll_wait() only
+ * looks at the sockets which got an event since the last call.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_sock, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <net/net_context.h>
+#include <net/net_pkt.h>
+#include <net/socket.h>
+#include <syscall_handler.h>
+#include <misc/fdtable.h>
+
+#include "sockets_internal.h"
+
+/* Always reported, whether requested or not */
+#define EPOLL_EVENTS_ALWAYS (ZSOCK_EPOLLERR | ZSOCK_EPOLLHUP)
+
+struct epoll_instance;
+
+struct epoll_item {
+	/** Node in the list of the socket */
+	sys_snode_t ctx_node;
+
+	/** Node in the list of the instance */
+	sys_dnode_t ep_node;
+
+	/** Node in the ready list of the instance */
+	sys_dnode_t ready_node;
+
+	struct epoll_instance *ep;
+	struct net_context *ctx;
+
+	/** Requested events and flags, 0 while a one shot item is disabled */
+	u32_t events;
+	zsock_epoll_data_t data;
+
+	/** Is the item on the ready list */
+	bool queued;
+};
+
+struct epoll_instance {
+	sys_dlist_t items;
+	sys_dlist_t ready;
+	struct k_poll_signal signal;
+	bool is_used;
+};
+
+static struct epoll_instance epolls[CONFIG_NET_SOCKETS_EPOLL_MAX];
+
+K_MEM_SLAB_DEFINE(epoll_item_slab, sizeof(struct epoll_item),
+		  CONFIG_NET_SOCKETS_EPOLL_MAX_ITEMS,
+		  __alignof__(struct epoll_item));
+
+extern const struct socket_op_vtable sock_fd_op_vtable;
+
+static const struct fd_op_vtable epoll_fd_op_vtable;
+
+/* Current events of the socket, as poll() reports them */
+static u32_t epoll_ctx_events(struct net_context *ctx)
+{
+	/* For now, assume that socket is always writable */
+	u32_t events = ZSOCK_EPOLLOUT;
+	bool eof = sock_is_eof(ctx);
+
+	if (!k_fifo_is_empty(&ctx->recv_q)) {
+		events |= ZSOCK_EPOLLIN;
+
+		/* accept_q shares recv_q and holds contexts, not packets */
+		if (net_context_get_state(ctx) != NET_CONTEXT_LISTENING) {
+			struct net_pkt *last = k_fifo_peek_tail(&ctx->recv_q);
+
+			eof = eof || net_pkt_eof(last);
+		}
+	}
+
+	if (eof) {
+		events |= ZSOCK_EPOLLIN | ZSOCK_EPOLLRDHUP;
+	}
+
+	return events;
+}
+
+static u32_t epoll_item_revents(struct epoll_item *item)
+{
+	if (item->events == 0U) {
+		return 0;
+	}
+
+	return epoll_ctx_events(item->ctx) &
+		(item->events | EPOLL_EVENTS_ALWAYS);
+}
+
+/* Must be called with interrupts locked */
+static void epoll_item_queue(struct epoll_item *item)
+{
+	if (item->queued) {
+		return;
+	}
+
+	item->queued = true;
+	sys_dlist_append(&item->ep->ready, &item->ready_node);
+	k_poll_signal_raise(&item->ep->signal, 0);
+}
+
+/* Must be called with interrupts locked */
+static void epoll_item_free(struct epoll_item *item)
+{
+	if (item->queued) {
+		sys_dlist_remove(&item->ready_node);
+	}
+
+	sys_dlist_remove(&item->ep_node);
+	(void)sys_slist_find_and_remove(&item->ctx->epoll_items,
+					&item->ctx_node);
+
+	k_mem_slab_free(&epoll_item_slab, (void **)&item);
+}
+
+/* Must be called with interrupts locked */
+static struct epoll_item *epoll_item_find(struct epoll_instance *ep,
+					  struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	/* A socket is rarely in more than one instance, so the list of the
+	 * socket is shorter than the one of the instance.
+	 */
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		if (item->ep == ep) {
+			return item;
+		}
+	}
+
+	return NULL;
+}
+
+/* Must be called with interrupts locked */
+static void epoll_item_set(struct epoll_item *item,
+			   const struct zsock_epoll_event *event)
+{
+	item->events = event->events;
+	item->data = event->data;
+
+	/* Report events which are pending already, like poll() would */
+	if (epoll_item_revents(item) != 0U) {
+		epoll_item_queue(item);
+	}
+}
+
+void zsock_epoll_init_ctx(struct net_context *ctx)
+{
+	sys_slist_init(&ctx->epoll_items);
+}
+
+void zsock_epoll_notify(struct net_context *ctx)
+{
+	struct epoll_item *item;
+	unsigned int key;
+
+	key = irq_lock();
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		if (item->events != 0U) {
+			epoll_item_queue(item);
+		}
+	}
+
+	irq_unlock(key);
+}
+
+void zsock_epoll_close_ctx(struct net_context *ctx)
+{
+	struct epoll_item *item, *next;
+	unsigned int key;
+
+	key = irq_lock();
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&ctx->epoll_items, item, next,
+					  ctx_node) {
+		epoll_item_free(item);
+	}
+
+	irq_unlock(key);
+}
+
+static int epoll_close(struct epoll_instance *ep)
+{
+	struct epoll_item *item, *next;
+	unsigned int key;
+
+	key = irq_lock();
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&ep->items, item, next, ep_node) {
+		epoll_item_free(item);
+	}
+
+	ep->is_used = false;
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+int _impl_zsock_epoll_create1(int flags)
+{
+	struct epoll_instance *ep = NULL;
+	unsigned int key;
+	int fd, i;
+
+	if (flags != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		return -1;
+	}
+
+	key = irq_lock();
+
+	for (i = 0; i < ARRAY_SIZE(epolls); i++) {
+		if (!epolls[i].is_used) {
+			ep = &epolls[i];
+			ep->is_used = true;
+			break;
+		}
+	}
+
+	irq_unlock(key);
+
+	if (ep == NULL) {
+		z_free_fd(fd);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	sys_dlist_init(&ep->items);
+	sys_dlist_init(&ep->ready);
+	k_poll_signal_init(&ep->signal);
+
+	z_finalize_fd(fd, ep, &epoll_fd_op_vtable);
+
+	return fd;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_create1, flags)
+{
+	return _impl_zsock_epoll_create1(flags);
+}
+#endif /* CONFIG_USERSPACE */
+
+int zsock_epoll_create(int size)
+{
+	if (size <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return zsock_epoll_create1(0);
+}
+
+int _impl_zsock_epoll_ctl(int epfd, int op, int fd,
+			  struct zsock_epoll_event *event)
+{
+	struct epoll_instance *ep;
+	struct net_context *ctx;
+	struct epoll_item *item;
+	unsigned int key;
+	int ret = 0;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	/* Only plain sockets notify the instances */
+	ctx = z_get_fd_obj(fd, (const struct fd_op_vtable *)&sock_fd_op_vtable,
+			   EPERM);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL && event == NULL) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	key = irq_lock();
+
+	item = epoll_item_find(ep, ctx);
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		if (item != NULL) {
+			ret = -EEXIST;
+			break;
+		}
+
+		if (k_mem_slab_alloc(&epoll_item_slab, (void **)&item,
+				     K_NO_WAIT) < 0) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		item->ep = ep;
+		item->ctx = ctx;
+		item->queued = false;
+		sys_dlist_append(&ep->items, &item->ep_node);
+		sys_slist_append(&ctx->epoll_items, &item->ctx_node);
+
+		epoll_item_set(item, event);
+		break;
+
+	case ZSOCK_EPOLL_CTL_MOD:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		epoll_item_set(item, event);
+		break;
+
+	case ZSOCK_EPOLL_CTL_DEL:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		epoll_item_free(item);
+		break;
+
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	irq_unlock(key);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_ctl, epfd, op, fd, event)
+{
+	struct zsock_epoll_event event_copy;
+
+	if (event == 0) {
+		return _impl_zsock_epoll_ctl(epfd, op, fd, NULL);
+	}
+
+	Z_OOPS(z_user_from_copy(&event_copy, (void *)event,
+				sizeof(event_copy)));
+
+	return _impl_zsock_epoll_ctl(epfd, op, fd, &event_copy);
+}
+#endif /* CONFIG_USERSPACE */
+
+/* Move up to maxevents ready items to events. Level triggered items stay
+ * queued, at the tail, until their socket is drained.
+ */
+static int epoll_collect(struct epoll_instance *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	sys_dlist_t requeue;
+	sys_dnode_t *node;
+	unsigned int key;
+	int n = 0;
+
+	sys_dlist_init(&requeue);
+
+	key = irq_lock();
+
+	while (n < maxevents && (node = sys_dlist_get(&ep->ready)) != NULL) {
+		struct epoll_item *item = CONTAINER_OF(node, struct epoll_item,
+						       ready_node);
+		u32_t revents = epoll_item_revents(item);
+
+		if (revents == 0U) {
+			item->queued = false;
+			continue;
+		}
+
+		events[n].events = revents;
+		events[n].data = item->data;
+		n++;
+
+		if (item->events & ZSOCK_EPOLLONESHOT) {
+			item->events = 0U;
+			item->queued = false;
+		} else if (item->events & ZSOCK_EPOLLET) {
+			item->queued = false;
+		} else {
+			sys_dlist_append(&requeue, node);
+		}
+	}
+
+	while ((node = sys_dlist_get(&requeue)) != NULL) {
+		sys_dlist_append(&ep->ready, node);
+	}
+
+	irq_unlock(key);
+
+	return n;
+}
+
+static inline int time_left(u32_t start, u32_t timeout)
+{
+	u32_t elapsed = k_uptime_get_32() - start;
+
+	return timeout - elapsed;
+}
+
+int _impl_zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			   int maxevents, int timeout)
+{
+	struct epoll_instance *ep;
+	struct k_poll_event event;
+	u32_t entry_time = k_uptime_get_32();
+	int remaining_time;
+	int ret;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout < 0) {
+		timeout = K_FOREVER;
+	}
+
+	remaining_time = timeout;
+
+	while (true) {
+		/* Reset before collecting, an event arriving afterwards
+		 * makes k_poll() return at once.
+		 */
+		k_poll_signal_reset(&ep->signal);
+
+		ret = epoll_collect(ep, events, maxevents);
+		if (ret > 0 || remaining_time == K_NO_WAIT) {
+			return ret;
+		}
+
+		k_poll_event_init(&event, K_POLL_TYPE_SIGNAL,
+				  K_POLL_MODE_NOTIFY_ONLY, &ep->signal);
+
+		ret = k_poll(&event, 1, remaining_time);
+		if (ret == -EAGAIN) {
+			return 0;
+		}
+
+		if (ret != 0 && ret != -EINTR) {
+			errno = -ret;
+			return -1;
+		}
+
+		if (timeout != K_FOREVER) {
+			/* Collect once more without waiting if the time is
+			 * up already.
+			 */
+			remaining_time = MAX(time_left(entry_time, timeout),
+					     K_NO_WAIT);
+		}
+	}
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_wait, epfd, events, maxevents, timeout)
+{
+	if (maxevents > 0) {
+		Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(events, maxevents,
+				sizeof(struct zsock_epoll_event)));
+	}
+
+	return _impl_zsock_epoll_wait(epfd, (struct zsock_epoll_event *)events,
+				      maxevents, timeout);
+}
+#endif /* CONFIG_USERSPACE */
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(count);
+
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(count);
+
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	ARG_UNUSED(args);
+
+	switch (request) {
+	case ZFD_IOCTL_CLOSE:
+		return epoll_close(obj);
+
+	default:
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+}
+
+static const struct fd_op_vtable epoll_fd_op_vtable = {
+	.read = epoll_read_vmeth,
+	.write = epoll_write_vmeth,
+	.ioctl = epoll_ioctl_vmeth,
+};
@@ -10,6 +10,7 @@
 
 #include <fcb.h>
 #include "settings/settings.h"
+#include "settings/settings_index.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +19,9 @@ extern "C" {
 struct settings_fcb {
 	struct settings_store cf_store;
 	struct fcb cf_fcb;
+#ifdef CONFIG_SETTINGS_INDEX
+	struct settings_index cf_index;	/* private */
+#endif
 };
 
 extern int settings_fcb_src(struct settings_fcb *cf);
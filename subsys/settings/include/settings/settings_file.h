@@ -9,6 +9,7 @@
 #define __SETTINGS_FILE_H_
 
 #include "settings/settings.h"
+#include "settings/settings_index.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,6 +22,9 @@ struct settings_file {
 	const char *cf_name;	/* filename */
 	int cf_maxlines;	/* max # of lines before compressing */
 	int cf_lines;		/* private */
+#ifdef CONFIG_SETTINGS_INDEX
+	struct settings_index cf_index;	/* private */
+#endif
 };
 
 /* register file to be source of settings */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __SETTINGS_INDEX_H_
+#define __SETTINGS_INDEX_H_
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_SETTINGS_INDEX
+
+/*
+ * In-RAM index from the hash of a setting name to the location of the
+ * newest record for that name in a storage back-end. Names are not stored,
+ * so a lookup may return the record of another name with the same hash;
+ * users must check the name of the record they read back.
+ */
+struct settings_index_entry {
+	u32_t hash;	/* name hash, 0 marks a free slot */
+	u32_t loc[2];	/* record location, meaning is back-end specific */
+};
+
+struct settings_index {
+	struct settings_index_entry entries[CONFIG_SETTINGS_INDEX_SIZE];
+	bool valid;	/* every record of the store has been indexed */
+	bool overflow;	/* some names did not fit, a miss is not final */
+};
+
+void settings_index_reset(struct settings_index *idx);
+void settings_index_put(struct settings_index *idx, const char *name,
+			u32_t loc0, u32_t loc1);
+struct settings_index_entry *settings_index_get(struct settings_index *idx,
+						const char *name);
+
+#endif /* CONFIG_SETTINGS_INDEX */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SETTINGS_INDEX_H_ */
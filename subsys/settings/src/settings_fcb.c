@@ -15,25 +15,78 @@
 
 #define SETTINGS_FCB_VERS		1
 
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+/*
+ * First data byte of an entry holding a batch of records. A plain entry
+ * starts with the record name, which is never empty.
+ */
+#define SETTINGS_FCB_BATCH_MAGIC	0x00
+#endif
+
 struct settings_fcb_load_cb_arg {
 	load_cb cb;
 	void *cb_arg;
+#ifdef CONFIG_SETTINGS_INDEX
+	struct settings_fcb *cf;	/* index every record when not NULL */
+#endif
 };
 
 static int settings_fcb_load(struct settings_store *cs, load_cb cb,
 			     void *cb_arg);
 static int settings_fcb_save(struct settings_store *cs, const char *name,
 			     const char *value, size_t val_len);
+#ifdef CONFIG_SETTINGS_INDEX
+static int settings_fcb_load_one(struct settings_store *cs, const char *name,
+				 load_cb cb, void *cb_arg);
+#endif
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+static int settings_fcb_save_batch(struct settings_store *cs, const char *buf,
+				   size_t len);
+#endif
 
 static struct settings_store_itf settings_fcb_itf = {
 	.csi_load = settings_fcb_load,
 	.csi_save = settings_fcb_save,
+#ifdef CONFIG_SETTINGS_INDEX
+	.csi_load_one = settings_fcb_load_one,
+#endif
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+	.csi_save_batch = settings_fcb_save_batch,
+#endif
 };
 
+#ifdef CONFIG_SETTINGS_INDEX
+/*
+ * Index locations are the sector number and the data length in loc[0], and
+ * the data offset within the sector in loc[1].
+ */
+static void settings_fcb_index_put(struct settings_fcb *cf, const char *name,
+				   const struct fcb_entry *loc)
+{
+	u32_t sector = loc->fe_sector - cf->cf_fcb.f_sectors;
+
+	settings_index_put(&cf->cf_index, name,
+			   (sector << 16) | loc->fe_data_len, loc->fe_data_off);
+}
+
+static void settings_fcb_index_loc(struct settings_fcb *cf,
+				   const struct settings_index_entry *e,
+				   struct fcb_entry *loc)
+{
+	loc->fe_sector = &cf->cf_fcb.f_sectors[e->loc[0] >> 16];
+	loc->fe_data_len = e->loc[0] & 0xffff;
+	loc->fe_data_off = e->loc[1];
+	loc->fe_elem_off = 0;
+}
+#endif
+
 int settings_fcb_src(struct settings_fcb *cf)
 {
 	int rc;
 
+#ifdef CONFIG_SETTINGS_INDEX
+	settings_index_reset(&cf->cf_index);
+#endif
 	cf->cf_fcb.f_version = SETTINGS_FCB_VERS;
 	cf->cf_fcb.f_scratch_cnt = 1;
 
@@ -70,13 +123,73 @@ int settings_fcb_src(struct settings_fcb *cf)
 
 int settings_fcb_dst(struct settings_fcb *cf)
 {
+#ifdef CONFIG_SETTINGS_INDEX
+	settings_index_reset(&cf->cf_index);
+#endif
 	cf->cf_store.cs_itf = &settings_fcb_itf;
 	settings_dst_register(&cf->cf_store);
 
 	return 0;
 }
 
-static int settings_fcb_load_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+/*
+ * Get the record at *off of an FCB entry and advance *off. A plain entry is
+ * a single record. A batch entry holds records back to back, each one
+ * prefixed with its u16 length. Returns -ENOENT past the last record.
+ */
+static int settings_fcb_rec_next(const struct fcb_entry_ctx *entry,
+				 size_t *off, struct fcb_entry_ctx *rec)
+{
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+	u8_t magic;
+	u16_t len;
+	int rc;
+#endif
+
+	if (*off >= entry->loc.fe_data_len) {
+		return -ENOENT;
+	}
+	*rec = *entry;
+
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+	if (*off == 0) {
+		rc = flash_area_read(entry->fap,
+				     FCB_ENTRY_FA_DATA_OFF(entry->loc),
+				     &magic, sizeof(magic));
+		if (rc) {
+			return -EIO;
+		}
+		if (magic == SETTINGS_FCB_BATCH_MAGIC) {
+			*off = sizeof(magic);
+		}
+	}
+
+	if (*off) {
+		if (*off + sizeof(len) > entry->loc.fe_data_len) {
+			return -ENOENT;
+		}
+		rc = flash_area_read(entry->fap,
+				     FCB_ENTRY_FA_DATA_OFF(entry->loc) + *off,
+				     &len, sizeof(len));
+		if (rc) {
+			return -EIO;
+		}
+		if (*off + sizeof(len) + len > entry->loc.fe_data_len) {
+			return -ENOENT;
+		}
+
+		rec->loc.fe_data_off += *off + sizeof(len);
+		rec->loc.fe_data_len = len;
+		*off += sizeof(len) + len;
+		return 0;
+	}
+#endif
+
+	*off = entry->loc.fe_data_len;
+	return 0;
+}
+
+static int settings_fcb_load_rec(struct fcb_entry_ctx *entry_ctx, void *arg)
 {
 	struct settings_fcb_load_cb_arg *argp;
 	char buf[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
@@ -93,12 +206,29 @@ static int settings_fcb_load_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
 	}
 	buf[len_read] = '\0';
 
+#ifdef CONFIG_SETTINGS_INDEX
+	if (argp->cf) {
+		settings_fcb_index_put(argp->cf, buf, &entry_ctx->loc);
+	}
+#endif
+
 	/*name, val-read_cb-ctx, val-off*/
 	/* take into account '=' separator after the name */
 	argp->cb(buf, (void *)&entry_ctx->loc, len_read + 1, argp->cb_arg);
 	return 0;
 }
 
+static int settings_fcb_load_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+{
+	struct fcb_entry_ctx rec;
+	size_t off = 0;
+
+	while (settings_fcb_rec_next(entry_ctx, &off, &rec) == 0) {
+		settings_fcb_load_rec(&rec, arg);
+	}
+	return 0;
+}
+
 static int settings_fcb_load(struct settings_store *cs, load_cb cb,
 			     void *cb_arg)
 {
@@ -108,13 +238,63 @@ static int settings_fcb_load(struct settings_store *cs, load_cb cb,
 
 	arg.cb = cb;
 	arg.cb_arg = cb_arg;
+#ifdef CONFIG_SETTINGS_INDEX
+	/* a full walk sees every record, so rebuild the index on the way */
+	arg.cf = cf;
+	settings_index_reset(&cf->cf_index);
+#endif
 	rc = fcb_walk(&cf->cf_fcb, 0, settings_fcb_load_cb, &arg);
 	if (rc) {
 		return -EINVAL;
 	}
+#ifdef CONFIG_SETTINGS_INDEX
+	cf->cf_index.valid = true;
+#endif
 	return 0;
 }
 
+#ifdef CONFIG_SETTINGS_INDEX
+static void settings_fcb_nop_cb(char *name, void *val_read_cb_ctx, off_t off,
+				void *cb_arg)
+{
+}
+
+/* ::csi_load_one implementation */
+static int settings_fcb_load_one(struct settings_store *cs, const char *name,
+				 load_cb cb, void *cb_arg)
+{
+	struct settings_fcb *cf = (struct settings_fcb *)cs;
+	struct settings_fcb_load_cb_arg arg;
+	struct settings_index_entry *e;
+	struct fcb_entry_ctx entry_ctx;
+	int rc;
+
+	if (!cf->cf_index.valid) {
+		rc = settings_fcb_load(cs, settings_fcb_nop_cb, NULL);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	e = settings_index_get(&cf->cf_index, name);
+	if (!e) {
+		if (cf->cf_index.overflow) {
+			return settings_fcb_load(cs, cb, cb_arg);
+		}
+		return 0;
+	}
+
+	entry_ctx.fap = cf->cf_fcb.fap;
+	settings_fcb_index_loc(cf, e, &entry_ctx.loc);
+
+	/* the callback checks the name, which may differ on hash collision */
+	arg.cb = cb;
+	arg.cb_arg = cb_arg;
+	arg.cf = NULL;
+	return settings_fcb_load_rec(&entry_ctx, &arg);
+}
+#endif
+
 static int read_handler(void *ctx, off_t off, char *buf, size_t *len)
 {
 	struct fcb_entry_ctx *entry_ctx = ctx;
@@ -133,22 +313,58 @@ static int read_handler(void *ctx, off_t off, char *buf, size_t *len)
 			       *len);
 }
 
+/*
+ * Check whether a record for name is found after the record at off of
+ * entry, either later in the same entry or in a newer one.
+ */
+static bool settings_fcb_has_newer(struct settings_fcb *cf,
+				   const struct fcb_entry_ctx *entry,
+				   size_t off, const char *name,
+				   size_t name_len)
+{
+	struct fcb_entry_ctx loc = *entry;
+	struct fcb_entry_ctx rec;
+	char name2[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN];
+	size_t val2_off;
+	int rc;
+
+	do {
+		while (settings_fcb_rec_next(&loc, &off, &rec) == 0) {
+			rc = settings_line_name_read(name2, sizeof(name2),
+						     &val2_off, &rec);
+			if (rc) {
+				continue;
+			}
+
+			if ((name_len == val2_off) &&
+			    !memcmp(name, name2, name_len)) {
+				return true;
+			}
+		}
+		off = 0;
+	} while (fcb_getnext(&cf->cf_fcb, &loc.loc) == 0);
+
+	return false;
+}
+
 static void settings_fcb_compress(struct settings_fcb *cf)
 {
 	int rc;
 	struct fcb_entry_ctx loc1;
 	struct fcb_entry_ctx loc2;
+	struct fcb_entry_ctx rec;
 	char name1[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN];
-	char name2[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN];
-	int copy;
-	u8_t rbs;
+	size_t off;
 
 	rc = fcb_append_to_scratch(&cf->cf_fcb);
 	if (rc) {
 		return; /* XXX */
 	}
 
-	rbs = flash_area_align(cf->cf_fcb.fap);
+#ifdef CONFIG_SETTINGS_INDEX
+	/* records are moved and the oldest sector erased */
+	settings_index_reset(&cf->cf_index);
+#endif
 
 	loc1.fap = cf->cf_fcb.fap;
 
@@ -160,58 +376,47 @@ static void settings_fcb_compress(struct settings_fcb *cf)
 			break;
 		}
 
-		size_t val1_off;
-
-		rc = settings_line_name_read(name1, sizeof(name1), &val1_off,
-					     &loc1);
-		if (rc) {
-			continue;
-		}
+		off = 0;
+		while (settings_fcb_rec_next(&loc1, &off, &rec) == 0) {
+			size_t val1_off;
 
-		if (val1_off + 1 == loc1.loc.fe_data_len) {
-			/* Lack of a value so the record is a deletion-record */
-			/* No sense to copy empty entry from */
-			/* the oldest sector */
-			continue;
-		}
+			rc = settings_line_name_read(name1, sizeof(name1),
+						     &val1_off, &rec);
+			if (rc) {
+				continue;
+			}
 
-		loc2 = loc1;
-		copy = 1;
+			if (val1_off + 1 == rec.loc.fe_data_len) {
+				/* Lack of a value so the record is a */
+				/* deletion-record. No sense to copy empty */
+				/* entry from the oldest sector */
+				continue;
+			}
 
-		while (fcb_getnext(&cf->cf_fcb, &loc2.loc) == 0) {
-			size_t val2_off;
+			if (settings_fcb_has_newer(cf, &loc1, off, name1,
+						   val1_off)) {
+				continue;
+			}
 
-			rc = settings_line_name_read(name2, sizeof(name2),
-						     &val2_off, &loc2);
+			/*
+			 * Can't find one. Must copy. Records of a batch are
+			 * copied as plain entries.
+			 */
+			rc = fcb_append(&cf->cf_fcb, rec.loc.fe_data_len,
+					&loc2.loc);
 			if (rc) {
 				continue;
 			}
 
-			if ((val1_off == val2_off) &&
-			    !memcmp(name1, name2, val1_off)) {
-				copy = 0;
-				break;
+			loc2.fap = cf->cf_fcb.fap;
+			rc = settings_entry_copy(&loc2, 0, &rec, 0,
+						 rec.loc.fe_data_len);
+			if (rc) {
+				continue;
 			}
+			rc = fcb_append_finish(&cf->cf_fcb, &loc2.loc);
+			__ASSERT(rc == 0, "Failed to finish fcb_append.\n");
 		}
-		if (!copy) {
-			continue;
-		}
-
-		/*
-		 * Can't find one. Must copy.
-		 */
-		rc = fcb_append(&cf->cf_fcb, loc1.loc.fe_data_len, &loc2.loc);
-		if (rc) {
-			continue;
-		}
-
-		rc = settings_entry_copy(&loc2, 0, &loc1, 0,
-					 loc1.loc.fe_data_len);
-		if (rc) {
-			continue;
-		}
-		rc = fcb_append_finish(&cf->cf_fcb, &loc2.loc);
-		__ASSERT(rc == 0, "Failed to finish fcb_append.\n");
 	}
 	rc = fcb_rotate(&cf->cf_fcb);
 
@@ -273,8 +478,128 @@ static int settings_fcb_save(struct settings_store *cs, const char *name,
 			rc = i;
 		}
 	}
+
+#ifdef CONFIG_SETTINGS_INDEX
+	if (rc) {
+		/* an unfinished record may still be found by a full walk */
+		settings_index_reset(&cf->cf_index);
+	} else if (cf->cf_index.valid) {
+		settings_fcb_index_put(cf, name, &loc.loc);
+	}
+#endif
+	return rc;
+}
+
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+/* Write the batch magic followed by the records, padded to write-block-size */
+static int settings_fcb_batch_write(struct settings_fcb *cf,
+				    struct fcb_entry_ctx *loc,
+				    const char *buf, size_t len)
+{
+	char w_buf[16];
+	size_t w_size, add;
+	off_t w_loc = 0;
+	u8_t wbs = cf->cf_fcb.f_align;
+	int rc;
+
+	w_buf[0] = SETTINGS_FCB_BATCH_MAGIC;
+	w_size = 1;
+
+	do {
+		add = MIN(len, sizeof(w_buf) - w_size);
+		memcpy(&w_buf[w_size], buf, add);
+		w_size += add;
+		buf += add;
+		len -= add;
+
+		if (!len && (w_size % wbs)) {
+			add = wbs - w_size % wbs;
+			(void)memset(&w_buf[w_size], '\0', add);
+			w_size += add;
+		}
+
+		rc = write_handler(loc, w_loc, w_buf, w_size);
+		if (rc) {
+			return -EIO;
+		}
+		w_loc += w_size;
+		w_size = 0;
+	} while (len);
+
+	return 0;
+}
+
+#ifdef CONFIG_SETTINGS_INDEX
+static void settings_fcb_index_batch(struct settings_fcb *cf,
+				     const struct fcb_entry_ctx *loc,
+				     const char *buf, size_t len)
+{
+	char name[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+	struct fcb_entry rec;
+	const char *line;
+	const char *sep;
+	size_t off = 0;
+	u16_t line_len;
+
+	rec = loc->loc;
+	while (!settings_line_batch_next(buf, len, &off, &line, &line_len)) {
+		sep = memchr(line, '=', line_len);
+		if (!sep || sep - line >= sizeof(name)) {
+			settings_index_reset(&cf->cf_index);
+			return;
+		}
+		memcpy(name, line, sep - line);
+		name[sep - line] = '\0';
+
+		/* lines are found after the magic byte */
+		rec.fe_data_off = loc->loc.fe_data_off + 1 + (line - buf);
+		rec.fe_data_len = line_len;
+		settings_fcb_index_put(cf, name, &rec);
+	}
+}
+#endif
+
+/* ::csi_save_batch implementation */
+static int settings_fcb_save_batch(struct settings_store *cs, const char *buf,
+				   size_t len)
+{
+	struct settings_fcb *cf = (struct settings_fcb *)cs;
+	struct fcb_entry_ctx loc;
+	int rc;
+	int i;
+
+	/*
+	 * The whole batch goes into a single entry, so the entry CRC makes
+	 * either all or none of its records valid.
+	 */
+	for (i = 0; i < cf->cf_fcb.f_sector_cnt - 1; i++) {
+		rc = fcb_append(&cf->cf_fcb, len + 1, &loc.loc);
+		if (rc != FCB_ERR_NOSPACE) {
+			break;
+		}
+		settings_fcb_compress(cf);
+	}
+	if (rc) {
+		return -EINVAL;
+	}
+
+	loc.fap = cf->cf_fcb.fap;
+
+	rc = settings_fcb_batch_write(cf, &loc, buf, len);
+	if (!rc) {
+		rc = fcb_append_finish(&cf->cf_fcb, &loc.loc);
+	}
+
+#ifdef CONFIG_SETTINGS_INDEX
+	if (rc) {
+		settings_index_reset(&cf->cf_index);
+	} else if (cf->cf_index.valid) {
+		settings_fcb_index_batch(cf, &loc, buf, len);
+	}
+#endif
 	return rc;
 }
+#endif
 
 void settings_mount_fcb_backend(struct settings_fcb *cf)
 {
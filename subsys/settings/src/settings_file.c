@@ -18,12 +18,31 @@ static int settings_file_load(struct settings_store *cs, load_cb cb,
 			      void *cb_arg);
 static int settings_file_save(struct settings_store *cs, const char *name,
 			      const char *value, size_t val_len);
+#ifdef CONFIG_SETTINGS_INDEX
+static int settings_file_load_one(struct settings_store *cs, const char *name,
+				  load_cb cb, void *cb_arg);
+#endif
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+static int settings_file_save_batch(struct settings_store *cs,
+				    const char *buf, size_t len);
+#endif
 
 static struct settings_store_itf settings_file_itf = {
 	.csi_load = settings_file_load,
 	.csi_save = settings_file_save,
+#ifdef CONFIG_SETTINGS_INDEX
+	.csi_load_one = settings_file_load_one,
+#endif
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+	.csi_save_batch = settings_file_save_batch,
+#endif
 };
 
+/*
+ * Index locations are the file offset of the line past its length field
+ * in loc[0] and the line length in loc[1], as in struct line_entry_ctx.
+ */
+
 /*
  * Register a file to be a source of configuration.
  */
@@ -32,6 +51,9 @@ int settings_file_src(struct settings_file *cf)
 	if (!cf->cf_name) {
 		return -EINVAL;
 	}
+#ifdef CONFIG_SETTINGS_INDEX
+	settings_index_reset(&cf->cf_index);
+#endif
 	cf->cf_store.cs_itf = &settings_file_itf;
 	settings_src_register(&cf->cf_store);
 
@@ -43,6 +65,9 @@ int settings_file_dst(struct settings_file *cf)
 	if (!cf->cf_name) {
 		return -EINVAL;
 	}
+#ifdef CONFIG_SETTINGS_INDEX
+	settings_index_reset(&cf->cf_index);
+#endif
 	cf->cf_store.cs_itf = &settings_file_itf;
 	settings_dst_register(&cf->cf_store);
 
@@ -83,6 +108,11 @@ static int settings_file_load(struct settings_store *cs, load_cb cb,
 		return -EINVAL;
 	}
 
+#ifdef CONFIG_SETTINGS_INDEX
+	/* a full walk sees every line, so rebuild the index on the way */
+	settings_index_reset(&cf->cf_index);
+#endif
+
 	while (1) {
 		rc = settings_next_line_ctx(&entry_ctx);
 
@@ -98,6 +128,11 @@ static int settings_file_load(struct settings_store *cs, load_cb cb,
 		}
 		buf[len_read] = '\0';
 
+#ifdef CONFIG_SETTINGS_INDEX
+		settings_index_put(&cf->cf_index, buf, entry_ctx.seek,
+				   entry_ctx.len);
+#endif
+
 		/*name, val-read_cb-ctx, val-off*/
 		/* take into account '=' separator after the name */
 		cb(buf, (void *)&entry_ctx, len_read + 1, cb_arg);
@@ -106,10 +141,68 @@ static int settings_file_load(struct settings_store *cs, load_cb cb,
 
 	rc = fs_close(&file);
 	cf->cf_lines = lines;
+#ifdef CONFIG_SETTINGS_INDEX
+	cf->cf_index.valid = (rc == 0);
+#endif
 
 	return rc;
 }
 
+#ifdef CONFIG_SETTINGS_INDEX
+static void settings_file_nop_cb(char *name, void *val_read_cb_ctx, off_t off,
+				 void *cb_arg)
+{
+}
+
+/* ::csi_load_one implementation */
+static int settings_file_load_one(struct settings_store *cs, const char *name,
+				  load_cb cb, void *cb_arg)
+{
+	struct settings_file *cf = (struct settings_file *)cs;
+	char buf[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+	struct settings_index_entry *e;
+	struct fs_file_t file;
+	struct line_entry_ctx entry_ctx = {
+		.stor_ctx = (void *)&file,
+	};
+	size_t len_read;
+	int rc;
+
+	if (!cf->cf_index.valid) {
+		rc = settings_file_load(cs, settings_file_nop_cb, NULL);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	e = settings_index_get(&cf->cf_index, name);
+	if (!e) {
+		if (cf->cf_index.overflow) {
+			return settings_file_load(cs, cb, cb_arg);
+		}
+		return 0;
+	}
+
+	entry_ctx.seek = e->loc[0];
+	entry_ctx.len = e->loc[1];
+
+	rc = fs_open(&file, cf->cf_name);
+	if (rc != 0) {
+		return -EINVAL;
+	}
+
+	rc = settings_line_name_read(buf, sizeof(buf), &len_read,
+				     (void *)&entry_ctx);
+	if (rc == 0 && len_read != 0) {
+		buf[len_read] = '\0';
+		/* the callback checks the name, which may differ on collision */
+		cb(buf, (void *)&entry_ctx, len_read + 1, cb_arg);
+	}
+
+	return fs_close(&file);
+}
+#endif
+
 static void settings_tmpfile(char *dst, const char *src, char *pfx)
 {
 	int len;
@@ -144,10 +237,12 @@ static int settings_file_create_or_replace(struct fs_file_t *zfp,
 }
 
 /*
- * Try to compress configuration file by keeping unique names only.
+ * Try to compress configuration file by keeping unique names only, then
+ * store either the new value or, if batch is not NULL, the lines of a batch.
  */
-int settings_file_save_and_compress(struct settings_file *cf, const char *name,
-			      const char *value, size_t val_len)
+static int settings_file_compress(struct settings_file *cf, const char *name,
+				  const char *value, size_t val_len,
+				  const char *batch, size_t batch_len)
 {
 	int rc, rc2;
 	struct fs_file_t rf;
@@ -184,7 +279,12 @@ int settings_file_save_and_compress(struct settings_file *cf, const char *name,
 	}
 
 	lines = 0;
-	new_name_len = strlen(name);
+	new_name_len = name ? strlen(name) : 0;
+
+#ifdef CONFIG_SETTINGS_INDEX
+	/* every line moves, rebuild on next use */
+	settings_index_reset(&cf->cf_index);
+#endif
 
 	while (1) {
 		rc = settings_next_line_ctx(&loc1);
@@ -209,10 +309,16 @@ int settings_file_save_and_compress(struct settings_file *cf, const char *name,
 		}
 
 		/* avoid copping value which will be overwritten by new value*/
-		if ((val1_off == new_name_len) &&
+		if (name && (val1_off == new_name_len) &&
 		    !memcmp(name1, name, val1_off)) {
 			continue;
 		}
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+		if (batch && !settings_line_batch_find(batch, batch_len, name1,
+						       val1_off, NULL)) {
+			continue;
+		}
+#endif
 
 		loc2 = loc1;
 
@@ -256,11 +362,30 @@ int settings_file_save_and_compress(struct settings_file *cf, const char *name,
 		lines++;
 	}
 
-	/* at last store the new value */
-	rc = settings_line_write(name, value, val_len, 0, &loc3);
-	if (rc) {
-		/* compressed file might be corrupted */
-		goto end_rolback;
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+	if (batch) {
+		const char *line;
+		size_t off = 0;
+		u16_t line_len;
+
+		/* batch lines are already in the file format */
+		if (fs_write(&wf, batch, batch_len) != batch_len) {
+			goto end_rolback;
+		}
+		while (!settings_line_batch_next(batch, batch_len, &off, &line,
+						 &line_len)) {
+			lines++;
+		}
+	} else
+#endif
+	{
+		/* at last store the new value */
+		rc = settings_line_write(name, value, val_len, 0, &loc3);
+		if (rc) {
+			/* compressed file might be corrupted */
+			goto end_rolback;
+		}
+		lines++;
 	}
 
 	rc = fs_close(&wf);
@@ -269,7 +394,7 @@ int settings_file_save_and_compress(struct settings_file *cf, const char *name,
 		if (fs_rename(tmp_file, cf->cf_name)) {
 			return -ENOENT;
 		}
-		cf->cf_lines = lines + 1;
+		cf->cf_lines = lines;
 	} else {
 		rc = -EIO;
 	}
@@ -287,6 +412,28 @@ end_rolback:
 
 }
 
+int settings_file_save_and_compress(struct settings_file *cf, const char *name,
+			      const char *value, size_t val_len)
+{
+	return settings_file_compress(cf, name, value, val_len, NULL, 0);
+}
+
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+/*
+ * ::csi_save_batch implementation. The batch is written to a temporary file
+ * together with the compressed content of the current one, which then
+ * replaces the current file, so none of the batch is found before the
+ * rename.
+ */
+static int settings_file_save_batch(struct settings_store *cs,
+				    const char *buf, size_t len)
+{
+	struct settings_file *cf = (struct settings_file *)cs;
+
+	return settings_file_compress(cf, NULL, NULL, 0, buf, len);
+}
+#endif
+
 /*
  * Called to save configuration.
  */
@@ -320,11 +467,24 @@ static int settings_file_save(struct settings_store *cs, const char *name,
 		rc = fs_seek(&file, 0, FS_SEEK_END);
 		if (rc == 0) {
 			entry_ctx.stor_ctx = &file;
+#ifdef CONFIG_SETTINGS_INDEX
+			/* the line starts after its length field */
+			entry_ctx.seek = fs_tell(&file) + sizeof(u16_t);
+#endif
 			rc2 = settings_line_write(name, value, val_len, 0,
 						  (void *)&entry_ctx);
 			if (rc2 == 0) {
 				cf->cf_lines++;
 			}
+#ifdef CONFIG_SETTINGS_INDEX
+			if (rc2) {
+				settings_index_reset(&cf->cf_index);
+			} else if (cf->cf_index.valid) {
+				settings_index_put(&cf->cf_index, name,
+					entry_ctx.seek,
+					settings_line_len_calc(name, val_len));
+			}
+#endif
 		}
 
 		rc2 = fs_close(&file);
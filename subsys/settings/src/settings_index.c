@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "settings/settings_index.h"
+
+/* 32-bit FNV-1a, 0 is reserved for free slots */
+static u32_t settings_index_hash(const char *name)
+{
+	u32_t hash = 2166136261U;
+
+	while (*name) {
+		hash ^= (u8_t)*name++;
+		hash *= 16777619U;
+	}
+
+	return hash ? hash : 1;
+}
+
+/*
+ * Open addressing with linear probing. Names are never removed (a delete
+ * is just a newer, empty record), so a free slot ends every probe chain.
+ */
+static struct settings_index_entry *settings_index_slot(
+	struct settings_index *idx, u32_t hash)
+{
+	struct settings_index_entry *e;
+	int i, pos;
+
+	pos = hash % CONFIG_SETTINGS_INDEX_SIZE;
+	for (i = 0; i < CONFIG_SETTINGS_INDEX_SIZE; i++) {
+		e = &idx->entries[pos];
+		if (e->hash == hash || e->hash == 0) {
+			return e;
+		}
+		if (++pos == CONFIG_SETTINGS_INDEX_SIZE) {
+			pos = 0;
+		}
+	}
+
+	return NULL;
+}
+
+void settings_index_reset(struct settings_index *idx)
+{
+	(void)memset(idx, 0, sizeof(*idx));
+}
+
+void settings_index_put(struct settings_index *idx, const char *name,
+			u32_t loc0, u32_t loc1)
+{
+	u32_t hash = settings_index_hash(name);
+	struct settings_index_entry *e;
+
+	e = settings_index_slot(idx, hash);
+	if (!e) {
+		idx->overflow = true;
+		return;
+	}
+
+	e->hash = hash;
+	e->loc[0] = loc0;
+	e->loc[1] = loc1;
+}
+
+struct settings_index_entry *settings_index_get(struct settings_index *idx,
+						const char *name)
+{
+	struct settings_index_entry *e;
+
+	e = settings_index_slot(idx, settings_index_hash(name));
+	if (!e || e->hash == 0) {
+		return NULL;
+	}
+
+	return e;
+}
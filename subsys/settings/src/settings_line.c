@@ -278,6 +278,92 @@ int settings_line_len_calc(const char *name, size_t val_len)
 	return len;
 }
 
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+int settings_line_encode(char *dst, size_t dlen, const char *name,
+			 const char *value, size_t val_len)
+{
+	size_t len, nlen;
+#ifdef CONFIG_SETTINGS_USE_BASE64
+	char enc_buf[MAX_ENC_BLOCK_SIZE + 1];
+	size_t enc_len, add;
+	int rc;
+#endif
+
+	len = settings_line_len_calc(name, val_len);
+	if (len > dlen) {
+		return -ENOMEM;
+	}
+
+	nlen = strlen(name);
+	memcpy(dst, name, nlen);
+	dst += nlen;
+	*dst++ = '=';
+
+#ifdef CONFIG_SETTINGS_USE_BASE64
+	/* same block size as settings_line_write() */
+	while (val_len) {
+		add = MIN(val_len, MAX_ENC_BLOCK_SIZE/4*3);
+		rc = base64_encode(enc_buf, sizeof(enc_buf), &enc_len, value,
+				   add);
+		if (rc) {
+			return -EINVAL;
+		}
+		memcpy(dst, enc_buf, enc_len);
+		dst += enc_len;
+		value += add;
+		val_len -= add;
+	}
+#else
+	if (val_len) {
+		memcpy(dst, value, val_len);
+	}
+#endif
+
+	return len;
+}
+
+int settings_line_batch_next(const char *buf, size_t len, size_t *off,
+			     const char **line, u16_t *line_len)
+{
+	u16_t l;
+
+	if (*off + sizeof(l) > len) {
+		return -ENOENT;
+	}
+	memcpy(&l, buf + *off, sizeof(l));
+	if (*off + sizeof(l) + l > len) {
+		return -ENOENT;
+	}
+
+	*line = buf + *off + sizeof(l);
+	*line_len = l;
+	*off += sizeof(l) + l;
+	return 0;
+}
+
+int settings_line_batch_find(const char *buf, size_t len, const char *name,
+			     size_t name_len, size_t *rec_off)
+{
+	const char *line;
+	size_t off = 0, start;
+	u16_t line_len;
+
+	do {
+		start = off;
+		if (settings_line_batch_next(buf, len, &off, &line,
+					     &line_len)) {
+			return -ENOENT;
+		}
+	} while (line_len <= name_len || line[name_len] != '=' ||
+		 memcmp(line, name, name_len));
+
+	if (rec_off) {
+		*rec_off = start;
+	}
+	return 0;
+}
+#endif
+
 
 /**
  * Read RAW settings line entry data until a char from the storage.
@@ -42,6 +42,28 @@ int settings_line_write(const char *name, const char *value, size_t val_len,
 /* Get len of record without alignment to write-block-size */
 int settings_line_len_calc(const char *name, size_t val_len);
 
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+/*
+ * Encode the <name>=<value> line into dst, as settings_line_write() would
+ * write it. Returns the line length or -ERRNO.
+ */
+int settings_line_encode(char *dst, size_t dlen, const char *name,
+			 const char *value, size_t val_len);
+
+/*
+ * A batch of lines is stored back to back, each one prefixed with its u16
+ * length (the CONFIG_SETTINGS_ENCODE_LEN line format).
+ *
+ * settings_line_batch_next() returns the line at *off and advances *off,
+ * or -ENOENT past the last line. settings_line_batch_find() returns in
+ * rec_off (if not NULL) the offset of the record for name, or -ENOENT.
+ */
+int settings_line_batch_next(const char *buf, size_t len, size_t *off,
+			     const char **line, u16_t *line_len);
+int settings_line_batch_find(const char *buf, size_t len, const char *name,
+			     size_t name_len, size_t *rec_off);
+#endif
+
 #ifdef CONFIG_SETTINGS_ENCODE_LEN
 /* in storage line contex */
 struct line_entry_ctx {
@@ -115,10 +137,16 @@ typedef void (*load_cb)(char *name, void *val_read_cb_ctx, off_t off,
 
 struct settings_store_itf {
 	int (*csi_load)(struct settings_store *cs, load_cb cb, void *cb_arg);
+	/* optional: like csi_load, but may skip records not matching name */
+	int (*csi_load_one)(struct settings_store *cs, const char *name,
+			    load_cb cb, void *cb_arg);
 	int (*csi_save_start)(struct settings_store *cs);
 	int (*csi_save)(struct settings_store *cs, const char *name,
 			const char *value, size_t val_len);
 	int (*csi_save_end)(struct settings_store *cs);
+	/* optional: write a batch of lines so that all or none survive */
+	int (*csi_save_batch)(struct settings_store *cs, const char *buf,
+			      size_t len);
 };
 
 struct read_value_cb_ctx {
@@ -27,6 +27,12 @@ struct settings_dup_check_arg {
 sys_slist_t  settings_load_srcs;
 struct settings_store *settings_save_dst;
 
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+static char settings_batch_buf[CONFIG_SETTINGS_SAVE_BATCH_SIZE];
+static size_t settings_batch_len;
+static bool settings_batch_active;
+#endif
+
 void settings_src_register(struct settings_store *cs)
 {
 	sys_snode_t *prev, *cur;
@@ -133,6 +139,53 @@ static void settings_dup_check_cb(char *name, void *val_read_cb_ctx, off_t off,
 	}
 }
 
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+/*
+ * Drop an earlier record for name from the batch, so that a later value
+ * within the same batch wins.
+ */
+static void settings_batch_drop(const char *name)
+{
+	size_t off, next;
+	u16_t line_len;
+
+	if (settings_line_batch_find(settings_batch_buf, settings_batch_len,
+				     name, strlen(name), &off)) {
+		return;
+	}
+	memcpy(&line_len, &settings_batch_buf[off], sizeof(line_len));
+	next = off + sizeof(line_len) + line_len;
+	memmove(&settings_batch_buf[off], &settings_batch_buf[next],
+		settings_batch_len - next);
+	settings_batch_len -= next - off;
+}
+
+static int settings_batch_add(const char *name, void *value, size_t val_len)
+{
+	u16_t line_len;
+	int rc;
+
+	if (settings_batch_len + sizeof(line_len) >
+	    sizeof(settings_batch_buf)) {
+		return -ENOMEM;
+	}
+
+	rc = settings_line_encode(
+		&settings_batch_buf[settings_batch_len + sizeof(line_len)],
+		sizeof(settings_batch_buf) - settings_batch_len -
+		sizeof(line_len), name, value, val_len);
+	if (rc < 0) {
+		return rc;
+	}
+
+	line_len = rc;
+	memcpy(&settings_batch_buf[settings_batch_len], &line_len,
+	       sizeof(line_len));
+	settings_batch_len += sizeof(line_len) + line_len;
+	return 0;
+}
+#endif
+
 /*
  * Append a single value to persisted config. Don't store duplicate value.
  */
@@ -146,6 +199,12 @@ int settings_save_one(const char *name, void *value, size_t val_len)
 		return -ENOENT;
 	}
 
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+	if (settings_batch_active) {
+		settings_batch_drop(name);
+	}
+#endif
+
 	/*
 	 * Check if we're writing the same value again.
 	 */
@@ -153,10 +212,19 @@ int settings_save_one(const char *name, void *value, size_t val_len)
 	cdca.val = (char *)value;
 	cdca.is_dup = 0;
 	cdca.val_len = val_len;
-	cs->cs_itf->csi_load(cs, settings_dup_check_cb, &cdca);
+	if (cs->cs_itf->csi_load_one) {
+		cs->cs_itf->csi_load_one(cs, name, settings_dup_check_cb, &cdca);
+	} else {
+		cs->cs_itf->csi_load(cs, settings_dup_check_cb, &cdca);
+	}
 	if (cdca.is_dup == 1) {
 		return 0;
 	}
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+	if (settings_batch_active) {
+		return settings_batch_add(name, value, val_len);
+	}
+#endif
 	return cs->cs_itf->csi_save(cs, name, (char *)value, val_len);
 }
 
@@ -165,6 +233,50 @@ int settings_delete(const char *name)
 	return settings_save_one(name, NULL, 0);
 }
 
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+int settings_save_begin(void)
+{
+	struct settings_store *cs;
+
+	cs = settings_save_dst;
+	if (!cs) {
+		return -ENOENT;
+	}
+	if (!cs->cs_itf->csi_save_batch) {
+		return -ENOTSUP;
+	}
+	if (settings_batch_active) {
+		return -EBUSY;
+	}
+
+	settings_batch_len = 0;
+	settings_batch_active = true;
+	return 0;
+}
+
+int settings_save_end(void)
+{
+	struct settings_store *cs;
+	int rc = 0;
+
+	if (!settings_batch_active) {
+		return -EINVAL;
+	}
+	settings_batch_active = false;
+
+	cs = settings_save_dst;
+	if (!cs) {
+		rc = -ENOENT;
+	} else if (settings_batch_len) {
+		rc = cs->cs_itf->csi_save_batch(cs, settings_batch_buf,
+						settings_batch_len);
+	}
+
+	settings_batch_len = 0;
+	return rc;
+}
+#endif
+
 int settings_save(void)
 {
 	struct settings_store *cs;
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+
+/* Memory pool allocator benchmark, see README.rst.  Runs the same
+ * pseudo-random allocation pattern against a buddy pool and, if
+ * enabled, a TLSF pool of the same size and reports alloc/free
+ * latency and how much of the pool can actually be used.
+ */
+
+#define POOL_MIN 16
+#define POOL_MAX 4096
+#define POOL_NMAX 4
+#define POOL_SIZE (POOL_MAX * POOL_NMAX)
+
+#define N_SLOTS 128
+#define N_OPS 20000
+#define N_CHURN 2000
+
+K_MEM_POOL_DEFINE(buddy_pool, POOL_MIN, POOL_MAX, POOL_NMAX, 4);
+#ifdef CONFIG_MEM_POOL_TLSF
+K_MEM_POOL_DEFINE_TLSF(tlsf_pool, POOL_MIN, POOL_MAX, POOL_NMAX, 4);
+#endif
+
+struct slot {
+	struct k_mem_block block;
+	size_t size;
+	bool used;
+};
+
+static struct slot slots[N_SLOTS];
+
+static u32_t rand_state;
+
+static u32_t next_rand(void)
+{
+	/* Numerical Recipes LCG, deterministic across runs */
+	rand_state = rand_state * 1664525U + 1013904223U;
+	return rand_state >> 8;
+}
+
+/* Mostly small requests with the occasional large buffer */
+static size_t rand_size(void)
+{
+	u32_t r = next_rand();
+
+	if ((r & 0xf) != 0U) {
+		return 8 + (r >> 4) % 250;
+	}
+
+	return 256 + (r >> 4) % 1300;
+}
+
+static inline u32_t stamp(void)
+{
+	u32_t t;
+
+	/* See tests/benchmarks/sched for why rdtsc is not used
+	 * elsewhere
+	 */
+#ifdef CONFIG_X86
+	__asm__ volatile("rdtsc" : "=a"(t) : : "edx");
+#else
+	t = k_cycle_get_32();
+#endif
+	return t;
+}
+
+static void free_all(void)
+{
+	int i;
+
+	for (i = 0; i < N_SLOTS; i++) {
+		if (slots[i].used) {
+			k_mem_pool_free(&slots[i].block);
+			slots[i].used = false;
+		}
+	}
+}
+
+/* Toggle a random slot, returns false if an allocation failed */
+static bool churn_one(struct k_mem_pool *pool, u32_t *alloc_t,
+		      u32_t *free_t)
+{
+	struct slot *s = &slots[next_rand() % N_SLOTS];
+	u32_t t0, t1;
+	int ret;
+
+	if (s->used) {
+		t0 = stamp();
+		k_mem_pool_free(&s->block);
+		t1 = stamp();
+		s->used = false;
+		*free_t = t1 - t0;
+		*alloc_t = 0U;
+		return true;
+	}
+
+	s->size = rand_size();
+	t0 = stamp();
+	ret = k_mem_pool_alloc(pool, &s->block, s->size, K_NO_WAIT);
+	t1 = stamp();
+	s->used = (ret == 0);
+	*alloc_t = t1 - t0;
+	*free_t = 0U;
+
+	return s->used;
+}
+
+static void bench_latency(struct k_mem_pool *pool)
+{
+	u64_t alloc_tot = 0, free_tot = 0;
+	u32_t alloc_max = 0, free_max = 0;
+	u32_t n_alloc = 0, n_free = 0, n_fail = 0;
+	int i;
+
+	for (i = 0; i < N_OPS; i++) {
+		u32_t at, ft;
+
+		if (!churn_one(pool, &at, &ft)) {
+			n_fail++;
+			continue;
+		}
+
+		if (at != 0U) {
+			n_alloc++;
+			alloc_tot += at;
+			alloc_max = MAX(alloc_max, at);
+		} else {
+			n_free++;
+			free_tot += ft;
+			free_max = MAX(free_max, ft);
+		}
+	}
+
+	printk("  alloc avg %6u max %6u, free avg %6u max %6u, %u failed\n",
+	       (u32_t)(alloc_tot / MAX(n_alloc, 1U)), alloc_max,
+	       (u32_t)(free_tot / MAX(n_free, 1U)), free_max, n_fail);
+
+	free_all();
+}
+
+static void bench_fill(struct k_mem_pool *pool)
+{
+	size_t live = 0;
+	u32_t at, ft, n_fail = 0;
+	int i;
+
+	for (i = 0; i < N_CHURN; i++) {
+		(void)churn_one(pool, &at, &ft);
+	}
+
+	/* Try to fill every remaining slot, skipping requests that no
+	 * longer fit
+	 */
+	for (i = 0; i < N_SLOTS; i++) {
+		if (!slots[i].used) {
+			slots[i].size = rand_size();
+			if (k_mem_pool_alloc(pool, &slots[i].block,
+					     slots[i].size, K_NO_WAIT) != 0) {
+				n_fail++;
+				continue;
+			}
+			slots[i].used = true;
+		}
+
+		live += slots[i].size;
+	}
+
+	printk("  fill: %u of %u bytes in use (%u%%), %u failed\n",
+	       (u32_t)live, POOL_SIZE, (u32_t)(live * 100 / POOL_SIZE),
+	       n_fail);
+
+	free_all();
+}
+
+static void bench_pool(const char *name, struct k_mem_pool *pool)
+{
+	printk("%s:\n", name);
+
+	rand_state = 12345;
+	bench_latency(pool);
+
+	rand_state = 54321;
+	bench_fill(pool);
+}
+
+void main(void)
+{
+	printk("Memory pool benchmark: %d x %d bytes, %d slots\n",
+	       POOL_NMAX, POOL_MAX, N_SLOTS);
+
+	bench_pool("buddy", &buddy_pool);
+#ifdef CONFIG_MEM_POOL_TLSF
+	bench_pool("tlsf", &tlsf_pool);
+#endif
+
+	printk("fin\n");
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_bench, LOG_LEVEL_NONE);
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <string.h>
+#include <errno.h>
+
+#include <net/socket.h>
+#include <net/net_mgmt.h>
+#include <net/net_stats.h>
+
+/* Network stack benchmark over the loopback interface, see README.rst.
+ * Every message carries the cycle counter value when it was sent, the
+ * receiver uses it for the latency.
+ */
+
+#define N_MSGS 256
+#define WINDOW 8
+#define MAX_SOCKETS 4
+#define MAX_LEN 480
+
+#define SERVER_PORT 4242
+
+/* A lost UDP datagram is given up after this many milliseconds */
+#define RECV_TIMEOUT 100
+
+static const size_t sizes[] = { 64, 256, MAX_LEN };
+static const int socket_counts[] = { 1, MAX_SOCKETS };
+
+static const char * const layer_names[NET_STATS_LAYER_COUNT] = {
+	"socket", "context", "conn", "ip", "l2",
+};
+
+static int clients[MAX_SOCKETS];
+static int servers[MAX_SOCKETS];
+static size_t received_len[MAX_SOCKETS];
+
+static u8_t send_buf[MAX_LEN];
+static u8_t recv_buf[MAX_SOCKETS][MAX_LEN];
+
+static u32_t latency[N_MSGS];
+
+static struct net_stats stats_before;
+static struct net_stats stats_after;
+
+static int errors;
+static u16_t next_port = SERVER_PORT;
+
+static int open_udp(int count)
+{
+	struct sockaddr_in addr;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		(void)memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(next_port);
+		next_port++;
+		inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			  &addr.sin_addr);
+
+		servers[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		clients[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (servers[i] < 0 || clients[i] < 0) {
+			return -errno;
+		}
+
+		if (bind(servers[i], (struct sockaddr *)&addr,
+			 sizeof(addr)) < 0 ||
+		    connect(clients[i], (struct sockaddr *)&addr,
+			    sizeof(addr)) < 0) {
+			return -errno;
+		}
+	}
+
+	return 0;
+}
+
+static int open_tcp(int count)
+{
+	struct sockaddr_in addr;
+	int listener, i, ret = 0;
+
+	(void)memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(next_port);
+	next_port++;
+	inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR, &addr.sin_addr);
+
+	listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener < 0) {
+		return -errno;
+	}
+
+	if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(listener, count) < 0) {
+		ret = -errno;
+		goto out;
+	}
+
+	for (i = 0; i < count; i++) {
+		clients[i] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (clients[i] < 0) {
+			ret = -errno;
+			goto out;
+		}
+
+		if (connect(clients[i], (struct sockaddr *)&addr,
+			    sizeof(addr)) < 0) {
+			ret = -errno;
+			goto out;
+		}
+
+		servers[i] = accept(listener, NULL, NULL);
+		if (servers[i] < 0) {
+			ret = -errno;
+			goto out;
+		}
+	}
+
+out:
+	close(listener);
+
+	return ret;
+}
+
+static void close_all(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (clients[i] >= 0) {
+			close(clients[i]);
+		}
+
+		if (servers[i] >= 0) {
+			close(servers[i]);
+		}
+	}
+}
+
+static int send_msg(int sock, size_t len)
+{
+	u32_t stamp = k_cycle_get_32();
+	size_t sent = 0;
+	ssize_t ret;
+
+	memcpy(send_buf, &stamp, sizeof(stamp));
+
+	/* A TCP send can be cut short by the send window */
+	while (sent < len) {
+		ret = send(sock, send_buf + sent, len - sent, 0);
+		if (ret < 0) {
+			return -errno;
+		}
+
+		sent += ret;
+	}
+
+	return 0;
+}
+
+/* Returns 1 when a whole message was received */
+static int recv_msg(int idx, size_t len, u32_t *msg_latency)
+{
+	u32_t stamp;
+	ssize_t ret;
+
+	ret = recv(servers[idx], recv_buf[idx] + received_len[idx],
+		   len - received_len[idx], ZSOCK_MSG_DONTWAIT);
+	if (ret < 0) {
+		return errno == EAGAIN ? 0 : -errno;
+	}
+
+	received_len[idx] += ret;
+	if (received_len[idx] < len) {
+		return 0;
+	}
+
+	received_len[idx] = 0;
+
+	memcpy(&stamp, recv_buf[idx], sizeof(stamp));
+	*msg_latency = k_cycle_get_32() - stamp;
+
+	return 1;
+}
+
+static void sort(u32_t *values, int count)
+{
+	int i, j;
+	u32_t tmp;
+
+	for (i = 1; i < count; i++) {
+		tmp = values[i];
+
+		for (j = i; j > 0 && values[j - 1] > tmp; j--) {
+			values[j] = values[j - 1];
+		}
+
+		values[j] = tmp;
+	}
+}
+
+static u32_t cycles_to_us(u32_t cycles)
+{
+	return (u64_t)cycles * USEC_PER_SEC / sys_clock_hw_cycles_per_sec();
+}
+
+static void report(const char *proto, size_t len, int count, int received,
+		   int lost, u32_t elapsed)
+{
+	u64_t pkts_per_sec = 0U;
+	int i;
+
+	printk("%s %3u bytes, %d socket(s): %d messages", proto, len, count,
+	       received);
+
+	if (lost) {
+		printk(", %d lost", lost);
+	}
+
+	if (received == 0) {
+		printk("\n");
+		return;
+	}
+
+	if (elapsed) {
+		pkts_per_sec = (u64_t)received *
+			       sys_clock_hw_cycles_per_sec() / elapsed;
+	}
+
+	sort(latency, received);
+
+	printk("\n  %u pkts/s, %u bytes/s, latency p50 %u us, p99 %u us\n",
+	       (u32_t)pkts_per_sec, (u32_t)(pkts_per_sec * len),
+	       cycles_to_us(latency[received / 2]),
+	       cycles_to_us(latency[(received * 99) / 100]));
+
+	printk("  cycles per message  ");
+	for (i = 0; i < NET_STATS_LAYER_COUNT; i++) {
+		printk(" %8s", layer_names[i]);
+	}
+
+	printk("\n  tx                  ");
+	for (i = 0; i < NET_STATS_LAYER_COUNT; i++) {
+		printk(" %8u", (u32_t)((stats_after.layer_cycles.tx[i] -
+					stats_before.layer_cycles.tx[i]) /
+				       received));
+	}
+
+	printk("\n  rx                  ");
+	for (i = 0; i < NET_STATS_LAYER_COUNT; i++) {
+		printk(" %8u", (u32_t)((stats_after.layer_cycles.rx[i] -
+					stats_before.layer_cycles.rx[i]) /
+				       received));
+	}
+
+	printk("\n");
+}
+
+static void run(int type, size_t len, int count)
+{
+	const char *proto = type == SOCK_STREAM ? "TCP" : "UDP";
+	struct pollfd fds[MAX_SOCKETS];
+	int sent = 0, received = 0, lost = 0;
+	u32_t start, elapsed;
+	int i, ret;
+
+	for (i = 0; i < MAX_SOCKETS; i++) {
+		clients[i] = servers[i] = -1;
+		received_len[i] = 0;
+	}
+
+	if (type == SOCK_STREAM) {
+		ret = open_tcp(count);
+	} else {
+		ret = open_udp(count);
+	}
+
+	if (ret < 0) {
+		printk("ERROR: %s %d socket(s): cannot connect (%d)\n", proto,
+		       count, ret);
+		errors++;
+		goto out;
+	}
+
+	for (i = 0; i < count; i++) {
+		fds[i].fd = servers[i];
+		fds[i].events = POLLIN;
+	}
+
+	net_mgmt(NET_REQUEST_STATS_GET_ALL, NULL, &stats_before,
+		 sizeof(stats_before));
+
+	start = k_cycle_get_32();
+
+	while (received + lost < N_MSGS) {
+		while (sent < N_MSGS && sent - received - lost < WINDOW) {
+			ret = send_msg(clients[sent % count], len);
+			if (ret < 0) {
+				printk("ERROR: %s send failed (%d)\n", proto,
+				       ret);
+				errors++;
+				goto out;
+			}
+
+			sent++;
+		}
+
+		ret = poll(fds, count, RECV_TIMEOUT);
+		if (ret < 0) {
+			printk("ERROR: %s poll failed (%d)\n", proto, -errno);
+			errors++;
+			goto out;
+		}
+
+		if (ret == 0) {
+			if (type == SOCK_STREAM) {
+				printk("ERROR: TCP receive timeout\n");
+				errors++;
+				goto out;
+			}
+
+			/* Whatever is still in flight has been dropped */
+			lost = sent - received;
+			continue;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (!(fds[i].revents & POLLIN)) {
+				continue;
+			}
+
+			do {
+				ret = recv_msg(i, len, &latency[received]);
+				if (ret < 0) {
+					printk("ERROR: %s recv failed (%d)\n",
+					       proto, ret);
+					errors++;
+					goto out;
+				}
+
+				received += ret;
+			} while (ret > 0 && received < N_MSGS);
+		}
+	}
+
+	elapsed = k_cycle_get_32() - start;
+
+	net_mgmt(NET_REQUEST_STATS_GET_ALL, NULL, &stats_after,
+		 sizeof(stats_after));
+
+	report(proto, len, count, received, lost, elapsed);
+
+out:
+	close_all(count);
+}
+
+void main(void)
+{
+	size_t i;
+	int j;
+
+	printk("Network stack benchmark, %d messages per run, "
+	       "%u cycles/s\n", N_MSGS, sys_clock_hw_cycles_per_sec());
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		for (j = 0; j < ARRAY_SIZE(socket_counts); j++) {
+			run(SOCK_DGRAM, sizes[i], socket_counts[j]);
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		for (j = 0; j < ARRAY_SIZE(socket_counts); j++) {
+			run(SOCK_STREAM, sizes[i], socket_counts[j]);
+		}
+	}
+
+	if (errors) {
+		printk("%d errors\n", errors);
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_chksum_bench, LOG_LEVEL_NONE);
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <string.h>
+
+#include "net_private.h"
+
+/* Internet checksum benchmark, see README.rst.  Compares the word at a
+ * time checksum and the fused copy and checksum with the former byte
+ * pair implementation.
+ */
+
+#define N_ITER 200
+#define MAX_LEN 1500
+
+static const size_t sizes[] = { 64, 536, 1280, MAX_LEN };
+
+/* Room for an odd start address */
+static u8_t src_buf[MAX_LEN + 4] __aligned(4);
+static u8_t dst_buf[MAX_LEN + 4] __aligned(4);
+
+static u32_t rand_state;
+
+static u32_t next_rand(void)
+{
+	/* Numerical Recipes LCG, deterministic across runs */
+	rand_state = rand_state * 1664525U + 1013904223U;
+	return rand_state >> 8;
+}
+
+static inline u32_t stamp(void)
+{
+	u32_t t;
+
+	/* See tests/benchmarks/sched for why rdtsc is not used
+	 * elsewhere
+	 */
+#ifdef CONFIG_X86
+	__asm__ volatile("rdtsc" : "=a"(t) : : "edx");
+#else
+	t = k_cycle_get_32();
+#endif
+	return t;
+}
+
+/* The implementation net_calc_chksum() used before */
+static u16_t ref_chksum(u16_t sum, const u8_t *data, size_t len)
+{
+	const u8_t *end;
+	u16_t tmp;
+
+	end = data + len - 1;
+
+	while (data < end) {
+		tmp = (data[0] << 8) + data[1];
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+
+		data += 2;
+	}
+
+	if (data == end) {
+		tmp = data[0] << 8;
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+	}
+
+	return sum;
+}
+
+static int errors;
+
+static void check(const char *what, size_t len, int offset, u16_t got,
+		  u16_t expected)
+{
+	if (got != expected) {
+		printk("ERROR: %s len %u offset %d: 0x%04x, expected 0x%04x\n",
+		       what, len, offset, got, expected);
+		errors++;
+	}
+}
+
+static void run(size_t len, int offset)
+{
+	const u8_t *src = src_buf + offset;
+	u8_t *dst = dst_buf + offset;
+	u32_t t_ref = 0U, t_word = 0U, t_two = 0U, t_fused = 0U;
+	u16_t ref, sum;
+	u32_t t;
+	int i;
+
+	ref = ref_chksum(0, src, len);
+
+	for (i = 0; i < N_ITER; i++) {
+		t = stamp();
+		sum = ref_chksum(0, src, len);
+		t_ref += stamp() - t;
+	}
+
+	for (i = 0; i < N_ITER; i++) {
+		t = stamp();
+		sum = net_calc_chksum_data(0, src, len, false);
+		t_word += stamp() - t;
+	}
+
+	check("word", len, offset, sum, ref);
+
+	for (i = 0; i < N_ITER; i++) {
+		t = stamp();
+		memcpy(dst, src, len);
+		sum = net_calc_chksum_data(0, dst, len, false);
+		t_two += stamp() - t;
+	}
+
+	for (i = 0; i < N_ITER; i++) {
+		memset(dst, 0, len);
+
+		t = stamp();
+		sum = net_calc_chksum_copy(0, dst, src, len, false);
+		t_fused += stamp() - t;
+	}
+
+	check("copy", len, offset, sum, ref);
+
+	if (memcmp(dst, src, len)) {
+		printk("ERROR: copy len %u offset %d: data mismatch\n", len,
+		       offset);
+		errors++;
+	}
+
+	printk("%4u bytes, offset %d: reference %u, word %u, "
+	       "memcpy+sum %u, fused %u cycles\n", len, offset,
+	       t_ref / N_ITER, t_word / N_ITER, t_two / N_ITER,
+	       t_fused / N_ITER);
+}
+
+/* A sum split at an odd length must match the sum of the whole data */
+static void check_split(void)
+{
+	size_t len = 1280;
+	size_t split;
+	u16_t ref, sum;
+
+	ref = ref_chksum(0, src_buf, len);
+
+	for (split = 1; split < 40; split++) {
+		sum = net_calc_chksum_data(0, src_buf, split, false);
+		sum = net_calc_chksum_data(sum, src_buf + split, len - split,
+					   split & 1);
+		check("split", len, split, sum, ref);
+	}
+}
+
+void main(void)
+{
+	size_t i;
+	int offset;
+
+	rand_state = 0x12345678;
+
+	for (i = 0; i < sizeof(src_buf); i++) {
+		src_buf[i] = next_rand();
+	}
+
+	printk("Internet checksum benchmark, %u iterations\n", N_ITER);
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		for (offset = 0; offset < 4; offset++) {
+			run(sizes[i], offset);
+		}
+	}
+
+	check_split();
+
+	if (errors) {
+		printk("%d errors\n", errors);
+	}
+
+	printk("fin\n");
+}
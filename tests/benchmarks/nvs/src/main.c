@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <nvs/nvs.h>
+
+#include "ram_flash.h"
+
+/* NVS read/write cost benchmark, see README.rst.  Costs are reported
+ * as the number of flash read calls per operation.
+ */
+
+#define N_IDS 64
+#define N_UPDATES 6000
+#define SECTOR_SIZE (4 * RAM_FLASH_PAGE_SIZE)
+#define SECTOR_COUNT (RAM_FLASH_PAGES * RAM_FLASH_PAGE_SIZE / SECTOR_SIZE)
+
+static struct nvs_fs fs = {
+	.offset = 0,
+	.sector_size = SECTOR_SIZE,
+	.sector_count = SECTOR_COUNT,
+};
+
+static u32_t values[N_IDS];
+static u32_t rand_state = 12345;
+
+static u32_t next_rand(void)
+{
+	/* Numerical Recipes LCG, deterministic across runs */
+	rand_state = rand_state * 1664525U + 1013904223U;
+	return rand_state;
+}
+
+/* ids start at 1, 0 is commonly reserved by users of NVS */
+static int write_id(int i)
+{
+	values[i]++;
+	return nvs_write(&fs, i + 1, &values[i], sizeof(values[i]));
+}
+
+static void report(const char *what, u32_t total, u32_t max, int n)
+{
+	printk("%s: avg %u max %u flash reads\n", what, total / n, max);
+}
+
+void main(void)
+{
+	u32_t total = 0, max = 0, reads, val;
+	int i, rc;
+
+	printk("NVS benchmark: %s, %d ids, %d updates\n",
+	       IS_ENABLED(CONFIG_NVS_LOOKUP_CACHE) ?
+	       "lookup cache" : "ATE walk", N_IDS, N_UPDATES);
+
+	rc = nvs_init(&fs, RAM_FLASH_NAME);
+	if (rc) {
+		printk("ERROR: nvs_init failed: %d\n", rc);
+		return;
+	}
+
+	for (i = 0; i < N_IDS; i++) {
+		rc = write_id(i);
+		if (rc < 0) {
+			printk("ERROR: nvs_write failed: %d\n", rc);
+			return;
+		}
+	}
+
+	for (i = 0; i < N_UPDATES; i++) {
+		reads = ram_flash_reads;
+		rc = write_id((next_rand() >> 8) % N_IDS);
+		if (rc < 0) {
+			printk("ERROR: nvs_write failed: %d\n", rc);
+			return;
+		}
+		reads = ram_flash_reads - reads;
+		total += reads;
+		max = MAX(max, reads);
+	}
+	report("nvs_write", total, max, N_UPDATES);
+
+	total = 0;
+	max = 0;
+	for (i = 0; i < N_IDS; i++) {
+		reads = ram_flash_reads;
+		rc = nvs_read(&fs, i + 1, &val, sizeof(val));
+		reads = ram_flash_reads - reads;
+		if (rc != sizeof(val) || val != values[i]) {
+			printk("ERROR: id %d read %d, value %u expected %u\n",
+			       i + 1, rc, val, values[i]);
+			return;
+		}
+		total += reads;
+		max = MAX(max, reads);
+	}
+	report("nvs_read", total, max, N_IDS);
+
+	/* Remount to check the cache is rebuilt from flash */
+	rc = nvs_init(&fs, RAM_FLASH_NAME);
+	if (rc) {
+		printk("ERROR: nvs_init failed: %d\n", rc);
+		return;
+	}
+
+	for (i = 0; i < N_IDS; i++) {
+		rc = nvs_read(&fs, i + 1, &val, sizeof(val));
+		if (rc != sizeof(val) || val != values[i]) {
+			printk("ERROR: id %d read %d after remount\n", i + 1, rc);
+			return;
+		}
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <flash.h>
+#include <string.h>
+
+#include "ram_flash.h"
+
+/* Minimal RAM backed NOR flash: writes can only clear bits and erase
+ * works on whole pages.  Every read call is counted.
+ */
+
+static u8_t ram_flash[RAM_FLASH_PAGE_SIZE * RAM_FLASH_PAGES];
+
+u32_t ram_flash_reads;
+
+static bool in_range(off_t offset, size_t len)
+{
+	return offset >= 0 && len <= sizeof(ram_flash) &&
+	       offset <= sizeof(ram_flash) - len;
+}
+
+static int ram_flash_read(struct device *dev, off_t offset, void *data,
+			  size_t len)
+{
+	if (!in_range(offset, len)) {
+		return -EINVAL;
+	}
+
+	ram_flash_reads++;
+	memcpy(data, &ram_flash[offset], len);
+	return 0;
+}
+
+static int ram_flash_write(struct device *dev, off_t offset,
+			   const void *data, size_t len)
+{
+	const u8_t *data8 = data;
+
+	if (!in_range(offset, len)) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		ram_flash[offset + i] &= data8[i];
+	}
+	return 0;
+}
+
+static int ram_flash_erase(struct device *dev, off_t offset, size_t size)
+{
+	if (!in_range(offset, size) || (offset % RAM_FLASH_PAGE_SIZE) != 0 ||
+	    (size % RAM_FLASH_PAGE_SIZE) != 0) {
+		return -EINVAL;
+	}
+
+	(void)memset(&ram_flash[offset], 0xff, size);
+	return 0;
+}
+
+static int ram_flash_write_protection(struct device *dev, bool enable)
+{
+	return 0;
+}
+
+static const struct flash_pages_layout ram_flash_layout = {
+	.pages_count = RAM_FLASH_PAGES,
+	.pages_size = RAM_FLASH_PAGE_SIZE,
+};
+
+static void ram_flash_page_layout(struct device *dev,
+				  const struct flash_pages_layout **layout,
+				  size_t *layout_size)
+{
+	*layout = &ram_flash_layout;
+	*layout_size = 1;
+}
+
+static const struct flash_driver_api ram_flash_api = {
+	.read = ram_flash_read,
+	.write = ram_flash_write,
+	.erase = ram_flash_erase,
+	.write_protection = ram_flash_write_protection,
+	.page_layout = ram_flash_page_layout,
+	.write_block_size = 1,
+};
+
+static int ram_flash_init(struct device *dev)
+{
+	(void)memset(ram_flash, 0xff, sizeof(ram_flash));
+	return 0;
+}
+
+DEVICE_AND_API_INIT(ram_flash, RAM_FLASH_NAME, ram_flash_init, NULL, NULL,
+		    POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &ram_flash_api);
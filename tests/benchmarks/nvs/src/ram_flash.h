@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _RAM_FLASH_H
+#define _RAM_FLASH_H
+
+#define RAM_FLASH_NAME "RAM_FLASH"
+#define RAM_FLASH_PAGE_SIZE 4096
+#define RAM_FLASH_PAGES 16
+
+/* number of read calls made to the device so far */
+extern u32_t ram_flash_reads;
+
+#endif /* _RAM_FLASH_H */
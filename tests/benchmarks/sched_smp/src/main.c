@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+
+/* SMP context switch throughput benchmark, see README.rst.  Pairs of
+ * threads hand a token back and forth through two semaphores while
+ * main sleeps, then main reports the aggregate handoff rate.
+ */
+
+#define N_PAIRS (2 * CONFIG_MP_NUM_CPUS)
+#define STACK_SIZE 1024
+#define RUN_MS 2000
+#define PRIO 5
+
+struct pair {
+	struct k_sem sem[2];
+	u32_t count[2];
+};
+
+static struct pair pairs[N_PAIRS];
+static struct k_thread threads[N_PAIRS][2];
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, 2 * N_PAIRS, STACK_SIZE);
+
+static volatile bool running;
+
+static void pair_fn(void *arg1, void *arg2, void *arg3)
+{
+	struct pair *p = arg1;
+	int me = POINTER_TO_INT(arg2);
+	int peer = !me;
+
+	ARG_UNUSED(arg3);
+
+	while (running) {
+		k_sem_take(&p->sem[me], K_FOREVER);
+		p->count[me]++;
+		k_sem_give(&p->sem[peer]);
+	}
+
+	/* Let the partner run out too */
+	k_sem_give(&p->sem[peer]);
+}
+
+void main(void)
+{
+	u64_t total = 0;
+	s64_t start, ms;
+	int i, j;
+
+	printk("SMP sched throughput: %d CPUs, %d pairs, %s ready queue\n",
+	       CONFIG_MP_NUM_CPUS, N_PAIRS,
+	       IS_ENABLED(CONFIG_SCHED_PERCPU_RUNQ) ? "per-CPU" : "global");
+
+	running = true;
+
+	for (i = 0; i < N_PAIRS; i++) {
+		k_sem_init(&pairs[i].sem[0], 0, 1);
+		k_sem_init(&pairs[i].sem[1], 0, 1);
+
+		for (j = 0; j < 2; j++) {
+			k_thread_create(&threads[i][j], stacks[2 * i + j],
+					STACK_SIZE, pair_fn, &pairs[i],
+					INT_TO_POINTER(j), NULL,
+					PRIO, 0, K_NO_WAIT);
+		}
+	}
+
+	start = k_uptime_get();
+	for (i = 0; i < N_PAIRS; i++) {
+		k_sem_give(&pairs[i].sem[0]);
+	}
+
+	k_sleep(RUN_MS);
+
+	running = false;
+	ms = k_uptime_delta(&start);
+
+	for (i = 0; i < N_PAIRS; i++) {
+		u32_t n = pairs[i].count[0] + pairs[i].count[1];
+
+		printk("pair %2d: %u handoffs\n", i, n);
+		total += n;
+	}
+
+	printk("total %u handoffs in %u ms: %u handoffs/s\n",
+	       (u32_t)total, (u32_t)ms, (u32_t)(total * 1000U / ms));
+
+	for (i = 0; i < N_PAIRS; i++) {
+		for (j = 0; j < 2; j++) {
+			k_thread_abort(&threads[i][j]);
+		}
+	}
+
+	printk("fin\n");
+}
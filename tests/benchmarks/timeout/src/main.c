@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <timeout_q.h>
+
+/* Timeout queue microbenchmark.  Arms a population of N timeouts far
+ * in the future and then measures the latency of _add_timeout() and
+ * _abort_timeout() of one extra timeout against that population.
+ * See README.rst for details.
+ */
+
+#define MAX_ARMED 1024
+#define N_RUNS 200
+#define N_SETTLE 10
+
+/* Keep every armed timeout well beyond the benchmark duration */
+#define MIN_TICKS 10000
+#define TICKS_RANGE 1000000
+
+static const int populations[] = { 0, 16, 64, 256, MAX_ARMED };
+
+static struct _timeout armed[MAX_ARMED];
+static struct _timeout probe;
+
+static u32_t rand_state = 12345;
+
+static u32_t next_rand(void)
+{
+	/* Numerical Recipes LCG, deterministic across runs */
+	rand_state = rand_state * 1664525U + 1013904223U;
+	return rand_state;
+}
+
+static s32_t rand_ticks(void)
+{
+	return MIN_TICKS + (next_rand() >> 8) % TICKS_RANGE;
+}
+
+static inline u32_t stamp(void)
+{
+	u32_t t;
+
+	/* See tests/benchmarks/sched for why rdtsc is not used
+	 * elsewhere
+	 */
+#ifdef CONFIG_X86
+	__asm__ volatile("rdtsc" : "=a"(t) : : "edx");
+#else
+	t = k_cycle_get_32();
+#endif
+	return t;
+}
+
+static void never_fires(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+
+	printk("ERROR: benchmark timeout expired\n");
+}
+
+static void bench_population(int n)
+{
+	u64_t add_tot = 0, abort_tot = 0;
+	u32_t add_max = 0, abort_max = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		_add_timeout(&armed[i], never_fires, rand_ticks());
+	}
+
+	for (i = 0; i < N_RUNS + N_SETTLE; i++) {
+		s32_t ticks = rand_ticks();
+		u32_t t0, t1, t2;
+
+		t0 = stamp();
+		_add_timeout(&probe, never_fires, ticks);
+		t1 = stamp();
+		(void)_abort_timeout(&probe);
+		t2 = stamp();
+
+		/* Let caches and branch predictors settle first */
+		if (i < N_SETTLE) {
+			continue;
+		}
+
+		add_tot += t1 - t0;
+		abort_tot += t2 - t1;
+		add_max = MAX(add_max, t1 - t0);
+		abort_max = MAX(abort_max, t2 - t1);
+	}
+
+	printk("armed %4d: add avg %6u max %6u, abort avg %6u max %6u\n",
+	       n, (u32_t)(add_tot / N_RUNS), add_max,
+	       (u32_t)(abort_tot / N_RUNS), abort_max);
+
+	for (i = 0; i < n; i++) {
+		(void)_abort_timeout(&armed[i]);
+	}
+}
+
+void main(void)
+{
+	int i;
+
+	for (i = 0; i < MAX_ARMED; i++) {
+		_init_timeout(&armed[i], never_fires);
+	}
+	_init_timeout(&probe, never_fires);
+
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+	printk("Timeout queue: timer wheel (%d levels)\n",
+	       CONFIG_TIMEOUT_WHEEL_LEVELS);
+#else
+	printk("Timeout queue: delta list\n");
+#endif
+
+	for (i = 0; i < ARRAY_SIZE(populations); i++) {
+		bench_population(populations[i]);
+	}
+
+	printk("fin\n");
+}
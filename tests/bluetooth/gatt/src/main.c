@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/uuid.h>
+#include <bluetooth/gatt.h>
+
+#define MAX_ATTRS 64
+
+static struct bt_gatt_attr attrs_a[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_16(0xaaa0)),
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_16(0xaaa1), BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ, NULL, NULL, NULL),
+};
+
+static struct bt_gatt_attr attrs_b[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_16(0xbbb0)),
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_16(0xbbb1), BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ, NULL, NULL, NULL),
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_16(0xbbb2), BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ, NULL, NULL, NULL),
+};
+
+static struct bt_gatt_attr attrs_c[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_16(0xccc0)),
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_16(0xccc1), BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ, NULL, NULL, NULL),
+};
+
+static struct bt_gatt_attr attrs_d[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_16(0xddd0)),
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_16(0xddd1), BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ, NULL, NULL, NULL),
+};
+
+static struct bt_gatt_service svc_a = BT_GATT_SERVICE(attrs_a);
+static struct bt_gatt_service svc_b = BT_GATT_SERVICE(attrs_b);
+static struct bt_gatt_service svc_c = BT_GATT_SERVICE(attrs_c);
+static struct bt_gatt_service svc_d = BT_GATT_SERVICE(attrs_d);
+
+struct attr_list {
+	const struct bt_gatt_attr *attrs[MAX_ATTRS];
+	size_t count;
+};
+
+/* Full database as seen by walking the whole handle range */
+static struct attr_list db;
+
+static u8_t collect_attr(const struct bt_gatt_attr *attr, void *user_data)
+{
+	struct attr_list *list = user_data;
+
+	zassert_true(list->count < MAX_ATTRS, "too many attributes");
+	list->attrs[list->count++] = attr;
+
+	return BT_GATT_ITER_CONTINUE;
+}
+
+static bool db_has(const struct bt_gatt_service *svc)
+{
+	size_t i, j;
+
+	for (i = 0; i < db.count; i++) {
+		if (db.attrs[i] == &svc->attrs[0]) {
+			break;
+		}
+	}
+
+	if (i + svc->attr_count > db.count) {
+		return false;
+	}
+
+	for (j = 0; j < svc->attr_count; j++) {
+		if (db.attrs[i + j] != &svc->attrs[j]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void db_snapshot(void)
+{
+	size_t i;
+
+	db.count = 0;
+	bt_gatt_foreach_attr(0x0001, 0xffff, collect_attr, &db);
+
+	zassert_true(db.count > 0, "empty database");
+
+	for (i = 1; i < db.count; i++) {
+		zassert_true(db.attrs[i - 1]->handle < db.attrs[i]->handle,
+			     "handle 0x%04x follows 0x%04x",
+			     db.attrs[i]->handle, db.attrs[i - 1]->handle);
+	}
+}
+
+static void check_range(u16_t start, u16_t end)
+{
+	struct attr_list found = { .count = 0 };
+	size_t i, n = 0;
+
+	bt_gatt_foreach_attr(start, end, collect_attr, &found);
+
+	for (i = 0; i < db.count; i++) {
+		if (db.attrs[i]->handle < start || db.attrs[i]->handle > end) {
+			continue;
+		}
+
+		zassert_true(n < found.count,
+			     "0x%04x-0x%04x: handle 0x%04x missing", start, end,
+			     db.attrs[i]->handle);
+		zassert_equal_ptr(found.attrs[n], db.attrs[i],
+				  "0x%04x-0x%04x: wrong attribute %zu",
+				  start, end, n);
+		n++;
+	}
+
+	zassert_equal(found.count, n, "0x%04x-0x%04x: %zu extra attributes",
+		      start, end, found.count - n);
+}
+
+/* Check every range around the database against the full walk, ranges
+ * starting or ending in a hole left by a removed service included.
+ */
+static void check_ranges(void)
+{
+	u16_t last = db.attrs[db.count - 1]->handle + 2;
+	u16_t start, end;
+
+	for (start = 0x0001; start <= last; start++) {
+		for (end = start - 1; end <= last; end++) {
+			check_range(start, end);
+		}
+
+		check_range(start, 0xffff);
+	}
+}
+
+static void check_next(void)
+{
+	const struct bt_gatt_attr *next, *expected;
+	size_t i;
+
+	for (i = 0; i < db.count; i++) {
+		expected = NULL;
+		if (i + 1 < db.count &&
+		    db.attrs[i + 1]->handle == db.attrs[i]->handle + 1) {
+			expected = db.attrs[i + 1];
+		}
+
+		next = bt_gatt_attr_next(db.attrs[i]);
+		zassert_equal_ptr(next, expected, "wrong next of 0x%04x",
+				  db.attrs[i]->handle);
+	}
+}
+
+static void check_db(void)
+{
+	db_snapshot();
+	check_ranges();
+	check_next();
+}
+
+static void test_gatt_register(void)
+{
+	zassert_false(bt_gatt_service_register(&svc_a), "register A failed");
+	zassert_false(bt_gatt_service_register(&svc_b), "register B failed");
+	zassert_false(bt_gatt_service_register(&svc_c), "register C failed");
+
+	zassert_equal(attrs_b[0].handle,
+		      attrs_a[ARRAY_SIZE(attrs_a) - 1].handle + 1,
+		      "B does not follow A");
+	zassert_equal(attrs_c[0].handle,
+		      attrs_b[ARRAY_SIZE(attrs_b) - 1].handle + 1,
+		      "C does not follow B");
+
+	check_db();
+
+	zassert_true(db_has(&svc_a), "A not found");
+	zassert_true(db_has(&svc_b), "B not found");
+	zassert_true(db_has(&svc_c), "C not found");
+	zassert_equal_ptr(db.attrs[db.count - 1],
+			  &attrs_c[ARRAY_SIZE(attrs_c) - 1],
+			  "C is not the last service");
+}
+
+static void test_gatt_unregister(void)
+{
+	zassert_false(bt_gatt_service_unregister(&svc_b),
+		      "unregister B failed");
+	zassert_equal(bt_gatt_service_unregister(&svc_b), -ENOENT,
+		      "B unregistered twice");
+
+	check_db();
+
+	zassert_true(db_has(&svc_a), "A not found");
+	zassert_false(db_has(&svc_b), "B still found");
+	zassert_true(db_has(&svc_c), "C not found");
+	zassert_is_null(bt_gatt_attr_next(&attrs_a[ARRAY_SIZE(attrs_a) - 1]),
+			"next of A crosses the hole left by B");
+}
+
+static void test_gatt_unregister_tail(void)
+{
+	u16_t handle_c = attrs_c[0].handle;
+
+	zassert_false(bt_gatt_service_unregister(&svc_c),
+		      "unregister C failed");
+
+	check_db();
+
+	zassert_true(db_has(&svc_a), "A not found");
+	zassert_false(db_has(&svc_c), "C still found");
+	zassert_equal_ptr(db.attrs[db.count - 1],
+			  &attrs_a[ARRAY_SIZE(attrs_a) - 1],
+			  "A is not the last service");
+
+	/* C keeps its handles, they are above the new tail */
+	zassert_false(bt_gatt_service_register(&svc_c),
+		      "register C again failed");
+	zassert_equal(attrs_c[0].handle, handle_c, "C moved");
+
+	check_db();
+
+	zassert_true(db_has(&svc_c), "C not found");
+}
+
+static void test_gatt_register_after_tail(void)
+{
+	/* B's handles are below the tail, it cannot be inserted back */
+	zassert_equal(bt_gatt_service_register(&svc_b), -EINVAL,
+		      "B inserted below the tail");
+
+	zassert_false(bt_gatt_service_register(&svc_d), "register D failed");
+	zassert_equal(attrs_d[0].handle,
+		      attrs_c[ARRAY_SIZE(attrs_c) - 1].handle + 1,
+		      "D does not follow C");
+
+	check_db();
+
+	zassert_true(db_has(&svc_a), "A not found");
+	zassert_false(db_has(&svc_b), "B found");
+	zassert_true(db_has(&svc_c), "C not found");
+	zassert_true(db_has(&svc_d), "D not found");
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_gatt,
+			 ztest_unit_test(test_gatt_register),
+			 ztest_unit_test(test_gatt_unregister),
+			 ztest_unit_test(test_gatt_unregister_tail),
+			 ztest_unit_test(test_gatt_register_after_tail));
+	ztest_run_test_suite(test_gatt);
+}
@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <misc/byteorder.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/hci.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/uuid.h>
+#include <bluetooth/gatt.h>
+#include <drivers/bluetooth/hci_driver.h>
+
+/* Connected peers, one more peer has notifications enabled but is not
+ * connected.
+ */
+#define PEERS 3
+
+#define L2CAP_CID_ATT 0x0004
+#define ATT_OP_MTU_REQ 0x02
+#define ATT_OP_NOTIFY 0x1b
+
+/* Larger value than the default ATT MTU lets through */
+#define LARGE_LEN 30
+#define LARGE_MTU 40
+
+/* Largest return parameters read by the host during the initialization */
+#define RP_LEN sizeof(struct bt_hci_rp_read_supported_commands)
+
+static const u8_t payload[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+static u8_t large_payload[LARGE_MTU];
+
+static const bt_addr_le_t peers[PEERS + 1] = {
+	{ BT_ADDR_LE_RANDOM, { { 0x01, 0x00, 0x00, 0x00, 0x00, 0xc0 } } },
+	{ BT_ADDR_LE_RANDOM, { { 0x02, 0x00, 0x00, 0x00, 0x00, 0xc0 } } },
+	{ BT_ADDR_LE_RANDOM, { { 0x03, 0x00, 0x00, 0x00, 0x00, 0xc0 } } },
+	{ BT_ADDR_LE_RANDOM, { { 0x04, 0x00, 0x00, 0x00, 0x00, 0xc0 } } },
+};
+
+static struct bt_gatt_ccc_cfg ccc_cfg[BT_GATT_CCC_MAX];
+
+static void ccc_changed(const struct bt_gatt_attr *attr, u16_t value)
+{
+}
+
+static struct bt_gatt_attr attrs[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_16(0xaaa0)),
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_16(0xaaa1), BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_NONE, NULL, NULL, NULL),
+	BT_GATT_CCC(ccc_cfg, ccc_changed),
+};
+
+static struct bt_gatt_service svc = BT_GATT_SERVICE(attrs);
+
+/* Notifications seen by the controller, per connection handle */
+static struct {
+	u8_t count;
+	u16_t handle;
+	u8_t len;
+	u8_t data[LARGE_LEN];
+} notified[PEERS];
+
+static K_FIFO_DEFINE(rx_queue);
+static K_THREAD_STACK_DEFINE(rx_stack, 1024);
+static struct k_thread rx_thread_data;
+
+static K_SEM_DEFINE(connected_sem, 0, PEERS);
+static K_SEM_DEFINE(notify_all_sem, 0, 1);
+
+static struct bt_conn *conns[PEERS];
+static u8_t notify_all_calls;
+static u8_t notify_all_count;
+
+static void *evt_add(struct net_buf *buf, u8_t evt, u8_t len)
+{
+	struct bt_hci_evt_hdr *hdr;
+
+	hdr = net_buf_add(buf, sizeof(*hdr));
+	hdr->evt = evt;
+	hdr->len = len;
+
+	return memset(net_buf_add(buf, len), 0, len);
+}
+
+/* Complete any command, the return parameters the host depends on
+ * describe an LE only controller with a public address, the others are
+ * left zeroed.
+ */
+static void cmd_complete(u16_t opcode)
+{
+	struct bt_hci_evt_cmd_complete *cc;
+	struct net_buf *buf;
+	void *rp;
+
+	buf = bt_buf_get_cmd_complete(K_FOREVER);
+	cc = evt_add(buf, BT_HCI_EVT_CMD_COMPLETE, sizeof(*cc) + RP_LEN);
+	cc->ncmd = 1U;
+	cc->opcode = sys_cpu_to_le16(opcode);
+	rp = cc + 1;
+
+	switch (opcode) {
+	case BT_HCI_OP_READ_LOCAL_FEATURES: {
+		struct bt_hci_rp_read_local_features *features = rp;
+
+		/* LE supported, BR/EDR not supported */
+		features->features[4] = BIT(5) | BIT(6);
+		break;
+	}
+	case BT_HCI_OP_READ_SUPPORTED_COMMANDS: {
+		struct bt_hci_rp_read_supported_commands *commands = rp;
+
+		/* LE Rand, used to seed the host PRNG */
+		commands->commands[27] = BIT(7);
+		break;
+	}
+	case BT_HCI_OP_READ_BD_ADDR: {
+		struct bt_hci_rp_read_bd_addr *addr = rp;
+
+		memset(&addr->bdaddr, 0x11, sizeof(addr->bdaddr));
+		break;
+	}
+	case BT_HCI_OP_LE_READ_BUFFER_SIZE: {
+		struct bt_hci_rp_le_read_buffer_size *size = rp;
+
+		size->le_max_len = sys_cpu_to_le16(LARGE_MTU + 4);
+		size->le_max_num = PEERS;
+		break;
+	}
+	}
+
+	net_buf_put(&rx_queue, buf);
+}
+
+static void acl_sent(struct net_buf *buf)
+{
+	struct bt_hci_evt_num_completed_packets *nocp;
+	struct bt_hci_acl_hdr *hdr;
+	struct net_buf *evt;
+	u16_t handle;
+
+	hdr = net_buf_pull_mem(buf, sizeof(*hdr));
+	handle = bt_acl_handle(sys_le16_to_cpu(hdr->handle));
+
+	/* L2CAP header, ATT opcode and attribute handle */
+	if (handle < PEERS && buf->len >= 7 &&
+	    sys_get_le16(&buf->data[2]) == L2CAP_CID_ATT &&
+	    buf->data[4] == ATT_OP_NOTIFY) {
+		notified[handle].count++;
+		notified[handle].handle = sys_get_le16(&buf->data[5]);
+		notified[handle].len = MIN(buf->len - 7, LARGE_LEN);
+		memcpy(notified[handle].data, &buf->data[7],
+		       notified[handle].len);
+	}
+
+	evt = bt_buf_get_rx(BT_BUF_EVT, K_FOREVER);
+	nocp = evt_add(evt, BT_HCI_EVT_NUM_COMPLETED_PACKETS,
+		       sizeof(*nocp) + sizeof(nocp->h[0]));
+	nocp->num_handles = 1U;
+	nocp->h[0].handle = sys_cpu_to_le16(handle);
+	nocp->h[0].count = sys_cpu_to_le16(1);
+
+	net_buf_put(&rx_queue, evt);
+}
+
+static void rx_thread(void *p1, void *p2, void *p3)
+{
+	while (1) {
+		struct net_buf *buf;
+		struct bt_hci_evt_hdr *hdr;
+
+		buf = net_buf_get(&rx_queue, K_FOREVER);
+		hdr = (void *)buf->data;
+
+		if (bt_buf_get_type(buf) == BT_BUF_EVT &&
+		    bt_hci_evt_is_prio(hdr->evt)) {
+			bt_recv_prio(buf);
+		} else {
+			bt_recv(buf);
+		}
+	}
+}
+
+static int driver_open(void)
+{
+	k_thread_create(&rx_thread_data, rx_stack,
+			K_THREAD_STACK_SIZEOF(rx_stack), rx_thread,
+			NULL, NULL, NULL, K_PRIO_COOP(8), 0, K_NO_WAIT);
+
+	return 0;
+}
+
+static int driver_send(struct net_buf *buf)
+{
+	struct bt_hci_cmd_hdr *hdr;
+	u16_t opcode;
+
+	switch (bt_buf_get_type(buf)) {
+	case BT_BUF_CMD:
+		hdr = (void *)buf->data;
+		opcode = sys_le16_to_cpu(hdr->opcode);
+		net_buf_unref(buf);
+
+		cmd_complete(opcode);
+		return 0;
+	case BT_BUF_ACL_OUT:
+		acl_sent(buf);
+		net_buf_unref(buf);
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+static const struct bt_hci_driver drv = {
+	.name         = "test",
+	.bus          = BT_HCI_DRIVER_BUS_VIRTUAL,
+	.open         = driver_open,
+	.send         = driver_send,
+};
+
+static void connected(struct bt_conn *conn, u8_t err)
+{
+	const bt_addr_le_t *dst = bt_conn_get_dst(conn);
+	int i;
+
+	for (i = 0; i < PEERS; i++) {
+		if (!bt_addr_le_cmp(dst, &peers[i])) {
+			conns[i] = bt_conn_ref(conn);
+			k_sem_give(&connected_sem);
+			return;
+		}
+	}
+}
+
+static struct bt_conn_cb conn_callbacks = {
+	.connected = connected,
+};
+
+static void connect_peer(u16_t handle)
+{
+	struct bt_hci_evt_le_meta_event *meta;
+	struct bt_hci_evt_le_conn_complete *cc;
+	struct net_buf *buf;
+
+	buf = bt_buf_get_rx(BT_BUF_EVT, K_FOREVER);
+	meta = evt_add(buf, BT_HCI_EVT_LE_META_EVENT,
+		       sizeof(*meta) + sizeof(*cc));
+	meta->subevent = BT_HCI_EVT_LE_CONN_COMPLETE;
+
+	cc = (void *)(meta + 1);
+	cc->handle = sys_cpu_to_le16(handle);
+	cc->role = BT_HCI_ROLE_SLAVE;
+	bt_addr_le_copy(&cc->peer_addr, &peers[handle]);
+	cc->interval = sys_cpu_to_le16(0x0028);
+	cc->supv_timeout = sys_cpu_to_le16(0x002a);
+
+	net_buf_put(&rx_queue, buf);
+}
+
+/* The peer asks for a larger ATT MTU, the host answers it right away */
+static void exchange_mtu(u16_t handle, u16_t mtu)
+{
+	struct bt_hci_acl_hdr *hdr;
+	struct net_buf *buf;
+	u8_t *pdu;
+
+	buf = bt_buf_get_rx(BT_BUF_ACL_IN, K_FOREVER);
+
+	hdr = net_buf_add(buf, sizeof(*hdr));
+	hdr->handle = sys_cpu_to_le16(bt_acl_handle_pack(handle,
+							 BT_ACL_START));
+	hdr->len = sys_cpu_to_le16(7);
+
+	/* L2CAP header, ATT opcode and MTU */
+	pdu = net_buf_add(buf, 7);
+	sys_put_le16(3, &pdu[0]);
+	sys_put_le16(L2CAP_CID_ATT, &pdu[2]);
+	pdu[4] = ATT_OP_MTU_REQ;
+	sys_put_le16(mtu, &pdu[5]);
+
+	net_buf_put(&rx_queue, buf);
+}
+
+static void notify_all_func(struct bt_gatt_notify_all_params *params,
+			    u8_t count)
+{
+	notify_all_calls++;
+	notify_all_count = count;
+	k_sem_give(&notify_all_sem);
+}
+
+static void test_gatt_notify_all_setup(void)
+{
+	u16_t i;
+
+	zassert_false(bt_hci_driver_register(&drv), "driver register failed");
+	zassert_false(bt_enable(NULL), "bt_enable failed");
+
+	bt_conn_cb_register(&conn_callbacks);
+
+	zassert_false(bt_gatt_service_register(&svc), "register failed");
+
+	for (i = 0; i < PEERS; i++) {
+		connect_peer(i);
+		zassert_false(k_sem_take(&connected_sem, K_SECONDS(1)),
+			      "peer %u not connected", i);
+	}
+
+	/* Notifications enabled by all the peers */
+	for (i = 0; i < ARRAY_SIZE(peers); i++) {
+		ccc_cfg[i].id = BT_ID_DEFAULT;
+		bt_addr_le_copy(&ccc_cfg[i].peer, &peers[i]);
+		ccc_cfg[i].value = BT_GATT_CCC_NOTIFY;
+	}
+}
+
+static void test_gatt_notify_all(void)
+{
+	struct bt_gatt_notify_all_params params = {
+		.attr = &attrs[1],
+		.data = payload,
+		.len = sizeof(payload),
+		.func = notify_all_func,
+	};
+	int i;
+
+	zassert_false(bt_gatt_notify_all(&params), "notify all failed");
+	zassert_false(k_sem_take(&notify_all_sem, K_SECONDS(1)),
+		      "notify all not completed");
+
+	/* The callback is called once, for the connected peers only */
+	k_sleep(K_MSEC(100));
+	zassert_equal(notify_all_calls, 1, "callback called %u times",
+		      notify_all_calls);
+	zassert_equal(notify_all_count, PEERS, "count %u", notify_all_count);
+	zassert_equal(params.count, PEERS, "params count %u", params.count);
+
+	for (i = 0; i < PEERS; i++) {
+		zassert_equal(notified[i].count, 1, "peer %d notified %u times",
+			      i, notified[i].count);
+		zassert_equal(notified[i].handle, attrs[2].handle,
+			      "peer %d wrong handle 0x%04x", i,
+			      notified[i].handle);
+		zassert_equal(notified[i].len, sizeof(payload),
+			      "peer %d wrong length %u", i, notified[i].len);
+		zassert_false(memcmp(notified[i].data, payload, sizeof(payload)),
+			      "peer %d wrong value", i);
+	}
+}
+
+static void test_gatt_notify_all_skip_failed(void)
+{
+	struct bt_gatt_notify_all_params params = {
+		.attr = &attrs[1],
+		.data = large_payload,
+		.len = LARGE_LEN,
+		.func = notify_all_func,
+	};
+	int i;
+
+	for (i = 0; i < sizeof(large_payload); i++) {
+		large_payload[i] = i;
+	}
+
+	/* Only the second peer can take the larger value */
+	exchange_mtu(1, LARGE_MTU);
+	k_sleep(K_MSEC(100));
+	zassert_equal(bt_gatt_get_mtu(conns[1]), LARGE_MTU, "MTU %u",
+		      bt_gatt_get_mtu(conns[1]));
+
+	memset(notified, 0, sizeof(notified));
+	notify_all_calls = 0U;
+
+	/* The first peer failing does not keep the others from it */
+	zassert_false(bt_gatt_notify_all(&params), "notify all failed");
+	zassert_false(k_sem_take(&notify_all_sem, K_SECONDS(1)),
+		      "notify all not completed");
+
+	k_sleep(K_MSEC(100));
+	zassert_equal(notify_all_calls, 1, "callback called %u times",
+		      notify_all_calls);
+	zassert_equal(notify_all_count, 1, "count %u", notify_all_count);
+
+	for (i = 0; i < PEERS; i++) {
+		zassert_equal(notified[i].count, i == 1 ? 1 : 0,
+			      "peer %d notified %u times", i,
+			      notified[i].count);
+	}
+
+	zassert_equal(notified[1].len, LARGE_LEN, "wrong length %u",
+		      notified[1].len);
+	zassert_false(memcmp(notified[1].data, large_payload, LARGE_LEN),
+		      "wrong value");
+
+	/* No peer can take a value larger than its MTU, so nothing is
+	 * queued and the callback is not called.
+	 */
+	params.len = LARGE_MTU - 2;
+	zassert_equal(bt_gatt_notify_all(&params), -EMSGSIZE,
+		      "notify all did not fail");
+	zassert_not_equal(k_sem_take(&notify_all_sem, K_MSEC(100)), 0,
+			  "callback called");
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_gatt_notify_all,
+			 ztest_unit_test(test_gatt_notify_all_setup),
+			 ztest_unit_test(test_gatt_notify_all),
+			 ztest_unit_test(test_gatt_notify_all_skip_failed));
+	ztest_run_test_suite(test_gatt_notify_all);
+}
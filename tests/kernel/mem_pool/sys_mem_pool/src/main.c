@@ -21,8 +21,16 @@
 
 K_MUTEX_DEFINE(pool_mutex);
 
+#ifdef CONFIG_MEM_POOL_TLSF
+SYS_MEM_POOL_DEFINE_TLSF(pool, &pool_mutex, BLK_SIZE_MIN, BLK_SIZE_MAX,
+			 BLK_NUM_MAX, BLK_ALIGN, ZTEST_SECTION);
+
+/* Smallest TLSF block is 16 bytes */
+#define TLSF_MAX_BLKS (TOTAL_POOL_SIZE / 16)
+#else
 SYS_MEM_POOL_DEFINE(pool, &pool_mutex, BLK_SIZE_MIN, BLK_SIZE_MAX,
 		    BLK_NUM_MAX, BLK_ALIGN, ZTEST_SECTION);
+#endif
 
 /**
  * @brief Verify sys_mem_pool allocation and free
@@ -95,6 +103,13 @@ void test_sys_mem_pool_alloc_align4(void)
  *
  * @see sys_mem_pool_alloc(), sys_mem_pool_free()
  */
+#ifdef CONFIG_MEM_POOL_TLSF
+void test_sys_mem_pool_min_block_size(void)
+{
+	/* TLSF pools have no minimum block size beyond their header */
+	ztest_test_skip();
+}
+#else
 void test_sys_mem_pool_min_block_size(void)
 {
 	void *block[TOTAL_MIN_BLKS], *block_fail;
@@ -122,6 +137,58 @@ void test_sys_mem_pool_min_block_size(void)
 		sys_mem_pool_free(block[i]);
 	}
 }
+#endif
+
+#ifdef CONFIG_MEM_POOL_TLSF
+ZTEST_BMEM static void *tlsf_block[TLSF_MAX_BLKS];
+
+/**
+ * @brief Verify that released TLSF blocks are coalesced
+ *
+ * @ingroup kernel_memory_pool_tests
+ *
+ * @see sys_mem_pool_alloc(), sys_mem_pool_free()
+ */
+void test_sys_mem_pool_tlsf_coalesce(void)
+{
+	void *block[BLK_NUM_MAX];
+	int i, n;
+
+	/* Cut the whole pool into minimum sized blocks */
+	for (n = 0; n < TLSF_MAX_BLKS; n++) {
+		tlsf_block[n] = sys_mem_pool_alloc(&pool, 0);
+		if (tlsf_block[n] == NULL) {
+			break;
+		}
+	}
+	zassert_true(n > TOTAL_MIN_BLKS, NULL);
+
+	/* Release every other block first so that each free has to
+	 * merge with both neighbours
+	 */
+	for (i = 0; i < n; i += 2) {
+		sys_mem_pool_free(tlsf_block[i]);
+	}
+	for (i = 1; i < n; i += 2) {
+		sys_mem_pool_free(tlsf_block[i]);
+	}
+
+	/** TESTPOINT: the pool is back in one piece */
+	for (i = 0; i < BLK_NUM_MAX; i++) {
+		block[i] = sys_mem_pool_alloc(&pool, BLK_SIZE_MAX - DESC_SIZE);
+		zassert_not_null(block[i], NULL);
+	}
+
+	for (i = 0; i < BLK_NUM_MAX; i++) {
+		sys_mem_pool_free(block[i]);
+	}
+}
+#else
+void test_sys_mem_pool_tlsf_coalesce(void)
+{
+	ztest_test_skip();
+}
+#endif
 
 /*test case main entry*/
 void test_main(void)
@@ -132,7 +199,8 @@ void test_main(void)
 	ztest_test_suite(test_sys_mem_pool_api,
 			 ztest_user_unit_test(test_sys_mem_pool_alloc_free),
 			 ztest_user_unit_test(test_sys_mem_pool_alloc_align4),
-			 ztest_user_unit_test(test_sys_mem_pool_min_block_size)
+			 ztest_user_unit_test(test_sys_mem_pool_min_block_size),
+			 ztest_user_unit_test(test_sys_mem_pool_tlsf_coalesce)
 			 );
 	ztest_run_test_suite(test_sys_mem_pool_api);
 }
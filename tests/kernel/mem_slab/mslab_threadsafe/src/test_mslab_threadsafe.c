@@ -88,6 +88,13 @@ void test_mslab_threadsafe(void)
 		k_sem_take(&sync_sema, K_FOREVER);
 	}
 
+	/* TESTPOINT: every block was returned */
+	for (int i = 0; i < SLAB_NUM; i++) {
+		zassert_equal(k_mem_slab_num_used_get(slabs[i]), 0, NULL);
+		zassert_equal(k_mem_slab_num_free_get(slabs[i]), SLAB_BLOCKS,
+			      NULL);
+	}
+
 	/* test case tear down*/
 	for (int i = 0; i < THREAD_NUM; i++) {
 		k_thread_abort(tid[i]);
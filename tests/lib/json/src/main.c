@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include <ztest.h>
 #include <json.h>
+#include <net/buf.h>
 
 struct test_nested {
 	int nested_int;
@@ -409,6 +410,438 @@ static void test_json_key_not_in_descr(void)
 	zassert_equal(ret, 0, "No items should be decoded");
 }
 
+struct stream {
+	const char *data;
+	size_t len;
+	size_t chunk;
+};
+
+static ssize_t read_chunk(char *bytes, size_t len, void *data)
+{
+	struct stream *stream = data;
+
+	len = MIN(len, MIN(stream->chunk, stream->len));
+
+	memcpy(bytes, stream->data, len);
+	stream->data += len;
+	stream->len -= len;
+
+	return len;
+}
+
+static void test_json_decoding_stream(void)
+{
+	const char encoded[] = "{\"some_string\":\"zephyr 123\","
+		"\"some_int\":\t42\n,"
+		"\"some_bool\":true    \t  "
+		"\n"
+		"\r   ,"
+		"\"some_nested_struct\":{    "
+		"\"nested_int\":-1234,\n\n"
+		"\"nested_bool\":false,\t"
+		"\"nested_string\":\"this should be escaped: \\t\"},"
+		"\"some_array\":[11,22, 33,\t45,\n299]"
+		"\"another_b!@l\":true,"
+		"\"if\":false,"
+		"\"another-array\":[2,3,5,7],"
+		"\"4nother_ne$+\":{\"nested_int\":1234,"
+		"\"nested_bool\":true,"
+		"\"nested_string\":\"no escape necessary\"}"
+		"}";
+	const int expected_array[] = { 11, 22, 33, 45, 299 };
+	struct stream stream;
+	struct test_struct ts;
+	char buf[112];
+	size_t chunk;
+	s64_t ret;
+
+	/* Tokens are split at every possible place */
+	for (chunk = 1; chunk <= 16; chunk++) {
+		stream.data = encoded;
+		stream.len = sizeof(encoded) - 1;
+		stream.chunk = chunk;
+
+		(void)memset(&ts, 0, sizeof(ts));
+		(void)memset(buf, 0, sizeof(buf));
+
+		ret = json_obj_parse_stream(read_chunk, &stream, buf,
+					    sizeof(buf), test_descr,
+					    ARRAY_SIZE(test_descr), &ts);
+
+		zassert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+			      "All fields decoded correctly");
+		zassert_true(!strcmp(ts.some_string, "zephyr 123"),
+			     "String decoded correctly");
+		zassert_equal(ts.some_int, 42, "Integer decoded correctly");
+		zassert_true(ts.some_bool, "Boolean decoded correctly");
+		zassert_equal(ts.some_nested_struct.nested_int, -1234,
+			      "Nested integer decoded correctly");
+		zassert_true(!strcmp(ts.some_nested_struct.nested_string,
+				     "this should be escaped: \\t"),
+			     "Nested string decoded correctly");
+		zassert_equal(ts.some_array_len, 5,
+			      "Array has correct number of items");
+		zassert_true(!memcmp(ts.some_array, expected_array,
+				     sizeof(expected_array)),
+			     "Array decoded with expected values");
+		zassert_equal(ts.another_array_len, 4,
+			      "Named array has correct number of items");
+		zassert_true(!strcmp(ts.xnother_nexx.nested_string,
+				     "no escape necessary"),
+			     "Named nested string decoded correctly");
+	}
+}
+
+static void test_json_decoding_stream_nomem(void)
+{
+	const char encoded[] = "{\"some_string\":\"zephyr 123\","
+		"\"some_int\":42}";
+	struct stream stream = {
+		.data = encoded,
+		.len = sizeof(encoded) - 1,
+		.chunk = 8,
+	};
+	struct test_struct ts;
+	char buf[48];
+	s64_t ret;
+
+	/* The first key and value pair does not fit */
+	ret = json_obj_parse_stream(read_chunk, &stream, buf, 24, test_descr,
+				    ARRAY_SIZE(test_descr), &ts);
+	zassert_equal(ret, -ENOMEM, "Decoding has to fail");
+
+	stream.data = encoded;
+	stream.len = sizeof(encoded) - 1;
+
+	ret = json_obj_parse_stream(read_chunk, &stream, buf, sizeof(buf),
+				    test_descr, ARRAY_SIZE(test_descr), &ts);
+	zassert_equal(ret, 3, "Fields decoded with enough room");
+}
+
+#define MANY_FIELDS 40
+
+struct many_fields {
+	int f[MANY_FIELDS];
+};
+
+#define FIELD_DESCR(n) \
+	JSON_OBJ_DESCR_PRIM_NAMED(struct many_fields, "f" #n, f[n], \
+				  JSON_TOK_NUMBER)
+
+static const struct json_obj_descr many_fields_descr[] = {
+	FIELD_DESCR(0), FIELD_DESCR(1), FIELD_DESCR(2), FIELD_DESCR(3),
+	FIELD_DESCR(4), FIELD_DESCR(5), FIELD_DESCR(6), FIELD_DESCR(7),
+	FIELD_DESCR(8), FIELD_DESCR(9), FIELD_DESCR(10), FIELD_DESCR(11),
+	FIELD_DESCR(12), FIELD_DESCR(13), FIELD_DESCR(14), FIELD_DESCR(15),
+	FIELD_DESCR(16), FIELD_DESCR(17), FIELD_DESCR(18), FIELD_DESCR(19),
+	FIELD_DESCR(20), FIELD_DESCR(21), FIELD_DESCR(22), FIELD_DESCR(23),
+	FIELD_DESCR(24), FIELD_DESCR(25), FIELD_DESCR(26), FIELD_DESCR(27),
+	FIELD_DESCR(28), FIELD_DESCR(29), FIELD_DESCR(30), FIELD_DESCR(31),
+	FIELD_DESCR(32), FIELD_DESCR(33), FIELD_DESCR(34), FIELD_DESCR(35),
+	FIELD_DESCR(36), FIELD_DESCR(37), FIELD_DESCR(38), FIELD_DESCR(39),
+};
+
+/* Every other field, in reverse order */
+static size_t encode_many_fields(char *encoded, size_t size)
+{
+	size_t len = 0;
+	int i;
+
+	len += snprintk(encoded + len, size - len, "{");
+
+	for (i = MANY_FIELDS - 1; i >= 0; i -= 2) {
+		len += snprintk(encoded + len, size - len,
+				"\"f%d\":%d%s", i, i * 10, i > 1 ? "," : "");
+	}
+
+	len += snprintk(encoded + len, size - len, "}");
+
+	return len;
+}
+
+static void test_json_decoding_many_fields(void)
+{
+	struct many_fields mf;
+	char encoded[MANY_FIELDS * 12];
+	size_t len;
+	s64_t ret;
+	int i;
+
+	len = encode_many_fields(encoded, sizeof(encoded));
+
+	(void)memset(&mf, 0, sizeof(mf));
+
+	ret = json_obj_parse(encoded, len, many_fields_descr,
+			     ARRAY_SIZE(many_fields_descr), &mf);
+	zassert_equal(ret, 0xaaaaaaaaaaLL, "Fields decoded correctly");
+
+	for (i = 0; i < MANY_FIELDS; i++) {
+		zassert_equal(mf.f[i], i & 1 ? i * 10 : 0,
+			      "Field value decoded correctly");
+	}
+}
+
+static void test_json_decoding_indexed(void)
+{
+	u8_t index[ARRAY_SIZE(many_fields_descr)];
+	u8_t test_index[ARRAY_SIZE(test_descr)];
+	struct many_fields mf;
+	struct test_struct ts;
+	char encoded[MANY_FIELDS * 12];
+	char nested[] = "{\"some_int\":42,\"key_not_in_descr\":1,"
+		"\"4nother_ne$+\":{\"nested_int\":7},\"some_int\":43}";
+	size_t len;
+	s64_t ret;
+	int i;
+
+	zassert_equal(json_obj_descr_index_build(many_fields_descr,
+						 ARRAY_SIZE(many_fields_descr),
+						 index), 0,
+		      "Index built");
+
+	len = encode_many_fields(encoded, sizeof(encoded));
+
+	(void)memset(&mf, 0, sizeof(mf));
+
+	ret = json_obj_parse_indexed(encoded, len, many_fields_descr,
+				     ARRAY_SIZE(many_fields_descr), index,
+				     &mf);
+	zassert_equal(ret, 0xaaaaaaaaaaLL, "Fields decoded correctly");
+
+	for (i = 0; i < MANY_FIELDS; i++) {
+		zassert_equal(mf.f[i], i & 1 ? i * 10 : 0,
+			      "Field value decoded correctly");
+	}
+
+	/* Unknown and repeated keys are skipped, as without an index */
+	zassert_equal(json_obj_descr_index_build(test_descr,
+						 ARRAY_SIZE(test_descr),
+						 test_index), 0,
+		      "Index built");
+
+	(void)memset(&ts, 0, sizeof(ts));
+
+	ret = json_obj_parse_indexed(nested, sizeof(nested) - 1, test_descr,
+				     ARRAY_SIZE(test_descr), test_index, &ts);
+	zassert_equal(ret, BIT(1) | BIT(8), "Fields decoded correctly");
+	zassert_equal(ts.some_int, 42, "Integer decoded correctly");
+	zassert_equal(ts.xnother_nexx.nested_int, 7,
+		      "Nested integer decoded correctly");
+}
+
+static void test_json_decoding_stream_indexed(void)
+{
+	const char encoded[] = "{\"some_string\":\"zephyr 123\","
+		"\"some_int\":42}";
+	struct stream stream = {
+		.data = encoded,
+		.len = sizeof(encoded) - 1,
+		.chunk = 5,
+	};
+	u8_t index[ARRAY_SIZE(test_descr)];
+	struct test_struct ts;
+	char buf[48];
+	s64_t ret;
+
+	zassert_equal(json_obj_descr_index_build(test_descr,
+						 ARRAY_SIZE(test_descr),
+						 index), 0,
+		      "Index built");
+
+	ret = json_obj_parse_stream_indexed(read_chunk, &stream, buf,
+					    sizeof(buf), test_descr,
+					    ARRAY_SIZE(test_descr), index,
+					    &ts);
+	zassert_equal(ret, 3, "Fields decoded correctly");
+	zassert_true(!strcmp(ts.some_string, "zephyr 123"),
+		     "String decoded correctly");
+	zassert_equal(ts.some_int, 42, "Integer decoded correctly");
+}
+
+static void test_json_index_duplicate_field(void)
+{
+	const struct json_obj_descr dup_descr[] = {
+		JSON_OBJ_DESCR_PRIM_NAMED(struct many_fields, "f0", f[0],
+					  JSON_TOK_NUMBER),
+		JSON_OBJ_DESCR_PRIM_NAMED(struct many_fields, "f1", f[1],
+					  JSON_TOK_NUMBER),
+		JSON_OBJ_DESCR_PRIM_NAMED(struct many_fields, "f0", f[2],
+					  JSON_TOK_NUMBER),
+	};
+	u8_t index[ARRAY_SIZE(dup_descr)];
+
+	zassert_equal(json_obj_descr_index_build(dup_descr,
+						 ARRAY_SIZE(dup_descr),
+						 index), -EINVAL,
+		      "Duplicate field names rejected");
+}
+
+struct numbers {
+	s64_t i64;
+	u64_t u64;
+	struct json_float f;
+	struct json_float floats[4];
+	size_t floats_len;
+	const char *name;
+};
+
+static const struct json_obj_descr numbers_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct numbers, i64, JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct numbers, u64, JSON_TOK_UINT64),
+	JSON_OBJ_DESCR_PRIM(struct numbers, f, JSON_TOK_FLOAT),
+	JSON_OBJ_DESCR_ARRAY(struct numbers, floats, 4, floats_len,
+			     JSON_TOK_FLOAT),
+	JSON_OBJ_DESCR_PRIM(struct numbers, name, JSON_TOK_STRING),
+};
+
+static void test_json_numbers_encoding(void)
+{
+	struct numbers nums = {
+		.i64 = INT64_MIN,
+		.u64 = UINT64_MAX,
+		.f = { -1, -250000 },
+		.floats = { { 0, 0 }, { 0, -500000 }, { 3, 141592 },
+			    { 123, 456000 } },
+		.floats_len = 4,
+		.name = NULL,
+	};
+	const char encoded[] = "{\"i64\":-9223372036854775808,"
+		"\"u64\":18446744073709551615,\"f\":-1.25,"
+		"\"floats\":[0.0,-0.5,3.141592,123.456],\"name\":null}";
+	char buffer[sizeof(encoded)];
+	int ret;
+
+	ret = json_obj_encode_buf(numbers_descr, ARRAY_SIZE(numbers_descr),
+				  &nums, buffer, sizeof(buffer));
+	zassert_equal(ret, 0, "Encoding function returned no errors");
+
+	ret = strncmp(buffer, encoded, sizeof(encoded) - 1);
+	zassert_equal(ret, 0, "Encoded contents consistent");
+
+	zassert_equal(json_calc_encoded_len(numbers_descr,
+					    ARRAY_SIZE(numbers_descr), &nums),
+		      sizeof(encoded) - 1, "Encoded length consistent");
+
+	/* The decimals must fit in val2 */
+	nums.f.val2 = JSON_FLOAT_DEC_MAX;
+	ret = json_obj_encode_buf(numbers_descr, ARRAY_SIZE(numbers_descr),
+				  &nums, buffer, sizeof(buffer));
+	zassert_equal(ret, -EINVAL, "Encoding has to fail");
+}
+
+static void test_json_numbers_decoding(void)
+{
+	char encoded[] = "{\"i64\":-9223372036854775808,"
+		"\"u64\":18446744073709551615,\"f\":-1.25,"
+		"\"floats\":[0,-0.5,3.14159265,123.456],\"name\":null}";
+	struct numbers nums;
+	s64_t ret;
+
+	(void)memset(&nums, 0, sizeof(nums));
+
+	ret = json_obj_parse(encoded, sizeof(encoded) - 1, numbers_descr,
+			     ARRAY_SIZE(numbers_descr), &nums);
+
+	/* The null name is not decoded */
+	zassert_equal(ret, 0xf, "Fields decoded correctly");
+	zassert_true(nums.i64 == INT64_MIN, "s64 decoded correctly");
+	zassert_true(nums.u64 == UINT64_MAX, "u64 decoded correctly");
+	zassert_true(nums.f.val1 == -1 && nums.f.val2 == -250000,
+		     "Float decoded correctly");
+	zassert_equal(nums.floats_len, 4, "Array has correct number of items");
+	zassert_true(nums.floats[0].val1 == 0 && nums.floats[0].val2 == 0,
+		     "Integer decoded as float");
+	zassert_true(nums.floats[1].val1 == 0 &&
+		     nums.floats[1].val2 == -500000,
+		     "Negative fraction decoded correctly");
+	zassert_true(nums.floats[2].val1 == 3 &&
+		     nums.floats[2].val2 == 141592,
+		     "Extra decimals ignored");
+	zassert_true(nums.floats[3].val1 == 123 &&
+		     nums.floats[3].val2 == 456000,
+		     "Float decoded correctly");
+	zassert_is_null(nums.name, "Null string left untouched");
+}
+
+static void test_json_numbers_out_of_range(void)
+{
+	char i64_overflow[] = "{\"i64\":9223372036854775808}";
+	char u64_overflow[] = "{\"u64\":18446744073709551616}";
+	char u64_negative[] = "{\"u64\":-1}";
+	char float_overflow[] = "{\"f\":2147483648.5}";
+	char float_no_decimals[] = "{\"f\":1.}";
+	struct numbers nums;
+	s64_t ret;
+
+	ret = json_obj_parse(i64_overflow, sizeof(i64_overflow) - 1,
+			     numbers_descr, ARRAY_SIZE(numbers_descr), &nums);
+	zassert_equal(ret, -ERANGE, "s64 overflow detected");
+
+	ret = json_obj_parse(u64_overflow, sizeof(u64_overflow) - 1,
+			     numbers_descr, ARRAY_SIZE(numbers_descr), &nums);
+	zassert_equal(ret, -ERANGE, "u64 overflow detected");
+
+	ret = json_obj_parse(u64_negative, sizeof(u64_negative) - 1,
+			     numbers_descr, ARRAY_SIZE(numbers_descr), &nums);
+	zassert_equal(ret, -EINVAL, "Negative u64 rejected");
+
+	ret = json_obj_parse(float_overflow, sizeof(float_overflow) - 1,
+			     numbers_descr, ARRAY_SIZE(numbers_descr), &nums);
+	zassert_equal(ret, -ERANGE, "Float overflow detected");
+
+	ret = json_obj_parse(float_no_decimals, sizeof(float_no_decimals) - 1,
+			     numbers_descr, ARRAY_SIZE(numbers_descr), &nums);
+	zassert_equal(ret, -EINVAL, "Float without decimals rejected");
+}
+
+NET_BUF_POOL_DEFINE(json_pool, 4, 16, 0, NULL);
+
+static void test_json_encoding_net_buf(void)
+{
+	struct elt elt = { .name = "a name that does not fit", .height = 42 };
+	const char encoded[] = "{\"name\":\"a name that does not fit\","
+		"\"height\":42}";
+	struct net_buf *buf, *frag;
+	char flat[sizeof(encoded)];
+	size_t len = 0;
+	int ret, i;
+
+	buf = net_buf_alloc(&json_pool, K_NO_WAIT);
+	zassert_not_null(buf, "Cannot allocate buffer");
+
+	/* Part of the first fragment is used already */
+	net_buf_add_u8(buf, '>');
+
+	/* Too small to hold the object, nothing is written */
+	ret = json_obj_encode_net_buf(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+				      buf);
+	zassert_equal(ret, -ENOMEM, "Encoding has to fail");
+	zassert_equal(buf->len, 1, "Nothing appended");
+
+	for (i = 0; i < 3; i++) {
+		frag = net_buf_alloc(&json_pool, K_NO_WAIT);
+		zassert_not_null(frag, "Cannot allocate fragment");
+		net_buf_frag_add(buf, frag);
+	}
+
+	ret = json_obj_encode_net_buf(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+				      buf);
+	zassert_equal(ret, sizeof(encoded) - 1, "Encoded length returned");
+
+	for (frag = buf; frag; frag = frag->frags) {
+		zassert_true(len + frag->len <= sizeof(flat), "Too much data");
+		memcpy(flat + len, frag->data, frag->len);
+		len += frag->len;
+	}
+
+	zassert_equal(len, sizeof(encoded), "All data appended");
+	zassert_equal(flat[0], '>', "Existing data preserved");
+	zassert_true(!memcmp(flat + 1, encoded, sizeof(encoded) - 1),
+		     "Encoded contents consistent");
+
+	net_buf_unref(buf);
+}
+
 static void test_json_escape(void)
 {
 	char buf[42];
@@ -507,6 +940,16 @@ void test_main(void)
 			 ztest_unit_test(test_json_wrong_token),
 			 ztest_unit_test(test_json_item_wrong_type),
 			 ztest_unit_test(test_json_key_not_in_descr),
+			 ztest_unit_test(test_json_decoding_stream),
+			 ztest_unit_test(test_json_decoding_stream_nomem),
+			 ztest_unit_test(test_json_decoding_many_fields),
+			 ztest_unit_test(test_json_decoding_indexed),
+			 ztest_unit_test(test_json_decoding_stream_indexed),
+			 ztest_unit_test(test_json_index_duplicate_field),
+			 ztest_unit_test(test_json_numbers_encoding),
+			 ztest_unit_test(test_json_numbers_decoding),
+			 ztest_unit_test(test_json_numbers_out_of_range),
+			 ztest_unit_test(test_json_encoding_net_buf),
 			 ztest_unit_test(test_json_escape),
 			 ztest_unit_test(test_json_escape_one),
 			 ztest_unit_test(test_json_escape_empty),
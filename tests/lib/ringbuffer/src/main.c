@@ -395,6 +395,151 @@ void test_byte_put_free(void)
 	}
 }
 
+void test_byte_claim_segments(void)
+{
+	u8_t indata[] = {1, 2, 3, 4};
+	struct ring_buf_segment segs[2];
+	u8_t outdata[RINGBUFFER_SIZE];
+	u32_t size;
+	int err;
+
+	ring_buf_init(&ringbuf_raw, RINGBUFFER_SIZE, ringbuf_raw.buf.buf8);
+
+	/* Move the indexes close to the end of the buffer */
+	zassert_equal(ring_buf_put(&ringbuf_raw, indata, 3), 3, NULL);
+	zassert_equal(ring_buf_get(&ringbuf_raw, outdata, 3), 3, NULL);
+
+	/* Nothing to read, both segments are empty */
+	size = ring_buf_get_claim_segments(&ringbuf_raw, segs,
+					   RINGBUFFER_SIZE);
+	zassert_equal(size, 0, NULL);
+	zassert_equal(segs[0].size, 0, NULL);
+	zassert_equal(segs[1].size, 0, NULL);
+
+	/**TESTPOINT: the allocated area wraps, two segments are returned*/
+	size = ring_buf_put_claim_segments(&ringbuf_raw, segs,
+					   RINGBUFFER_SIZE);
+	zassert_equal(size, RINGBUFFER_SIZE - 1, NULL);
+	zassert_equal(segs[0].size, RINGBUFFER_SIZE - 3, NULL);
+	zassert_equal(segs[0].data, &ringbuf_raw.buf.buf8[3], NULL);
+	zassert_equal(segs[1].size, 2, NULL);
+	zassert_equal(segs[1].data, &ringbuf_raw.buf.buf8[0], NULL);
+
+	memcpy(segs[0].data, indata, segs[0].size);
+	memcpy(segs[1].data, indata + segs[0].size, segs[1].size);
+
+	err = ring_buf_put_finish(&ringbuf_raw, sizeof(indata));
+	zassert_equal(err, 0, NULL);
+
+	/**TESTPOINT: the valid data wraps, two segments are returned*/
+	size = ring_buf_get_claim_segments(&ringbuf_raw, segs,
+					   RINGBUFFER_SIZE);
+	zassert_equal(size, sizeof(indata), NULL);
+	zassert_equal(segs[0].size, RINGBUFFER_SIZE - 3, NULL);
+	zassert_equal(segs[1].size, 2, NULL);
+	zassert_true(memcmp(segs[0].data, indata, segs[0].size) == 0, NULL);
+	zassert_true(memcmp(segs[1].data, indata + segs[0].size,
+			    segs[1].size) == 0, NULL);
+
+	err = ring_buf_get_finish(&ringbuf_raw, size);
+	zassert_equal(err, 0, NULL);
+	zassert_true(ring_buf_is_empty(&ringbuf_raw), NULL);
+
+	/* A request that stops before the wrap point is not split */
+	size = ring_buf_put_claim_segments(&ringbuf_raw, segs, 1);
+	zassert_equal(size, 1, NULL);
+	zassert_equal(segs[1].size, 0, NULL);
+
+	err = ring_buf_put_finish(&ringbuf_raw, 0);
+	zassert_equal(err, 0, NULL);
+}
+
+#define SPSC_BUF_SIZE 256
+#define SPSC_TOTAL (64 * 1024)
+#define SPSC_CHUNK 61
+#define SPSC_STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+RING_BUF_DECLARE(ringbuf_spsc, SPSC_BUF_SIZE);
+
+static K_THREAD_STACK_DEFINE(spsc_stack, SPSC_STACK_SIZE);
+static struct k_thread spsc_thread;
+static K_SEM_DEFINE(spsc_done, 0, 1);
+static u32_t spsc_errors;
+
+/* Consumer, checks that the bytes come out in the order they were put */
+static void spsc_consumer(void *p1, void *p2, void *p3)
+{
+	u8_t chunk[SPSC_CHUNK];
+	u8_t expected = 0U;
+	u32_t received = 0U;
+	u32_t len, i;
+
+	while (received < SPSC_TOTAL) {
+		len = ring_buf_get(&ringbuf_spsc, chunk,
+				   1 + received % sizeof(chunk));
+		if (!len) {
+			k_yield();
+			continue;
+		}
+
+		for (i = 0; i < len; i++) {
+			if (chunk[i] != expected++) {
+				spsc_errors++;
+			}
+		}
+
+		received += len;
+	}
+
+	k_sem_give(&spsc_done);
+}
+
+void test_ringbuffer_spsc_throughput(void)
+{
+	u8_t chunk[SPSC_CHUNK];
+	u8_t next = 0U;
+	u32_t sent = 0U;
+	u32_t start, cycles, len, i;
+
+	spsc_errors = 0U;
+
+	k_thread_create(&spsc_thread, spsc_stack, SPSC_STACK_SIZE,
+			spsc_consumer, NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	start = k_cycle_get_32();
+
+	/**TESTPOINT: one producer and one consumer without locking*/
+	while (sent < SPSC_TOTAL) {
+		len = MIN(SPSC_TOTAL - sent, 1 + sent % sizeof(chunk));
+
+		for (i = 0; i < len; i++) {
+			chunk[i] = next + i;
+		}
+
+		len = ring_buf_put(&ringbuf_spsc, chunk, len);
+		if (!len) {
+			k_yield();
+			continue;
+		}
+
+		next += len;
+		sent += len;
+	}
+
+	zassert_equal(k_sem_take(&spsc_done, K_SECONDS(10)), 0,
+		      "Consumer did not finish");
+
+	cycles = k_cycle_get_32() - start;
+
+	zassert_equal(spsc_errors, 0, "Data corrupted");
+	zassert_true(ring_buf_is_empty(&ringbuf_spsc), NULL);
+
+	TC_PRINT("%u bytes in %u cycles, %u bytes/ms\n", SPSC_TOTAL, cycles,
+		 (u32_t)((u64_t)SPSC_TOTAL * sys_clock_hw_cycles_per_sec() /
+			 MSEC_PER_SEC / MAX(cycles, 1)));
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -410,7 +555,9 @@ void test_main(void)
 			 ztest_unit_test(test_ring_buffer_main),
 			 ztest_unit_test(test_ringbuffer_raw),
 			 ztest_unit_test(test_ringbuffer_alloc_put),
-			 ztest_unit_test(test_byte_put_free)
+			 ztest_unit_test(test_byte_put_free),
+			 ztest_unit_test(test_byte_claim_segments),
+			 ztest_unit_test(test_ringbuffer_spsc_throughput)
 			 );
 	ztest_run_test_suite(test_ringbuffer_api);
 }
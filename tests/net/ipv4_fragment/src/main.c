@@ -0,0 +1,375 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "reassembly.h"
+#include "udp_internal.h"
+
+#if defined(CONFIG_NET_IPV4_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+#define TEST_MTU 576
+#define DATA_LEN 1200
+
+/* 8 bytes UDP header + 1200 bytes of data in 552 byte pieces */
+#define FRAG_LEN ((TEST_MTU - NET_IPV4H_LEN) & ~7)
+#define FRAG_COUNT 3
+
+#define SRC_PORT 4352
+#define DST_PORT 25348
+
+#define WAIT_TIME K_SECONDS(1)
+
+#define ALLOC_TIMEOUT 500
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_if *iface1;
+
+static bool test_failed;
+static bool test_started;
+static struct k_sem wait_frag;
+static struct k_sem wait_data;
+
+static struct net_pkt *frags[FRAG_COUNT];
+static int frag_count;
+
+static u8_t data[DATA_LEN];
+
+struct net_if_test {
+	u8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static int net_iface_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	struct net_if_test *data = net_if_get_device(iface)->driver_data;
+
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	data->mac_addr[0] = 0x00;
+	data->mac_addr[1] = 0x00;
+	data->mac_addr[2] = 0x5E;
+	data->mac_addr[3] = 0x00;
+	data->mac_addr[4] = 0x53;
+	data->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, data->mac_addr, sizeof(data->mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int verify_fragment(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	u16_t flags = ntohs(UNALIGNED_GET((u16_t *)hdr->offset));
+	u16_t len = net_pkt_get_len(pkt);
+	u16_t offset = (flags & NET_IPV4_FRAGH_OFFSET_MASK) * 8;
+
+	DBG("Fragment %d len %u offset %u flags 0x%x\n", frag_count, len,
+	    offset, flags);
+
+	if (len > TEST_MTU || ntohs(hdr->len) != len) {
+		DBG("Invalid fragment length %u\n", len);
+		return -EINVAL;
+	}
+
+	if (net_calc_chksum_ipv4(pkt) != 0) {
+		DBG("Invalid IPv4 header checksum\n");
+		return -EINVAL;
+	}
+
+	if (frag_count < FRAG_COUNT - 1) {
+		if (!(flags & NET_IPV4_MORE_FRAG_MASK) ||
+		    (len - NET_IPV4H_LEN) % 8) {
+			DBG("Fragment More flag should be set\n");
+			return -EINVAL;
+		}
+	} else if (flags & NET_IPV4_MORE_FRAG_MASK) {
+		DBG("Fragment More flag should be unset\n");
+		return -EINVAL;
+	}
+
+	if (offset != frag_count * FRAG_LEN) {
+		DBG("Invalid fragment offset %u\n", offset);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int sender_iface(struct device *dev, struct net_pkt *pkt)
+{
+	if (!pkt->frags) {
+		DBG("No data to send!\n");
+		return -ENODATA;
+	}
+
+	if (test_started) {
+		if (frag_count >= FRAG_COUNT || verify_fragment(pkt) < 0) {
+			DBG("Fragments cannot be verified\n");
+			test_failed = true;
+		} else {
+			/* Keep a copy so that it can be received back */
+			frags[frag_count] = net_pkt_clone(pkt, ALLOC_TIMEOUT);
+			frag_count++;
+
+			k_sem_give(&wait_frag);
+		}
+	}
+
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 TEST_MTU);
+
+static enum net_verdict udp_data_received(struct net_conn *conn,
+					  struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  union net_proto_header *proto_hdr,
+					  void *user_data)
+{
+	static u8_t buf[DATA_LEN];
+
+	DBG("Data %p received, %zd bytes\n", pkt, net_pkt_get_len(pkt));
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_get_len(pkt) != NET_IPV4UDPH_LEN + DATA_LEN ||
+	    net_pkt_skip(pkt, NET_IPV4UDPH_LEN) ||
+	    net_pkt_read_new(pkt, buf, sizeof(buf)) ||
+	    memcmp(buf, data, sizeof(buf))) {
+		test_failed = true;
+	}
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_data);
+
+	return NET_OK;
+}
+
+static struct net_pkt *create_udp_pkt(bool dont_frag)
+{
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface1, NET_UDPH_LEN + DATA_LEN,
+					AF_INET, IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	zassert_equal(net_ipv4_create_new(pkt, &my_addr, &peer_addr), 0,
+		      "Cannot create IPv4 header");
+
+	if (dont_frag) {
+		UNALIGNED_PUT(htons(NET_IPV4_DO_NOT_FRAG_MASK),
+			      (u16_t *)NET_IPV4_HDR(pkt)->offset);
+	}
+
+	zassert_equal(net_udp_create(pkt, htons(SRC_PORT), htons(DST_PORT)),
+		      0, "Cannot create UDP header");
+	zassert_equal(net_pkt_write_new(pkt, data, sizeof(data)), 0,
+		      "Cannot append data");
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_ipv4_finalize(pkt, IPPROTO_UDP), 0,
+		      "Cannot finalize");
+
+	return pkt;
+}
+
+static void test_setup(void)
+{
+	struct sockaddr remote_addr = { 0 };
+	struct sockaddr local_addr = { 0 };
+	struct net_conn_handle *handle;
+	struct net_if_addr *ifaddr;
+	int i, ret;
+
+	k_sem_init(&wait_frag, 0, UINT_MAX);
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = i;
+	}
+
+	iface1 = net_if_get_by_index(1);
+	zassert_not_null(iface1, "Interface 1");
+
+	ifaddr = net_if_ipv4_addr_add(iface1, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_up(iface1);
+
+	/* The packets sent to the peer are fed back to the stack, so
+	 * listen to them as if we were the peer.
+	 */
+	net_ipaddr_copy(&net_sin(&remote_addr)->sin_addr, &my_addr);
+	remote_addr.sa_family = AF_INET;
+	net_ipaddr_copy(&net_sin(&local_addr)->sin_addr, &peer_addr);
+	local_addr.sa_family = AF_INET;
+
+	ret = net_udp_register(AF_INET, &remote_addr, &local_addr,
+			       SRC_PORT, DST_PORT, udp_data_received,
+			       NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+
+	test_started = true;
+}
+
+static void test_send_ipv4_dont_fragment(void)
+{
+	struct net_pkt *pkt;
+
+	frag_count = 0;
+	test_failed = false;
+
+	pkt = create_udp_pkt(true);
+
+	zassert_true(net_send_data(pkt) < 0, "Too large packet sent");
+	net_pkt_unref(pkt);
+
+	zassert_equal(frag_count, 0, "Fragments sent");
+}
+
+static void test_send_ipv4_fragment(void)
+{
+	struct net_pkt *pkt;
+	int i;
+
+	frag_count = 0;
+	test_failed = false;
+
+	pkt = create_udp_pkt(false);
+
+	zassert_equal(net_send_data(pkt), 0, "Cannot send test packet");
+
+	for (i = 0; i < FRAG_COUNT; i++) {
+		zassert_equal(k_sem_take(&wait_frag, WAIT_TIME), 0,
+			      "Timeout while waiting fragment %d", i);
+	}
+
+	zassert_false(test_failed, "Fragment verify failed");
+	zassert_equal(frag_count, FRAG_COUNT, "Invalid fragment count");
+
+	for (i = 0; i < FRAG_COUNT; i++) {
+		zassert_not_null(frags[i], "Cannot clone fragment");
+		net_pkt_set_iface(frags[i], iface1);
+	}
+}
+
+static void count_cb(struct net_reassembly *reass, void *user_data)
+{
+	(*(int *)user_data)++;
+}
+
+static void test_recv_ipv4_fragment_timeout(void)
+{
+	struct net_pkt *pkt;
+	int i, count;
+
+	test_failed = false;
+
+	/* Without the last fragment the reassembly times out */
+	for (i = 0; i < FRAG_COUNT - 1; i++) {
+		pkt = net_pkt_clone(frags[i], ALLOC_TIMEOUT);
+		zassert_not_null(pkt, "Cannot clone fragment");
+
+		net_pkt_set_iface(pkt, iface1);
+
+		zassert_equal(net_recv_data(iface1, pkt), 0,
+			      "Cannot receive fragment");
+	}
+
+	zassert_not_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			  "Incomplete packet received");
+
+	k_sleep(K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT));
+
+	count = 0;
+	net_reassembly_foreach(AF_INET, count_cb, &count);
+	zassert_equal(count, 0, "Reassembly not cancelled");
+}
+
+static void test_recv_ipv4_fragment(void)
+{
+	int i;
+
+	test_failed = false;
+
+	/* Fragments arriving in the wrong order */
+	for (i = FRAG_COUNT - 1; i >= 0; i--) {
+		zassert_equal(net_recv_data(iface1, frags[i]), 0,
+			      "Cannot receive fragment");
+		frags[i] = NULL;
+	}
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Timeout while waiting reassembled packet");
+	zassert_false(test_failed, "Reassembled packet verify failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_ipv4_dont_fragment),
+			 ztest_unit_test(test_send_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment_timeout),
+			 ztest_unit_test(test_recv_ipv4_fragment)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
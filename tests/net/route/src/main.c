@@ -468,6 +468,76 @@ static void route_del_many(void)
 	}
 }
 
+static void route_lookup_prefix(void)
+{
+	static const struct {
+		u8_t addr[16];
+		u8_t len;
+	} prefixes[] = {
+		{ { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 2,
+		    0, 0, 0, 0, 0, 0, 0, 5 }, 128 },
+		{ { 0x20, 0x01, 0x0d, 0xb8, 0, 1 }, 48 },
+		{ { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 2 }, 64 },
+		{ { 0x20 }, 3 },
+	};
+	struct net_route_entry *routes[ARRAY_SIZE(prefixes)];
+	struct in6_addr dst = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 2,
+				    0, 0, 0, 0, 0, 0, 0, 5 } } };
+	int i;
+
+	/* The more specific route is added first */
+	for (i = 0; i < ARRAY_SIZE(prefixes); i++) {
+		routes[i] = net_route_add(my_iface,
+					  (struct in6_addr *)prefixes[i].addr,
+					  prefixes[i].len, &peer_addr);
+		zassert_not_null(routes[i], "Route add failed");
+	}
+
+	zassert_equal_ptr(net_route_lookup(my_iface, &dst), routes[0],
+			  "Host route not found");
+
+	dst.s6_addr[15] = 6;
+	zassert_equal_ptr(net_route_lookup(my_iface, &dst), routes[2],
+			  "/64 route not found");
+
+	dst.s6_addr[7] = 3;
+	zassert_equal_ptr(net_route_lookup(my_iface, &dst), routes[1],
+			  "/48 route not found");
+
+	dst.s6_addr[5] = 2;
+	zassert_equal_ptr(net_route_lookup(my_iface, &dst), routes[3],
+			  "/3 route not found");
+
+	dst.s6_addr[0] = 0x40;
+	zassert_is_null(net_route_lookup(my_iface, &dst),
+			"Unexpected route");
+
+	zassert_is_null(net_route_lookup(peer_iface, &dest_addr),
+			"Unexpected route on other interface");
+
+	/* The covering route is used once the more specific one is gone */
+	zassert_false(net_route_del(routes[2]), "Route del failed");
+
+	memcpy(&dst, prefixes[0].addr, sizeof(dst));
+	dst.s6_addr[15] = 6;
+	zassert_equal_ptr(net_route_lookup(my_iface, &dst), routes[1],
+			  "/48 route not found");
+
+	zassert_false(net_route_del(routes[1]), "Route del failed");
+	zassert_equal_ptr(net_route_lookup(my_iface, &dst), routes[3],
+			  "/3 route not found");
+
+	zassert_false(net_route_del(routes[3]), "Route del failed");
+	zassert_is_null(net_route_lookup(my_iface, &dst), "Unexpected route");
+
+	dst.s6_addr[15] = 5;
+	zassert_equal_ptr(net_route_lookup(my_iface, &dst), routes[0],
+			  "Host route not found");
+
+	zassert_false(net_route_del(routes[0]), "Route del failed");
+	zassert_is_null(net_route_lookup(my_iface, &dst), "Unexpected route");
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -487,6 +557,7 @@ void test_main(void)
 			ztest_unit_test(route_del_nexthop_again),
 			ztest_unit_test(populate_nbr_cache),
 			ztest_unit_test(route_add_many),
-			ztest_unit_test(route_del_many));
+			ztest_unit_test(route_del_many),
+			ztest_unit_test(route_lookup_prefix));
 	ztest_run_test_suite(test_route);
 }
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+
+#include "../../socket_helpers.h"
+
+#define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
+#define STRLEN(buf) (sizeof(buf) - 1)
+
+#define TEST_STR_SMALL "test"
+
+#define SERVER_PORT 4242
+#define CLIENT_PORT 9898
+
+/* On QEMU, epoll_wait() which waits takes +10ms from the requested time. */
+#define FUZZ 10
+
+#define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
+
+static int c_sock;
+static int s_sock;
+
+static void udp_setup(void)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	int res;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+}
+
+static void udp_teardown(void)
+{
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+static void send_small(void)
+{
+	ssize_t len;
+
+	len = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+}
+
+static void recv_small(void)
+{
+	char buf[10];
+	ssize_t len;
+
+	len = recv(s_sock, buf, sizeof(buf), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid recv len");
+}
+
+static void add(int epfd, int fd, u32_t events)
+{
+	struct epoll_event event = {
+		.events = events,
+		.data.fd = fd,
+	};
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event), 0,
+		      "epoll_ctl failed");
+}
+
+void test_epoll_api(void)
+{
+	struct epoll_event event = { .events = EPOLLIN };
+	struct epoll_event events[2];
+	int epfd;
+
+	zassert_equal(epoll_create(0), -1, "");
+	zassert_equal(errno, EINVAL, "");
+	zassert_equal(epoll_create1(1), -1, "");
+	zassert_equal(errno, EINVAL, "");
+
+	udp_setup();
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+
+	/* An epoll instance cannot be added to itself */
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, epfd, &event), -1, "");
+	zassert_equal(errno, EPERM, "");
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &event), -1, "");
+	zassert_equal(errno, ENOENT, "");
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL), -1, "");
+	zassert_equal(errno, ENOENT, "");
+
+	add(epfd, s_sock, EPOLLIN);
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &event), -1, "");
+	zassert_equal(errno, EEXIST, "");
+
+	zassert_equal(epoll_wait(epfd, events, 0, 0), -1, "");
+	zassert_equal(errno, EINVAL, "");
+	zassert_equal(epoll_wait(s_sock, events, 1, 0), -1, "");
+	zassert_equal(errno, EINVAL, "");
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL), 0, "");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	udp_teardown();
+}
+
+void test_epoll_level(void)
+{
+	struct epoll_event events[2];
+	u32_t tstamp;
+	int epfd, res;
+
+	udp_setup();
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	add(epfd, c_sock, EPOLLIN);
+	add(epfd, s_sock, EPOLLIN);
+
+	/* Wait for non-ready fd's with timeout of 0 */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 0, "");
+
+	/* Wait for non-ready fd's with timeout of 30 */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_true(tstamp >= 30 && tstamp <= 30 + FUZZ, "");
+	zassert_equal(res, 0, "");
+
+	/* Send pkt for s_sock, only s_sock is reported */
+	send_small();
+
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_true(tstamp <= FUZZ, "");
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	/* Level triggered, reported again until the data is read */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	recv_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	/* Closing a socket removes it from the instance */
+	res = close(s_sock);
+	zassert_equal(res, 0, "close failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(epfd), 0, "close failed");
+}
+
+void test_epoll_edge(void)
+{
+	struct epoll_event events[2];
+	int epfd, res;
+
+	udp_setup();
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	add(epfd, s_sock, EPOLLIN | EPOLLET);
+
+	/* Edge triggered, reported once per new packet */
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+
+	recv_small();
+	recv_small();
+
+	/* One shot, disabled after the first event until rearmed */
+	events[0].events = EPOLLIN | EPOLLONESHOT;
+	events[0].data.fd = s_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &events[0]);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 0, "");
+
+	/* Rearming reports the pending data */
+	events[0].events = EPOLLIN | EPOLLONESHOT;
+	events[0].data.fd = s_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &events[0]);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+
+	recv_small();
+	recv_small();
+
+	zassert_equal(close(epfd), 0, "close failed");
+
+	/* The sockets outlive the instance */
+	send_small();
+	recv_small();
+
+	udp_teardown();
+}
+
+void test_epoll_accept(void)
+{
+	struct sockaddr_in c_addr;
+	struct sockaddr_in s_addr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	struct epoll_event events[2];
+	int epfd, new_sock, res;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	zassert_equal(bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr)),
+		      0, "bind failed");
+	zassert_equal(listen(s_sock, 1), 0, "listen failed");
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	add(epfd, s_sock, EPOLLIN);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	/* A pending connection makes the listening socket readable */
+	zassert_equal(connect(c_sock, (struct sockaddr *)&s_addr,
+			      sizeof(s_addr)), 0, "connect failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 100);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	new_sock = accept(s_sock, &addr, &addrlen);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	/* Data and the peer closing the connection */
+	add(epfd, new_sock, EPOLLIN | EPOLLRDHUP);
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 100);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, new_sock, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+
+	zassert_equal(close(c_sock), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN | EPOLLRDHUP, "");
+
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+	zassert_equal(close(epfd), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_epoll,
+			 ztest_unit_test(test_epoll_api),
+			 ztest_unit_test(test_epoll_level),
+			 ztest_unit_test(test_epoll_edge),
+			 ztest_unit_test(test_epoll_accept));
+
+	ztest_run_test_suite(socket_epoll);
+}
@@ -326,6 +326,184 @@ void test_v6_sendto_recvfrom_null_dest(void)
 	k_sleep(TCP_TEARDOWN_TIMEOUT);
 }
 
+void test_v4_buf_size_options(void)
+{
+	/* Test SO_RCVBUF and SO_SNDBUF, and that an accepted socket inherits
+	 * them from the listening socket.
+	 */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	socklen_t optlen;
+	int optval;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	optval = 4096;
+	zassert_equal(setsockopt(s_sock, SOL_SOCKET, SO_RCVBUF, &optval,
+				 sizeof(optval)), 0, "setsockopt failed");
+	optval = 2048;
+	zassert_equal(setsockopt(s_sock, SOL_SOCKET, SO_SNDBUF, &optval,
+				 sizeof(optval)), 0, "setsockopt failed");
+
+	optval = -1;
+	zassert_equal(setsockopt(s_sock, SOL_SOCKET, SO_RCVBUF, &optval,
+				 sizeof(optval)), -1, "negative size accepted");
+	zassert_equal(errno, EINVAL, "unexpected errno");
+
+	zassert_equal(setsockopt(s_sock, IPPROTO_TCP, SO_RCVBUF, &optval,
+				 sizeof(optval)), -1, "wrong level accepted");
+	zassert_equal(errno, ENOPROTOOPT, "unexpected errno");
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_send(c_sock, TEST_STR_SMALL, strlen(TEST_STR_SMALL), 0);
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	optlen = sizeof(optval);
+	zassert_equal(getsockopt(new_sock, SOL_SOCKET, SO_RCVBUF, &optval,
+				 &optlen), 0, "getsockopt failed");
+	zassert_equal(optlen, sizeof(optval), "wrong optlen");
+	zassert_equal(optval, 4096, "SO_RCVBUF not inherited");
+
+	zassert_equal(getsockopt(new_sock, SOL_SOCKET, SO_SNDBUF, &optval,
+				 &optlen), 0, "getsockopt failed");
+	zassert_equal(optval, 2048, "SO_SNDBUF not inherited");
+
+	zassert_equal(getsockopt(c_sock, SOL_SOCKET, SO_RCVBUF, &optval,
+				 &optlen), 0, "getsockopt failed");
+	zassert_equal(optval, CONFIG_NET_TCP_RECV_BUF_SIZE,
+		      "unexpected default SO_RCVBUF");
+
+	test_recv(new_sock, 0);
+
+	test_close(new_sock);
+	test_close(c_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_recvmsg_partial(void)
+{
+	/* Test that recvmsg() returns what it got when the queue runs dry
+	 * before the last iovec, without leaving EAGAIN in errno.
+	 */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	char rx_buf[2][sizeof(TEST_STR_SMALL)] = { 0 };
+	struct iovec iov[2] = {
+		{ .iov_base = rx_buf[0], .iov_len = strlen(TEST_STR_SMALL) },
+		{ .iov_base = rx_buf[1], .iov_len = sizeof(rx_buf[1]) },
+	};
+	struct msghdr msg = {
+		.msg_iov = iov,
+		.msg_iovlen = ARRAY_SIZE(iov),
+	};
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_send(c_sock, TEST_STR_SMALL, strlen(TEST_STR_SMALL), 0);
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	errno = 0;
+	zassert_equal(recvmsg(new_sock, &msg, 0), strlen(TEST_STR_SMALL),
+		      "unexpected received bytes");
+	zassert_equal(errno, 0, "errno set by a successful recvmsg");
+	zassert_equal(strncmp(rx_buf[0], TEST_STR_SMALL,
+			      strlen(TEST_STR_SMALL)), 0, "unexpected data");
+
+	test_close(new_sock);
+	test_close(c_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_send_blocking(void)
+{
+	/* Test that a blocking send() waits for the send buffer to drain
+	 * instead of failing once SO_SNDBUF is used up.
+	 */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	char rx_buf[3 * sizeof(TEST_STR_SMALL)];
+	size_t total = 3 * strlen(TEST_STR_SMALL);
+	size_t recved = 0;
+	ssize_t ret;
+	int optval;
+	int i;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+
+	optval = strlen(TEST_STR_SMALL);
+	zassert_equal(setsockopt(c_sock, SOL_SOCKET, SO_SNDBUF, &optval,
+				 sizeof(optval)), 0, "setsockopt failed");
+
+	for (i = 0; i < 3; i++) {
+		test_send(c_sock, TEST_STR_SMALL, strlen(TEST_STR_SMALL), 0);
+	}
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	while (recved < total) {
+		ret = recv(new_sock, rx_buf + recved, sizeof(rx_buf) - recved,
+			   0);
+		zassert_true(ret > 0, "recv failed");
+		recved += ret;
+	}
+
+	zassert_equal(recved, total, "unexpected received bytes");
+
+	for (i = 0; i < 3; i++) {
+		zassert_equal(strncmp(rx_buf + i * strlen(TEST_STR_SMALL),
+				      TEST_STR_SMALL, strlen(TEST_STR_SMALL)),
+			      0, "unexpected data");
+	}
+
+	test_close(new_sock);
+	test_close(c_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_tcp,
@@ -334,7 +512,10 @@ void test_main(void)
 			 ztest_user_unit_test(test_v4_sendto_recvfrom),
 			 ztest_user_unit_test(test_v6_sendto_recvfrom),
 			 ztest_user_unit_test(test_v4_sendto_recvfrom_null_dest),
-			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest));
+			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest),
+			 ztest_user_unit_test(test_v4_buf_size_options),
+			 ztest_user_unit_test(test_v4_recvmsg_partial),
+			 ztest_user_unit_test(test_v4_send_blocking));
 
 	ztest_run_test_suite(socket_tcp);
 }
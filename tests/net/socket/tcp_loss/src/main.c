@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/loopback.h>
+
+/* Bulk TCP transfer over the loopback interface while it drops a share
+ * of the packets. The received stream must be intact, the goodput is
+ * printed so that retransmission strategies can be compared.
+ */
+
+#define SERVER_PORT 4243
+
+#define TOTAL_LEN (16 * 1024)
+#define CHUNK_LEN 256
+
+#define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
+
+#define RECV_STACK_SIZE 2048
+#define RECV_PRIORITY K_PRIO_PREEMPT(8)
+
+static K_THREAD_STACK_DEFINE(recv_stack, RECV_STACK_SIZE);
+static struct k_thread recv_thread;
+static K_SEM_DEFINE(recv_done, 0, 1);
+
+static int s_sock;
+static size_t received;
+static bool intact;
+
+static void recv_entry(void *p1, void *p2, void *p3)
+{
+	u8_t buf[CHUNK_LEN];
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	int sock;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	received = 0;
+	intact = true;
+
+	sock = accept(s_sock, &addr, &addrlen);
+	if (sock < 0) {
+		intact = false;
+		k_sem_give(&recv_done);
+		return;
+	}
+
+	while (received < TOTAL_LEN) {
+		ssize_t len = recv(sock, buf, sizeof(buf), 0);
+		ssize_t i;
+
+		if (len <= 0) {
+			break;
+		}
+
+		for (i = 0; i < len; i++) {
+			if (buf[i] != (u8_t)(received + i)) {
+				intact = false;
+			}
+		}
+
+		received += len;
+	}
+
+	close(sock);
+	k_sem_give(&recv_done);
+}
+
+static void transfer(u8_t drop_rate)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	u32_t dropped, start, elapsed;
+	u8_t buf[CHUNK_LEN];
+	size_t sent = 0;
+	int c_sock;
+
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&addr.sin_addr), 1, "inet_pton failed");
+
+	s_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(s_sock >= 0, "socket open failed");
+	c_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(c_sock >= 0, "socket open failed");
+
+	zassert_equal(bind(s_sock, (struct sockaddr *)&addr, sizeof(addr)), 0,
+		      "bind failed");
+	zassert_equal(listen(s_sock, 1), 0, "listen failed");
+
+	k_thread_create(&recv_thread, recv_stack, RECV_STACK_SIZE,
+			recv_entry, NULL, NULL, NULL, RECV_PRIORITY, 0,
+			K_NO_WAIT);
+
+	zassert_equal(connect(c_sock, (struct sockaddr *)&addr, sizeof(addr)),
+		      0, "connect failed");
+
+	/* Only the data transfer is lossy */
+	dropped = loopback_get_num_dropped_packets();
+	zassert_equal(loopback_set_packet_drop_rate(drop_rate), 0,
+		      "cannot set drop rate");
+
+	start = k_uptime_get_32();
+
+	/* A write can be cut short by the send buffer limit */
+	while (sent < TOTAL_LEN) {
+		ssize_t len;
+		size_t i;
+
+		for (i = 0; i < sizeof(buf); i++) {
+			buf[i] = (u8_t)(sent + i);
+		}
+
+		len = send(c_sock, buf, sizeof(buf), 0);
+		zassert_true(len > 0, "send failed (%d)", errno);
+		sent += len;
+	}
+
+	zassert_equal(k_sem_take(&recv_done, K_SECONDS(120)), 0,
+		      "transfer timed out, %u of %u bytes received",
+		      received, TOTAL_LEN);
+
+	elapsed = MAX(k_uptime_get_32() - start, 1U);
+	dropped = loopback_get_num_dropped_packets() - dropped;
+
+	loopback_set_packet_drop_rate(0);
+
+	TC_PRINT("%u%% loss: %u bytes in %u ms (%u bytes/s), "
+		 "%u packets dropped\n", drop_rate, received, elapsed,
+		 (u32_t)((u64_t)received * MSEC_PER_SEC / elapsed), dropped);
+
+	zassert_equal(received, TOTAL_LEN, "short transfer");
+	zassert_true(intact, "corrupted data");
+
+	if (drop_rate > 0) {
+		zassert_true(dropped > 0, "no packets dropped");
+	}
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_no_loss(void)
+{
+	transfer(0);
+}
+
+void test_loss_2_percent(void)
+{
+	transfer(2);
+}
+
+void test_loss_10_percent(void)
+{
+	transfer(10);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_tcp_loss,
+			 ztest_unit_test(test_no_loss),
+			 ztest_unit_test(test_loss_2_percent),
+			 ztest_unit_test(test_loss_10_percent));
+
+	ztest_run_test_suite(socket_tcp_loss);
+}
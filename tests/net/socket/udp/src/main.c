@@ -11,6 +11,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <ztest_assert.h>
 
 #include <net/socket.h>
+#include <net/net_pkt.h>
 
 #include "../../socket_helpers.h"
 
@@ -301,6 +302,236 @@ void test_send_recv_2_sock(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+void test_v6_zero_copy(void)
+{
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in6 client_addr;
+	struct sockaddr_in6 server_addr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	struct net_buf *buf, *frag;
+	char rx_buf[sizeof(TEST_STR2)];
+	size_t half = STRLEN(TEST_STR2) / 2;
+	ssize_t len;
+	int rv;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = bind(client_sock, (struct sockaddr *)&client_addr,
+		  sizeof(client_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	/* Payload split over two buffers, sent as they are */
+	buf = net_pkt_get_reserve_tx_data(K_NO_WAIT);
+	zassert_not_null(buf, "cannot allocate buffer");
+	frag = net_pkt_get_reserve_tx_data(K_NO_WAIT);
+	zassert_not_null(frag, "cannot allocate buffer");
+
+	net_buf_add_mem(buf, TEST_STR2, half);
+	net_buf_add_mem(frag, TEST_STR2 + half, STRLEN(TEST_STR2) - half);
+	net_buf_frag_add(buf, frag);
+
+	len = zsock_sendto_buf(client_sock, buf, 0,
+			       (struct sockaddr *)&server_addr,
+			       sizeof(server_addr));
+	zassert_equal(len, STRLEN(TEST_STR2), "invalid send len");
+
+	len = zsock_recvfrom_buf(server_sock, &buf, 0, &addr, &addrlen);
+	zassert_equal(len, STRLEN(TEST_STR2), "invalid recv len");
+	zassert_not_null(buf, "no buffer");
+	zassert_equal(net_buf_frags_len(buf), len, "invalid buffer len");
+	zassert_equal(addrlen, sizeof(struct sockaddr_in6), "wrong addrlen");
+	zassert_equal(net_sin6(&addr)->sin6_port, client_addr.sin6_port,
+		      "wrong source port");
+
+	clear_buf(rx_buf);
+	net_buf_linearize(rx_buf, sizeof(rx_buf), buf, 0, len);
+	zassert_mem_equal(rx_buf, BUF_AND_SIZE(TEST_STR2), "Wrong data");
+	net_buf_unref(buf);
+
+	/* Connected socket, then nothing left to receive */
+	rv = connect(client_sock, (struct sockaddr *)&server_addr,
+		     sizeof(server_addr));
+	zassert_equal(rv, 0, "connect failed");
+
+	buf = net_pkt_get_reserve_tx_data(K_NO_WAIT);
+	zassert_not_null(buf, "cannot allocate buffer");
+	net_buf_add_mem(buf, TEST_STR_SMALL, STRLEN(TEST_STR_SMALL));
+
+	len = zsock_send_buf(client_sock, buf, 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+
+	len = zsock_recv_buf(server_sock, &buf, 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid recv len");
+	zassert_equal(buf->len, len, "invalid buffer len");
+	zassert_mem_equal(buf->data, BUF_AND_SIZE(TEST_STR_SMALL),
+			  "Wrong data");
+	net_buf_unref(buf);
+
+	len = zsock_recv_buf(server_sock, &buf, MSG_DONTWAIT);
+	zassert_equal(len, -1, "unexpected data");
+	zassert_equal(errno, EAGAIN, "wrong errno");
+	zassert_is_null(buf, "unexpected buffer");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v4_sendmsg_recvmsg(void)
+{
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in addr;
+	char rx_buf[2][8];
+	struct iovec iov[3];
+	struct msghdr msg;
+	ssize_t len;
+	int rv;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	/* Odd sized pieces, the checksum spans them */
+	iov[0].iov_base = (void *)(TEST_STR2);
+	iov[0].iov_len = 3;
+	iov[1].iov_base = (void *)(TEST_STR2 + 3);
+	iov[1].iov_len = 0;
+	iov[2].iov_base = (void *)(TEST_STR2 + 3);
+	iov[2].iov_len = 12;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &server_addr;
+	msg.msg_namelen = sizeof(server_addr);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = ARRAY_SIZE(iov);
+
+	len = sendmsg(client_sock, &msg, 0);
+	zassert_equal(len, 15, "invalid send len");
+
+	/* Scattered over two buffers, the rest is truncated */
+	iov[0].iov_base = rx_buf[0];
+	iov[0].iov_len = sizeof(rx_buf[0]);
+	iov[1].iov_base = rx_buf[1];
+	iov[1].iov_len = 5;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &addr;
+	msg.msg_namelen = sizeof(addr);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	len = recvmsg(server_sock, &msg, 0);
+	zassert_equal(len, 13, "invalid recv len");
+	zassert_mem_equal(rx_buf[0], TEST_STR2, 8, "wrong data");
+	zassert_mem_equal(rx_buf[1], TEST_STR2 + 8, 5, "wrong data");
+	zassert_equal(msg.msg_flags, MSG_TRUNC, "not truncated");
+	zassert_equal(msg.msg_namelen, sizeof(addr), "wrong addrlen");
+	zassert_equal(addr.sin_port, client_addr.sin_port,
+		      "wrong source port");
+
+	len = recvmsg(server_sock, &msg, MSG_DONTWAIT);
+	zassert_equal(len, -1, "unexpected data");
+	zassert_equal(errno, EAGAIN, "wrong errno");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v6_sendmmsg_recvmmsg(void)
+{
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in6 client_addr;
+	struct sockaddr_in6 server_addr;
+	char rx_buf[3][8];
+	struct iovec tx_iov[3];
+	struct iovec rx_iov[3];
+	struct mmsghdr msgs[3];
+	int i;
+	int rv;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = connect(client_sock, (struct sockaddr *)&server_addr,
+		     sizeof(server_addr));
+	zassert_equal(rv, 0, "connect failed");
+
+	memset(msgs, 0, sizeof(msgs));
+
+	for (i = 0; i < ARRAY_SIZE(msgs); i++) {
+		tx_iov[i].iov_base = (void *)(TEST_STR2 + i);
+		tx_iov[i].iov_len = i + 1;
+		msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	rv = sendmmsg(client_sock, msgs, ARRAY_SIZE(msgs), 0);
+	zassert_equal(rv, ARRAY_SIZE(msgs), "invalid number of messages");
+
+	memset(msgs, 0, sizeof(msgs));
+
+	for (i = 0; i < ARRAY_SIZE(msgs); i++) {
+		zassert_equal(msgs[i].msg_len, 0, "");
+		rx_iov[i].iov_base = rx_buf[i];
+		rx_iov[i].iov_len = sizeof(rx_buf[i]);
+		msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	/* Only the first one waits */
+	rv = recvmmsg(server_sock, msgs, ARRAY_SIZE(msgs), MSG_WAITFORONE);
+	zassert_true(rv >= 1, "no messages");
+
+	if (rv < ARRAY_SIZE(msgs)) {
+		rv += recvmmsg(server_sock, &msgs[rv], ARRAY_SIZE(msgs) - rv,
+			       0);
+	}
+
+	zassert_equal(rv, ARRAY_SIZE(msgs), "invalid number of messages");
+
+	for (i = 0; i < ARRAY_SIZE(msgs); i++) {
+		zassert_equal(msgs[i].msg_len, i + 1, "invalid recv len");
+		zassert_mem_equal(rx_buf[i], TEST_STR2 + i, i + 1,
+				  "wrong data");
+	}
+
+	rv = recvmmsg(server_sock, msgs, ARRAY_SIZE(msgs), MSG_DONTWAIT);
+	zassert_equal(rv, -1, "unexpected data");
+	zassert_equal(errno, EAGAIN, "wrong errno");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_udp,
@@ -308,7 +539,10 @@ void test_main(void)
 			 ztest_unit_test(test_v4_sendto_recvfrom),
 			 ztest_unit_test(test_v6_sendto_recvfrom),
 			 ztest_unit_test(test_v4_bind_sendto),
-			 ztest_unit_test(test_v6_bind_sendto));
+			 ztest_unit_test(test_v6_bind_sendto),
+			 ztest_unit_test(test_v6_zero_copy),
+			 ztest_unit_test(test_v4_sendmsg_recvmsg),
+			 ztest_unit_test(test_v6_sendmmsg_recvmmsg));
 
 	ztest_run_test_suite(socket_udp);
 }
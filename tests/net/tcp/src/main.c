@@ -1519,18 +1519,15 @@ static bool test_init_tcp_context(void)
 	return true;
 }
 
-/* Receive window helper function copied from tcp.c */
+/* Receive window helper function */
 static inline u32_t get_recv_wnd(struct net_tcp *tcp)
 {
 	ARG_UNUSED(tcp);
 
-	/* We don't queue received data inside the stack, we hand off
-	 * packets to synchronous callbacks (who can queue if they
-	 * want, but it's not our business).  So the available window
-	 * size is always the same.  There are two configurables to
-	 * check though.
+	/* Nothing is read through sockets here, so the receive buffer is
+	 * always empty and the window is the configured buffer size.
 	 */
-	return MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
+	return CONFIG_NET_TCP_RECV_BUF_SIZE;
 }
 
 static bool test_tcp_seq_validity(void)
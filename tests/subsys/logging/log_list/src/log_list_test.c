@@ -83,11 +83,56 @@ void test_log_list_multiple_items(void)
 	zassert_true(log_list_head_get(&my_list) == NULL,
 		     "Expected empty list.\n");
 }
+void test_log_list_get_n(void)
+{
+	struct log_list_t my_list;
+
+	log_list_init(&my_list);
+
+	struct log_msg msg[10];
+	struct log_msg *head;
+	u32_t cnt;
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		log_list_add_tail(&my_list, &msg[i]);
+	}
+
+	cnt = 4;
+	head = log_list_head_get_n(&my_list, &cnt);
+	zassert_equal(cnt, 4, "Unexpected count %d.\n", cnt);
+	for (i = 0; i < 4; i++) {
+		zassert_true(&msg[i] == head, "Unexpected message.\n");
+		head = head->next;
+	}
+
+	zassert_true(&msg[4] == log_list_head_peek(&my_list),
+		     "Unexpected head.\n");
+
+	cnt = 20;
+	head = log_list_head_get_n(&my_list, &cnt);
+	zassert_equal(cnt, 6, "Unexpected count %d.\n", cnt);
+	zassert_true(&msg[4] == head, "Unexpected message.\n");
+	zassert_true(log_list_head_peek(&my_list) == NULL,
+		     "Expected empty list.\n");
+
+	cnt = 1;
+	head = log_list_head_get_n(&my_list, &cnt);
+	zassert_equal(cnt, 0, "Unexpected count %d.\n", cnt);
+	zassert_true(head == NULL, "Expected empty list.\n");
+
+	/* List remains usable after being emptied */
+	log_list_add_tail(&my_list, &msg[0]);
+	zassert_true(&msg[0] == log_list_head_get(&my_list),
+		     "Unexpected head.\n");
+}
+
 /*test case main entry*/
 void test_main(void)
 {
 	ztest_test_suite(test_log_list,
 			 ztest_unit_test(test_log_list),
-			 ztest_unit_test(test_log_list_multiple_items));
+			 ztest_unit_test(test_log_list_multiple_items),
+			 ztest_unit_test(test_log_list_get_n));
 	ztest_run_test_suite(test_log_list);
 }
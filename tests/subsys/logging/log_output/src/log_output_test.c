@@ -10,6 +10,7 @@
  */
 
 #include <logging/log_output.h>
+#include <logging/log_output_dict.h>
 
 #include <tc_util.h>
 #include <stdbool.h>
@@ -145,6 +146,95 @@ void test_log_output_string(void)
 	validate_output_string(exp_str_no_crlf);
 }
 
+#ifdef CONFIG_LOG_OUTPUT_DICTIONARY
+static void msg_ids_set(struct log_msg *msg, u32_t timestamp)
+{
+	msg->hdr.ids.level = LOG_LEVEL_INF;
+	msg->hdr.ids.domain_id = CONFIG_LOG_DOMAIN_ID;
+	msg->hdr.ids.source_id = log_const_source_id(
+				&LOG_ITEM_CONST_DATA(LOG_MODULE_NAME));
+	msg->hdr.timestamp = timestamp;
+}
+
+void test_log_output_dict(void)
+{
+	static const char fmt[] = "abc %d %s";
+	static const char meta[] = "data";
+	static const u8_t data[] = {1, 2, 3, 4, 5};
+	char str[] = "xy";
+	struct log_dict_msg_hdr exp = {
+		.type = LOG_DICT_PKT_STD,
+		.nargs = 2,
+		.ids = LOG_LEVEL_INF | (CONFIG_LOG_DOMAIN_ID << 3) |
+		       (log_const_source_id(
+				&LOG_ITEM_CONST_DATA(LOG_MODULE_NAME)) << 6),
+		.timestamp = 1234,
+		.fmt = (u32_t)fmt,
+	};
+	u32_t exp_args[] = {7, (u32_t)str};
+	struct log_dict_dropped_pkt exp_dropped = {
+		.type = LOG_DICT_PKT_DROPPED,
+		.cnt = 3,
+	};
+	struct log_msg *msg;
+	u16_t len;
+	u8_t *p = mock_buffer;
+
+	msg = log_msg_create_2(fmt, 7, (u32_t)str);
+	zassert_not_null(msg, "Failed to allocate message");
+	msg_ids_set(msg, 1234);
+
+	log_output_dict_msg_process(&log_output, msg, 0);
+	log_msg_put(msg);
+
+	/* Header, raw arguments and the %s string, nothing formatted */
+	zassert_equal(mock_len, sizeof(exp) + sizeof(exp_args) + sizeof(str),
+		      "Unexpected packet length %d", mock_len);
+	zassert_equal(memcmp(p, &exp, sizeof(exp)), 0, "Unexpected header");
+	p += sizeof(exp);
+	zassert_equal(memcmp(p, exp_args, sizeof(exp_args)), 0,
+		      "Unexpected arguments");
+	p += sizeof(exp_args);
+	zassert_equal(strcmp((char *)p, str), 0, "Unexpected string");
+
+	reset_mock_buffer();
+
+	msg = log_msg_hexdump_create(meta, data, sizeof(data));
+	zassert_not_null(msg, "Failed to allocate message");
+	msg_ids_set(msg, 1234);
+
+	log_output_dict_msg_process(&log_output, msg, 0);
+	log_msg_put(msg);
+
+	exp.type = LOG_DICT_PKT_HEXDUMP;
+	exp.nargs = 0;
+	exp.fmt = (u32_t)meta;
+	len = sizeof(data);
+
+	zassert_equal(mock_len, sizeof(exp) + sizeof(len) + sizeof(data),
+		      "Unexpected packet length %d", mock_len);
+	p = mock_buffer;
+	zassert_equal(memcmp(p, &exp, sizeof(exp)), 0, "Unexpected header");
+	p += sizeof(exp);
+	zassert_equal(memcmp(p, &len, sizeof(len)), 0, "Unexpected length");
+	p += sizeof(len);
+	zassert_equal(memcmp(p, data, sizeof(data)), 0, "Unexpected data");
+
+	reset_mock_buffer();
+
+	log_output_dict_dropped_process(&log_output, 3);
+	zassert_equal(mock_len, sizeof(exp_dropped),
+		      "Unexpected packet length %d", mock_len);
+	zassert_equal(memcmp(mock_buffer, &exp_dropped, sizeof(exp_dropped)),
+		      0, "Unexpected packet");
+}
+#else
+void test_log_output_dict(void)
+{
+	ztest_test_skip();
+}
+#endif
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -152,6 +242,8 @@ void test_main(void)
 		ztest_unit_test_setup_teardown(test_log_output_raw_string,
 					       setup, teardown),
 		ztest_unit_test_setup_teardown(test_log_output_string,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict,
 					       setup, teardown)
 		);
 	ztest_run_test_suite(test_log_message);
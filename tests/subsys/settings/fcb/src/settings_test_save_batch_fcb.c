@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "settings_test.h"
+#include "settings/settings_fcb.h"
+
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+static int test_config_save_batch(u8_t v8, u64_t v64)
+{
+	int rc;
+
+	rc = settings_save_begin();
+	zassert_true(rc == 0, "can't begin batch");
+
+	/* a later value within the batch overrides an earlier one */
+	v8--;
+	rc = settings_save_one("myfoo/mybar", &v8, sizeof(v8));
+	zassert_true(rc == 0, "batched write error");
+	v8++;
+	rc = settings_save_one("myfoo/mybar", &v8, sizeof(v8));
+	zassert_true(rc == 0, "batched write error");
+	rc = settings_save_one("myfoo/mybar64", &v64, sizeof(v64));
+	zassert_true(rc == 0, "batched write error");
+
+	return settings_save_end();
+}
+
+void test_config_save_batch_fcb(void)
+{
+	int rc;
+	int i;
+	struct settings_fcb cf;
+
+	config_wipe_srcs();
+	config_wipe_fcb(fcb_sectors, ARRAY_SIZE(fcb_sectors));
+
+	cf.cf_fcb.f_magic = CONFIG_SETTINGS_FCB_MAGIC;
+	cf.cf_fcb.f_sectors = fcb_sectors;
+	cf.cf_fcb.f_sector_cnt = ARRAY_SIZE(fcb_sectors);
+
+	rc = settings_fcb_src(&cf);
+	zassert_true(rc == 0, "can't register FCB as configuration source");
+
+	rc = settings_fcb_dst(&cf);
+	zassert_true(rc == 0,
+		     "can't register FCB as configuration destination");
+
+	rc = settings_save_end();
+	zassert_true(rc == -EINVAL, "batch ended without being started");
+
+	val8 = 33U;
+	rc = settings_save_one("myfoo/mybar", &val8, sizeof(val8));
+	zassert_true(rc == 0, "fcb one item write error");
+
+	rc = settings_save_begin();
+	zassert_true(rc == 0, "can't begin batch");
+	rc = settings_save_begin();
+	zassert_true(rc == -EBUSY, "nested batch started");
+
+	val8 = 42U;
+	rc = settings_save_one("myfoo/mybar", &val8, sizeof(val8));
+	zassert_true(rc == 0, "batched write error");
+
+	/* nothing reaches the storage before the batch ends */
+	rc = settings_load();
+	zassert_true(rc == 0, "fcb read error");
+	zassert_true(val8 == 33U, "batched value stored early");
+
+	rc = settings_save_end();
+	zassert_true(rc == 0, "can't end batch");
+
+	rc = settings_load();
+	zassert_true(rc == 0, "fcb read error");
+	zassert_true(val8 == 42U, "bad value read");
+
+	/* enough batches to fill the FCB sectors and have them compressed */
+	for (i = 0; i < 1024; i++) {
+		rc = test_config_save_batch(i, 0x100000000ULL * i + i);
+		zassert_true(rc == 0, "can't save batch %d", i);
+
+		val8 = 0U;
+		val64 = 0U;
+		rc = settings_load();
+		zassert_true(rc == 0, "fcb read error");
+		zassert_true(val8 == (u8_t)i, "bad value read");
+		zassert_true(val64 == 0x100000000ULL * i + i,
+			     "bad value read");
+	}
+}
+#else
+void test_config_save_batch_fcb(void)
+{
+	ztest_test_skip();
+}
+#endif
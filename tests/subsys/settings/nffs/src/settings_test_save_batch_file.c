@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "settings_test.h"
+#include "settings/settings_file.h"
+
+#ifdef CONFIG_SETTINGS_SAVE_BATCH
+static int test_config_save_batch(u8_t v8, u64_t v64)
+{
+	int rc;
+
+	rc = settings_save_begin();
+	zassert_true(rc == 0, "can't begin batch");
+
+	/* a later value within the batch overrides an earlier one */
+	v8--;
+	rc = settings_save_one("myfoo/mybar", &v8, sizeof(v8));
+	zassert_true(rc == 0, "batched write error");
+	v8++;
+	rc = settings_save_one("myfoo/mybar", &v8, sizeof(v8));
+	zassert_true(rc == 0, "batched write error");
+	rc = settings_save_one("myfoo/mybar64", &v64, sizeof(v64));
+	zassert_true(rc == 0, "batched write error");
+
+	return settings_save_end();
+}
+
+void test_config_save_batch_file(void)
+{
+	int rc;
+	int i;
+	struct settings_file cf = {
+		.cf_name = TEST_CONFIG_DIR "/batch",
+		.cf_maxlines = 8,
+	};
+	struct settings_file cf2 = {
+		.cf_name = TEST_CONFIG_DIR "/batch",
+	};
+
+	config_wipe_srcs();
+
+	rc = fs_mkdir(TEST_CONFIG_DIR);
+	zassert_true(rc == 0 || rc == -EEXIST, "can't create directory");
+
+	(void)fs_unlink(cf.cf_name);
+
+	rc = settings_file_src(&cf);
+	zassert_true(rc == 0, "can't register FS as configuration source");
+
+	rc = settings_file_dst(&cf);
+	zassert_true(rc == 0,
+		     "can't register FS as configuration destination");
+
+	rc = settings_save_end();
+	zassert_true(rc == -EINVAL, "batch ended without being started");
+
+	val8 = 33U;
+	rc = settings_save_one("myfoo/mybar", &val8, sizeof(val8));
+	zassert_true(rc == 0, "fs one item write error");
+
+	rc = settings_save_begin();
+	zassert_true(rc == 0, "can't begin batch");
+	rc = settings_save_begin();
+	zassert_true(rc == -EBUSY, "nested batch started");
+
+	val8 = 42U;
+	rc = settings_save_one("myfoo/mybar", &val8, sizeof(val8));
+	zassert_true(rc == 0, "batched write error");
+
+	/* nothing reaches the file before the batch ends */
+	rc = settings_load();
+	zassert_true(rc == 0, "fs read error");
+	zassert_true(val8 == 33U, "batched value stored early");
+
+	rc = settings_save_end();
+	zassert_true(rc == 0, "can't end batch");
+
+	rc = settings_load();
+	zassert_true(rc == 0, "fs read error");
+	zassert_true(val8 == 42U, "bad value read");
+
+	/* each batch replaces the file through a rename */
+	for (i = 0; i < 32; i++) {
+		rc = test_config_save_batch(i, 0x100000000ULL * i + i);
+		zassert_true(rc == 0, "can't save batch %d", i);
+
+		val8 = 0U;
+		val64 = 0U;
+		rc = settings_load();
+		zassert_true(rc == 0, "fs read error");
+		zassert_true(val8 == (u8_t)i, "bad value read");
+		zassert_true(val64 == 0x100000000ULL * i + i,
+			     "bad value read");
+	}
+
+	/* the renamed file holds the last batch for a new source too */
+	config_wipe_srcs();
+
+	rc = settings_file_src(&cf2);
+	zassert_true(rc == 0, "can't register FS as configuration source");
+
+	val8 = 0U;
+	val64 = 0U;
+	rc = settings_load();
+	zassert_true(rc == 0, "fs read error");
+	zassert_true(val8 == 31U, "bad value read");
+	zassert_true(val64 == 0x100000000ULL * 31 + 31, "bad value read");
+}
+#else
+void test_config_save_batch_file(void)
+{
+	ztest_test_skip();
+}
+#endif